@@ -986,4 +986,30 @@
     #endif
   #endif
 
+  #if ENABLED(SLOWDOWN) && !defined(SLOWDOWN_QUEUE_TIME)
+    #define SLOWDOWN_QUEUE_TIME 100000
+  #endif
+  #if ENABLED(PLANNER_UNDERRUN_STATS) && !defined(PLANNER_UNDERRUN_WINDOW)
+    #define PLANNER_UNDERRUN_WINDOW 1000
+  #endif
+
+  // Adaptive arc segments, for configurations that only set MM_PER_ARC_SEGMENT
+  #if ENABLED(ARC_SUPPORT)
+    #ifndef MIN_ARC_SEGMENT_MM
+      #define MIN_ARC_SEGMENT_MM 0.1
+    #endif
+    #ifndef ARC_MAX_CHORD_ERROR
+      #define ARC_MAX_CHORD_ERROR 0.01
+    #endif
+    #ifndef ARC_SEGMENTS_PER_SEC
+      #define ARC_SEGMENTS_PER_SEC 100
+    #endif
+  #endif
+
+  // Track the queued execution time of the planner buffer
+  #define HAS_BLOCK_BUFFER_RUNTIME (ENABLED(SLOWDOWN) || ENABLED(ULTRA_LCD) || ENABLED(PLANNER_UNDERRUN_STATS) || ENABLED(TOOLCHANGE_PREHEAT))
+
+  // Keep the flow of each block for the hotend feed-forward
+  #define HAS_EXTRUSION_RATE (ENABLED(PID_EXTRUSION_FEEDFORWARD) || ENABLED(MPCTEMP))
+
 #endif // CONDITIONALS_POST_H
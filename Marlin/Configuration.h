@@ -708,6 +708,27 @@
 // Use double touch for probing
 //#define PROBE_DOUBLE_TOUCH
 
+/**
+ * Fast G29 grid probing. After the first point each point is approached
+ * from the height where the probe triggered at the previous point instead
+ * of from Z_CLEARANCE_BETWEEN_PROBES:
+ *  - The lift to G29_FAST_PROBE_CLEARANCE above that height is one move
+ *    with the XY travel.
+ *  - The probe descends at Z_PROBE_SPEED_FAST to G29_FAST_PROBE_MARGIN
+ *    above that height and only the rest at Z_PROBE_SPEED_SLOW.
+ *  - If it triggers during the fast descent it backs off and confirms
+ *    the point with a slow touch.
+ *  - A BLTouch is not stowed between points. The pin retracts itself on
+ *    each trigger and is deployed again at the next point.
+ * The clearance must leave room for the deployed probe over the largest
+ * height change between two neighbouring points. G29 E disables it.
+ */
+//#define G29_FAST_PROBE
+#if ENABLED(G29_FAST_PROBE)
+  #define G29_FAST_PROBE_CLEARANCE 2  // (mm) Travel height above the previous trigger height
+  #define G29_FAST_PROBE_MARGIN    1  // (mm) Slow probe from this far above the previous trigger height
+#endif
+
 /**
  * Z probes require clearance when deploying, stowing, and moving between
  * probe points to avoid hitting the bed and other hardware.
@@ -915,6 +936,64 @@
       #define BILINEAR_SUBDIVISIONS 3
     #endif
 
+    //
+    // Keep the bilinear slopes of each grid box in a table, rebuilt whenever
+    // the grid changes, so each leveled move is a table lookup and three
+    // multiply-adds. Uses 12 bytes of RAM per box: 432 for a 7x7 grid, but
+    // with ABL_BILINEAR_SUBDIVISION the boxes are those of the subdivided
+    // grid, 1728 bytes with 2 subdivisions and 3888 with 3. At most 2048.
+    //
+    //#define ABL_BILINEAR_CELL_CACHE
+
+    //
+    // G29 U checks the stored grid instead of probing all of it. Every
+    // INCREMENTAL_PROBE_STRIDE-th point in each direction (and the last row
+    // and column) is probed, and the points around any that moved by more
+    // than INCREMENTAL_PROBE_THRESHOLD are probed again. Without a complete
+    // grid of the same size G29 U probes every point.
+    //
+    //#define ABL_INCREMENTAL_PROBE
+    #if ENABLED(ABL_INCREMENTAL_PROBE)
+      #define INCREMENTAL_PROBE_STRIDE      3 // 9 of 49 points on a 7x7 grid
+      #define INCREMENTAL_PROBE_THRESHOLD 0.05 // (mm)
+    #endif
+
+    //
+    // While a file prints, G29 probes only the grid points around the print.
+    // The area is read from the ;MINX: ;MINY: ;MAXX: ;MAXY: header (Cura) or
+    // else from the extruding moves of the whole file, and widened by
+    // PRINT_AREA_MARGIN. The other points keep their stored values, or are
+    // extrapolated if there are none. G29 with L, R, F or B probes as given.
+    // Files longer than PRINT_AREA_SCAN_LIMIT are only searched for the
+    // header, in their first PRINT_AREA_HEADER_SCAN bytes, and without one
+    // the whole grid is probed. Requires SDSUPPORT or UDISKSUPPORT.
+    //
+    //#define ABL_PRINT_AREA
+    #if ENABLED(ABL_PRINT_AREA)
+      #define PRINT_AREA_MARGIN 10          // (mm) Around the print
+      #define PRINT_AREA_SCAN_LIMIT 1000000 // (bytes) Longest file read through for its moves
+      #define PRINT_AREA_HEADER_SCAN 4096   // (bytes) Start of a longer file searched for the header
+    #endif
+
+    //
+    // Keep grids probed at up to THERMAL_MESHES bed temperatures in EEPROM.
+    // G29 saves its grid for the bed temperature, replacing the one probed
+    // within THERMAL_MESH_MATCH of it. When the bed temperature has moved by
+    // THERMAL_MESH_HYSTERESIS the grid in use is interpolated between the
+    // stored grids on either side of it, or is the nearest one beyond them.
+    // While printing this happens only after M190.
+    // After M421 or G29 W the edited grid stays in use until M500 stores it
+    // for the temperature it was edited at, or the next G29.
+    // M420 T lists the stored grids and M420 T0 deletes them.
+    // Requires EEPROM_SETTINGS.
+    //
+    //#define ABL_THERMAL_MESHES
+    #if ENABLED(ABL_THERMAL_MESHES)
+      #define THERMAL_MESHES          4 // Each takes 4 bytes of EEPROM per grid point
+      #define THERMAL_MESH_MATCH      5 // (°C) G29 replaces a grid probed this close to the bed temperature
+      #define THERMAL_MESH_HYSTERESIS 2 // (°C)
+    #endif
+
   #endif
 
 #elif ENABLED(AUTO_BED_LEVELING_3POINT)
@@ -1032,6 +1111,15 @@
 //#define DISABLE_M503    // Saves ~2700 bytes of PROGMEM. Disable for release!
 //#define EEPROM_CHITCHAT   // Give feedback on EEPROM commands. Disable to save PROGMEM.
 
+//
+// Store the leveling grid (MESH_BED_LEVELING or AUTO_BED_LEVELING_BILINEAR)
+// as 16-bit steps from a base Z, with the step size and a CRC: 10 bytes and
+// 2 per point instead of 4 per point. A grid that fails the CRC isn't loaded.
+// Moves the settings stored after the grid: the stored version is marked,
+// so settings stored with the other layout are reset to their defaults.
+//
+//#define EEPROM_MESH_COMPRESSION
+
 //
 // Host Keepalive
 //
@@ -98,6 +98,42 @@
   #define WATCH_BED_TEMP_INCREASE 2               // Degrees Celsius
 #endif
 
+/**
+ * Model based heater and sensor fault detection for the hotends
+ *
+ * A thermal model of each hotend is run from the heater power and the part
+ * cooling fan, and pulled slowly toward the measured temperature. A working
+ * hotend stays within the error that the heat flows of the model can explain.
+ * A heater cartridge or sensor out of the block, a sensor that reads ambient,
+ * or a heater that stays on with the target at 0 take the reading away from
+ * the model, and the machine is halted with "Heater or sensor fault".
+ *
+ * With MPCTEMP the model set by M306 is used, otherwise the one below (M303
+ * with PID_AUTOTUNE_FAST reports the gain and time constant). The model must
+ * be within about 20% of the real hotend. This works alongside the thermal
+ * runaway checks above, which can then be set looser without slower detection.
+ * buildroot/share/scripts/thermalModelSim.py injects faults into a simulated hotend.
+ */
+//#define THERMAL_PROTECTION_MODEL
+#if ENABLED(THERMAL_PROTECTION_MODEL)
+  #define THERMAL_MODEL_PERIOD 2                  // (s) How long the reading must be off the model
+  #define THERMAL_MODEL_TOLERANCE 4               // (°C) Always allowed error
+  #define THERMAL_MODEL_MARGIN 0.3                // Allowed relative error of the model heat flows
+  #define THERMAL_MODEL_CORRECTION 0.1            // (1/s) How fast the model follows the reading
+  #define THERMAL_MODEL_AMBIENT 25                // (°C) Without MPCTEMP or a chamber sensor
+
+  // Hotend model without MPCTEMP, as for MPCTEMP
+  #ifdef USE_HEATING_TUBE_80W
+    #define THERMAL_MODEL_HEATER_POWER 80.0       // (W)
+  #else
+    #define THERMAL_MODEL_HEATER_POWER 40.0       // (W)
+  #endif
+  #define THERMAL_MODEL_HEAT_CAPACITY 16.7        // (J/K)
+  #define THERMAL_MODEL_SENSOR_RESPONSIVENESS 0.22 // (K/s per K)
+  #define THERMAL_MODEL_AMBIENT_XFER_COEFF 0.068  // (W/K) Fan off
+  #define THERMAL_MODEL_AMBIENT_XFER_COEFF_FAN255 0.097 // (W/K) Fan at full speed
+#endif
+
 #if ENABLED(PIDTEMP)
   // this adds an experimental additional term to the heating power, proportional to the extrusion speed.
   // if Kc is chosen well, the additional required power due to increased melting should be compensated.
@@ -106,6 +142,207 @@
     #define DEFAULT_Kc (100) //heating power=Kc*(e_speed)
     #define LPQ_MAX_LEN 50
   #endif
+
+  /**
+   * Extrusion-rate feed-forward
+   *
+   * Add Kf * (volumetric flow of the move being executed) to the hotend PID output,
+   * so the heater follows flow changes (perimeters, infill, travels) as they start
+   * instead of after the temperature has dipped. Unlike PID_EXTRUSION_SCALING the
+   * flow comes from the planner block in the stepper, not from E steps LPQ_LEN
+   * updates old. Kf is in PID output (0-255) per mm³/s. Set it with M301 F.
+   *
+   * With PID_FEEDFORWARD_LEARN Kf is learned while printing, as the slope of the
+   * mean heater power over the mean flow of PID_FEEDFORWARD_WINDOW second windows.
+   * Save the learned value with M500. Simulate with
+   * buildroot/share/scripts/flowFeedforwardSim.py.
+   */
+  //#define PID_EXTRUSION_FEEDFORWARD
+  #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+    #ifdef USE_HEATING_TUBE_80W
+      #define DEFAULT_Kf 1.45                 // 2.33mJ/mm³K of PLA at 220°C, 80W heater
+    #else
+      #define DEFAULT_Kf 2.9                  // 2.33mJ/mm³K of PLA at 220°C, 40W heater
+    #endif
+    #define PID_FEEDFORWARD_LEARN
+    #if ENABLED(PID_FEEDFORWARD_LEARN)
+      #define PID_FEEDFORWARD_WINDOW 10       // (s) Heater power and flow are averaged over this
+      #define PID_FEEDFORWARD_WINDOWS 30      // Windows the slope is taken over
+    #endif
+  #endif
+#endif
+
+/**
+ * Fixed-point PID
+ *
+ * Run the hotend, bed and chamber PID loops with integer math instead of float.
+ * Gains are 16.16 fixed point; temperatures, errors and the P, I and D terms are
+ * 24.8 (1/256 degC, as read from the thermistor tables). Gains are converted once
+ * when they change, so M301, M304, M303 and the EEPROM keep the usual values.
+ * Tuning and the PID_FUNCTIONAL_RANGE anti-windup behave as with float.
+ * Gains are limited to +/-32767 (after Ki/Kd scaling by PID_dT).
+ */
+//#define PID_FIXED_POINT
+
+/**
+ * Model Predictive Control for the hotends (MPCTEMP, enabled in _Config.h)
+ *
+ * Instead of PID, the heater power is planned from a thermal model of the hotend:
+ * the heater block, the lag of the sensor, heat lost to ambient and to the part
+ * cooling fan, and heat carried off by the filament. The flow of the planner
+ * block being executed is fed forward, so flow and fan changes are compensated
+ * before the temperature drops.
+ * The model follows the sensor and learns the ambient temperature while running.
+ *
+ * M306 T runs the identification (like M303), M306 shows or sets the model and
+ * M500 saves it. buildroot/share/scripts/mpcThermalSim.py simulates a hotend to
+ * compare settle time and overshoot with PID.
+ */
+#if ENABLED(MPCTEMP)
+  #define MPC_MAX BANG_MAX                    // Limits the heater power (255 = full)
+  #ifndef MPC_HEATER_POWER
+    #define MPC_HEATER_POWER 40.0             // (W) Heater cartridge power                       M306 P
+  #endif
+  #define MPC_BLOCK_HEAT_CAPACITY 16.7        // (J/K) Heater block heat capacity                 M306 C
+  #define MPC_SENSOR_RESPONSIVENESS 0.22      // (K/s per K) How fast the sensor follows the block M306 R
+  #define MPC_AMBIENT_XFER_COEFF 0.068        // (W/K) Heat loss to ambient, fan off              M306 A
+  #define MPC_AMBIENT_XFER_COEFF_FAN255 0.097 // (W/K) Heat loss to ambient, fan at full speed    M306 F (the difference)
+  #define FILAMENT_HEAT_CAPACITY_PERMM 5.6e-3 // (J/K/mm) 5.6e-3 for 1.75mm PLA or PEEK, 1.4e-2 for 2.85mm  M306 H
+
+  #define MPC_SMOOTHING_FACTOR 0.5            // (0..1) How much of the sensor error is applied to the model per update
+  #define MPC_MIN_AMBIENT_CHANGE 1.0          // (K/s) Least change of the ambient estimate when it is corrected
+  #define MPC_STEADYSTATE 0.5                 // (K/s) Below this rate the hotend counts as settled
+
+  #define MPC_TUNING_TEMP 200                 // (°C) Default M306 T temperature
+#endif
+
+/**
+ * Heater power budget
+ *
+ * Heat the bed, chamber and hotends at the same time without asking more of
+ * the PSU than it can give. When the heaters want more than PSU_POWER_BUDGET,
+ * those already holding their target keep their power and the others are
+ * served in order of their estimated time to target, longest first. Whoever
+ * is last gets what is left, so no heater waits for the whole of another.
+ * Set the watts of a heater that isn't on the PSU (e.g. a mains bed) to 0.
+ * The heating watch (WATCH_TEMP_PERIOD) of a heater starts over when it is
+ * held back, and waits while it gets no power at all.
+ *
+ * Set all the targets with M104/M140/M6013, then M116 waits for them together.
+ * buildroot/share/scripts/heatupSim.py compares the heat-up time with M190/M109.
+ */
+//#define HEATER_POWER_BUDGET
+#if ENABLED(HEATER_POWER_BUDGET)
+  #define PSU_POWER_BUDGET 360      // (W) Power the PSU can give to the heaters
+  #ifdef USE_HEATING_TUBE_80W
+    #define HOTEND_HEATER_WATTS 80  // (W) Each hotend at full power
+  #else
+    #define HOTEND_HEATER_WATTS 40
+  #endif
+  #define BED_HEATER_WATTS 300      // (W) 0 if the bed isn't powered by the PSU
+  #define CHAMBER_HEATER_WATTS 0    // (W) 0 if the chamber isn't powered by the PSU
+
+  // Full power heating rates, for the time to target estimates
+  #define HOTEND_HEATUP_RATE 2.0    // (K/s)
+  #define BED_HEATUP_RATE 0.3       // (K/s)
+  #define CHAMBER_HEATUP_RATE 0.05  // (K/s)
+#endif
+
+/**
+ * Tool change preheat
+ *
+ * While a file prints from SD or U disk, read ahead in it for the next T
+ * command. The moves on the way, after those already in the planner, give the
+ * time until it comes, and the next nozzle is heated just early enough to be
+ * at temperature then instead of waiting at the tool change. Its temperature
+ * comes from an M104/M109 near the T command, or from an earlier M104 T<n>.
+ *
+ * A nozzle that won't be used for at least TOOLCHANGE_STANDBY_TIME (counting
+ * the time to reheat it) is dropped to TOOLCHANGE_STANDBY_TEMP meanwhile and
+ * restored by the preheat or the tool change. The tool change waits for a
+ * nozzle back from standby to reach its temperature, like M109.
+ *
+ * buildroot/share/scripts/toolchangePreheatSim.py shows the waits it saves.
+ */
+//#define TOOLCHANGE_PREHEAT
+#if ENABLED(TOOLCHANGE_PREHEAT)
+  #define TOOLCHANGE_PREHEAT_RATE { 2.0, 2.0 }  // (K/s) Heating rate of each hotend, for the preheat time
+  #define TOOLCHANGE_PREHEAT_MARGIN 5           // (s) Extra time to settle at the target
+  #define TOOLCHANGE_PREHEAT_HORIZON 300        // (s) How far ahead to read. Further on the estimate drifts.
+  #define TOOLCHANGE_PREHEAT_CHUNK 64           // (bytes) Read at a time, on the stack
+  #define TOOLCHANGE_PREHEAT_INTERVAL 160       // (ms) Between reads of up to 512 bytes (3.2KB/s). Keep it ahead of the print.
+  #define TOOLCHANGE_PREHEAT_MAX_HEATING 2      // Don't preheat while this many hotends are heating up
+
+  #define TOOLCHANGE_STANDBY_TEMP 150           // (°C) Idle nozzle temperature
+  #define TOOLCHANGE_STANDBY_TIME 60            // (s) Least time at standby to be worth it
+#endif
+
+/**
+ * ADC IIR filter
+ *
+ * By default the temperature ISR reads the sensors in turn and averages 16
+ * (OVERSAMPLENR) rounds, so new temperatures come every ~164ms. With this the
+ * ADC runs on its own, one conversion per timer 0 overflow (~976/s), and its
+ * interrupt feeds each reading to an exponential filter for that channel.
+ * The temperatures are taken from the filters every ADC_READY_LOOPS ms, which
+ * becomes the PID (and MPC) update period.
+ *
+ * The conversions are shared out by priority: a channel with priority 4 is read
+ * four times as often as one with priority 1. Each filter averages over about
+ * 2^ADC_IIR_SHIFT of its own readings.
+ *
+ * Re-run M303/M306 after enabling it. PID_FIXED_POINT limits the scaled gains,
+ * so keep the bed Kd / (ADC_READY_LOOPS / 1000) below 32767.
+ * buildroot/share/scripts/adcFilterSim.py compares latency and noise.
+ */
+//#define ADC_IIR_FILTER
+#if ENABLED(ADC_IIR_FILTER)
+  #define ADC_IIR_SHIFT 4           // (1..6) Filter time constant, 2^n readings
+  #define ADC_READY_LOOPS 82        // (ms) Temperature update period, 2..127
+
+  // Readings per round of each channel (1..8)
+  #define ADC_PRIORITY_HOTEND 4
+  #define ADC_PRIORITY_BED 2
+  #define ADC_PRIORITY_CHAMBER 1
+  #define ADC_PRIORITY_FILWIDTH 1
+  #define ADC_PRIORITY_KEYPAD 1
+#endif
+
+/**
+ * Bit-angle modulated soft PWM
+ *
+ * The standard soft PWM compares the duty of every heater (and fan, with
+ * FAN_SOFT_PWM) on every temperature ISR tick. With this the PWM period is
+ * split into one slot per duty bit, slot n lasting 2^n ticks, and an output
+ * is on in the slots of its set bits. The port values of each slot are only
+ * worked out when a duty changes, so a tick costs a counter check, and at
+ * the 7 slot starts of a period one write per port, however many outputs
+ * there are. The frequency follows SOFT_PWM_SCALE as before.
+ *
+ * SLOW_PID_BED and SLOW_PID_CHAMBER heaters keep their slow PWM.
+ * Compare the temperature ISR time with ISR_TIMING_STATS (M880).
+ */
+//#define SOFT_PWM_BAM
+
+/**
+ * Fast PID autotune
+ *
+ * M303 and M305 measure Ku and Tu on every relay cycle from the second on,
+ * and stop once both are within PID_AUTOTUNE_TOLERANCE of the cycle before.
+ * C (or 20 cycles for the chamber) becomes the most cycles to run.
+ * Ku allows for the relay being on longer than off (or the reverse) once
+ * the bias has moved away from the middle.
+ *
+ * The heater is also reported as a first order model with dead time: the
+ * gain (degC per unit of power, 0-255) from the mean temperature and power
+ * of a cycle, the time constant from the first heat-up, and the dead time
+ * from Tu, along with the power that holds the target temperature.
+ * Start the tune with the heater at room temperature for a good model.
+ * buildroot/share/scripts/pidAutotuneSim.py runs it on a hotend, bed and chamber.
+ */
+//#define PID_AUTOTUNE_FAST
+#if ENABLED(PID_AUTOTUNE_FAST)
+  #define PID_AUTOTUNE_TOLERANCE 0.05 // Relative change of Ku and Tu between cycles to stop at
 #endif
 
 /**
@@ -394,8 +631,49 @@
 // minimum time in microseconds that a movement needs to take if the buffer is emptied.
 #define DEFAULT_MINSEGMENTTIME        20000
 
-// If defined the movements slow down when the look ahead buffer is only half full
+// If defined the movements slow down when the look ahead buffer is running low on queued time.
+// Segments shorter than DEFAULT_MINSEGMENTTIME are stretched in proportion to the missing time.
 #define SLOWDOWN
+#if ENABLED(SLOWDOWN)
+  #define SLOWDOWN_QUEUE_TIME 100000 // (µs) Start slowing down below this much queued motion
+#endif
+
+/**
+ * Planner underrun statistics
+ *
+ * Count the times the stepper finishes the last queued move and the next
+ * move shows up within PLANNER_UNDERRUN_WINDOW. That means the G-code feed
+ * (SD card, host, parser) couldn't keep up, as opposed to the motion itself
+ * being slow. Deliberate waits (M400, M109, homing...) are not counted.
+ *
+ * M881 reports the queued time, underruns and SLOWDOWN activity. M881 R resets.
+ */
+//#define PLANNER_UNDERRUN_STATS
+#if ENABLED(PLANNER_UNDERRUN_STATS)
+  #define PLANNER_UNDERRUN_WINDOW 1000 // (ms) Longer gaps are treated as intentional pauses
+#endif
+
+/**
+ * Segment coalescing
+ *
+ * Slicers emit curves as runs of tiny G1 moves. Each one costs a full planner
+ * recalculation and a junction slowdown. With this option, short G0/G1 moves
+ * that keep heading the same way are merged into one move before planning.
+ *
+ * A move is merged if it has the same feedrate, tool and extrusion ratio,
+ * turns less than SEGMENT_COALESCE_MAX_ANGLE from the pending move, and all
+ * merged corners stay within SEGMENT_COALESCE_TOLERANCE of the new line.
+ *
+ * M882 reports the merge ratio. M882 R resets the counters.
+ */
+//#define SEGMENT_COALESCING
+#if ENABLED(SEGMENT_COALESCING)
+  #define SEGMENT_COALESCE_MAX_LENGTH   0.5   // (mm) Longer moves are planned as they are
+  #define SEGMENT_COALESCE_MAX_SEGMENTS 8     // Moves merged into one, at most (2-32)
+  #define SEGMENT_COALESCE_MAX_ANGLE    2.0   // (°) Heading change allowed against the pending move
+  #define SEGMENT_COALESCE_TOLERANCE    0.005 // (mm) Chordal deviation allowed for merged corners
+  #define SEGMENT_COALESCE_E_TOLERANCE  0.02  // Relative difference in extrusion ratio (E/mm) allowed
+#endif
 
 // Frequency limit
 // See nophead's blog for more info
@@ -682,8 +960,11 @@
 //
 //#define ARC_SUPPORT               // Disable this feature to save ~3226 bytes
 #if ENABLED(ARC_SUPPORT)
-  #define MM_PER_ARC_SEGMENT  1   // Length of each arc segment
-  #define N_ARC_CORRECTION   25   // Number of intertpolated segments between corrections
+  #define MM_PER_ARC_SEGMENT     3    // (mm) Length of the longest arc segment
+  #define MIN_ARC_SEGMENT_MM     0.1  // (mm) Length of the shortest arc segment
+  #define ARC_MAX_CHORD_ERROR    0.01 // (mm) Max distance between a segment and the true arc
+  #define ARC_SEGMENTS_PER_SEC   100  // Planner budget. Fast arcs use longer segments to stay under this rate.
+  #define N_ARC_CORRECTION      25    // Number of intertpolated segments between corrections
   //#define ARC_P_CIRCLES         // Enable the 'P' parameter to specify complete circles
   //#define CNC_WORKSPACE_PLANES  // Allow G2/G3 to operate in XY, ZX, or YZ planes
 #endif
@@ -701,6 +982,25 @@
 // Moves (or segments) with fewer steps than this will be joined with the next move
 #define MIN_STEPS_PER_SEGMENT 6
 
+/**
+ * Adaptive Multi-Axis Step Smoothing (AMASS)
+ *
+ * At low step rates the Bresenham line tracer steps the minor axes at
+ * irregular intervals, which shows up as artifacts on slow perimeters.
+ * With this option the stepper ISR is oversampled 2x, 4x or 8x while the
+ * step rate is low, so minor axis steps land closer to their ideal time.
+ * The oversampling level follows the step rate and is dropped entirely
+ * before the ISR rate exceeds ADAPTIVE_STEP_SMOOTHING_MAX_RATE, so fast
+ * moves cost no extra CPU time.
+ *
+ * Use buildroot/share/scripts/stepTimingTrace.py to compare step timing.
+ */
+//#define ADAPTIVE_STEP_SMOOTHING
+#if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+  #define ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL 3     // Oversample up to 2^3 = 8x
+  #define ADAPTIVE_STEP_SMOOTHING_MAX_RATE 10000  // (Hz) Highest oversampled ISR rate. Keep <= 10000 to avoid double-stepping.
+#endif
+
 // The minimum pulse width (in µs) for stepping a stepper.
 // Set this if you find stepping unreliable, or if using a very fast CPU.
 #define MINIMUM_STEPPER_PULSE 0 // (µs) The smallest stepper pulse allowed
@@ -1235,6 +1535,19 @@
  */
 //#define PINS_DEBUGGING
 
+/**
+ * ISR timing statistics
+ *
+ * Profile Stepper::isr(), Stepper::advance_isr() and Temperature::isr() in CPU cycles
+ * (min/avg/max), count missed stepper deadlines and the step_loops used per block.
+ * Use M880 to report the numbers and M880 R to reset them. This needs a 16-bit timer
+ * that nothing else is using. Timer 5 is free unless servos or motor current PWM are used.
+ */
+//#define ISR_TIMING_STATS
+#if ENABLED(ISR_TIMING_STATS)
+  #define ISR_TIMING_TIMER 5
+#endif
+
 /**
  * Auto-report temperatures with M155 S<seconds>
  */
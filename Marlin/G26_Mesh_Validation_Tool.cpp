@@ -49,6 +49,9 @@
   #define SIZE_OF_INTERSECTION_CIRCLES 5
   #define SIZE_OF_CROSSHAIRS 3
 
+  #define TOUR_JUMP_COST 2      // Grid steps added for a travel past the neighbours (retract, Z bump, recover)
+  #define TOUR_2OPT_PASSES 2    // Limit on the 2-opt passes over the circle tour
+
   #if SIZE_OF_CROSSHAIRS >= SIZE_OF_INTERSECTION_CIRCLES
     #error "SIZE_OF_CROSSHAIRS must be less than SIZE_OF_INTERSECTION_CIRCLES."
   #endif
@@ -118,8 +121,8 @@
    *
    *   U #  Random      Randomize the order that the circles are drawn on the bed. The search for the closest
    *                    undrawn cicle is still done. But the distance to the location for each circle has a
-   *                    random number of the size specified added to it. Specifying S50 will give an interesting
-   *                    deviation from the normal behaviour on a 10 x 10 Mesh.
+   *                    random number of the size specified added to it, and the order isn't shortened further.
+   *                    Specifying S50 will give an interesting deviation from the normal behaviour on a 10 x 10 Mesh.
    *
    *   X #  X Coord.    Specify the starting location of the drawing activity.
    *
@@ -145,7 +148,7 @@
 
   // Private functions
 
-  static uint16_t circle_flags[16], horizontal_mesh_line_flags[16], vertical_mesh_line_flags[16];
+  static uint16_t circle_flags[16];
   float g26_e_axis_feedrate = 0.020,
         random_deviation = 0.0;
 
@@ -154,6 +157,11 @@
 
   float valid_trig_angle(float);
 
+  // Mesh indexes in the planned tour are packed as (x << 4 | y)
+  #define TOUR_X(P) ((P) >> 4)
+  #define TOUR_Y(P) ((P) & 0x0F)
+  static uint8_t plan_circle_tour(uint8_t tour[], const float &X, const float &Y, const uint8_t limit);
+
   float unified_bed_leveling::g26_extrusion_multiplier,
         unified_bed_leveling::g26_retraction_multiplier,
         unified_bed_leveling::g26_nozzle,
@@ -216,7 +224,7 @@
     SERIAL_ECHOLNPGM("G26 command started. Waiting for heater(s).");
     float tmp, start_angle, end_angle;
     int   i, xi, yi;
-    mesh_index_pair location;
+    uint8_t tour[GRID_MAX_POINTS], circles;
 
     // Don't allow Mesh Validation without homing first,
     // or if the parameter parsing did not go OK, abort
@@ -246,8 +254,6 @@
      */
 
     ZERO(circle_flags);
-    ZERO(horizontal_mesh_line_flags);
-    ZERO(vertical_mesh_line_flags);
 
     // Move nozzle to the specified height for the first layer
     set_destination_to_current();
@@ -268,98 +274,94 @@
       sin_table[i] = SIZE_OF_INTERSECTION_CIRCLES * sin(RADIANS(valid_trig_angle(i * 30.0)));
     }
 
-    do {
-      location = g26_continue_with_closest
-        ? find_closest_circle_to_print(current_position[X_AXIS], current_position[Y_AXIS])
-        : find_closest_circle_to_print(g26_x_pos, g26_y_pos); // Find the closest Mesh Intersection to where we are now.
-
-      if (location.x_index >= 0 && location.y_index >= 0) {
-        const float circle_x = mesh_index_to_xpos(location.x_index),
-                    circle_y = mesh_index_to_ypos(location.y_index);
+    // Order the circles, starting with the one closest to where we are now
+    circles = g26_continue_with_closest
+      ? plan_circle_tour(tour, current_position[X_AXIS], current_position[Y_AXIS], min(g26_repeats, GRID_MAX_POINTS))
+      : plan_circle_tour(tour, g26_x_pos, g26_y_pos, min(g26_repeats, GRID_MAX_POINTS));
 
-        // If this mesh location is outside the printable_radius, skip it.
+    for (i = 0; i < circles; i++) {
+      xi = TOUR_X(tour[i]);  // Just to shrink the next few lines and make them easier to understand
+      yi = TOUR_Y(tour[i]);
+      bit_set(circle_flags, xi, yi);   // Mark this location as done.
 
-        if (!position_is_reachable_raw_xy(circle_x, circle_y)) continue;
+      const float circle_x = mesh_index_to_xpos(xi),
+                  circle_y = mesh_index_to_ypos(yi);
 
-        xi = location.x_index;  // Just to shrink the next few lines and make them easier to understand
-        yi = location.y_index;
-
-        if (g26_debug_flag) {
-          SERIAL_ECHOPAIR("   Doing circle at: (xi=", xi);
-          SERIAL_ECHOPAIR(", yi=", yi);
-          SERIAL_CHAR(')');
-          SERIAL_EOL();
-        }
+      if (g26_debug_flag) {
+        SERIAL_ECHOPAIR("   Doing circle at: (xi=", xi);
+        SERIAL_ECHOPAIR(", yi=", yi);
+        SERIAL_CHAR(')');
+        SERIAL_EOL();
+      }
 
-        start_angle = 0.0;    // assume it is going to be a full circle
+      start_angle = 0.0;    // assume it is going to be a full circle
+      end_angle   = 360.0;
+      if (xi == 0) {       // Check for bottom edge
+        start_angle = -90.0;
+        end_angle   =  90.0;
+        if (yi == 0)        // it is an edge, check for the two left corners
+          start_angle = 0.0;
+        else if (yi == GRID_MAX_POINTS_Y - 1)
+          end_angle = 0.0;
+      }
+      else if (xi == GRID_MAX_POINTS_X - 1) { // Check for top edge
+        start_angle =  90.0;
+        end_angle   = 270.0;
+        if (yi == 0)                  // it is an edge, check for the two right corners
+          end_angle = 180.0;
+        else if (yi == GRID_MAX_POINTS_Y - 1)
+          start_angle = 180.0;
+      }
+      else if (yi == 0) {
+        start_angle =   0.0;         // only do the top   side of the cirlce
+        end_angle   = 180.0;
+      }
+      else if (yi == GRID_MAX_POINTS_Y - 1) {
+        start_angle = 180.0;         // only do the bottom side of the cirlce
         end_angle   = 360.0;
-        if (xi == 0) {       // Check for bottom edge
-          start_angle = -90.0;
-          end_angle   =  90.0;
-          if (yi == 0)        // it is an edge, check for the two left corners
-            start_angle = 0.0;
-          else if (yi == GRID_MAX_POINTS_Y - 1)
-            end_angle = 0.0;
-        }
-        else if (xi == GRID_MAX_POINTS_X - 1) { // Check for top edge
-          start_angle =  90.0;
-          end_angle   = 270.0;
-          if (yi == 0)                  // it is an edge, check for the two right corners
-            end_angle = 180.0;
-          else if (yi == GRID_MAX_POINTS_Y - 1)
-            start_angle = 180.0;
-        }
-        else if (yi == 0) {
-          start_angle =   0.0;         // only do the top   side of the cirlce
-          end_angle   = 180.0;
-        }
-        else if (yi == GRID_MAX_POINTS_Y - 1) {
-          start_angle = 180.0;         // only do the bottom side of the cirlce
-          end_angle   = 360.0;
-        }
+      }
 
-        for (tmp = start_angle; tmp < end_angle - 0.1; tmp += 30.0) {
+      for (tmp = start_angle; tmp < end_angle - 0.1; tmp += 30.0) {
 
-          #if ENABLED(NEWPANEL)
-            if (user_canceled()) goto LEAVE;              // Check if the user wants to stop the Mesh Validation
-          #endif
+        #if ENABLED(NEWPANEL)
+          if (user_canceled()) goto LEAVE;              // Check if the user wants to stop the Mesh Validation
+        #endif
 
-          int tmp_div_30 = tmp / 30.0;
-          if (tmp_div_30 < 0) tmp_div_30 += 360 / 30;
-          if (tmp_div_30 > 11) tmp_div_30 -= 360 / 30;
-
-          float x = circle_x + cos_table[tmp_div_30],    // for speed, these are now a lookup table entry
-                y = circle_y + sin_table[tmp_div_30],
-                xe = circle_x + cos_table[tmp_div_30 + 1],
-                ye = circle_y + sin_table[tmp_div_30 + 1];
-          #if IS_KINEMATIC
-            // Check to make sure this segment is entirely on the bed, skip if not.
-            if (!position_is_reachable_raw_xy(x, y) || !position_is_reachable_raw_xy(xe, ye)) continue;
-          #else                                              // not, we need to skip
-            x  = constrain(x, X_MIN_POS + 1, X_MAX_POS - 1); // This keeps us from bumping the endstops
-            y  = constrain(y, Y_MIN_POS + 1, Y_MAX_POS - 1);
-            xe = constrain(xe, X_MIN_POS + 1, X_MAX_POS - 1);
-            ye = constrain(ye, Y_MIN_POS + 1, Y_MAX_POS - 1);
-          #endif
+        int tmp_div_30 = tmp / 30.0;
+        if (tmp_div_30 < 0) tmp_div_30 += 360 / 30;
+        if (tmp_div_30 > 11) tmp_div_30 -= 360 / 30;
+
+        float x = circle_x + cos_table[tmp_div_30],    // for speed, these are now a lookup table entry
+              y = circle_y + sin_table[tmp_div_30],
+              xe = circle_x + cos_table[tmp_div_30 + 1],
+              ye = circle_y + sin_table[tmp_div_30 + 1];
+        #if IS_KINEMATIC
+          // Check to make sure this segment is entirely on the bed, skip if not.
+          if (!position_is_reachable_raw_xy(x, y) || !position_is_reachable_raw_xy(xe, ye)) continue;
+        #else                                              // not, we need to skip
+          x  = constrain(x, X_MIN_POS + 1, X_MAX_POS - 1); // This keeps us from bumping the endstops
+          y  = constrain(y, Y_MIN_POS + 1, Y_MAX_POS - 1);
+          xe = constrain(xe, X_MIN_POS + 1, X_MAX_POS - 1);
+          ye = constrain(ye, Y_MIN_POS + 1, Y_MAX_POS - 1);
+        #endif
 
-          //if (g26_debug_flag) {
-          //  char ccc, *cptr, seg_msg[50], seg_num[10];
-          //  strcpy(seg_msg, "   segment: ");
-          //  strcpy(seg_num, "    \n");
-          //  cptr = (char*) "01234567890ABCDEF????????";
-          //  ccc = cptr[tmp_div_30];
-          //  seg_num[1] = ccc;
-          //  strcat(seg_msg, seg_num);
-          //  debug_current_and_destination(seg_msg);
-          //}
+        //if (g26_debug_flag) {
+        //  char ccc, *cptr, seg_msg[50], seg_num[10];
+        //  strcpy(seg_msg, "   segment: ");
+        //  strcpy(seg_num, "    \n");
+        //  cptr = (char*) "01234567890ABCDEF????????";
+        //  ccc = cptr[tmp_div_30];
+        //  seg_num[1] = ccc;
+        //  strcat(seg_msg, seg_num);
+        //  debug_current_and_destination(seg_msg);
+        //}
 
-          print_line_from_here_to_there(LOGICAL_X_POSITION(x), LOGICAL_Y_POSITION(y), g26_layer_height, LOGICAL_X_POSITION(xe), LOGICAL_Y_POSITION(ye), g26_layer_height);
+        print_line_from_here_to_there(LOGICAL_X_POSITION(x), LOGICAL_Y_POSITION(y), g26_layer_height, LOGICAL_X_POSITION(xe), LOGICAL_Y_POSITION(ye), g26_layer_height);
 
-        }
-        if (look_for_lines_to_connect())
-          goto LEAVE;
       }
-    } while (--g26_repeats && location.x_index >= 0 && location.y_index >= 0);
+      if (look_for_lines_to_connect(xi, yi))
+        goto LEAVE;
+    }
 
     LEAVE:
     lcd_setstatusPGM(PSTR("Leaving G26"), -1);
@@ -394,126 +396,173 @@
     return d;
   }
 
-  mesh_index_pair unified_bed_leveling::find_closest_circle_to_print(const float &X, const float &Y) {
-    float closest = 99999.99;
-    mesh_index_pair return_val;
-
-    return_val.x_index = return_val.y_index = -1;
+  /**
+   * Plan the order of the circles once, before printing any. The walk to the
+   * closest unprinted circle, weighted toward X,Y so it spirals out from there,
+   * still picks the first 'limit' circles. It leaves a few long jumps back
+   * across the bed, which 2-opt then takes out by reversing stretches of the
+   * tour. Returns the number of circles.
+   */
+  static float tour_distance2(const uint8_t a, const uint8_t b) {
+    return HYPOT2(ubl.mesh_index_to_xpos(TOUR_X(a)) - ubl.mesh_index_to_xpos(TOUR_X(b)),
+                  ubl.mesh_index_to_ypos(TOUR_Y(a)) - ubl.mesh_index_to_ypos(TOUR_Y(b)));
+  }
 
-    for (uint8_t i = 0; i < GRID_MAX_POINTS_X; i++) {
-      for (uint8_t j = 0; j < GRID_MAX_POINTS_Y; j++) {
-        if (!is_bit_set(circle_flags, i, j)) {
-          const float mx = mesh_index_to_xpos(i),  // We found a circle that needs to be printed
-                      my = mesh_index_to_ypos(j);
+  // A travel to a circle that isn't a grid neighbour retracts and bumps Z,
+  // so it costs TOUR_JUMP_COST grid steps on top of its length
+  static float tour_cost(const uint8_t a, const uint8_t b, const float &d2) {
+    const bool jump = abs(TOUR_X(a) - TOUR_X(b)) + abs(TOUR_Y(a) - TOUR_Y(b)) > 1;
+    return SQRT(d2) + (jump ? (TOUR_JUMP_COST) * (MESH_X_DIST) : 0);
+  }
 
-          // Get the distance to this intersection
-          float f = HYPOT(X - mx, Y - my);
+  static void tour_swap(uint8_t tour[], const uint8_t a, const uint8_t b) {
+    const uint8_t t = tour[a];
+    tour[a] = tour[b];
+    tour[b] = t;
+  }
 
-          // It is possible that we are being called with the values
-          // to let us find the closest circle to the start position.
-          // But if this is not the case, add a small weighting to the
-          // distance calculation to help it choose a better place to continue.
-          f += HYPOT(g26_x_pos - mx, g26_y_pos - my) / 15.0;
+  static uint8_t plan_circle_tour(uint8_t tour[], const float &X, const float &Y, const uint8_t limit) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < GRID_MAX_POINTS_X; i++)
+      for (uint8_t j = 0; j < GRID_MAX_POINTS_Y; j++)
+        if (position_is_reachable_raw_xy(ubl.mesh_index_to_xpos(i), ubl.mesh_index_to_ypos(j)))
+          tour[count++] = i << 4 | j;
+    const uint8_t n = min(count, limit);
+
+    float x = X, y = Y;
+    for (uint8_t k = 0; k < n; k++) {
+      uint8_t best = k;
+      float closest = 99999.99;
+      for (uint8_t m = k; m < count; m++) {
+        const float mx = ubl.mesh_index_to_xpos(TOUR_X(tour[m])),
+                    my = ubl.mesh_index_to_ypos(TOUR_Y(tour[m]));
+        float f = HYPOT(x - mx, y - my) + HYPOT(X - mx, Y - my) / 15.0;
+        if (random_deviation > 1.0) f += random(0.0, random_deviation); // U adds random noise
+        if (f < closest) {
+          closest = f;
+          best = m;
+        }
+      }
+      tour_swap(tour, k, best);
+      x = ubl.mesh_index_to_xpos(TOUR_X(tour[k]));
+      y = ubl.mesh_index_to_ypos(TOUR_Y(tour[k]));
+      if (!(k & 0x0F)) idle();
+    }
 
-          // Add in the specified amount of Random Noise to our search
-          if (random_deviation > 1.0)
-            f += random(0.0, random_deviation);
+    // A random order was asked for, so leave it
+    if (random_deviation > 1.0) return n;
 
-          if (f < closest) {
-            closest = f;              // We found a closer location that is still
-            return_val.x_index = i;   // un-printed  --- save the data for it
-            return_val.y_index = j;
-            return_val.distance = closest;
+    /**
+     * 2-opt: reverse tour[i+1..j] wherever that lowers the cost, keeping the
+     * first circle first. The cost only grows with the distance, so a move can
+     * only pay if a new edge is shorter than the old edge it shares an end
+     * with, and only then are square roots taken. Each pass is O(n^2), so
+     * stop after TOUR_2OPT_PASSES. A third pass found nothing more on 10x10
+     * and 15x15 grids (g26TourTest.py).
+     */
+    bool improved = true;
+    for (uint8_t pass = 0; improved && pass < TOUR_2OPT_PASSES; pass++) {
+      improved = false;
+      for (uint8_t i = 0; i + 2 < n; i++) {
+        idle();
+        float ab2 = tour_distance2(tour[i], tour[i + 1]);
+        for (uint8_t j = i + 2; j < n; j++) {
+          const float ac2 = tour_distance2(tour[i], tour[j]);
+          float cd2 = 0, bd2 = 0;
+          if (j < n - 1) {
+            cd2 = tour_distance2(tour[j], tour[j + 1]);
+            bd2 = tour_distance2(tour[i + 1], tour[j + 1]);
+          }
+          if (ac2 >= ab2 && bd2 >= cd2) continue;
+          float gain = tour_cost(tour[i], tour[i + 1], ab2) - tour_cost(tour[i], tour[j], ac2);
+          if (j < n - 1) gain += tour_cost(tour[j], tour[j + 1], cd2) - tour_cost(tour[i + 1], tour[j + 1], bd2);
+          if (gain > 0.01) {
+            for (uint8_t l = i + 1, r = j; l < r; l++, r--) tour_swap(tour, l, r);
+            ab2 = ac2;
+            improved = true;
           }
         }
       }
     }
-    bit_set(circle_flags, return_val.x_index, return_val.y_index);   // Mark this location as done.
-    return return_val;
+    return n;
   }
 
-  bool unified_bed_leveling::look_for_lines_to_connect() {
+  /**
+   * Connect the circle just printed at i,j to each printed neighbour.
+   */
+  bool unified_bed_leveling::look_for_lines_to_connect(const uint8_t i, const uint8_t j) {
+
+    #if ENABLED(NEWPANEL)
+      if (user_canceled()) return true;     // Check if the user wants to stop the Mesh Validation
+    #endif
+
+    if (i > 0 && is_bit_set(circle_flags, i - 1, j)) connect_circles(i - 1, j, true);
+    if (i < GRID_MAX_POINTS_X - 1 && is_bit_set(circle_flags, i + 1, j)) connect_circles(i, j, true);
+    if (j > 0 && is_bit_set(circle_flags, i, j - 1)) connect_circles(i, j - 1, false);
+    if (j < GRID_MAX_POINTS_Y - 1 && is_bit_set(circle_flags, i, j + 1)) connect_circles(i, j, false);
+    return false;
+  }
+
+  /**
+   * Print the line from the circle at i,j to the one at i+1,j (horizontal)
+   * or i,j+1 (vertical), if both ends can be reached.
+   */
+  void unified_bed_leveling::connect_circles(const uint8_t i, const uint8_t j, const bool horizontal) {
     float sx, sy, ex, ey;
 
-    for (uint8_t i = 0; i < GRID_MAX_POINTS_X; i++) {
-      for (uint8_t j = 0; j < GRID_MAX_POINTS_Y; j++) {
+    if (horizontal) {
+      //
+      // We found two circles that need a horizontal line to connect them
+      // Print it!
+      //
+      sx = mesh_index_to_xpos(  i  ) + (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // right edge
+      ex = mesh_index_to_xpos(i + 1) - (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // left edge
 
-        #if ENABLED(NEWPANEL)
-          if (user_canceled()) return true;     // Check if the user wants to stop the Mesh Validation
-        #endif
+      sx = constrain(sx, X_MIN_POS + 1, X_MAX_POS - 1);
+      sy = ey = constrain(mesh_index_to_ypos(j), Y_MIN_POS + 1, Y_MAX_POS - 1);
+      ex = constrain(ex, X_MIN_POS + 1, X_MAX_POS - 1);
 
-        if (i < GRID_MAX_POINTS_X) { // We can't connect to anything to the right than GRID_MAX_POINTS_X.
-                                     // This is already a half circle because we are at the edge of the bed.
-
-          if (is_bit_set(circle_flags, i, j) && is_bit_set(circle_flags, i + 1, j)) { // check if we can do a line to the left
-            if (!is_bit_set(horizontal_mesh_line_flags, i, j)) {
-
-              //
-              // We found two circles that need a horizontal line to connect them
-              // Print it!
-              //
-              sx = mesh_index_to_xpos(  i  ) + (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // right edge
-              ex = mesh_index_to_xpos(i + 1) - (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // left edge
-
-              sx = constrain(sx, X_MIN_POS + 1, X_MAX_POS - 1);
-              sy = ey = constrain(mesh_index_to_ypos(j), Y_MIN_POS + 1, Y_MAX_POS - 1);
-              ex = constrain(ex, X_MIN_POS + 1, X_MAX_POS - 1);
-
-              if (position_is_reachable_raw_xy(sx, sy) && position_is_reachable_raw_xy(ex, ey)) {
-
-                if (g26_debug_flag) {
-                  SERIAL_ECHOPAIR(" Connecting with horizontal line (sx=", sx);
-                  SERIAL_ECHOPAIR(", sy=", sy);
-                  SERIAL_ECHOPAIR(") -> (ex=", ex);
-                  SERIAL_ECHOPAIR(", ey=", ey);
-                  SERIAL_CHAR(')');
-                  SERIAL_EOL();
-                  //debug_current_and_destination(PSTR("Connecting horizontal line."));
-                }
-
-                print_line_from_here_to_there(LOGICAL_X_POSITION(sx), LOGICAL_Y_POSITION(sy), g26_layer_height, LOGICAL_X_POSITION(ex), LOGICAL_Y_POSITION(ey), g26_layer_height);
-              }
-              bit_set(horizontal_mesh_line_flags, i, j);   // Mark it as done so we don't do it again, even if we skipped it
-            }
-          }
+      if (position_is_reachable_raw_xy(sx, sy) && position_is_reachable_raw_xy(ex, ey)) {
 
-          if (j < GRID_MAX_POINTS_Y) { // We can't connect to anything further back than GRID_MAX_POINTS_Y.
-                                           // This is already a half circle because we are at the edge  of the bed.
-
-            if (is_bit_set(circle_flags, i, j) && is_bit_set(circle_flags, i, j + 1)) { // check if we can do a line straight down
-              if (!is_bit_set( vertical_mesh_line_flags, i, j)) {
-                //
-                // We found two circles that need a vertical line to connect them
-                // Print it!
-                //
-                sy = mesh_index_to_ypos(  j  ) + (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // top edge
-                ey = mesh_index_to_ypos(j + 1) - (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // bottom edge
-
-                sx = ex = constrain(mesh_index_to_xpos(i), X_MIN_POS + 1, X_MAX_POS - 1);
-                sy = constrain(sy, Y_MIN_POS + 1, Y_MAX_POS - 1);
-                ey = constrain(ey, Y_MIN_POS + 1, Y_MAX_POS - 1);
-
-                if (position_is_reachable_raw_xy(sx, sy) && position_is_reachable_raw_xy(ex, ey)) {
-
-                  if (g26_debug_flag) {
-                    SERIAL_ECHOPAIR(" Connecting with vertical line (sx=", sx);
-                    SERIAL_ECHOPAIR(", sy=", sy);
-                    SERIAL_ECHOPAIR(") -> (ex=", ex);
-                    SERIAL_ECHOPAIR(", ey=", ey);
-                    SERIAL_CHAR(')');
-                    SERIAL_EOL();
-                    debug_current_and_destination(PSTR("Connecting vertical line."));
-                  }
-                  print_line_from_here_to_there(LOGICAL_X_POSITION(sx), LOGICAL_Y_POSITION(sy), g26_layer_height, LOGICAL_X_POSITION(ex), LOGICAL_Y_POSITION(ey), g26_layer_height);
-                }
-                bit_set(vertical_mesh_line_flags, i, j);   // Mark it as done so we don't do it again, even if skipped
-              }
-            }
-          }
+        if (g26_debug_flag) {
+          SERIAL_ECHOPAIR(" Connecting with horizontal line (sx=", sx);
+          SERIAL_ECHOPAIR(", sy=", sy);
+          SERIAL_ECHOPAIR(") -> (ex=", ex);
+          SERIAL_ECHOPAIR(", ey=", ey);
+          SERIAL_CHAR(')');
+          SERIAL_EOL();
+          //debug_current_and_destination(PSTR("Connecting horizontal line."));
         }
+
+        print_line_from_here_to_there(LOGICAL_X_POSITION(sx), LOGICAL_Y_POSITION(sy), g26_layer_height, LOGICAL_X_POSITION(ex), LOGICAL_Y_POSITION(ey), g26_layer_height);
+      }
+    }
+    else {
+      //
+      // We found two circles that need a vertical line to connect them
+      // Print it!
+      //
+      sy = mesh_index_to_ypos(  j  ) + (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // top edge
+      ey = mesh_index_to_ypos(j + 1) - (SIZE_OF_INTERSECTION_CIRCLES - (SIZE_OF_CROSSHAIRS)); // bottom edge
+
+      sx = ex = constrain(mesh_index_to_xpos(i), X_MIN_POS + 1, X_MAX_POS - 1);
+      sy = constrain(sy, Y_MIN_POS + 1, Y_MAX_POS - 1);
+      ey = constrain(ey, Y_MIN_POS + 1, Y_MAX_POS - 1);
+
+      if (position_is_reachable_raw_xy(sx, sy) && position_is_reachable_raw_xy(ex, ey)) {
+
+        if (g26_debug_flag) {
+          SERIAL_ECHOPAIR(" Connecting with vertical line (sx=", sx);
+          SERIAL_ECHOPAIR(", sy=", sy);
+          SERIAL_ECHOPAIR(") -> (ex=", ex);
+          SERIAL_ECHOPAIR(", ey=", ey);
+          SERIAL_CHAR(')');
+          SERIAL_EOL();
+          debug_current_and_destination(PSTR("Connecting vertical line."));
+        }
+        print_line_from_here_to_there(LOGICAL_X_POSITION(sx), LOGICAL_Y_POSITION(sy), g26_layer_height, LOGICAL_X_POSITION(ex), LOGICAL_Y_POSITION(ey), g26_layer_height);
       }
     }
-    return false;
   }
 
   void unified_bed_leveling::move_to(const float &x, const float &y, const float &z, const float &e_delta) {
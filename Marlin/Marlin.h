@@ -189,6 +189,11 @@ void kill(const char*);
 
 void quickstop_stepper();
 
+#if ENABLED(SEGMENT_COALESCING)
+  void flush_coalesced_move();
+  void discard_coalesced_move();
+#endif
+
 #if ENABLED(FILAMENT_RUNOUT_SENSOR)
   void handle_filament_runout();
 #endif
@@ -215,6 +220,7 @@ inline void refresh_cmd_timeout() { previous_cmd_ms = millis(); }
 /**
  * Feedrate scaling and conversion
  */
+extern float feedrate_mm_s;
 extern int16_t feedrate_percentage;
 
 #define MMM_TO_MMS(MM_M) ((MM_M)/60.0)
@@ -319,6 +325,11 @@ extern float soft_endstop_min[XYZ], soft_endstop_max[XYZ];
   extern float bilinear_grid_factor[2],
                z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
   float bilinear_z_offset(const float logical[XYZ]);
+  #if ENABLED(ABL_THERMAL_MESHES)
+    void thermal_mesh_save();
+    void thermal_mesh_save_edit();
+    void thermal_mesh_update(const bool force=false);
+  #endif
 #endif
 
 #if ENABLED(AUTO_BED_LEVELING_UBL)
@@ -119,7 +119,7 @@
  * M105 - Report current temperatures.
  * M106 - Fan on.
  * M107 - Fan off.
- * M108 - Break out of heating loops (M109, M190, M303). With no controller, breaks out of M0/M1. (Requires EMERGENCY_PARSER)
+ * M108 - Break out of heating loops (M109, M116, M190, M303). With no controller, breaks out of M0/M1. (Requires EMERGENCY_PARSER)
  * M109 - Sxxx Wait for extruder current temp to reach target temp. Waits only when heating
  *        Rxxx Wait for extruder current temp to reach target temp. Waits when heating and cooling
  *        If AUTOTEMP is enabled, S<mintemp> B<maxtemp> F<factor>. Exit autotemp by any M109 without F
@@ -129,6 +129,7 @@
  * M113 - Get or set the timeout interval for Host Keepalive "busy" messages. (Requires HOST_KEEPALIVE_FEATURE)
  * M114 - Report current position.
  * M115 - Report capabilities. (Extended capabilities requires EXTENDED_CAPABILITIES_REPORT)
+ * M116 - Wait for all heaters with a target to reach it. S<window> overrides TEMP_WINDOW / TEMP_BED_WINDOW.
  * M117 - Display a message on the controller screen. (Requires an LCD)
  * M118 - Display a message in the host console.
  * M119 - Report endstops status.
@@ -179,6 +180,7 @@
  * M303 - PID relay autotune S<temperature> sets the target temperature. Default 150C. (Requires PIDTEMP)
  * M304 - Set bed PID parameters P I and D. (Requires PIDTEMPBED)
  * M305 - PID (Chamber) relay autotune S<temperature> sets the target temperature. Default 50C. (Requires PIDTEMP_CHAMBER)
+ * M306 - Set or report the hotend thermal model, or T to identify it. (Requires MPCTEMP)
  * M350 - Set microstepping mode. (Requires digital microstepping pins.)
  * M351 - Toggle MS1 MS2 pins directly. (Requires digital microstepping pins.)
  * M355 - Set Case Light on/off and set brightness. (Requires CASE_LIGHT_PIN)
@@ -215,6 +217,9 @@
  * M867 - Enable/disable or toggle error correction for position encoder modules.
  * M868 - Report or set position encoder module error correction threshold.
  * M869 - Report position encoder module error.
+ * M880 - Report ISR timing statistics. R to reset them. (Requires ISR_TIMING_STATS)
+ * M881 - Report planner queued time, underruns and slowdowns. R to reset them. (Requires PLANNER_UNDERRUN_STATS)
+ * M882 - Report the G0/G1 segment merge ratio. R to reset it. (Requires SEGMENT_COALESCING)
  * M900 - Get and/or Set advance K factor and WH/D ratio. (Requires LIN_ADVANCE)
  * M906 - Set or get motor current in milliamps using axis codes X, Y, Z, E. Report values if no axis codes given. (Requires HAVE_TMC2130)
  * M907 - Set digital trimpot motor current using axis codes. (Requires a board with digital trimpots)
@@ -323,6 +328,18 @@
   #include "Max7219_Debug_LEDs.h"
 #endif
 
+#if ENABLED(ISR_TIMING_STATS)
+  #include "isr_timing.h"
+#endif
+
+#if ENABLED(TOOLCHANGE_PREHEAT)
+  #include "toolchange_preheat.h"
+#endif
+
+#if ENABLED(ABL_PRINT_AREA)
+  #include "print_area.h"
+#endif
+
 #if ENABLED(NEOPIXEL_LED)
   #include <Adafruit_NeoPixel.h>
 #endif
@@ -496,6 +513,21 @@ static float saved_feedrate_mm_s;
 int16_t feedrate_percentage = 100, saved_feedrate_percentage,
     flow_percentage[EXTRUDERS] = ARRAY_BY_EXTRUDERS1(100);
 
+#if ENABLED(SEGMENT_COALESCING)
+  // The pending move runs from coalesce_start to current_position
+  static bool coalesce_pending = false;
+  static float coalesce_start[XYZE],
+               coalesce_corners[SEGMENT_COALESCE_MAX_SEGMENTS - 1][XYZ], // Merged-away corners, checked against each new line
+               coalesce_feedrate_mm_s,
+               coalesce_e_per_mm;
+  static uint8_t coalesce_count, coalesce_extruder;
+  static uint32_t coalesce_moves_in = 0, coalesce_moves_out = 0;
+  #if ENABLED(QUICK_PAUSE)
+    static bool coalesce_flushing = false;
+    static uint32_t coalesce_gcode_pos;
+  #endif
+#endif
+
 // Initialized by settings.load()
 bool axis_relative_modes[] = AXIS_RELATIVE_MODES,
      volumetric_enabled;
@@ -674,6 +706,9 @@ static uint8_t target_extruder;
   int bilinear_grid_spacing[2], bilinear_start[2];
   float bilinear_grid_factor[2],
         z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+  #if ENABLED(ABL_BILINEAR_CELL_CACHE)
+    void bilinear_cell_refresh();
+  #endif
 #endif
 
 #if IS_SCARA
@@ -868,6 +903,10 @@ void get_available_commands();
 void process_next_command();
 void prepare_move_to_destination();
 
+#if ENABLED(SEGMENT_COALESCING)
+  bool coalesce_move();
+#endif
+
 void get_cartesian_from_steppers();
 void set_current_from_steppers_for_axis(const AxisEnum axis);
 
@@ -2492,16 +2531,19 @@ static void clean_up_after_endstop_or_probe_move() {
    *
    * @param  z        Z destination
    * @param  fr_mm_s  Feedrate in mm/s
+   * @param  bltouch  Deploy a BLTouch first and stow it after a trigger
    * @return true to indicate an error
    */
-  static bool do_probe_move(const float z, const float fr_mm_m) {
+  static bool do_probe_move(const float z, const float fr_mm_m, const bool bltouch=true) {
     #if ENABLED(DEBUG_LEVELING_FEATURE)
       if (DEBUGGING(LEVELING)) DEBUG_POS(">>> do_probe_move", current_position);
     #endif
 
     // Deploy BLTouch at the start of any probe
     #if ENABLED(BLTOUCH)
-      if (set_bltouch_deployed(true)) return true;
+      if (bltouch && set_bltouch_deployed(true)) return true;
+    #else
+      UNUSED(bltouch);
     #endif
 
     #if QUIET_PROBING
@@ -2526,7 +2568,7 @@ static void clean_up_after_endstop_or_probe_move() {
 
     // Retract BLTouch immediately after a probe if it was triggered
     #if ENABLED(BLTOUCH)
-      if (probe_triggered && set_bltouch_deployed(false)) return true;
+      if (bltouch && probe_triggered && set_bltouch_deployed(false)) return true;
     #endif
 
     // Clear endstop flags
@@ -2697,6 +2739,100 @@ static void clean_up_after_endstop_or_probe_move() {
     return measured_z;
   }
 
+  #if ENABLED(G29_FAST_PROBE)
+
+    /**
+     * Probe the next G29 grid point, starting from the previous point
+     * instead of from Z_CLEARANCE_BETWEEN_PROBES
+     *
+     * - Move to the given XY and G29_FAST_PROBE_CLEARANCE above the
+     *   previous trigger height in one move
+     * - Deploy the probe (a BLTouch is not stowed after the trigger)
+     * - Descend fast to G29_FAST_PROBE_MARGIN above the previous trigger
+     *   height, then probe the rest of the way slowly
+     * - If the fast descent triggers, back off and probe slowly from there
+     * - Return the probed Z position, leaving Z at the trigger height
+     *
+     * @param  last_z  The Z position probed at the previous point
+     */
+    static float fast_probe_pt(const float &lx, const float &ly, const float last_z, const uint8_t verbose_level) {
+      #if ENABLED(DEBUG_LEVELING_FEATURE)
+        if (DEBUGGING(LEVELING)) {
+          SERIAL_ECHOPAIR(">>> fast_probe_pt(", lx);
+          SERIAL_ECHOPAIR(", ", ly);
+          SERIAL_ECHOLNPAIR(", ", last_z);
+          DEBUG_POS("", current_position);
+        }
+      #endif
+
+      const float nx = lx - (X_PROBE_OFFSET_FROM_EXTRUDER), ny = ly - (Y_PROBE_OFFSET_FROM_EXTRUDER);
+
+      if (!position_is_reachable_xy(nx, ny)) return NAN;
+
+      refresh_cmd_timeout();
+
+      // Where the probe should trigger, going by the previous point
+      float trigger_z = LOGICAL_Z_POSITION(last_z - zprobe_zoffset);
+
+      // Lift (or lower) to the travel height on the way to XY
+      const float old_feedrate_mm_s = feedrate_mm_s;
+      feedrate_mm_s = XY_PROBE_FEEDRATE_MM_S;
+      current_position[X_AXIS] = nx;
+      current_position[Y_AXIS] = ny;
+      current_position[Z_AXIS] = trigger_z + G29_FAST_PROBE_CLEARANCE;
+      line_to_current_position();
+      stepper.synchronize();
+      feedrate_mm_s = old_feedrate_mm_s;
+
+      float measured_z = NAN;
+      if (!DEPLOY_PROBE()) {
+        for (uint8_t tries = 2; tries--;) {
+          #if ENABLED(BLTOUCH)
+            if (set_bltouch_deployed(true)) break;
+          #endif
+
+          // Triggered on the way down? The bed is higher than at the previous
+          // point, so back off and make the slow touch from the new height.
+          if (tries && !do_probe_move(trigger_z + G29_FAST_PROBE_MARGIN, Z_PROBE_SPEED_FAST, false)) {
+            #if ENABLED(DEBUG_LEVELING_FEATURE)
+              if (DEBUGGING(LEVELING)) SERIAL_ECHOLNPAIR("Fast trigger Z:", current_position[Z_AXIS]);
+            #endif
+            trigger_z = current_position[Z_AXIS];
+            do_blocking_move_to_z(trigger_z + G29_FAST_PROBE_CLEARANCE, MMM_TO_MMS(Z_PROBE_SPEED_FAST));
+            continue;
+          }
+
+          if (!do_probe_move(-10, Z_PROBE_SPEED_SLOW, false))
+            measured_z = RAW_CURRENT_POSITION(Z) + zprobe_zoffset;
+          break;
+        }
+      }
+
+      if (verbose_level > 2) {
+        SERIAL_PROTOCOLPGM("Bed X: ");
+        SERIAL_PROTOCOL_F(lx, 3);
+        SERIAL_PROTOCOLPGM(" Y: ");
+        SERIAL_PROTOCOL_F(ly, 3);
+        SERIAL_PROTOCOLPGM(" Z: ");
+        SERIAL_PROTOCOL_F(measured_z, 3);
+        SERIAL_EOL();
+      }
+
+      #if ENABLED(DEBUG_LEVELING_FEATURE)
+        if (DEBUGGING(LEVELING)) SERIAL_ECHOLNPGM("<<< fast_probe_pt");
+      #endif
+
+      if (isnan(measured_z)) {
+        LCD_MESSAGEPGM(MSG_ERR_PROBING_FAILED);
+        SERIAL_ERROR_START();
+        SERIAL_ERRORLNPGM(MSG_ERR_PROBING_FAILED);
+      }
+
+      return measured_z;
+    }
+
+  #endif // G29_FAST_PROBE
+
 #endif // HAS_BED_PROBE
 
 #if HAS_LEVELING
@@ -3096,45 +3232,58 @@ static void clean_up_after_endstop_or_probe_move() {
       return z_values[x - 1][y - 1];
     }
 
-    static float bed_level_virt_cmr(const float p[4], const uint8_t i, const float t) {
-      return (
-          p[i-1] * -t * sq(1 - t)
-        + p[i]   * (2 - 5 * sq(t) + 3 * t * sq(t))
-        + p[i+1] * t * (1 + 4 * t - 3 * sq(t))
-        - p[i+2] * sq(t) * (1 - t)
-      ) * 0.5;
+    // Catmull-Rom weights of the four neighbours for each step between grid points
+    static float bed_level_virt_weights[BILINEAR_SUBDIVISIONS][4];
+    static bool bed_level_virt_weights_ready = false;
+
+    static void bed_level_virt_init_weights() {
+      for (uint8_t i = 0; i < BILINEAR_SUBDIVISIONS; i++) {
+        const float t = (float)i / (BILINEAR_SUBDIVISIONS);
+        bed_level_virt_weights[i][0] = -t * sq(1 - t) * 0.5;
+        bed_level_virt_weights[i][1] = (2 - 5 * sq(t) + 3 * t * sq(t)) * 0.5;
+        bed_level_virt_weights[i][2] = t * (1 + 4 * t - 3 * sq(t)) * 0.5;
+        bed_level_virt_weights[i][3] = -sq(t) * (1 - t) * 0.5;
+      }
+      bed_level_virt_weights_ready = true;
     }
 
-    static float bed_level_virt_2cmr(const uint8_t x, const uint8_t y, const float &tx, const float &ty) {
-      float row[4], column[4];
-      for (uint8_t i = 0; i < 4; i++) {
-        for (uint8_t j = 0; j < 4; j++) {
-          column[j] = bed_level_virt_coord(i + x - 1, j + y - 1);
-        }
-        row[i] = bed_level_virt_cmr(column, 1, ty);
-      }
-      return bed_level_virt_cmr(row, 1, tx);
+    static float bed_level_virt_cmr(const float p[4], const float w[4]) {
+      return p[0] * w[0] + p[1] * w[1] + p[2] * w[2] + p[3] * w[3];
     }
 
+    /**
+     * Interpolate one row of the subdivided grid at a time: first each column
+     * of the extended grid along Y, then along that row in X. On a grid line
+     * (t = 0) the value is the grid point itself, and the fourth neighbour,
+     * past the extended grid at the last line, is never read.
+     */
     void bed_level_virt_interpolate() {
       bilinear_grid_spacing_virt[X_AXIS] = bilinear_grid_spacing[X_AXIS] / (BILINEAR_SUBDIVISIONS);
       bilinear_grid_spacing_virt[Y_AXIS] = bilinear_grid_spacing[Y_AXIS] / (BILINEAR_SUBDIVISIONS);
       bilinear_grid_factor_virt[X_AXIS] = RECIPROCAL(bilinear_grid_spacing_virt[X_AXIS]);
       bilinear_grid_factor_virt[Y_AXIS] = RECIPROCAL(bilinear_grid_spacing_virt[Y_AXIS]);
+      if (!bed_level_virt_weights_ready) bed_level_virt_init_weights();
+
+      float row[ABL_TEMP_POINTS_X], column[4];
       for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
-        for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
-          for (uint8_t ty = 0; ty < BILINEAR_SUBDIVISIONS; ty++)
+        for (uint8_t ty = 0; ty < BILINEAR_SUBDIVISIONS; ty++) {
+          if (ty && y == GRID_MAX_POINTS_Y - 1) break;
+          for (uint8_t i = 0; i < ABL_TEMP_POINTS_X; i++) {
+            if (ty) {
+              for (uint8_t j = 0; j < 4; j++)
+                column[j] = bed_level_virt_coord(i, y + j);
+              row[i] = bed_level_virt_cmr(column, bed_level_virt_weights[ty]);
+            }
+            else
+              row[i] = bed_level_virt_coord(i, y + 1);
+          }
+          for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
             for (uint8_t tx = 0; tx < BILINEAR_SUBDIVISIONS; tx++) {
-              if ((ty && y == GRID_MAX_POINTS_Y - 1) || (tx && x == GRID_MAX_POINTS_X - 1))
-                continue;
+              if (tx && x == GRID_MAX_POINTS_X - 1) break;
               z_values_virt[x * (BILINEAR_SUBDIVISIONS) + tx][y * (BILINEAR_SUBDIVISIONS) + ty] =
-                bed_level_virt_2cmr(
-                  x + 1,
-                  y + 1,
-                  (float)tx / (BILINEAR_SUBDIVISIONS),
-                  (float)ty / (BILINEAR_SUBDIVISIONS)
-                );
+                tx ? bed_level_virt_cmr(&row[x], bed_level_virt_weights[tx]) : row[x + 1];
             }
+        }
     }
   #endif // ABL_BILINEAR_SUBDIVISION
 
@@ -3145,8 +3294,95 @@ static void clean_up_after_endstop_or_probe_move() {
     #if ENABLED(ABL_BILINEAR_SUBDIVISION)
       bed_level_virt_interpolate();
     #endif
+    #if ENABLED(ABL_BILINEAR_CELL_CACHE)
+      bilinear_cell_refresh();
+    #endif
   }
 
+  #if ENABLED(ABL_THERMAL_MESHES)
+
+    static int16_t thermal_mesh_bed_temp; // The bed temperature of the grid in use
+    static bool thermal_mesh_edited;      // M421 or G29 W changed the grid in use
+
+    /**
+     * Save the grid in use for a bed temperature: G29 for the one it probed
+     * at, M500 for the one an edit was made at. It goes in the slot probed
+     * closest to it within THERMAL_MESH_MATCH, else in an empty slot, else
+     * in the one probed at the closest temperature.
+     */
+    static void thermal_mesh_store(const int16_t temp) {
+      const bool same_grid = settings.thermal_mesh_grid_matches();
+      uint8_t slot = 0;
+      int16_t best = 0x7FFF;
+      for (uint8_t s = 0; s < THERMAL_MESHES; s++) {
+        const int16_t t = same_grid ? settings.thermal_mesh_temp(s) : -1,
+                      d = t < 0 ? 2 * (THERMAL_MESH_MATCH) + 1 : 2 * abs(t - temp);
+        if (d < best) { best = d; slot = s; }
+      }
+      settings.store_thermal_mesh(slot, temp);
+      thermal_mesh_bed_temp = temp;
+      thermal_mesh_edited = false;
+    }
+
+    void thermal_mesh_save() { thermal_mesh_store(LROUND(thermalManager.degBed())); }
+
+    // M500: Store an edited grid for the temperature it's in use at, so it survives a restart
+    void thermal_mesh_save_edit() {
+      if (thermal_mesh_edited) thermal_mesh_store(thermal_mesh_bed_temp);
+    }
+
+    /**
+     * When the bed temperature has moved by THERMAL_MESH_HYSTERESIS, replace
+     * the grid with the one interpolated between the stored grids probed at
+     * the closest temperatures below and above it, or with the nearest one
+     * if the bed is outside their range. An edited grid is kept until M500 or
+     * G29 stores it, as the edit can't be told apart in the stored grids.
+     */
+    void thermal_mesh_update(const bool force/*=false*/) {
+      if (thermal_mesh_edited) return;
+      const int16_t temp = LROUND(thermalManager.degBed());
+      if (!force && abs(temp - thermal_mesh_bed_temp) < THERMAL_MESH_HYSTERESIS) return;
+      thermal_mesh_bed_temp = temp;
+      if (!settings.thermal_mesh_grid_matches()) return;
+
+      int8_t lo = -1, hi = -1;
+      int16_t lo_temp = 0, hi_temp = 0;
+      for (uint8_t s = 0; s < THERMAL_MESHES; s++) {
+        const int16_t t = settings.thermal_mesh_temp(s);
+        if (t < 0) continue;
+        if (t <= temp) {
+          if (lo < 0 || t > lo_temp) { lo = s; lo_temp = t; }
+        }
+        else if (hi < 0 || t < hi_temp) { hi = s; hi_temp = t; }
+      }
+      if (lo < 0) { lo = hi; lo_temp = hi_temp; }
+      if (lo < 0) return;
+      const float ratio = hi >= 0 && lo_temp < temp ? float(temp - lo_temp) / (hi_temp - lo_temp) : 0.0;
+
+      for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++) {
+          const float z = settings.thermal_mesh_z(lo, x, y);
+          z_values[x][y] = ratio ? z + ratio * (settings.thermal_mesh_z(hi, x, y) - z) : z;
+        }
+      refresh_bed_level();
+    }
+
+    // M420 T: List the stored grids, and the temperature of the one in use
+    void thermal_mesh_report() {
+      const bool same_grid = settings.thermal_mesh_grid_matches();
+      SERIAL_ECHO_START();
+      SERIAL_ECHOPGM("Bed temperature grids:");
+      for (uint8_t s = 0; s < THERMAL_MESHES; s++) {
+        const int16_t t = same_grid ? settings.thermal_mesh_temp(s) : -1;
+        if (t >= 0) SERIAL_ECHOPAIR(" ", t);
+      }
+      SERIAL_ECHOPAIR(" in use:", thermal_mesh_bed_temp);
+      if (thermal_mesh_edited) SERIAL_ECHOPGM(" edited");
+      SERIAL_EOL();
+    }
+
+  #endif // ABL_THERMAL_MESHES
+
 #endif // AUTO_BED_LEVELING_BILINEAR
 
 /**
@@ -3672,6 +3908,9 @@ inline void gcode_G0_G1(
           const float echange = destination[E_AXIS] - current_position[E_AXIS];
           // Is this a retract or recover move?
           if (WITHIN(FABS(echange), MIN_AUTORETRACT, MAX_AUTORETRACT) && retracted[active_extruder] == (echange > 0.0)) {
+            #if ENABLED(SEGMENT_COALESCING)
+              flush_coalesced_move();                       // The planner must be caught up
+            #endif
             current_position[E_AXIS] = destination[E_AXIS]; // Hide a G1-based retract/recover from calculations
             sync_plan_position_e();                         // AND from the planner
             return retract(echange < 0.0);                  // Firmware-based retract/recover (double-retract ignored)
@@ -3682,6 +3921,8 @@ inline void gcode_G0_G1(
 
     #if IS_SCARA
       fast_move ? prepare_uninterpolated_move_to_destination() : prepare_move_to_destination();
+    #elif ENABLED(SEGMENT_COALESCING)
+      if (!coalesce_move()) prepare_move_to_destination();
     #else
       prepare_move_to_destination();
     #endif
@@ -4682,6 +4923,107 @@ void home_all_axes() { gcode_G28(true); }
     #endif
   #endif
 
+  #if ENABLED(ABL_INCREMENTAL_PROBE)
+
+    static bool bilinear_grid_complete() {
+      for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
+          if (isnan(z_values[x][y])) return false;
+      return true;
+    }
+
+    #define INCREMENTAL_SAMPLE(I,N) ((I) % (INCREMENTAL_PROBE_STRIDE) == 0 || (I) == (N) - 1)
+
+    /**
+     * G29 U: Probe the sample points of the stored grid, then re-probe the
+     * points within INCREMENTAL_PROBE_STRIDE of any sample that moved by
+     * more than INCREMENTAL_PROBE_THRESHOLD. z_values is updated in place
+     * and the caller refreshes the grid.
+     *
+     * Return the last probed Z position, or NAN if probing failed.
+     */
+    static float bilinear_update_grid(const float &zoffset, const bool stow, const uint8_t verbose_level) {
+      enum : uint8_t { POINT_KEEP, POINT_REPROBE, POINT_PROBED };
+      uint8_t state[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+      ZERO(state);
+
+      uint8_t checked = 0, changed = 0, reprobed = 0;
+      float measured_z = 0;
+      #if ENABLED(G29_FAST_PROBE)
+        bool fast_probe = false; // Set after the first point
+      #endif
+
+      // The samples first, then the points around those that moved
+      for (uint8_t pass = 0; pass < 2 && !isnan(measured_z); pass++) {
+        for (uint8_t y = 0; y < GRID_MAX_POINTS_Y && !isnan(measured_z); y++) {
+          for (uint8_t n = 0; n < GRID_MAX_POINTS_X; n++) {
+            const uint8_t x = (y & 1) ? GRID_MAX_POINTS_X - 1 - n : n;
+            if (state[x][y] == POINT_PROBED) continue;
+            if (pass ? state[x][y] != POINT_REPROBE : !(INCREMENTAL_SAMPLE(x, GRID_MAX_POINTS_X) && INCREMENTAL_SAMPLE(y, GRID_MAX_POINTS_Y)))
+              continue;
+
+            const float xProbe = LOGICAL_X_POSITION(bilinear_start[X_AXIS] + x * bilinear_grid_spacing[X_AXIS]),
+                        yProbe = LOGICAL_Y_POSITION(bilinear_start[Y_AXIS] + y * bilinear_grid_spacing[Y_AXIS]);
+
+            // With fast probing expect the bed no lower than the stored grid says
+            measured_z =
+              #if ENABLED(G29_FAST_PROBE)
+                fast_probe ? fast_probe_pt(xProbe, yProbe, max(measured_z, z_values[x][y] - zoffset), verbose_level) :
+              #endif
+              probe_pt(xProbe, yProbe, stow, verbose_level);
+
+            if (isnan(measured_z)) break;
+
+            #if ENABLED(G29_FAST_PROBE)
+              fast_probe = !stow;
+            #endif
+
+            const float dz = measured_z + zoffset - z_values[x][y];
+            z_values[x][y] = measured_z + zoffset;
+            state[x][y] = POINT_PROBED;
+
+            if (pass)
+              reprobed++;
+            else {
+              checked++;
+              if (verbose_level > 1) {
+                SERIAL_PROTOCOLPAIR("Point ", x);
+                SERIAL_PROTOCOLPAIR(",", y);
+                SERIAL_PROTOCOLPGM(" moved ");
+                SERIAL_PROTOCOL_F(dz, 3);
+                SERIAL_EOL();
+              }
+              if (FABS(dz) > INCREMENTAL_PROBE_THRESHOLD) {
+                changed++;
+                for (int8_t i = x - (INCREMENTAL_PROBE_STRIDE - 1); i <= x + (INCREMENTAL_PROBE_STRIDE - 1); i++)
+                  for (int8_t j = y - (INCREMENTAL_PROBE_STRIDE - 1); j <= y + (INCREMENTAL_PROBE_STRIDE - 1); j++)
+                    if (WITHIN(i, 0, GRID_MAX_POINTS_X - 1) && WITHIN(j, 0, GRID_MAX_POINTS_Y - 1) && state[i][j] == POINT_KEEP)
+                      state[i][j] = POINT_REPROBE;
+              }
+            }
+
+            idle();
+          }
+        }
+      }
+
+      // Fast probing leaves a BLTouch deployed
+      #if ENABLED(G29_FAST_PROBE) && ENABLED(BLTOUCH)
+        if (fast_probe) set_bltouch_deployed(false);
+      #endif
+
+      if (!isnan(measured_z)) {
+        SERIAL_PROTOCOLPAIR("Grid checked at ", checked);
+        SERIAL_PROTOCOLPAIR(" points, ", changed);
+        SERIAL_PROTOCOLPAIR(" moved, ", reprobed);
+        SERIAL_PROTOCOLLNPGM(" more probed");
+      }
+
+      return measured_z;
+    }
+
+  #endif // ABL_INCREMENTAL_PROBE
+
   /**
    * G29: Detailed Z probe, probes the bed at 3 or more points.
    *      Will fail if the printer has not been homed with G28.
@@ -4752,6 +5094,15 @@ void home_all_axes() { gcode_G28(true); }
    *  E  By default G29 will engage the Z probe, test the bed, then disengage.
    *     Include "E" to engage/disengage the Z probe for each sample.
    *     There's no extra effect if you have a fixed Z probe.
+   *     With G29_FAST_PROBE "E" also turns off fast probing.
+   *
+   * With ABL_INCREMENTAL_PROBE:
+   *
+   *  U  Check the stored grid at a few points and re-probe only around
+   *     those that moved. Probes all points if there's no complete grid.
+   *
+   * With ABL_PRINT_AREA, while a file prints and without L, R, F or B,
+   * only the grid points under the print are probed.
    *
    */
   inline void gcode_G29() {
@@ -4836,6 +5187,11 @@ void home_all_axes() { gcode_G28(true); }
 
         ABL_VAR float zoffset;
 
+        #if ENABLED(ABL_PRINT_AREA)
+          // The grid points to probe, all of them or those under the print
+          ABL_VAR uint8_t area_first[2], area_last[2];
+        #endif
+
       #elif ENABLED(AUTO_BED_LEVELING_LINEAR)
 
         ABL_VAR int indexIntoAB[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
@@ -4905,10 +5261,11 @@ void home_all_axes() { gcode_G28(true); }
           if (WITHIN(i, 0, GRID_MAX_POINTS_X - 1) && WITHIN(j, 0, GRID_MAX_POINTS_Y)) {
             set_bed_leveling_enabled(false);
             z_values[i][j] = z;
-            #if ENABLED(ABL_BILINEAR_SUBDIVISION)
-              bed_level_virt_interpolate();
-            #endif
+            refresh_bed_level();
             set_bed_leveling_enabled(abl_should_enable);
+            #if ENABLED(ABL_THERMAL_MESHES)
+              thermal_mesh_edited = true;
+            #endif
           }
           return;
         } // parser.seen('W')
@@ -5060,6 +5417,33 @@ void home_all_axes() { gcode_G28(true); }
           abl_should_enable = false;
         }
 
+        #if ENABLED(ABL_PRINT_AREA)
+          area_first[X_AXIS] = area_first[Y_AXIS] = 0;
+          area_last[X_AXIS] = GRID_MAX_POINTS_X - 1;
+          area_last[Y_AXIS] = GRID_MAX_POINTS_Y - 1;
+
+          // While printing a file, probe only the grid points of the cells
+          // under the print. Other points keep their stored values and
+          // those without one are extrapolated.
+          float area_min[2], area_max[2];
+          if (FILE_IS_PRINT && !faux && !parser.seen('L') && !parser.seen('R') && !parser.seen('F') && !parser.seen('B')
+            && print_area_scan(area_min, area_max)
+          ) {
+            area_first[X_AXIS] = constrain(FLOOR((area_min[X_AXIS] - (PRINT_AREA_MARGIN) - left_probe_bed_position) / xGridSpacing), 0, GRID_MAX_POINTS_X - 1);
+            area_last[X_AXIS] = constrain(CEIL((area_max[X_AXIS] + (PRINT_AREA_MARGIN) - left_probe_bed_position) / xGridSpacing), 0, GRID_MAX_POINTS_X - 1);
+            area_first[Y_AXIS] = constrain(FLOOR((area_min[Y_AXIS] - (PRINT_AREA_MARGIN) - front_probe_bed_position) / yGridSpacing), 0, GRID_MAX_POINTS_Y - 1);
+            area_last[Y_AXIS] = constrain(CEIL((area_max[Y_AXIS] + (PRINT_AREA_MARGIN) - front_probe_bed_position) / yGridSpacing), 0, GRID_MAX_POINTS_Y - 1);
+            SERIAL_PROTOCOLPAIR("Print area X", area_min[X_AXIS]);
+            SERIAL_PROTOCOLPAIR(":", area_max[X_AXIS]);
+            SERIAL_PROTOCOLPAIR(" Y", area_min[Y_AXIS]);
+            SERIAL_PROTOCOLPAIR(":", area_max[Y_AXIS]);
+            SERIAL_PROTOCOLPAIR(" probes I", area_first[X_AXIS]);
+            SERIAL_PROTOCOLPAIR(":", area_last[X_AXIS]);
+            SERIAL_PROTOCOLPAIR(" J", area_first[Y_AXIS]);
+            SERIAL_PROTOCOLLNPAIR(":", area_last[Y_AXIS]);
+          }
+        #endif
+
       #endif // AUTO_BED_LEVELING_BILINEAR
 
       #if ENABLED(AUTO_BED_LEVELING_3POINT)
@@ -5248,14 +5632,36 @@ void home_all_axes() { gcode_G28(true); }
     {
       const bool stow_probe_after_each = parser.boolval('E');
 
+      #if ENABLED(G29_FAST_PROBE)
+        bool fast_probe = false; // Set after the first point
+      #endif
+
+      const millis_t probe_start_ms = millis();
+
       measured_z = 0;
 
       #if ABL_GRID
 
+        #if ENABLED(ABL_INCREMENTAL_PROBE)
+          bool update_grid = false;
+          if (parser.boolval('U') && !faux) {
+            update_grid = bilinear_grid_complete();
+            if (update_grid) {
+              measured_z = bilinear_update_grid(zoffset, stow_probe_after_each, verbose_level);
+              if (isnan(measured_z)) planner.abl_enabled = abl_should_enable;
+              abl_should_enable = false;
+            }
+            else
+              SERIAL_PROTOCOLLNPGM("No complete grid. Probing all points.");
+          }
+        #else
+          constexpr bool update_grid = false;
+        #endif
+
         bool zig = PR_OUTER_END & 1;  // Always end at RIGHT and BACK_PROBE_BED_POSITION
 
         // Outer loop is Y with PROBE_Y_FIRST disabled
-        for (uint8_t PR_OUTER_VAR = 0; PR_OUTER_VAR < PR_OUTER_END && !isnan(measured_z); PR_OUTER_VAR++) {
+        for (uint8_t PR_OUTER_VAR = 0; !update_grid && PR_OUTER_VAR < PR_OUTER_END && !isnan(measured_z); PR_OUTER_VAR++) {
 
           int8_t inStart, inStop, inInc;
 
@@ -5275,6 +5681,10 @@ void home_all_axes() { gcode_G28(true); }
           // Inner loop is Y with PROBE_Y_FIRST enabled
           for (int8_t PR_INNER_VAR = inStart; PR_INNER_VAR != inStop; PR_INNER_VAR += inInc) {
 
+            #if ENABLED(ABL_PRINT_AREA)
+              if (!WITHIN(xCount, area_first[X_AXIS], area_last[X_AXIS]) || !WITHIN(yCount, area_first[Y_AXIS], area_last[Y_AXIS])) continue;
+            #endif
+
             float xBase = left_probe_bed_position + xGridSpacing * xCount,
                   yBase = front_probe_bed_position + yGridSpacing * yCount;
 
@@ -5290,13 +5700,21 @@ void home_all_axes() { gcode_G28(true); }
               if (!position_is_reachable_by_probe_xy(xProbe, yProbe)) continue;
             #endif
 
-            measured_z = faux ? 0.001 * random(-100, 101) : probe_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
+            measured_z = faux ? 0.001 * random(-100, 101)
+              #if ENABLED(G29_FAST_PROBE)
+                : fast_probe ? fast_probe_pt(xProbe, yProbe, measured_z, verbose_level)
+              #endif
+              : probe_pt(xProbe, yProbe, stow_probe_after_each, verbose_level);
 
             if (isnan(measured_z)) {
               planner.abl_enabled = abl_should_enable;
               break;
             }
 
+            #if ENABLED(G29_FAST_PROBE)
+              fast_probe = !stow_probe_after_each;
+            #endif
+
             #if ENABLED(AUTO_BED_LEVELING_LINEAR)
 
               mean += measured_z;
@@ -5350,11 +5768,21 @@ void home_all_axes() { gcode_G28(true); }
 
       #endif // AUTO_BED_LEVELING_3POINT
 
+      // Fast probing leaves a BLTouch deployed
+      #if ENABLED(G29_FAST_PROBE) && ENABLED(BLTOUCH)
+        if (fast_probe) set_bltouch_deployed(false);
+      #endif
+
       // Raise to _Z_CLEARANCE_DEPLOY_PROBE. Stow the probe.
       if (STOW_PROBE()) {
         planner.abl_enabled = abl_should_enable;
         measured_z = NAN;
       }
+
+      if (!faux) {
+        SERIAL_PROTOCOLPAIR("Probing time: ", (millis() - probe_start_ms) * 0.001);
+        SERIAL_PROTOCOLLNPGM("s");
+      }
     }
     #endif // !PROBE_MANUALLY
 
@@ -5383,6 +5811,15 @@ void home_all_axes() { gcode_G28(true); }
     if (!isnan(measured_z)) {
       #if ENABLED(AUTO_BED_LEVELING_BILINEAR)
 
+        #if ENABLED(ABL_PRINT_AREA)
+          // Outside the print area, points without a stored value keep the nearest probed height
+          if (!dryrun)
+            for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+              for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
+                if (isnan(z_values[x][y]))
+                  z_values[x][y] = z_values[constrain(x, area_first[X_AXIS], area_last[X_AXIS])][constrain(y, area_first[Y_AXIS], area_last[Y_AXIS])];
+        #endif
+
         if (!dryrun) extrapolate_unprobed_bed_level();
         print_bilinear_leveling_grid();
 
@@ -5596,8 +6033,14 @@ void home_all_axes() { gcode_G28(true); }
     lcd_refresh();
     STORE_SETTING(bilinear_grid_spacing);
     STORE_SETTING(bilinear_start);
-    EEPROM_STORE(z_values, mesh_bilinear_z_values);
+    #if ENABLED(EEPROM_SETTINGS)
+      settings.store_grid(SETTING_ADDR_mesh_bilinear_z_values, z_values);
+    #endif
     /*******************************************/
+
+    #if ENABLED(ABL_THERMAL_MESHES)
+      if (!dryrun && !isnan(measured_z)) thermal_mesh_save();
+    #endif
   }
 
 #endif // HAS_ABL && !AUTO_BED_LEVELING_UBL
@@ -8206,6 +8649,11 @@ inline void gcode_M109() {
       SERIAL_ECHOLNPGM(MSG_BED_DONE);
       DWIN_MSG_P(DWIN_MSG_BED_DONE);
     }
+
+    #if ENABLED(ABL_THERMAL_MESHES)
+      // The print starts on the grid for the bed temperature reached
+      thermal_mesh_update();
+    #endif
     #if DISABLED(BUSY_WHILE_HEATING)
       KEEPALIVE_STATE(IN_HANDLER);
     #endif
@@ -8213,6 +8661,68 @@ inline void gcode_M109() {
 
 #endif // HAS_TEMP_BED
 
+/**
+ * M116: Wait for all the heaters with a target to reach it. Waits only when heating.
+ *       Set every target first (M104, M140, M6013) and they heat together.
+ *
+ *  S<degC> How close counts as reached. Default TEMP_WINDOW, TEMP_BED_WINDOW for the bed.
+ */
+inline void gcode_M116() {
+  if (DEBUGGING(DRYRUN)) return;
+
+  const bool seen_window = parser.seenval('S');
+  const float window = seen_window ? parser.value_float() : 0;
+  #define M116_HEATING(CURRENT, TARGET, WINDOW) ((TARGET) && (CURRENT) < (TARGET) - (seen_window ? window : (WINDOW)))
+
+  LCD_MESSAGEPGM(MSG_HEATING);
+  SERIAL_ECHOLNPGM(MSG_HEATING);
+  DWIN_MSG_P(DWIN_MSG_HEATING);
+
+  bool heating;
+  wait_for_heatup = true;
+  millis_t now, next_temp_ms = 0;
+
+  #if DISABLED(BUSY_WHILE_HEATING)
+    KEEPALIVE_STATE(NOT_BUSY);
+  #endif
+
+  target_extruder = active_extruder; // for print_heaterstates
+
+  do {
+    now = millis();
+    if (ELAPSED(now, next_temp_ms)) { // Print temps every 1s while waiting
+      next_temp_ms = now + 1000UL;
+      print_heaterstates();
+      SERIAL_EOL();
+    }
+
+    idle();
+    refresh_cmd_timeout(); // to prevent stepper_inactive_time from running out
+
+    // Targets might be changed during the loop
+    heating = false;
+    HOTEND_LOOP()
+      if (M116_HEATING(thermalManager.degHotend(e), thermalManager.degTargetHotend(e), TEMP_WINDOW)) heating = true;
+    #if HAS_TEMP_BED
+      if (M116_HEATING(thermalManager.degBed(), thermalManager.degTargetBed(), TEMP_BED_WINDOW)) heating = true;
+    #endif
+    #if HAS_TEMP_CHAMBER
+      if (M116_HEATING(thermalManager.degChamber(), thermalManager.degTargetChamber(), TEMP_WINDOW)) heating = true;
+    #endif
+
+  } while (wait_for_heatup && heating);
+
+  if (wait_for_heatup) {
+    LCD_MESSAGEPGM(MSG_HEATING_COMPLETE);
+    SERIAL_ECHOLNPGM(MSG_HEATING_COMPLETE);
+    DWIN_MSG_P(DWIN_MSG_HEATING_COMPLETE);
+  }
+
+  #if DISABLED(BUSY_WHILE_HEATING)
+    KEEPALIVE_STATE(IN_HANDLER);
+  #endif
+}
+
 /**
  * M110: Set Current Line Number
  */
@@ -9379,6 +9889,10 @@ inline void gcode_M226() {
    *   C[float] Kc term
    *   L[float] LPQ length
    *
+   * With PID_EXTRUSION_FEEDFORWARD:
+   *
+   *   F[float] Kf term (per mm³/s) of hotend E
+   *
    * PID_PARAMS_USE_TEMP_RANGE
    *   S[uint8_t] Temperature range index
    */
@@ -9395,6 +9909,10 @@ inline void gcode_M226() {
         if (parser.seen('L')) lpq_len = parser.value_float();
         NOMORE(lpq_len, LPQ_MAX_LEN);
       #endif
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        const uint8_t e = parser.byteval('E');
+        if (e < HOTENDS && parser.seen('F')) thermalManager.Kf[e] = max(parser.value_float(), 0);
+      #endif
       thermalManager.updatePID();
       SERIAL_ECHO_START();
       SERIAL_ECHOPAIR(" s:", s);
@@ -9405,6 +9923,9 @@ inline void gcode_M226() {
         //Kc does not have scaling applied above, or in resetting defaults
         SERIAL_ECHOPAIR(" c:", PID_PARAM(Kc, s));
       #endif
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        if (e < HOTENDS) SERIAL_ECHOPAIR(" f:", thermalManager.Kf[e]);
+      #endif
       SERIAL_EOL();
     } else {
       SERIAL_ERROR_START();
@@ -9425,6 +9946,9 @@ inline void gcode_M226() {
         if (parser.seen('L')) lpq_len = parser.value_float();
         NOMORE(lpq_len, LPQ_MAX_LEN);
       #endif
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        if (parser.seen('F')) thermalManager.Kf[e] = max(parser.value_float(), 0);
+      #endif
 
       thermalManager.updatePID();
       SERIAL_ECHO_START();
@@ -9438,6 +9962,9 @@ inline void gcode_M226() {
         //Kc does not have scaling applied above, or in resetting defaults
         SERIAL_ECHOPAIR(" c:", PID_PARAM(Kc, e));
       #endif
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        SERIAL_ECHOPAIR(" f:", thermalManager.Kf[e]);
+      #endif
       SERIAL_EOL();
     }
     else {
@@ -9593,6 +10120,62 @@ inline void gcode_M303() {
   }
 #endif // PIDTEMP_CHAMBER
 
+#if ENABLED(MPCTEMP)
+
+  /**
+   * M306: Set or report the hotend thermal model for MPC
+   *
+   *   E<extruder>  Hotend to set (default 0)
+   *   P<watts>     Heater power
+   *   C<J/K>       Heater block heat capacity
+   *   R<K/s/K>     Sensor responsiveness
+   *   A<W/K>       Heat loss to ambient with the fan off
+   *   F<W/K>       Extra heat loss to ambient with the fan at full speed
+   *   H<J/K/mm>    Filament heat capacity per mm
+   *
+   *   T            Identify C, R, A and F by heating to S<temperature> (default MPC_TUNING_TEMP)
+   *
+   * Use M500 to save the model.
+   */
+  inline void gcode_M306() {
+    const uint8_t e = parser.byteval('E');
+    if (e >= HOTENDS) {
+      SERIAL_ERROR_START();
+      SERIAL_ERRORLN(MSG_INVALID_EXTRUDER);
+      return;
+    }
+
+    if (parser.seen('T')) {
+      const int16_t temp = parser.celsiusval('S', MPC_TUNING_TEMP);
+      #if DISABLED(BUSY_WHILE_HEATING)
+        KEEPALIVE_STATE(NOT_BUSY);
+      #endif
+      thermalManager.MPC_autotune(e, temp);
+      #if DISABLED(BUSY_WHILE_HEATING)
+        KEEPALIVE_STATE(IN_HANDLER);
+      #endif
+    }
+
+    Temperature::mpc_t &model = thermalManager.mpc[e];
+    if (parser.seen('P')) model.heater_power = parser.value_float();
+    if (parser.seen('C')) model.block_heat_capacity = parser.value_float();
+    if (parser.seen('R')) model.sensor_responsiveness = parser.value_float();
+    if (parser.seen('A')) model.ambient_xfer_coeff_fan0 = parser.value_float();
+    if (parser.seen('F')) model.fan255_adjustment = parser.value_float();
+    if (parser.seen('H')) model.filament_heat_capacity_permm = parser.value_float();
+
+    SERIAL_ECHO_START();
+    SERIAL_ECHOPAIR(" e:", e);
+    SERIAL_ECHOPAIR(" p:", model.heater_power);
+    SERIAL_ECHOPAIR(" c:", model.block_heat_capacity);
+    SERIAL_ECHOPAIR(" r:", model.sensor_responsiveness);
+    SERIAL_ECHOPAIR(" a:", model.ambient_xfer_coeff_fan0);
+    SERIAL_ECHOPAIR(" f:", model.fan255_adjustment);
+    SERIAL_ECHOLNPAIR(" h:", model.filament_heat_capacity_permm);
+  }
+
+#endif // MPCTEMP
+
 #if ENABLED(MORGAN_SCARA)
 
   bool SCARA_move_to_cal(uint8_t delta_a, uint8_t delta_b) {
@@ -9818,6 +10401,10 @@ void quickstop_stepper() {
    * With AUTO_BED_LEVELING_UBL only:
    *
    *   L[index]  Load UBL mesh from index (0 is default)
+   *
+   * With ABL_THERMAL_MESHES only:
+   *
+   *   T[bool]   List the grids stored for bed temperatures, T0 to delete them
    */
   inline void gcode_M420() {
 
@@ -9861,6 +10448,13 @@ void quickstop_stepper() {
 
     #endif // AUTO_BED_LEVELING_UBL
 
+    #if ENABLED(ABL_THERMAL_MESHES)
+      if (parser.seen('T')) {
+        if (!parser.value_bool()) settings.clear_thermal_meshes();
+        thermal_mesh_report();
+      }
+    #endif
+
     // V to print the matrix or mesh
     if (parser.seen('V')) {
       #if ABL_PLANAR
@@ -9965,8 +10559,9 @@ void quickstop_stepper() {
     }
     else {
       z_values[ix][iy] = parser.value_linear_units() + (hasQ ? z_values[ix][iy] : 0);
-      #if ENABLED(ABL_BILINEAR_SUBDIVISION)
-        bed_level_virt_interpolate();
+      refresh_bed_level();
+      #if ENABLED(ABL_THERMAL_MESHES)
+        thermal_mesh_edited = true;
       #endif
     }
   }
@@ -10113,6 +10708,9 @@ inline void gcode_M502() {
           for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
             for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
               z_values[x][y] -= diff;
+          #if ENABLED(ABL_THERMAL_MESHES)
+            thermal_mesh_edited = true;
+          #endif
         }
         #if ENABLED(ABL_BILINEAR_SUBDIVISION)
           bed_level_virt_interpolate();
@@ -10344,6 +10942,46 @@ inline void gcode_M502() {
 
 #endif // DUAL_NOZZLE_DUPLICATION_MODE
 
+#if ENABLED(ISR_TIMING_STATS)
+  /**
+   * M880: Report stepper and temperature ISR timing statistics
+   *
+   *  R  Reset the statistics after reporting
+   */
+  inline void gcode_M880() {
+    isr_timing.report();
+    if (parser.seen('R')) isr_timing.reset();
+  }
+#endif // ISR_TIMING_STATS
+
+#if ENABLED(PLANNER_UNDERRUN_STATS)
+  /**
+   * M881: Report the planner queued time and underrun statistics
+   *
+   *  R  Reset the statistics after reporting
+   */
+  inline void gcode_M881() {
+    planner.report_underrun_stats();
+    if (parser.seen('R')) planner.reset_underrun_stats();
+  }
+#endif // PLANNER_UNDERRUN_STATS
+
+#if ENABLED(SEGMENT_COALESCING)
+  /**
+   * M882: Report how many G0/G1 moves were merged into how many planner moves
+   *
+   *  R  Reset the counters after reporting
+   */
+  inline void gcode_M882() {
+    SERIAL_ECHO_START();
+    SERIAL_ECHOPAIR("Coalesced ", coalesce_moves_in);
+    SERIAL_ECHOPAIR(" moves into ", coalesce_moves_out);
+    if (coalesce_moves_out) SERIAL_ECHOPAIR(" ratio:", (float)coalesce_moves_in / coalesce_moves_out);
+    SERIAL_EOL();
+    if (parser.seen('R')) coalesce_moves_in = coalesce_moves_out = 0;
+  }
+#endif // SEGMENT_COALESCING
+
 #if ENABLED(LIN_ADVANCE)
   /**
    * M900: Set and/or Get advance K factor and WH/D ratio
@@ -12075,6 +12713,10 @@ inline void gcode_T(uint8_t tmp_extruder) {
 
   #elif HOTENDS > 1
 
+    #if ENABLED(TOOLCHANGE_PREHEAT)
+      toolchange_preheat.tool_change(tmp_extruder);
+    #endif
+
     tool_change(
       tmp_extruder,
       MMM_TO_MMS(parser.linearval('F')),
@@ -12125,6 +12767,11 @@ void process_next_command() {
   // Parse the next command in the queue
   parser.parse(current_command);
 
+  #if ENABLED(SEGMENT_COALESCING)
+    // Only G0/G1 can extend the pending move. Everything else sees it planned.
+    if (parser.command_letter != 'G' || parser.codenum > 1) flush_coalesced_move();
+  #endif
+
   // Handle a known G, M, or T
   switch (parser.command_letter) {
     case 'G': switch (parser.codenum) {
@@ -12448,6 +13095,10 @@ void process_next_command() {
         gcode_M109();
         break;
 
+      case 116: // M116: Wait for all heaters to reach their targets
+        gcode_M116();
+        break;
+
       #if HAS_TEMP_BED
         case 190: // M190: Wait for bed temperature to reach target
           gcode_M190();
@@ -12715,6 +13366,12 @@ void process_next_command() {
           break;
       #endif
 
+      #if ENABLED(MPCTEMP)
+        case 306: // M306: MPC hotend model
+          gcode_M306();
+          break;
+      #endif
+
       #if ENABLED(MORGAN_SCARA)
         case 360:  // M360: SCARA Theta pos1
           if (gcode_M360()) return;
@@ -12949,6 +13606,24 @@ void process_next_command() {
 
       #endif // I2C_POSITION_ENCODERS
 
+      #if ENABLED(ISR_TIMING_STATS)
+        case 880: // M880: Report ISR timing statistics
+          gcode_M880();
+          break;
+      #endif
+
+      #if ENABLED(PLANNER_UNDERRUN_STATS)
+        case 881: // M881: Report planner underrun statistics
+          gcode_M881();
+          break;
+      #endif
+
+      #if ENABLED(SEGMENT_COALESCING)
+        case 882: // M882: Report the segment merge ratio
+          gcode_M882();
+          break;
+      #endif
+
       case 999: // M999: Restart after being Stopped
         gcode_M999();
         break;
@@ -13183,9 +13858,54 @@ void ok_to_send() {
     #define ABL_BG_GRID(X,Y)  z_values[X][Y]
   #endif
 
+  #if ENABLED(ABL_BILINEAR_CELL_CACHE)
+
+    // Slopes of each grid box from its left-front corner, so that
+    // z = z1 + ratio_x * (dx + ratio_y * dxy) + ratio_y * dy
+    typedef struct { float dx, dy, dxy; } abl_cell_t;
+    abl_cell_t abl_cells[ABL_BG_POINTS_X - 1][ABL_BG_POINTS_Y - 1];
+    static_assert(sizeof(abl_cells) <= 2048, "ABL_BILINEAR_CELL_CACHE needs more than 2048 bytes of RAM. Reduce GRID_MAX_POINTS or BILINEAR_SUBDIVISIONS.");
+
+    void bilinear_cell_refresh() {
+      for (uint8_t x = 0; x < ABL_BG_POINTS_X - 1; x++)
+        for (uint8_t y = 0; y < ABL_BG_POINTS_Y - 1; y++) {
+          const float z1 = ABL_BG_GRID(x, y),         // left-front
+                      z2 = ABL_BG_GRID(x, y + 1),     // left-back
+                      z3 = ABL_BG_GRID(x + 1, y),     // right-front
+                      z4 = ABL_BG_GRID(x + 1, y + 1); // right-back
+          abl_cells[x][y].dx = z3 - z1;
+          abl_cells[x][y].dy = z2 - z1;
+          abl_cells[x][y].dxy = z4 - z3 - z2 + z1;
+        }
+    }
+
+  #endif
+
   // Get the Z adjustment for non-linear bed leveling
   float bilinear_z_offset(const float logical[XYZ]) {
 
+    #if ENABLED(ABL_BILINEAR_CELL_CACHE)
+
+      // The box, and the ratios within it. Beyond the far edge use the last
+      // box, which gives the same heights as the edge itself.
+      float ratio_x = (RAW_X_POSITION(logical[X_AXIS]) - bilinear_start[X_AXIS]) * ABL_BG_FACTOR(X_AXIS),
+            ratio_y = (RAW_Y_POSITION(logical[Y_AXIS]) - bilinear_start[Y_AXIS]) * ABL_BG_FACTOR(Y_AXIS);
+      const int8_t gridx = constrain(int16_t(ratio_x), 0, ABL_BG_POINTS_X - 2),
+                   gridy = constrain(int16_t(ratio_y), 0, ABL_BG_POINTS_Y - 2);
+      ratio_x -= gridx;
+      ratio_y -= gridy;
+
+      #if DISABLED(EXTRAPOLATE_BEYOND_GRID)
+        // Beyond the grid maintain height at grid edges
+        ratio_x = constrain(ratio_x, 0, 1);
+        ratio_y = constrain(ratio_y, 0, 1);
+      #endif
+
+      const abl_cell_t &cell = abl_cells[gridx][gridy];
+      return ABL_BG_GRID(gridx, gridy) + ratio_x * (cell.dx + ratio_y * cell.dxy) + ratio_y * cell.dy;
+
+    #else
+
     static float z1, d2, z3, d4, L, D, ratio_x, ratio_y,
                  last_x = -999.999, last_y = -999.999;
 
@@ -13280,6 +14000,8 @@ void ok_to_send() {
     //*/
 
     return offset;
+
+    #endif // !ABL_BILINEAR_CELL_CACHE
   }
 
 #endif // AUTO_BED_LEVELING_BILINEAR
@@ -13536,13 +14258,74 @@ void set_current_from_steppers_for_axis(const AxisEnum axis) {
     current_position[axis] = cartes[axis];
 }
 
+#if ENABLED(MESH_BED_LEVELING) || (ENABLED(AUTO_BED_LEVELING_BILINEAR) && !IS_KINEMATIC)
+
+  #if ENABLED(MESH_BED_LEVELING)
+    #define GRID_LINE_X(I) LOGICAL_X_POSITION(mbl.index_to_xpos[I])
+    #define GRID_LINE_Y(I) LOGICAL_Y_POSITION(mbl.index_to_ypos[I])
+  #else
+    #define GRID_LINE_X(I) LOGICAL_X_POSITION(bilinear_start[X_AXIS] + ABL_BG_SPACING(X_AXIS) * (I))
+    #define GRID_LINE_Y(I) LOGICAL_Y_POSITION(bilinear_start[Y_AXIS] + ABL_BG_SPACING(Y_AXIS) * (I))
+  #endif
+
+  /**
+   * Buffer the move from current_position to destination in pieces
+   * ending where it crosses the grid lines, from the cell cx1/cy1 to
+   * the cell cx2/cy2. The X and Y crossings are merged in order along
+   * the move, so the stack use doesn't grow with the cells crossed.
+   */
+  static void grid_line_to_destination(const float fr_mm_s, const int8_t cx1, const int8_t cy1, const int8_t cx2, const int8_t cy2) {
+    // The grid line crossed next: the left/front border of the right/back cell
+    const int8_t sx = cx2 > cx1 ? 1 : -1, sy = cy2 > cy1 ? 1 : -1;
+    int8_t gx = sx > 0 ? cx1 + 1 : cx1, gy = sy > 0 ? cy1 + 1 : cy1;
+    uint8_t nx = abs(cx2 - cx1), ny = abs(cy2 - cy1);
+
+    float dist[XYZE];
+    LOOP_XYZE(i) dist[i] = destination[i] - current_position[i];
+
+    // Fraction of the move at the next crossing of each axis (past the end if none)
+    #define NO_CROSSING 2.0
+    float tx = nx ? (GRID_LINE_X(gx) - current_position[X_AXIS]) / dist[X_AXIS] : NO_CROSSING,
+          ty = ny ? (GRID_LINE_Y(gy) - current_position[Y_AXIS]) / dist[Y_AXIS] : NO_CROSSING;
+
+    while (nx || ny) {
+      const float t = min(tx, ty);
+      float end[XYZE];
+      LOOP_XYZE(i) end[i] = current_position[i] + dist[i] * t;
+      if (tx <= t) end[X_AXIS] = GRID_LINE_X(gx);
+      if (ty <= t) end[Y_AXIS] = GRID_LINE_Y(gy);
+      planner.buffer_line(end[X_AXIS], end[Y_AXIS], end[Z_AXIS], end[E_AXIS], fr_mm_s, active_extruder);
+      #if ENABLED(QUICK_PAUSE)
+        if (invalidLoop) return;
+      #endif
+
+      // A crossing at a grid corner advances both axes
+      if (tx <= t) {
+        gx += sx;
+        tx = --nx ? (GRID_LINE_X(gx) - current_position[X_AXIS]) / dist[X_AXIS] : NO_CROSSING;
+      }
+      if (ty <= t) {
+        gy += sy;
+        ty = --ny ? (GRID_LINE_Y(gy) - current_position[Y_AXIS]) / dist[Y_AXIS] : NO_CROSSING;
+      }
+    }
+
+    line_to_destination(fr_mm_s);
+    #if ENABLED(QUICK_PAUSE)
+      if (invalidLoop) return;
+    #endif
+    set_current_to_destination();
+  }
+
+#endif
+
 #if ENABLED(MESH_BED_LEVELING)
 
   /**
    * Prepare a mesh-leveled linear move in a Cartesian setup,
    * splitting the move where it crosses mesh borders.
    */
-  void mesh_line_to_destination(float fr_mm_s, uint8_t x_splits = 0xFF, uint8_t y_splits = 0xFF) {
+  void mesh_line_to_destination(const float fr_mm_s) {
     int cx1 = mbl.cell_index_x(RAW_CURRENT_POSITION(X)),
         cy1 = mbl.cell_index_y(RAW_CURRENT_POSITION(Y)),
         cx2 = mbl.cell_index_x(RAW_X_POSITION(destination[X_AXIS])),
@@ -13552,55 +14335,7 @@ void set_current_from_steppers_for_axis(const AxisEnum axis) {
     NOMORE(cx2, GRID_MAX_POINTS_X - 2);
     NOMORE(cy2, GRID_MAX_POINTS_Y - 2);
 
-    if (cx1 == cx2 && cy1 == cy2) {
-      // Start and end on same mesh square
-      line_to_destination(fr_mm_s);
-		#if ENABLED(QUICK_PAUSE)
-    	if(invalidLoop)	return;
-		#endif
-      set_current_to_destination();
-      return;
-    }
-
-    #define MBL_SEGMENT_END(A) (current_position[A ##_AXIS] + (destination[A ##_AXIS] - current_position[A ##_AXIS]) * normalized_dist)
-
-    float normalized_dist, end[XYZE];
-
-    // Split at the left/front border of the right/top square
-    const int8_t gcx = max(cx1, cx2), gcy = max(cy1, cy2);
-    if (cx2 != cx1 && TEST(x_splits, gcx)) {
-      COPY(end, destination);
-      destination[X_AXIS] = LOGICAL_X_POSITION(mbl.index_to_xpos[gcx]);
-      normalized_dist = (destination[X_AXIS] - current_position[X_AXIS]) / (end[X_AXIS] - current_position[X_AXIS]);
-      destination[Y_AXIS] = MBL_SEGMENT_END(Y);
-      CBI(x_splits, gcx);
-    }
-    else if (cy2 != cy1 && TEST(y_splits, gcy)) {
-      COPY(end, destination);
-      destination[Y_AXIS] = LOGICAL_Y_POSITION(mbl.index_to_ypos[gcy]);
-      normalized_dist = (destination[Y_AXIS] - current_position[Y_AXIS]) / (end[Y_AXIS] - current_position[Y_AXIS]);
-      destination[X_AXIS] = MBL_SEGMENT_END(X);
-      CBI(y_splits, gcy);
-    }
-    else {
-      // Already split on a border
-      line_to_destination(fr_mm_s);
-		#if ENABLED(QUICK_PAUSE)
-    	if(invalidLoop)	return;
-		#endif
-      set_current_to_destination();
-      return;
-    }
-
-    destination[Z_AXIS] = MBL_SEGMENT_END(Z);
-    destination[E_AXIS] = MBL_SEGMENT_END(E);
-
-    // Do the split and look for more borders
-    mesh_line_to_destination(fr_mm_s, x_splits, y_splits);
-
-    // Restore destination from stack
-    COPY(destination, end);
-    mesh_line_to_destination(fr_mm_s, x_splits, y_splits);
+    grid_line_to_destination(fr_mm_s, cx1, cy1, cx2, cy2);
   }
 
 #elif ENABLED(AUTO_BED_LEVELING_BILINEAR) && !IS_KINEMATIC
@@ -13611,7 +14346,7 @@ void set_current_from_steppers_for_axis(const AxisEnum axis) {
    * Prepare a bilinear-leveled linear move on Cartesian,
    * splitting the move where it crosses grid borders.
    */
-  void bilinear_line_to_destination(float fr_mm_s, uint16_t x_splits = 0xFFFF, uint16_t y_splits = 0xFFFF) {
+  void bilinear_line_to_destination(const float fr_mm_s) {
     int cx1 = CELL_INDEX(X, current_position[X_AXIS]),
         cy1 = CELL_INDEX(Y, current_position[Y_AXIS]),
         cx2 = CELL_INDEX(X, destination[X_AXIS]),
@@ -13621,55 +14356,7 @@ void set_current_from_steppers_for_axis(const AxisEnum axis) {
     cx2 = constrain(cx2, 0, ABL_BG_POINTS_X - 2);
     cy2 = constrain(cy2, 0, ABL_BG_POINTS_Y - 2);
 
-    if (cx1 == cx2 && cy1 == cy2) {
-      // Start and end on same mesh square
-      line_to_destination(fr_mm_s);
-		#if ENABLED(QUICK_PAUSE)
-    	if(invalidLoop)	return;
-		#endif
-      set_current_to_destination();
-      return;
-    }
-
-    #define LINE_SEGMENT_END(A) (current_position[A ##_AXIS] + (destination[A ##_AXIS] - current_position[A ##_AXIS]) * normalized_dist)
-
-    float normalized_dist, end[XYZE];
-
-    // Split at the left/front border of the right/top square
-    const int8_t gcx = max(cx1, cx2), gcy = max(cy1, cy2);
-    if (cx2 != cx1 && TEST(x_splits, gcx)) {
-      COPY(end, destination);
-      destination[X_AXIS] = LOGICAL_X_POSITION(bilinear_start[X_AXIS] + ABL_BG_SPACING(X_AXIS) * gcx);
-      normalized_dist = (destination[X_AXIS] - current_position[X_AXIS]) / (end[X_AXIS] - current_position[X_AXIS]);
-      destination[Y_AXIS] = LINE_SEGMENT_END(Y);
-      CBI(x_splits, gcx);
-    }
-    else if (cy2 != cy1 && TEST(y_splits, gcy)) {
-      COPY(end, destination);
-      destination[Y_AXIS] = LOGICAL_Y_POSITION(bilinear_start[Y_AXIS] + ABL_BG_SPACING(Y_AXIS) * gcy);
-      normalized_dist = (destination[Y_AXIS] - current_position[Y_AXIS]) / (end[Y_AXIS] - current_position[Y_AXIS]);
-      destination[X_AXIS] = LINE_SEGMENT_END(X);
-      CBI(y_splits, gcy);
-    }
-    else {
-      // Already split on a border
-      line_to_destination(fr_mm_s);
-		#if ENABLED(QUICK_PAUSE)
-    	if(invalidLoop)	return;
-		#endif
-      set_current_to_destination();
-      return;
-    }
-
-    destination[Z_AXIS] = LINE_SEGMENT_END(Z);
-    destination[E_AXIS] = LINE_SEGMENT_END(E);
-
-    // Do the split and look for more borders
-    bilinear_line_to_destination(fr_mm_s, x_splits, y_splits);
-
-    // Restore destination from stack
-    COPY(destination, end);
-    bilinear_line_to_destination(fr_mm_s, x_splits, y_splits);
+    grid_line_to_destination(fr_mm_s, cx1, cy1, cx2, cy2);
   }
 
 #endif // AUTO_BED_LEVELING_BILINEAR
@@ -13971,6 +14658,132 @@ void prepare_move_to_destination() {
   set_current_to_destination();
 }
 
+#if ENABLED(SEGMENT_COALESCING)
+
+  /**
+   * Check whether the G0/G1 move to destination can extend the pending move.
+   * It must use the same feedrate, tool and extrusion ratio, keep heading the
+   * same way, and leave every merged corner close to the new, longer line.
+   */
+  static bool can_coalesce(const float seg[XYZ], const float &seg_len, const float &e_per_mm) {
+    if (coalesce_count >= SEGMENT_COALESCE_MAX_SEGMENTS
+      || feedrate_mm_s != coalesce_feedrate_mm_s
+      || active_extruder != coalesce_extruder
+      || FABS(e_per_mm - coalesce_e_per_mm) > (SEGMENT_COALESCE_E_TOLERANCE) * FABS(coalesce_e_per_mm)
+    ) return false;
+
+    // Heading change against the pending move
+    float chord[XYZ], chord_len_sq = 0, dot = 0;
+    LOOP_XYZ(i) {
+      chord[i] = current_position[i] - coalesce_start[i];
+      chord_len_sq += sq(chord[i]);
+      dot += chord[i] * seg[i];
+    }
+    if (dot < cos(RADIANS(SEGMENT_COALESCE_MAX_ANGLE)) * SQRT(chord_len_sq) * seg_len) return false;
+
+    // Distance of the merged corners from the new line, compared squared:
+    // |corner x line|^2 <= tolerance^2 * |line|^2
+    float line[XYZ], line_len_sq = 0;
+    LOOP_XYZ(i) {
+      line[i] = destination[i] - coalesce_start[i];
+      line_len_sq += sq(line[i]);
+    }
+    const float limit = sq(SEGMENT_COALESCE_TOLERANCE) * line_len_sq;
+    for (uint8_t c = 0; c < coalesce_count; c++) {
+      const float * const corner = c < coalesce_count - 1 ? coalesce_corners[c] : current_position;
+      const float px = corner[X_AXIS] - coalesce_start[X_AXIS],
+                  py = corner[Y_AXIS] - coalesce_start[Y_AXIS],
+                  pz = corner[Z_AXIS] - coalesce_start[Z_AXIS];
+      if (sq(py * line[Z_AXIS] - pz * line[Y_AXIS])
+        + sq(pz * line[X_AXIS] - px * line[Z_AXIS])
+        + sq(px * line[Y_AXIS] - py * line[X_AXIS]) > limit
+      ) return false;
+    }
+    return true;
+  }
+
+  /**
+   * Hold back a short G0/G1 move, merging it into the pending move if possible.
+   * The total E of the merged moves is kept, so the extrusion ratio is too.
+   *
+   * Returns true if the move was taken (current_position is updated).
+   * Returns false if the caller should prepare the move normally.
+   */
+  bool coalesce_move() {
+    float seg[XYZ], seg_len = 0;
+    LOOP_XYZ(i) {
+      seg[i] = destination[i] - current_position[i];
+      seg_len += sq(seg[i]);
+    }
+    seg_len = SQRT(seg_len);
+
+    // E-only and long moves go straight through
+    if (seg_len < 0.0001 || seg_len > SEGMENT_COALESCE_MAX_LENGTH) {
+      flush_coalesced_move();
+      #if ENABLED(QUICK_PAUSE)
+        if (invalidLoop) return true;
+      #endif
+      return false;
+    }
+
+    const float e_per_mm = (destination[E_AXIS] - current_position[E_AXIS]) / seg_len;
+
+    if (coalesce_pending && can_coalesce(seg, seg_len, e_per_mm)) {
+      COPY(coalesce_corners[coalesce_count - 1], current_position);
+      coalesce_count++;
+    }
+    else {
+      flush_coalesced_move();
+      #if ENABLED(QUICK_PAUSE)
+        if (invalidLoop) return true;
+        coalesce_gcode_pos = getGcodePos();
+      #endif
+      COPY(coalesce_start, current_position);
+      coalesce_feedrate_mm_s = feedrate_mm_s;
+      coalesce_extruder = active_extruder;
+      coalesce_e_per_mm = e_per_mm;
+      coalesce_count = 1;
+      coalesce_pending = true;
+    }
+
+    coalesce_moves_in++;
+    set_current_to_destination();
+    return true;
+  }
+
+  /**
+   * Send the pending move to the planner, through the usual leveling / kinematic path.
+   * Called before anything else touches the planner, and when the command queue runs dry.
+   */
+  void flush_coalesced_move() {
+    if (!coalesce_pending) return;
+    coalesce_pending = false;
+    coalesce_moves_out++;
+
+    float saved_destination[XYZE];
+    COPY(saved_destination, destination);
+    const float saved_feedrate = feedrate_mm_s;
+
+    set_destination_to_current();
+    COPY(current_position, coalesce_start);
+    feedrate_mm_s = coalesce_feedrate_mm_s;
+    #if ENABLED(QUICK_PAUSE)
+      coalesce_flushing = true;
+    #endif
+    prepare_move_to_destination();
+    #if ENABLED(QUICK_PAUSE)
+      coalesce_flushing = false;
+    #endif
+
+    feedrate_mm_s = saved_feedrate;
+    COPY(destination, saved_destination);
+  }
+
+  // Drop the pending move. The planner and current_position are being reset.
+  void discard_coalesced_move() { coalesce_pending = false; }
+
+#endif // SEGMENT_COALESCING
+
 #if ENABLED(ARC_SUPPORT)
 
   #if N_ARC_CORRECTION < 1
@@ -13982,10 +14795,11 @@ void prepare_move_to_destination() {
    * Plan an arc in 2 dimensions
    *
    * The arc is approximated by generating many small linear segments.
-   * The length of each segment is configured in MM_PER_ARC_SEGMENT (Default 1mm)
-   * Arcs should only be made relatively large (over 5mm), as larger arcs with
-   * larger segments will tend to be more efficient. Your slicer should have
-   * options for G2/G3 arc generation. In future these options may be GCode tunable.
+   * The segment length is the longest chord that stays within ARC_MAX_CHORD_ERROR
+   * of the arc, so small radii get short segments and large radii long ones.
+   * Segments are never shorter than the feedrate allows for ARC_SEGMENTS_PER_SEC
+   * (so the planner keeps up) and are kept within MIN_ARC_SEGMENT_MM and
+   * MM_PER_ARC_SEGMENT.
    */
   void plan_arc(
     float logical[XYZE], // Destination position
@@ -14026,7 +14840,17 @@ void prepare_move_to_destination() {
     const float mm_of_travel = HYPOT(angular_travel * radius, FABS(linear_travel));
     if (mm_of_travel < 0.001) return;
 
-    uint16_t segments = FLOOR(mm_of_travel / (MM_PER_ARC_SEGMENT));
+    const float fr_mm_s = MMS_SCALED(feedrate_mm_s);
+
+    // Longest chord with a sagitta of ARC_MAX_CHORD_ERROR: c = 2 * sqrt(e * (2r - e))
+    float seg_length = radius > ARC_MAX_CHORD_ERROR
+      ? 2 * SQRT((ARC_MAX_CHORD_ERROR) * (2 * radius - (ARC_MAX_CHORD_ERROR)))
+      : MM_PER_ARC_SEGMENT;
+    // Don't outrun the planner at high feedrates
+    NOLESS(seg_length, fr_mm_s * (1.0 / (ARC_SEGMENTS_PER_SEC)));
+    seg_length = constrain(seg_length, MIN_ARC_SEGMENT_MM, MM_PER_ARC_SEGMENT);
+
+    uint16_t segments = CEIL(mm_of_travel / seg_length);
     if (segments == 0) segments = 1;
 
     /**
@@ -14043,9 +14867,9 @@ void prepare_move_to_destination() {
      * round off issues for CNC applications.) Single precision error can accumulate to be greater than
      * tool precision in some cases. Therefore, arc path correction is implemented.
      *
-     * Small angle approximation may be used to reduce computation overhead further. This approximation
-     * holds for everything, but very small circles and large MM_PER_ARC_SEGMENT values. In other words,
-     * theta_per_segment would need to be greater than 0.1 rad and N_ARC_CORRECTION would need to be large
+     * Small angle approximation may be used to reduce computation overhead further. Taylor terms up to
+     * fifth order (sin) and sixth order (cos) keep it accurate for the larger angles of small circles.
+     * theta_per_segment would need to be greater than 1 rad and N_ARC_CORRECTION would need to be large
      * to cause an appreciable drift error. N_ARC_CORRECTION~=25 is more than small enough to correct for
      * numerical drift error. N_ARC_CORRECTION may be on the order a hundred(s) before error becomes an
      * issue for CNC machines with the single precision Arduino calculations.
@@ -14060,8 +14884,9 @@ void prepare_move_to_destination() {
     const float theta_per_segment = angular_travel / segments,
                 linear_per_segment = linear_travel / segments,
                 extruder_per_segment = extruder_travel / segments,
-                sin_T = theta_per_segment,
-                cos_T = 1 - 0.5 * sq(theta_per_segment); // Small angle approximation
+                sq_theta_per_segment = sq(theta_per_segment),
+                sin_T = theta_per_segment * (1 - sq_theta_per_segment * (1.0 / 6 - sq_theta_per_segment * (1.0 / 120))),
+                cos_T = 1 - sq_theta_per_segment * (0.5 - sq_theta_per_segment * (1.0 / 24 - sq_theta_per_segment * (1.0 / 720))); // Small angle approximation
 
     // Initialize the linear axis
     arc_target[l_axis] = current_position[l_axis];
@@ -14069,8 +14894,6 @@ void prepare_move_to_destination() {
     // Initialize the extruder axis
     arc_target[E_AXIS] = current_position[E_AXIS];
 
-    const float fr_mm_s = MMS_SCALED(feedrate_mm_s);
-
     millis_t next_idle_ms = millis() + 200UL;
 
     #if N_ARC_CORRECTION > 1
@@ -14588,6 +15411,9 @@ void updateStateStrings(){
 
 #ifdef QUICK_PAUSE
 uint32_t getGcodePos(){
+	#if ENABLED(SEGMENT_COALESCING)
+		if (coalesce_flushing) return coalesce_gcode_pos;	// A merged move resumes from its first command
+	#endif
 	return fileGcodePos[cmd_queue_index_r];
 }
 
@@ -15356,6 +16182,10 @@ void idle(bool no_stepper_sleep/*=false*/) {
 
   thermalManager.manage_heater();
 
+  #if ENABLED(TOOLCHANGE_PREHEAT)
+    toolchange_preheat.update(relative_mode);
+  #endif
+
   #if ENABLED(PRINTCOUNTER)
     print_job_timer.tick();
   #endif
@@ -15561,6 +16391,10 @@ void setup() {
   // Vital to init stepper/planner equivalent for current_position
   SYNC_PLAN_POSITION_KINEMATIC();
 
+  #if ENABLED(ISR_TIMING_STATS)
+    isr_timing.init();        // Start the profiling timer before the ISRs
+  #endif
+
   thermalManager.init();    // Initialize temperature loop
 
   #if ENABLED(USE_WATCHDOG)
@@ -15862,6 +16696,17 @@ void loop() {
       if (++cmd_queue_index_r >= BUFSIZE) cmd_queue_index_r = 0;
     }
   }
+  #if ENABLED(SEGMENT_COALESCING)
+    // Nothing more to merge right now. Don't hold the pending move back.
+    if (!commands_in_queue) flush_coalesced_move();
+  #endif
+
+  #if ENABLED(ABL_THERMAL_MESHES)
+    // Between commands, follow the bed temperature. Not while printing, as
+    // reading the grids and refreshing the leveling would stall the planner.
+    if (!g29_in_progress && !print_job_timer.isRunning()) thermal_mesh_update();
+  #endif
+
   endstops.report_state();
   idle();
 
@@ -421,6 +421,43 @@ static_assert(X_MAX_LENGTH >= X_BED_SIZE && Y_MAX_LENGTH >= Y_BED_SIZE,
     #error "MIXING_EXTRUDER is incompatible with SINGLENOZZLE."
   #elif ENABLED(LIN_ADVANCE)
     #error "MIXING_EXTRUDER is incompatible with LIN_ADVANCE."
+  #elif ENABLED(ADAPTIVE_STEP_SMOOTHING)
+    #error "MIXING_EXTRUDER is incompatible with ADAPTIVE_STEP_SMOOTHING."
+  #endif
+#endif
+
+/**
+ * Adaptive Step Smoothing requirements
+ */
+#if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+  #if !WITHIN(ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL, 1, 4)
+    #error "ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL must be between 1 and 4."
+  #elif ADAPTIVE_STEP_SMOOTHING_MAX_RATE > MAX_STEP_FREQUENCY
+    #error "ADAPTIVE_STEP_SMOOTHING_MAX_RATE must not exceed MAX_STEP_FREQUENCY."
+  #endif
+#endif
+
+/**
+ * ISR timing statistics requirements
+ */
+#if ENABLED(ISR_TIMING_STATS)
+  #if !defined(__AVR_ATmega1280__) && !defined(__AVR_ATmega2560__)
+    #error "ISR_TIMING_STATS requires an ATmega1280 or ATmega2560."
+  #elif ISR_TIMING_TIMER != 3 && ISR_TIMING_TIMER != 4 && ISR_TIMING_TIMER != 5
+    #error "ISR_TIMING_TIMER must be 3, 4 or 5."
+  #elif ISR_TIMING_TIMER == 5 && (HAS_SERVOS || HAS_MOTOR_CURRENT_PWM)
+    #error "ISR_TIMING_STATS can't use Timer 5 with servos or motor current PWM. Set another ISR_TIMING_TIMER."
+  #endif
+#endif
+
+/**
+ * Segment coalescing requirements
+ */
+#if ENABLED(SEGMENT_COALESCING)
+  #if IS_SCARA
+    #error "SEGMENT_COALESCING is not supported for SCARA."
+  #elif !WITHIN(SEGMENT_COALESCE_MAX_SEGMENTS, 2, 32)
+    #error "SEGMENT_COALESCE_MAX_SEGMENTS must be between 2 and 32."
   #endif
 #endif
 
@@ -490,6 +527,108 @@ static_assert(X_MAX_LENGTH >= X_BED_SIZE && Y_MAX_LENGTH >= Y_BED_SIZE,
   #error "To use BED_LIMIT_SWITCHING you must disable PIDTEMPBED."
 #endif
 
+/**
+ * Fixed-point PID requires at least one PID loop
+ */
+#if ENABLED(PID_FIXED_POINT) && DISABLED(PIDTEMP) && DISABLED(PIDTEMPBED) && DISABLED(PIDTEMP_CHAMBER)
+  #error "PID_FIXED_POINT requires PIDTEMP, PIDTEMPBED or PIDTEMP_CHAMBER."
+#endif
+
+/**
+ * Model predictive control replaces PID for the hotends
+ */
+#if ENABLED(MPCTEMP) && ENABLED(PIDTEMP)
+  #error "MPCTEMP replaces PIDTEMP. Enable only one of them."
+#endif
+
+/**
+ * The power budget needs a bed output that is updated on every heater update
+ */
+#if ENABLED(HEATER_POWER_BUDGET)
+  #if DISABLED(PIDTEMPBED) && BED_HEATER_WATTS > 0
+    #error "HEATER_POWER_BUDGET with BED_HEATER_WATTS requires PIDTEMPBED."
+  #elif PSU_POWER_BUDGET < HOTEND_HEATER_WATTS
+    #error "PSU_POWER_BUDGET must allow at least one hotend at full power."
+  #endif
+#endif
+
+/**
+ * Tool change preheat reads ahead in the print file
+ */
+#if ENABLED(TOOLCHANGE_PREHEAT)
+  #if HOTENDS < 2
+    #error "TOOLCHANGE_PREHEAT requires more than one hotend."
+  #elif DISABLED(SDSUPPORT) && DISABLED(UDISKSUPPORT)
+    #error "TOOLCHANGE_PREHEAT requires SDSUPPORT or UDISKSUPPORT."
+  #endif
+#endif
+
+/**
+ * ADC IIR filter ranges
+ */
+#if ENABLED(ADC_IIR_FILTER)
+  #if !WITHIN(ADC_IIR_SHIFT, 1, 6)
+    #error "ADC_IIR_SHIFT must be between 1 and 6."
+  #elif !WITHIN(ADC_READY_LOOPS, 2, 127)
+    #error "ADC_READY_LOOPS must be between 2 and 127."
+  #elif !WITHIN(ADC_PRIORITY_HOTEND, 1, 8) || !WITHIN(ADC_PRIORITY_BED, 1, 8) || !WITHIN(ADC_PRIORITY_CHAMBER, 1, 8) \
+     || !WITHIN(ADC_PRIORITY_FILWIDTH, 1, 8) || !WITHIN(ADC_PRIORITY_KEYPAD, 1, 8)
+    #error "ADC_PRIORITY_* must be between 1 and 8."
+  #elif ENABLED(PINS_DEBUGGING)
+    #error "ADC_IIR_FILTER can't be used with PINS_DEBUGGING, whose analogRead() would take over the ADC."
+  #endif
+#endif
+
+/**
+ * Bit-angle modulation replaces the standard soft PWM only
+ */
+#if ENABLED(SOFT_PWM_BAM)
+  #if ENABLED(SLOW_PWM_HEATERS)
+    #error "SOFT_PWM_BAM can't be used with SLOW_PWM_HEATERS."
+  #elif ENABLED(SOFT_PWM_DITHER)
+    #error "SOFT_PWM_BAM can't be used with SOFT_PWM_DITHER."
+  #endif
+#endif
+
+/**
+ * Fast PID autotune
+ */
+#if ENABLED(PID_AUTOTUNE_FAST)
+  #if !HAS_PID_HEATING && DISABLED(PIDTEMP_CHAMBER)
+    #error "PID_AUTOTUNE_FAST requires PIDTEMP, PIDTEMPBED or PIDTEMP_CHAMBER."
+  #elif !(PID_AUTOTUNE_TOLERANCE > 0 && PID_AUTOTUNE_TOLERANCE < 1)
+    #error "PID_AUTOTUNE_TOLERANCE must be between 0 and 1."
+  #endif
+#endif
+
+/**
+ * Model based heater fault detection
+ */
+#if ENABLED(THERMAL_PROTECTION_MODEL)
+  #if DISABLED(PIDTEMP) && DISABLED(MPCTEMP)
+    #error "THERMAL_PROTECTION_MODEL requires PIDTEMP or MPCTEMP."
+  #elif !WITHIN(THERMAL_MODEL_PERIOD, 1, 40)
+    #error "THERMAL_MODEL_PERIOD must be between 1 and 40 seconds."
+  #elif !(THERMAL_MODEL_CORRECTION > 0 && THERMAL_MODEL_MARGIN > 0)
+    #error "THERMAL_MODEL_CORRECTION and THERMAL_MODEL_MARGIN must be above 0."
+  #endif
+#endif
+
+/**
+ * Extrusion-rate feed-forward
+ */
+#if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+  #if DISABLED(PIDTEMP) || ENABLED(MPCTEMP)
+    #error "PID_EXTRUSION_FEEDFORWARD requires PIDTEMP without MPCTEMP."
+  #elif ENABLED(PID_EXTRUSION_SCALING)
+    #error "PID_EXTRUSION_FEEDFORWARD and PID_EXTRUSION_SCALING are incompatible. Enable only one."
+  #elif ENABLED(PID_FEEDFORWARD_LEARN) && !WITHIN(PID_FEEDFORWARD_WINDOW, 2, 60)
+    #error "PID_FEEDFORWARD_WINDOW must be between 2 and 60 seconds."
+  #elif ENABLED(PID_FEEDFORWARD_LEARN) && PID_FEEDFORWARD_WINDOWS < 4
+    #error "PID_FEEDFORWARD_WINDOWS must be 4 or more."
+  #endif
+#endif
+
 /**
  * Kinematics
  */
@@ -679,6 +818,78 @@ static_assert(1 >= 0
   #error "Z_MIN_PROBE_REPEATABILITY_TEST requires a probe: FIX_MOUNTED_PROBE, BLTOUCH, SOLENOID_PROBE, Z_PROBE_ALLEN_KEY, Z_PROBE_SLED, or Z Servo."
 #endif
 
+/**
+ * G29 fast probing requirements
+ */
+#if ENABLED(G29_FAST_PROBE)
+  #if !HAS_BED_PROBE
+    #error "G29_FAST_PROBE requires a probe: FIX_MOUNTED_PROBE, BLTOUCH, SOLENOID_PROBE, Z_PROBE_ALLEN_KEY, Z_PROBE_SLED, or Z Servo."
+  #elif DISABLED(AUTO_BED_LEVELING_BILINEAR) && DISABLED(AUTO_BED_LEVELING_LINEAR)
+    #error "G29_FAST_PROBE requires AUTO_BED_LEVELING_BILINEAR or AUTO_BED_LEVELING_LINEAR."
+  #elif IS_KINEMATIC
+    #error "G29_FAST_PROBE is not compatible with DELTA or SCARA."
+  #endif
+  static_assert(G29_FAST_PROBE_MARGIN > 0 && G29_FAST_PROBE_CLEARANCE > G29_FAST_PROBE_MARGIN,
+    "G29_FAST_PROBE requires 0 < G29_FAST_PROBE_MARGIN < G29_FAST_PROBE_CLEARANCE.");
+#endif
+
+/**
+ * G29 U requirements
+ */
+#if ENABLED(ABL_INCREMENTAL_PROBE)
+  #if DISABLED(AUTO_BED_LEVELING_BILINEAR)
+    #error "ABL_INCREMENTAL_PROBE requires AUTO_BED_LEVELING_BILINEAR."
+  #elif !HAS_BED_PROBE
+    #error "ABL_INCREMENTAL_PROBE requires a probe: FIX_MOUNTED_PROBE, BLTOUCH, SOLENOID_PROBE, Z_PROBE_ALLEN_KEY, Z_PROBE_SLED, or Z Servo."
+  #elif !WITHIN(INCREMENTAL_PROBE_STRIDE, 2, 9)
+    #error "INCREMENTAL_PROBE_STRIDE must be from 2 to 9."
+  #endif
+  static_assert(INCREMENTAL_PROBE_THRESHOLD > 0, "INCREMENTAL_PROBE_THRESHOLD must be greater than 0.");
+#endif
+
+/**
+ * Print area leveling reads the print file
+ */
+#if ENABLED(ABL_PRINT_AREA)
+  #if DISABLED(AUTO_BED_LEVELING_BILINEAR)
+    #error "ABL_PRINT_AREA requires AUTO_BED_LEVELING_BILINEAR."
+  #elif DISABLED(SDSUPPORT) && DISABLED(UDISKSUPPORT)
+    #error "ABL_PRINT_AREA requires SDSUPPORT or UDISKSUPPORT."
+  #elif ENABLED(PROBE_MANUALLY)
+    #error "ABL_PRINT_AREA is not compatible with PROBE_MANUALLY."
+  #endif
+  static_assert(PRINT_AREA_MARGIN >= 0, "PRINT_AREA_MARGIN must be 0 or more.");
+  static_assert(PRINT_AREA_HEADER_SCAN <= PRINT_AREA_SCAN_LIMIT, "PRINT_AREA_HEADER_SCAN must not be more than PRINT_AREA_SCAN_LIMIT.");
+#endif
+
+/**
+ * Grids for several bed temperatures are kept in EEPROM
+ */
+#if ENABLED(ABL_THERMAL_MESHES)
+  #if DISABLED(AUTO_BED_LEVELING_BILINEAR)
+    #error "ABL_THERMAL_MESHES requires AUTO_BED_LEVELING_BILINEAR."
+  #elif DISABLED(EEPROM_SETTINGS)
+    #error "ABL_THERMAL_MESHES requires EEPROM_SETTINGS."
+  #elif !HAS_TEMP_BED
+    #error "ABL_THERMAL_MESHES requires a bed temperature sensor."
+  #elif !WITHIN(THERMAL_MESHES, 2, 8)
+    #error "THERMAL_MESHES must be from 2 to 8."
+  #endif
+  static_assert(THERMAL_MESH_MATCH >= 0, "THERMAL_MESH_MATCH must be 0 or more.");
+  static_assert(THERMAL_MESH_HYSTERESIS > 0, "THERMAL_MESH_HYSTERESIS must be greater than 0.");
+#endif
+
+/**
+ * Compressed grids in EEPROM
+ */
+#if ENABLED(EEPROM_MESH_COMPRESSION)
+  #if DISABLED(EEPROM_SETTINGS)
+    #error "EEPROM_MESH_COMPRESSION requires EEPROM_SETTINGS."
+  #elif DISABLED(MESH_BED_LEVELING) && DISABLED(AUTO_BED_LEVELING_BILINEAR)
+    #error "EEPROM_MESH_COMPRESSION requires MESH_BED_LEVELING or AUTO_BED_LEVELING_BILINEAR."
+  #endif
+#endif
+
 /**
  * Allow only one bed leveling option to be defined
  */
@@ -106,6 +106,9 @@ static dir_t temp;
 UDiskReader::UDiskReader(){
 	fileSize = 0;
 	filePos = 0;
+	#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+		aheadMoved = false;
+	#endif
 	UDiskPrintState = false;
 	UDiskPauseState = false;
 	UDiskConn = false;
@@ -680,6 +683,9 @@ void UDiskReader::openFile(char * name, bool read, bool replace_current){
 			SERIAL_ECHOPGM(MSG_SD_SIZE);
 			SERIAL_ECHOLN(fileSize);
 			filePos = 0;
+			#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+				aheadMoved = false;
+			#endif
 
 			SERIAL_ECHOLNPGM(MSG_SD_FILE_SELECTED);
 
@@ -703,6 +709,12 @@ void UDiskReader::closefile() {
 int16_t UDiskReader::get(){
   uint8_t get_char;
 
+  #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+    if (aheadMoved) {
+      UDiskImpl.setOffset(filePos);
+      aheadMoved = false;
+    }
+  #endif
   get_char = UDiskImpl.readByte();
   if(UDiskImpl.getState() == USB_INT_SUCCESS){
     filePos = UDiskImpl.getOffset();
@@ -716,6 +728,29 @@ int16_t UDiskReader::get(){
 void UDiskReader::setIndex(long index){
 	filePos = index;
 	UDiskImpl.setOffset(index);
+	#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+		aheadMoved = false;
+	#endif
 }
 
+#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+/**
+ * Read 'len' bytes at 'index' without moving the read position of the print.
+ * Return the number of bytes read, less at the end of the file, or -1.
+ */
+int16_t UDiskReader::readAhead(const uint32_t index, char *buf, const uint16_t len){
+	if (index >= fileSize) return 0;
+	// The file pointer is left where the read ends, so reading on needs no
+	// locate. get() puts it back at filePos for the print.
+	const bool locate = index != (aheadMoved ? aheadPos : filePos);
+	aheadMoved = true;
+	if (locate && !UDiskImpl.setOffset(index)) return -1;
+	// One CH376 read for the whole piece
+	int16_t n = UDiskImpl.readBytes((uint8_t*)buf, min(uint32_t(len), fileSize - index));
+	aheadPos = index + n;
+	if (UDiskImpl.getState() != USB_INT_SUCCESS) n = -1;
+	return n;
+}
+#endif
+
 #endif	//UDISKSUPPORT
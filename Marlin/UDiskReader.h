@@ -56,6 +56,9 @@ public:
 	void closefile();
 	int16_t get();
 	void setIndex(long index);
+	#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+		int16_t readAhead(const uint32_t index, char *buf, const uint16_t len);
+	#endif
 	
 	bool UDiskPrintState, UDiskPauseState, UDiskConn, UDiskOK, isDir, isFileOpen, saving, logging;
 	char filename[FILENAME_LENGTH], longFilename[LONG_FILENAME_LENGTH];
@@ -63,6 +66,7 @@ public:
 	bool eof() { return filePos >= fileSize; }
 	float percentDoneF() { return (isFileOpen && fileSize) ? (float)filePos / fileSize * 100 : 0; }
 	uint32_t getSdPos() { return filePos; }
+	uint32_t getFileSize() { return fileSize; }
 	
 private:
 	void getUSBInfo();
@@ -77,6 +81,10 @@ private:
 	USBFile root, *curfile, workDir, workDirParents[MAX_DIR_DEPTH], file;
 	uint32_t fileSize;
 	uint32_t filePos;
+	#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+		uint32_t aheadPos;		// Where readAhead() left the file pointer
+		bool aheadMoved;			// The file pointer is not at filePos
+	#endif
 	uint16_t workDirDepth;
 };
 
@@ -635,6 +635,20 @@ uint8_t CH376_UDisk::readByte(){
   //}
 }
 
+// 读多个字节,返回读到的长度(文件结束时较少). 成功后状态为USB_INT_SUCCESS
+uint16_t CH376_UDisk::readBytes(uint8_t *buf, uint16_t len){
+  uint16_t n = 0;
+  sendCmd(CMD2H_BYTE_READ, 2, (uint8_t)len & 0xFF, (uint8_t)(len >> 8) & 0xFF);
+  endCmd();
+  // The CH376 hands over the data in blocks of its buffer size, never more than was asked
+  while (waitForInterrupt() == USB_INT_DISK_READ) {
+    n += readBlock(buf + n);
+    sendCmd(CMD0H_BYTE_RD_GO);
+    endCmd();
+  }
+  return n;
+}
+
 #endif //USB_READ
 
 #ifdef USB_WRITE
@@ -165,6 +165,7 @@ public:
 	uint32_t get_file_size();																								//获取当前文件大小
 
 	uint8_t readByte();																											//读下一个字节
+	uint16_t readBytes(uint8_t *buf, uint16_t len);													//读多个字节,返回读到的长度
 #endif
 
 #ifdef USB_WRITE
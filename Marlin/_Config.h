@@ -93,8 +93,20 @@
   #define TEMP_SENSOR_AD595_GAIN      1.0
 #endif
 
+// Model predictive control for the hotends instead of PID (settings in Configuration_adv.h)
+//#define MPCTEMP
+#if ENABLED(MPCTEMP)
+  #ifdef USE_HEATING_TUBE_80W
+    #define MPC_HEATER_POWER 80.0
+  #else
+    #define MPC_HEATER_POWER 40.0
+  #endif
+#endif
+
 // PID Settting
-#define PIDTEMP
+#if DISABLED(MPCTEMP)
+  #define PIDTEMP
+#endif
 #if ENABLED(PIDTEMP)
   //#define PID_DEBUG
   //#define PID_OPENLOOP 1
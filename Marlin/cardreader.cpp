@@ -318,6 +318,9 @@ void CardReader::stopSDPrint() {
   sdprinting = false;
   isPauseState = false;			// By LYN
   if (isFileOpen()) file.close();
+  #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+    ahead.close();
+  #endif
 }
 
 void CardReader::openLogFile(char* name) {
@@ -424,6 +427,9 @@ void CardReader::openFile(char* name, bool read, bool push_current/*=false*/) {
   if (read) {
     if (file.open(curDir, fname, O_READ)) {
       filesize = file.fileSize();
+      #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+        ahead.open(curDir, fname, O_READ);
+      #endif
       SERIAL_PROTOCOLPAIR(MSG_SD_FILE_OPENED, fname);
       SERIAL_PROTOCOLLNPAIR(MSG_SD_SIZE, filesize);
       sdpos = 0;
@@ -874,9 +880,25 @@ void CardReader::updir() {
 
 #endif // SDCARD_SORT_ALPHA
 
+#if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+  /**
+   * Read 'len' bytes at 'index' without moving the read position of the print.
+   * Return the number of bytes read, less at the end of the file, or -1.
+   */
+  int16_t CardReader::readAhead(const uint32_t index, char *buf, const uint16_t len) {
+    // On a handle of its own, reading on from where it was needs no seek. Seeking
+    // the print's handle back would follow its cluster chain from the start.
+    if (index != ahead.curPosition() && !ahead.seekSet(index)) return -1;
+    return ahead.read(buf, len);
+  }
+#endif
+
 void CardReader::printingHasFinished() {
   stepper.synchronize();
   file.close();
+  #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+    ahead.close();
+  #endif
   if(isPauseState) isPauseState = false;		// By LYN
   if (file_subcall_ctr > 0) { // Heading up to a parent file that called current as a procedure.
     file_subcall_ctr--;
@@ -90,6 +90,11 @@ public:
 
   FORCE_INLINE float percentDoneF() { return (isFileOpen() && filesize) ? (float)sdpos / filesize * 100 : 0; }	// By LYN
   FORCE_INLINE uint32_t getSdPos() { return sdpos; }															// By LYN
+  FORCE_INLINE uint32_t getFileSize() { return filesize; }
+
+  #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+    int16_t readAhead(const uint32_t index, char *buf, const uint16_t len);
+  #endif
 
 public:
   bool saving, logging, sdprinting, cardOK, filenameIsDir;
@@ -148,6 +153,9 @@ private:
   Sd2Card card;
   SdVolume volume;
   SdFile file;
+  #if ENABLED(TOOLCHANGE_PREHEAT) || ENABLED(ABL_PRINT_AREA)
+    SdFile ahead; // The print file again, for readAhead()
+  #endif
 
   #define SD_PROCEDURE_DEPTH 1
   #define MAXPATHNAMELENGTH (FILENAME_LENGTH*MAX_DIR_DEPTH + MAX_DIR_DEPTH + 1)
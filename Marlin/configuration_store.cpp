@@ -88,7 +88,7 @@ void MarlinSettings::postprocess() {
   // and init stepper.count[], planner.position[] with current_position
   planner.refresh_positioning();
 
-  #if ENABLED(PIDTEMP)
+  #if ENABLED(PIDTEMP) || ENABLED(PID_FIXED_POINT)
     thermalManager.updatePID();
   #endif
 
@@ -112,6 +112,11 @@ void MarlinSettings::postprocess() {
     //set_bed_leveling_enabled(leveling_is_on);
   #endif
 
+  #if ENABLED(ABL_THERMAL_MESHES)
+    // The stored grid is the last one probed. Use the one for the bed temperature.
+    thermal_mesh_update(true);
+  #endif
+
   #if HAS_MOTOR_CURRENT_PWM
     stepper.refresh_motor_power();
   #endif
@@ -197,6 +202,21 @@ void MarlinSettings::postprocess() {
 			EEPROM_CHECK(extruder_advance_k, 0, 999, "extruder_advance_k out of range");
 		#endif
 
+		#if ENABLED(MPCTEMP)
+			HOTEND_LOOP() {
+				EEPROM_CHECK(thermalManager.mpc[e].heater_power, 1, 500, "mpc heater_power out of range");
+				EEPROM_CHECK(thermalManager.mpc[e].block_heat_capacity, 0.1, 1000, "mpc block_heat_capacity out of range");
+				EEPROM_CHECK(thermalManager.mpc[e].sensor_responsiveness, 0.001, 10, "mpc sensor_responsiveness out of range");
+				EEPROM_CHECK(thermalManager.mpc[e].ambient_xfer_coeff_fan0, 0.001, 10, "mpc ambient_xfer_coeff out of range");
+				EEPROM_CHECK(thermalManager.mpc[e].fan255_adjustment, -10, 10, "mpc fan255_adjustment out of range");
+				EEPROM_CHECK(thermalManager.mpc[e].filament_heat_capacity_permm, 0, 1, "mpc filament_heat_capacity out of range");
+			}
+		#endif
+
+		#if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+			HOTEND_LOOP() EEPROM_CHECK(thermalManager.Kf[e], 0, 255, "Kf out of range");
+		#endif
+
 		#if HAS_AUTO_FAN
 			EEPROM_CHECK(extruder_auto_fan_speed, 0, 255, "extruder_auto_fan_speed out of range");
 		#endif
@@ -216,11 +236,143 @@ void MarlinSettings::postprocess() {
   	return eeprom_read_pass;
   }
 
+  #if ENABLED(MESH_BED_LEVELING) || ENABLED(AUTO_BED_LEVELING_BILINEAR)
+
+    #if ENABLED(EEPROM_MESH_COMPRESSION)
+
+      /**
+       * A grid is stored as a base Z and a step size, each Z being a whole
+       * number of steps (+/-32766) from the base, and a CRC of all of them.
+       * The step is 1/65532 of the range of the grid, so a grid spanning
+       * 2mm is kept to 0.02 microns. Points without a height are stored as
+       * MESH_STORE_NAN.
+       */
+      #define MESH_STORE_NAN      -32768
+      #define MESH_STORE_STEPS    32766
+      #define GRID_ADDR_base(P)   (P)
+      #define GRID_ADDR_step(P)   ((P) + sizeof(float))
+      #define GRID_ADDR_crc(P)    ((P) + sizeof(float) * 2)
+      #define GRID_ADDR_z(P, I)   ((P) + sizeof(float) * 2 + sizeof(uint16_t) + (I) * sizeof(int16_t))
+
+      void MarlinSettings::store_grid(const int pos, const float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]) {
+        float lo = 0, hi = 0;
+        bool first = true;
+        for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+          for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
+            if (!isnan(z[x][y])) {
+              if (first || z[x][y] < lo) lo = z[x][y];
+              if (first || z[x][y] > hi) hi = z[x][y];
+              first = false;
+            }
+
+        // Not RECIPROCAL(): a grid spanning under 0.07mm has a step NEAR_ZERO
+        const float base = (lo + hi) * 0.5, step = (hi - lo) * (0.5 / (MESH_STORE_STEPS)),
+                    per_step = step > 0 ? 1.0 / step : 0;
+        uint16_t crc = 0;
+        crc16(&crc, &base, sizeof(base));
+        crc16(&crc, &step, sizeof(step));
+        uint16_t i = 0;
+        for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+          for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++, i++) {
+            const int16_t steps = isnan(z[x][y]) ? MESH_STORE_NAN : constrain(LROUND((z[x][y] - base) * per_step), -(MESH_STORE_STEPS), MESH_STORE_STEPS);
+            crc16(&crc, &steps, sizeof(steps));
+            EEPROM_UPDATE_VAR(GRID_ADDR_z(pos, i), steps);
+          }
+        EEPROM_UPDATE_VAR(GRID_ADDR_base(pos), base);
+        EEPROM_UPDATE_VAR(GRID_ADDR_step(pos), step);
+        EEPROM_UPDATE_VAR(GRID_ADDR_crc(pos), crc);
+      }
+
+      // Read a grid into z. False, with z undefined, if it fails the CRC.
+      bool MarlinSettings::load_grid(const int pos, float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]) {
+        float base, step;
+        uint16_t stored_crc, crc = 0;
+        EEPROM_READ_VAR(GRID_ADDR_base(pos), base);
+        EEPROM_READ_VAR(GRID_ADDR_step(pos), step);
+        EEPROM_READ_VAR(GRID_ADDR_crc(pos), stored_crc);
+        crc16(&crc, &base, sizeof(base));
+        crc16(&crc, &step, sizeof(step));
+        uint16_t i = 0;
+        for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+          for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++, i++) {
+            int16_t steps;
+            EEPROM_READ_VAR(GRID_ADDR_z(pos, i), steps);
+            crc16(&crc, &steps, sizeof(steps));
+            z[x][y] = steps == MESH_STORE_NAN ? NAN : base + steps * step;
+          }
+        if (crc == stored_crc) return true;
+        #if ENABLED(EEPROM_CHITCHAT)
+          SERIAL_ERROR_START();
+          SERIAL_ERRORLNPGM("Stored grid CRC mismatch");
+        #endif
+        return false;
+      }
+
+      bool MarlinSettings::grid_is_valid(const int pos) {
+        uint16_t stored_crc, crc = 0;
+        EEPROM_READ_VAR(GRID_ADDR_crc(pos), stored_crc);
+        for (uint16_t a = GRID_ADDR_base(pos); a < GRID_ADDR_crc(pos); a++) {
+          const uint8_t b = eeprom_read_byte((uint8_t *)a);
+          crc16(&crc, &b, 1);
+        }
+        for (uint16_t a = GRID_ADDR_z(pos, 0); a < GRID_ADDR_z(pos, GRID_MAX_POINTS); a++) {
+          const uint8_t b = eeprom_read_byte((uint8_t *)a);
+          crc16(&crc, &b, 1);
+        }
+        return crc == stored_crc;
+      }
+
+      float MarlinSettings::grid_z(const int pos, const uint8_t x, const uint8_t y) {
+        float base, step;
+        int16_t steps;
+        EEPROM_READ_VAR(GRID_ADDR_base(pos), base);
+        EEPROM_READ_VAR(GRID_ADDR_step(pos), step);
+        EEPROM_READ_VAR(GRID_ADDR_z(pos, x * (GRID_MAX_POINTS_Y) + y), steps);
+        return steps == MESH_STORE_NAN ? NAN : base + steps * step;
+      }
+
+    #else // !EEPROM_MESH_COMPRESSION
+
+      void MarlinSettings::store_grid(const int pos, const float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]) {
+        EEPROM_UPDATE_VAR(pos, z);
+      }
+
+      bool MarlinSettings::load_grid(const int pos, float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]) {
+        EEPROM_READ_VAR(pos, z);
+        return true;
+      }
+
+      bool MarlinSettings::grid_is_valid(const int pos) { UNUSED(pos); return true; }
+
+      float MarlinSettings::grid_z(const int pos, const uint8_t x, const uint8_t y) {
+        float z;
+        EEPROM_READ_VAR(pos + (x * (GRID_MAX_POINTS_Y) + y) * sizeof(z), z);
+        return z;
+      }
+
+    #endif // !EEPROM_MESH_COMPRESSION
+
+  #endif // MESH_BED_LEVELING || AUTO_BED_LEVELING_BILINEAR
+
+  /**
+   * The version stored with the settings. EEPROM_MESH_COMPRESSION moves the
+   * settings after the grid, so it stores a 'C' in place of the 'V', and
+   * firmware built with the other layout resets them.
+   */
+  static void eeprom_version(char (&ver)[FW_STR_LEN + 1]) {
+    strncpy(ver, versionFW, sizeof(ver));
+    #if ENABLED(EEPROM_MESH_COMPRESSION)
+      ver[0] = 'C';
+    #endif
+  }
+
   /**
    * M500 - Store Configuration
    */
   bool MarlinSettings::save() {
-  	STORE_SETTING(versionFW);
+  	char ver[FW_STR_LEN + 1];
+  	eeprom_version(ver);
+  	EEPROM_STORE(ver, versionFW);
   	STORE_PLAN(axis_steps_per_mm);
   	STORE_PLAN(max_feedrate_mm_s);
   	STORE_PLAN(max_acceleration_mm_per_s2);
@@ -267,7 +419,7 @@ void MarlinSettings::postprocess() {
   		EEPROM_STORE(mesh_num_x, mesh_bilinear_max_x);
   		EEPROM_STORE(mesh_num_y, mesh_bilinear_max_y);
   		EEPROM_STORE(mbl.z_offset, mesh_ubl_z_offset);
-  		EEPROM_STORE(mbl.z_values, mesh_bilinear_z_values);
+  		store_grid(SETTING_ADDR_mesh_bilinear_z_values, mbl.z_values);
 		#elif ENABLED(AUTO_BED_LEVELING_BILINEAR)		// Bilinear Auto Bed Leveling
       // Compile time test that sizeof(z_values) is as expected
       static_assert(
@@ -280,7 +432,7 @@ void MarlinSettings::postprocess() {
       EEPROM_STORE(grid_max_y, mesh_bilinear_max_y);
       STORE_SETTING(bilinear_grid_spacing);
       STORE_SETTING(bilinear_start);
-      EEPROM_STORE(z_values, mesh_bilinear_z_values);
+      store_grid(SETTING_ADDR_mesh_bilinear_z_values, z_values);
 		#elif ENABLED(AUTO_BED_LEVELING_UBL)				// Unified Bed Leveling
       EEPROM_STORE(ubl.state.active, mesh_bilinear_ubl_status);
   		EEPROM_STORE(ubl.state.z_offset, mesh_ubl_z_offset);
@@ -344,6 +496,14 @@ void MarlinSettings::postprocess() {
 			EEPROM_STORE(thermalManager.bedKd, bedKpid + 8);
 		#endif
 
+		#if ENABLED(MPCTEMP)
+			HOTEND_LOOP() EEPROM_STORE(thermalManager.mpc[e], mpc + e * sizeof(Temperature::mpc_t));
+		#endif
+
+		#if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+			HOTEND_LOOP() EEPROM_STORE(thermalManager.Kf[e], flow_ff + e * sizeof(float));
+		#endif
+
 		#if HAS_LCD_CONTRAST
 			STORE_SETTING(lcd_contrast);
 		#endif
@@ -458,6 +618,10 @@ void MarlinSettings::postprocess() {
         store_mesh(ubl.state.storage_slot);
     #endif
 
+    #if ENABLED(ABL_THERMAL_MESHES)
+      thermal_mesh_save_edit();
+    #endif
+
     return !eeprom_error;
   }
 
@@ -466,15 +630,16 @@ void MarlinSettings::postprocess() {
    */
   bool MarlinSettings::load() {
 		eeprom_error = false;
-  	char stored_ver[12];
+  	char stored_ver[12], ver[FW_STR_LEN + 1];
   	EEPROM_READ(stored_ver, versionFW);
+  	eeprom_version(ver);
 
-  	if (strncmp(versionFW, stored_ver, FW_STR_LEN) != 0) {
+  	if (strncmp(ver, stored_ver, FW_STR_LEN) != 0) {
       #if ENABLED(EEPROM_CHITCHAT)
 	      SERIAL_ECHO_START();
 	      SERIAL_ECHOPGM("EEPROM version mismatch ");
 	      SERIAL_ECHOPAIR("(EEPROM=", stored_ver);
-	      SERIAL_ECHOPAIR(" LATEST=", versionFW);
+	      SERIAL_ECHOPAIR(" LATEST=", ver);
 	      SERIAL_ECHOLNPGM(")");
 			#endif
   		reset(true);
@@ -527,7 +692,7 @@ void MarlinSettings::postprocess() {
 					EEPROM_READ(status, mesh_bilinear_ubl_status);
 					mbl.status = status ? _BV(MBL_STATUS_HAS_MESH_BIT) : 0;
 					EEPROM_READ(mbl.z_offset, mesh_ubl_z_offset);
-					EEPROM_READ(mbl.z_values, mesh_bilinear_z_values);
+					if (!load_grid(SETTING_ADDR_mesh_bilinear_z_values, mbl.z_values)) mbl.reset();
 				} else {
 					mbl.reset();
 				}
@@ -539,8 +704,10 @@ void MarlinSettings::postprocess() {
 					EEPROM_READ(status, mesh_bilinear_ubl_status);
 					READ_SETTING(bilinear_grid_spacing);
 					READ_SETTING(bilinear_start);
-					EEPROM_READ(z_values, mesh_bilinear_z_values);
-					set_bed_leveling_enabled(status);
+					if (load_grid(SETTING_ADDR_mesh_bilinear_z_values, z_values))
+						set_bed_leveling_enabled(status);
+					else
+						reset_bed_level();
 				}
 			#elif ENABLED(AUTO_BED_LEVELING_UBL)				// Unified Bed Leveling
 				EEPROM_READ(ubl.state.active, mesh_bilinear_ubl_status);
@@ -605,6 +772,14 @@ void MarlinSettings::postprocess() {
 				EEPROM_READ(thermalManager.bedKd, bedKpid + 8);
 			#endif
 
+			#if ENABLED(MPCTEMP)
+				HOTEND_LOOP() EEPROM_READ(thermalManager.mpc[e], mpc + e * sizeof(Temperature::mpc_t));
+			#endif
+
+			#if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+				HOTEND_LOOP() EEPROM_READ(thermalManager.Kf[e], flow_ff + e * sizeof(float));
+			#endif
+
       #if ENABLED(PIDTEMP_CHAMBER)
 		    thermalManager.chamberKp = DEFAULT_chamberKp;
 		    thermalManager.chamberKi = scalePID_i(DEFAULT_chamberKi);
@@ -871,6 +1046,57 @@ void MarlinSettings::postprocess() {
 
   #endif // AUTO_BED_LEVELING_UBL
 
+  #if ENABLED(ABL_THERMAL_MESHES)
+
+    /**
+     * Each slot holds a bed temperature (-1 if empty) and a grid. All of
+     * them belong to the grid size, spacing and start written before them.
+     */
+    static_assert(SETTING_ADDR_thermal_mesh_END <= E2END + 1, "THERMAL_MESHES don't fit in the EEPROM. Reduce THERMAL_MESHES.");
+
+    #define THERMAL_MESH_ADDR(S) (SETTING_ADDR_thermal_mesh_z_values + (S) * MESH_STORE_SIZE)
+
+    bool MarlinSettings::thermal_mesh_grid_matches() {
+      uint8_t grid_max[2];
+      int spacing[2], start[2];
+      EEPROM_READ(grid_max, thermal_mesh_max);
+      EEPROM_READ(spacing, thermal_mesh_spacing);
+      EEPROM_READ(start, thermal_mesh_start);
+      return grid_max[X_AXIS] == GRID_MAX_POINTS_X && grid_max[Y_AXIS] == GRID_MAX_POINTS_Y
+          && spacing[X_AXIS] == bilinear_grid_spacing[X_AXIS] && spacing[Y_AXIS] == bilinear_grid_spacing[Y_AXIS]
+          && start[X_AXIS] == bilinear_start[X_AXIS] && start[Y_AXIS] == bilinear_start[Y_AXIS];
+    }
+
+    // Empty all the slots, for the current grid
+    void MarlinSettings::clear_thermal_meshes() {
+      const uint8_t grid_max[2] = { GRID_MAX_POINTS_X, GRID_MAX_POINTS_Y };
+      int16_t temp[THERMAL_MESHES];
+      for (uint8_t s = 0; s < THERMAL_MESHES; s++) temp[s] = -1;
+      EEPROM_STORE(grid_max, thermal_mesh_max);
+      EEPROM_STORE(bilinear_grid_spacing, thermal_mesh_spacing);
+      EEPROM_STORE(bilinear_start, thermal_mesh_start);
+      EEPROM_STORE(temp, thermal_mesh_temp);
+    }
+
+    int16_t MarlinSettings::thermal_mesh_temp(const uint8_t slot) {
+      int16_t temp;
+      EEPROM_READ_VAR(SETTING_ADDR_thermal_mesh_temp + slot * sizeof(temp), temp);
+      return temp >= 0 && grid_is_valid(THERMAL_MESH_ADDR(slot)) ? temp : -1;
+    }
+
+    // Store z_values in a slot. A grid of another size, spacing or start empties the others.
+    void MarlinSettings::store_thermal_mesh(const uint8_t slot, const int16_t temp) {
+      if (!thermal_mesh_grid_matches()) clear_thermal_meshes();
+      store_grid(THERMAL_MESH_ADDR(slot), z_values);
+      EEPROM_UPDATE_VAR(SETTING_ADDR_thermal_mesh_temp + slot * sizeof(temp), temp);
+    }
+
+    float MarlinSettings::thermal_mesh_z(const uint8_t slot, const uint8_t x, const uint8_t y) {
+      return grid_z(THERMAL_MESH_ADDR(slot), x, y);
+    }
+
+  #endif // ABL_THERMAL_MESHES
+
 #else // !EEPROM_SETTINGS
 
   bool MarlinSettings::save() {
@@ -1022,6 +1248,21 @@ void MarlinSettings::reset(bool init/* = false*/) {
     thermalManager.bedKd = scalePID_d(DEFAULT_bedKd);
   #endif
 
+  #if ENABLED(MPCTEMP)
+    HOTEND_LOOP() {
+      thermalManager.mpc[e].heater_power = MPC_HEATER_POWER;
+      thermalManager.mpc[e].block_heat_capacity = MPC_BLOCK_HEAT_CAPACITY;
+      thermalManager.mpc[e].sensor_responsiveness = MPC_SENSOR_RESPONSIVENESS;
+      thermalManager.mpc[e].ambient_xfer_coeff_fan0 = MPC_AMBIENT_XFER_COEFF;
+      thermalManager.mpc[e].fan255_adjustment = MPC_AMBIENT_XFER_COEFF_FAN255 - (MPC_AMBIENT_XFER_COEFF);
+      thermalManager.mpc[e].filament_heat_capacity_permm = FILAMENT_HEAT_CAPACITY_PERMM;
+    }
+  #endif
+
+  #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+    HOTEND_LOOP() thermalManager.Kf[e] = DEFAULT_Kf;
+  #endif
+
   #if ENABLED(FWRETRACT)
     autoretract_enabled = false;
     retract_length = RETRACT_LENGTH;
@@ -1502,6 +1743,36 @@ void MarlinSettings::reset(bool init/* = false*/) {
 
     #endif // PIDTEMP || PIDTEMPBED
 
+    #if ENABLED(MPCTEMP)
+      if (!forReplay) {
+        CONFIG_ECHO_START;
+        SERIAL_ECHOLNPGM("Model predictive control:");
+      }
+      HOTEND_LOOP() {
+        CONFIG_ECHO_START;
+        SERIAL_ECHOPAIR("  M306 E", e);
+        SERIAL_ECHOPAIR(" P", thermalManager.mpc[e].heater_power);
+        SERIAL_ECHOPAIR(" C", thermalManager.mpc[e].block_heat_capacity);
+        SERIAL_ECHOPAIR(" R", thermalManager.mpc[e].sensor_responsiveness);
+        SERIAL_ECHOPAIR(" A", thermalManager.mpc[e].ambient_xfer_coeff_fan0);
+        SERIAL_ECHOPAIR(" F", thermalManager.mpc[e].fan255_adjustment);
+        SERIAL_ECHOPAIR(" H", thermalManager.mpc[e].filament_heat_capacity_permm);
+        SERIAL_EOL();
+      }
+    #endif
+
+    #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+      if (!forReplay) {
+        CONFIG_ECHO_START;
+        SERIAL_ECHOLNPGM("Extrusion feed-forward:");
+      }
+      HOTEND_LOOP() {
+        CONFIG_ECHO_START;
+        SERIAL_ECHOPAIR("  M301 E", e);
+        SERIAL_ECHOLNPAIR(" F", thermalManager.Kf[e]);
+      }
+    #endif
+
     #if HAS_LCD_CONTRAST
       if (!forReplay) {
         CONFIG_ECHO_START;
@@ -46,6 +46,21 @@ class MarlinSettings {
         //static void delete_mesh();    // necessary if we have a MAT
         //static void defrag_meshes();  // "
       #endif
+
+      #if ENABLED(MESH_BED_LEVELING) || ENABLED(AUTO_BED_LEVELING_BILINEAR)
+        static void store_grid(const int pos, const float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+        static bool load_grid(const int pos, float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+        static bool grid_is_valid(const int pos);
+        static float grid_z(const int pos, const uint8_t x, const uint8_t y);
+      #endif
+
+      #if ENABLED(ABL_THERMAL_MESHES)
+        static bool thermal_mesh_grid_matches();
+        static void clear_thermal_meshes();
+        static int16_t thermal_mesh_temp(const uint8_t slot);
+        static void store_thermal_mesh(const uint8_t slot, const int16_t temp);
+        static float thermal_mesh_z(const uint8_t slot, const uint8_t x, const uint8_t y);
+      #endif
     #else
       FORCE_INLINE
       static bool load() { reset(); report(); return true; }
@@ -81,6 +96,14 @@ extern MarlinSettings settings;
 
 #if ENABLED(EEPROM_SETTINGS)
 	#define EEPROM_OFFSET 100
+
+	#if ENABLED(EEPROM_MESH_COMPRESSION)
+		// A grid is stored as a base Z, a step size, a CRC and a step count for each point
+		#define MESH_STORE_SIZE		(sizeof(float) * 2 + sizeof(uint16_t) + sizeof(int16_t) * GRID_MAX_POINTS)
+	#else
+		#define MESH_STORE_SIZE		(sizeof(float) * GRID_MAX_POINTS)
+	#endif
+
 	#if ENABLED(PARSE_SETTING_ADDR)
 		#define SETTING_ADDR_versionFW														(EEPROM_OFFSET)
 		#define SETTING_ADDR_axis_steps_per_mm										(sizeof(char) 			* (FW_STR_LEN + 1) + SETTING_ADDR_versionFW)
@@ -112,7 +135,7 @@ extern MarlinSettings settings;
 		#define SETTING_ADDR_mesh_bilinear_z_values								(sizeof(int8_t)			+ SETTING_ADDR_ubl_eeprom_storage_slot)
 
 		#if ENABLED(AUTO_BED_LEVELING_BILINEAR) || ENABLED(MESH_BED_LEVELING)
-			#define SETTING_ADDR_endstop_adj												(sizeof(float)			* GRID_MAX_POINTS_X * GRID_MAX_POINTS_Y + SETTING_ADDR_mesh_bilinear_z_values)
+			#define SETTING_ADDR_endstop_adj												(MESH_STORE_SIZE + SETTING_ADDR_mesh_bilinear_z_values)
 		#else
 			#define SETTING_ADDR_endstop_adj												(sizeof(float)			* 9 + SETTING_ADDR_mesh_bilinear_z_values)
 		#endif
@@ -182,7 +205,11 @@ extern MarlinSettings settings;
 		#define SETTING_ADDR_lastToolsState												(sizeof(float)			* XYZE + SETTING_ADDR_lastPos)
 		#define SETTING_ADDR_lastFilename													(sizeof(int)				* TOOLS_NUM + SETTING_ADDR_lastToolsState)
 
-		#define SETTING_ADDR_END																	(sizeof(char)			* 225 + SETTING_ADDR_lastFilename)
+		#define SETTING_ADDR_mpc																	(sizeof(char)			* 225 + SETTING_ADDR_lastFilename)
+
+		#define SETTING_ADDR_flow_ff															(sizeof(float)			* 6 * MAX_EXTRUDERS + SETTING_ADDR_mpc)
+
+		#define SETTING_ADDR_END																	(sizeof(float)			* MAX_EXTRUDERS + SETTING_ADDR_flow_ff)
 	#else
 		#define SETTING_ADDR_OFFSET																(EEPROM_OFFSET - 100)
 
@@ -216,7 +243,7 @@ extern MarlinSettings settings;
 		#define SETTING_ADDR_mesh_bilinear_z_values								(332 + SETTING_ADDR_OFFSET)
 
 		#if ENABLED(AUTO_BED_LEVELING_BILINEAR) || ENABLED(MESH_BED_LEVELING)
-			#define SETTING_ADDR_OFFSET_2														(SETTING_ADDR_OFFSET + GRID_MAX_POINTS * 4 - 36)
+			#define SETTING_ADDR_OFFSET_2														(SETTING_ADDR_OFFSET + MESH_STORE_SIZE - 36)
 		#else
 			#define SETTING_ADDR_OFFSET_2														(SETTING_ADDR_OFFSET)
 		#endif
@@ -286,7 +313,19 @@ extern MarlinSettings settings;
 		#define SETTING_ADDR_lastPos															(655 + SETTING_ADDR_OFFSET_2)
 		#define SETTING_ADDR_lastToolsState												(671 + SETTING_ADDR_OFFSET_2)
 		#define SETTING_ADDR_lastFilename													(687 + SETTING_ADDR_OFFSET_2)
-		#define SETTING_ADDR_END																	(912 + SETTING_ADDR_OFFSET_2)
+		#define SETTING_ADDR_mpc																	(912 + SETTING_ADDR_OFFSET_2)
+		#define SETTING_ADDR_flow_ff															(1032 + SETTING_ADDR_OFFSET_2)
+		#define SETTING_ADDR_END																	(1052 + SETTING_ADDR_OFFSET_2)
+	#endif
+
+	#if ENABLED(ABL_THERMAL_MESHES)
+		// The grids for other bed temperatures follow the settings
+		#define SETTING_ADDR_thermal_mesh_max											(SETTING_ADDR_END)
+		#define SETTING_ADDR_thermal_mesh_spacing									(sizeof(uint8_t)		* 2 + SETTING_ADDR_thermal_mesh_max)
+		#define SETTING_ADDR_thermal_mesh_start										(sizeof(int)				* 2 + SETTING_ADDR_thermal_mesh_spacing)
+		#define SETTING_ADDR_thermal_mesh_temp										(sizeof(int)				* 2 + SETTING_ADDR_thermal_mesh_start)
+		#define SETTING_ADDR_thermal_mesh_z_values								(sizeof(int16_t)		* THERMAL_MESHES + SETTING_ADDR_thermal_mesh_temp)
+		#define SETTING_ADDR_thermal_mesh_END											(MESH_STORE_SIZE		* THERMAL_MESHES + SETTING_ADDR_thermal_mesh_z_values)
 	#endif
 
 
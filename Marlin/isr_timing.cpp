@@ -0,0 +1,91 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * isr_timing.cpp - Cycle-accurate timing statistics for the stepper and temperature ISRs
+ */
+
+#include "Marlin.h"
+
+#if ENABLED(ISR_TIMING_STATS)
+
+#include "isr_timing.h"
+
+IsrTiming isr_timing;
+
+volatile isr_timing_t IsrTiming::stats[ISR_TIMING_SOURCES];
+volatile uint16_t IsrTiming::late_compares,
+                  IsrTiming::max_latency,
+                  IsrTiming::nested_cycles;
+volatile uint32_t IsrTiming::step_loops_blocks[3];
+
+void IsrTiming::init() {
+  // Free-running normal mode at F_CPU, no interrupts, outputs disconnected
+  ISR_TIMING_REG(TCCR,A) = 0;
+  ISR_TIMING_REG(TCCR,B) = _BV(ISR_TIMING_REG(CS,0));
+  ISR_TIMING_REG(TIMSK,) = 0;
+  reset();
+}
+
+void IsrTiming::reset() {
+  CRITICAL_SECTION_START
+    for (uint8_t i = 0; i < ISR_TIMING_SOURCES; i++) {
+      stats[i].cycles_min = 0xFFFF;
+      stats[i].cycles_max = 0;
+      stats[i].cycles_total = stats[i].count = 0;
+    }
+    late_compares = max_latency = 0;
+    step_loops_blocks[0] = step_loops_blocks[1] = step_loops_blocks[2] = 0;
+  CRITICAL_SECTION_END
+}
+
+void IsrTiming::report() {
+  for (uint8_t i = 0; i < ISR_TIMING_SOURCES; i++) {
+    CRITICAL_SECTION_START
+      const isr_timing_t s = { stats[i].cycles_min, stats[i].cycles_max, stats[i].cycles_total, stats[i].count };
+    CRITICAL_SECTION_END
+    if (!s.count) continue;
+    SERIAL_ECHO_START();
+    serialprintPGM(i == ISR_TIMING_STEPPER ? PSTR("Stepper") : i == ISR_TIMING_ADVANCE ? PSTR("Advance") : PSTR("Temperature"));
+    SERIAL_ECHOPAIR(" ISR runs:", s.count);
+    SERIAL_ECHOPAIR(" min:", (uint32_t)s.cycles_min);
+    SERIAL_ECHOPAIR(" avg:", s.cycles_total / s.count);
+    SERIAL_ECHOPAIR(" max:", (uint32_t)s.cycles_max);
+    SERIAL_ECHOLNPGM(" cycles");
+  }
+
+  CRITICAL_SECTION_START
+    const uint16_t late = late_compares, latency = max_latency;
+    const uint32_t loops1 = step_loops_blocks[0], loops2 = step_loops_blocks[1], loops4 = step_loops_blocks[2];
+  CRITICAL_SECTION_END
+
+  SERIAL_ECHO_START();
+  SERIAL_ECHOPAIR("Late compares:", (uint32_t)late);
+  SERIAL_ECHOPAIR(" Max latency:", (uint32_t)latency * 8 * 1000000UL / (F_CPU));  // Timer 1 ticks at F_CPU / 8
+  SERIAL_ECHOLNPGM("us");
+  SERIAL_ECHO_START();
+  SERIAL_ECHOPAIR("Blocks by step_loops 1x:", loops1);
+  SERIAL_ECHOPAIR(" 2x:", loops2);
+  SERIAL_ECHOLNPAIR(" 4x:", loops4);
+}
+
+#endif // ISR_TIMING_STATS
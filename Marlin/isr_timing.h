@@ -0,0 +1,104 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * isr_timing.h - Cycle-accurate timing statistics for the stepper and temperature ISRs
+ *
+ * A spare 16-bit timer (ISR_TIMING_TIMER) is run at F_CPU and read on entry and exit
+ * of each ISR. Durations exclude the time spent in a nested stepper ISR, so the
+ * temperature ISR numbers are its own cost. M880 reports the statistics, M880 R
+ * resets them.
+ */
+
+#ifndef ISR_TIMING_H
+#define ISR_TIMING_H
+
+#include "MarlinConfig.h"
+#include "temperature.h"
+
+enum IsrTimingSource : char {
+  ISR_TIMING_STEPPER,
+  ISR_TIMING_ADVANCE,
+  ISR_TIMING_TEMPERATURE,
+  ISR_TIMING_SOURCES
+};
+
+typedef struct {
+  uint16_t cycles_min, cycles_max;  // Shortest and longest run, in CPU cycles
+  uint32_t cycles_total,            // Sum of all runs, for the average
+           count;                   // Number of runs
+} isr_timing_t;
+
+#define __ISR_TIMING_REG(R,N,S) R ## N ## S
+#define _ISR_TIMING_REG(R,N,S) __ISR_TIMING_REG(R,N,S)
+#define ISR_TIMING_REG(R,S) _ISR_TIMING_REG(R, ISR_TIMING_TIMER, S)
+#define ISR_TIMING_TCNT ISR_TIMING_REG(TCNT,)
+
+class IsrTiming {
+
+  public:
+
+    static volatile isr_timing_t stats[ISR_TIMING_SOURCES];
+
+    static volatile uint16_t late_compares,       // Times OCR1A had to be pushed ahead because the ISR overran it
+                             max_latency;         // Longest delay (timer 1 ticks) from compare match to ISR entry
+
+    static volatile uint32_t step_loops_blocks[3]; // Blocks executed with step_loops 1, 2 and 4 at nominal speed
+
+    IsrTiming() {};
+
+    static void init();
+    static void reset();
+    static void report();
+
+    static FORCE_INLINE uint16_t now() { return ISR_TIMING_TCNT; }
+
+    // Add one run of an ISR that began at 'start'
+    static FORCE_INLINE void record(const IsrTimingSource src, const uint16_t start) {
+      uint16_t cycles = now() - start;
+      if (src == ISR_TIMING_TEMPERATURE)
+        cycles -= nested_cycles;          // Don't charge the temperature ISR for the stepper ISR
+      else if (Temperature::in_temp_isr)
+        nested_cycles += cycles;
+      volatile isr_timing_t &s = stats[src];
+      if (cycles < s.cycles_min) s.cycles_min = cycles;
+      if (cycles > s.cycles_max) s.cycles_max = cycles;
+      s.cycles_total += cycles;
+      s.count++;
+    }
+
+    static FORCE_INLINE void temperature_isr_start() { nested_cycles = 0; }
+
+    static FORCE_INLINE void compare_latency(const uint16_t ticks) { NOLESS(max_latency, ticks); }
+
+    static FORCE_INLINE void block_started(const uint8_t loops) {
+      step_loops_blocks[loops == 4 ? 2 : loops - 1]++;
+    }
+
+  private:
+
+    static volatile uint16_t nested_cycles;     // Stepper ISR cycles spent inside the current temperature ISR
+};
+
+extern IsrTiming isr_timing;
+
+#endif // ISR_TIMING_H
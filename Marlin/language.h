@@ -237,13 +237,24 @@
 #define MSG_PID_DEBUG_ITERM                 " iTerm "
 #define MSG_PID_DEBUG_DTERM                 " dTerm "
 #define MSG_PID_DEBUG_CTERM                 " cTerm "
+#define MSG_PID_DEBUG_FTERM                 " fTerm "
 #define MSG_INVALID_EXTRUDER_NUM            " - Invalid extruder number !"
+#define MSG_MPC_AUTOTUNE                    "MPC Autotune"
+#define MSG_MPC_AUTOTUNE_START              MSG_MPC_AUTOTUNE " start"
+#define MSG_MPC_AUTOTUNE_FAILED             MSG_MPC_AUTOTUNE " failed!"
+#define MSG_MPC_AUTOTUNE_INTERRUPTED        MSG_MPC_AUTOTUNE " interrupted!"
+#define MSG_MPC_COOLING_TO_AMBIENT          "Cooling to ambient"
+#define MSG_MPC_HEATING                     "Heating at full power"
+#define MSG_MPC_MEASURING_AMBIENT           "Measuring ambient heat loss"
+#define MSG_MPC_MEASURING_FAN               "Measuring fan heat loss"
+#define MSG_MPC_AUTOTUNE_FINISHED           MSG_MPC_AUTOTUNE " finished! Put the constants below into Configuration_adv.h"
 
 #define MSG_HEATER_BED                      "bed"
 #define MSG_STOPPED_HEATER                  ", system stopped! Heater_ID: "
 #define MSG_REDUNDANCY                      "Heater switched off. Temperature difference between temp sensors is too high !"
 #define MSG_T_HEATING_FAILED                "Heating failed"
 #define MSG_T_THERMAL_RUNAWAY               "Thermal Runaway"
+#define MSG_T_THERMAL_MODEL                 "Heater or sensor fault"
 #define MSG_T_MAXTEMP                       "MAXTEMP triggered"
 #define MSG_T_MINTEMP                       "MINTEMP triggered"
 
@@ -150,10 +150,18 @@ float Planner::previous_speed[NUM_AXIS],
         Planner::position_float[NUM_AXIS] = { 0 };
 #endif
 
-#if ENABLED(ULTRA_LCD)
+#if HAS_BLOCK_BUFFER_RUNTIME
   volatile uint32_t Planner::block_buffer_runtime_us = 0;
 #endif
 
+#if ENABLED(PLANNER_UNDERRUN_STATS)
+  volatile bool Planner::buffer_ran_dry = false;
+  volatile millis_t Planner::ran_dry_ms = 0;
+  uint16_t Planner::underrun_count = 0,
+           Planner::slowdown_count = 0;
+  millis_t Planner::underrun_ms = 0;
+#endif
+
 #if ENABLED(QUICK_PAUSE)
   extern float feedrate_mm_s;
 #endif
@@ -1172,28 +1180,28 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
   const uint8_t moves_queued = movesplanned();
 
   // Slow down when the buffer starts to empty, rather than wait at the corner for a buffer refill
-  #if ENABLED(SLOWDOWN) || ENABLED(ULTRA_LCD) || defined(XY_FREQUENCY_LIMIT)
+  #if HAS_BLOCK_BUFFER_RUNTIME || defined(XY_FREQUENCY_LIMIT)
     // Segment time im micro seconds
     unsigned long segment_time = LROUND(1000000.0 / inverse_mm_s);
   #endif
   #if ENABLED(SLOWDOWN)
-    if (WITHIN(moves_queued, 2, (BLOCK_BUFFER_SIZE) / 2 - 1)) {
-      if (segment_time < min_segment_time) {
-        // buffer is draining, add extra time.  The amount of time added increases if the buffer is still emptied more.
-        inverse_mm_s = 1000000.0 / (segment_time + LROUND(2 * (min_segment_time - segment_time) / moves_queued));
-        #if defined(XY_FREQUENCY_LIMIT) || ENABLED(ULTRA_LCD)
-          segment_time = LROUND(1000000.0 / inverse_mm_s);
+    // The block count says little about how long the queue will last, so look
+    // at the queued time instead. A full buffer of tiny segments can still run dry.
+    if (moves_queued > 1 && segment_time < min_segment_time) {
+      CRITICAL_SECTION_START
+        const uint32_t queued_us = block_buffer_runtime_us;
+      CRITICAL_SECTION_END
+      if (queued_us < SLOWDOWN_QUEUE_TIME) {
+        // buffer is draining, add extra time. The amount of time added increases as the queued time drops.
+        inverse_mm_s = 1000000.0 / (segment_time + (min_segment_time - segment_time) * (float)((SLOWDOWN_QUEUE_TIME) - queued_us) * (1.0 / (SLOWDOWN_QUEUE_TIME)));
+        segment_time = LROUND(1000000.0 / inverse_mm_s);
+        #if ENABLED(PLANNER_UNDERRUN_STATS)
+          slowdown_count++;
         #endif
       }
     }
   #endif
 
-  #if ENABLED(ULTRA_LCD)
-    CRITICAL_SECTION_START
-      block_buffer_runtime_us += segment_time;
-    CRITICAL_SECTION_END
-  #endif
-
   block->nominal_speed = block->millimeters * inverse_mm_s; // (mm/sec) Always > 0
   block->nominal_rate = CEIL(block->step_event_count * inverse_mm_s); // (step/sec) Always > 0
 
@@ -1286,6 +1294,24 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
     block->nominal_rate *= speed_factor;
   }
 
+  #if HAS_EXTRUSION_RATE
+    // Filament melted per second, for the hotend feed-forward
+    if (current_speed[E_AXIS] > 0) {
+      const float dia = filament_size[extruder] ? filament_size[extruder] : DEFAULT_NOMINAL_FILAMENT_DIA;
+      block->extrusion_rate = current_speed[E_AXIS] * (M_PI / 4) * sq(dia);
+    }
+    else
+      block->extrusion_rate = 0;
+  #endif
+
+  #if HAS_BLOCK_BUFFER_RUNTIME
+    // Nominal duration of the block, with all speed limits applied
+    block->segment_time = speed_factor < 1.0 ? LROUND(1000000.0 / (inverse_mm_s * speed_factor)) : segment_time;
+    CRITICAL_SECTION_START
+      block_buffer_runtime_us += block->segment_time;
+    CRITICAL_SECTION_END
+  #endif
+
   // Compute and limit the acceleration rate for the trapezoid generator.
   const float steps_per_mm = block->step_event_count * inverse_millimeters;
   uint32_t accel;
@@ -1520,6 +1546,20 @@ void Planner::_buffer_line(const float &a, const float &b, const float &c, const
 
   calculate_trapezoid_for_block(block, block->entry_speed / block->nominal_speed, safe_speed / block->nominal_speed);
 
+  #if ENABLED(PLANNER_UNDERRUN_STATS)
+    // The stepper finished the last block a moment ago. The G-code feed couldn't keep up.
+    if (buffer_ran_dry) {
+      CRITICAL_SECTION_START
+        const millis_t dry_ms = millis() - ran_dry_ms;
+        buffer_ran_dry = false;
+      CRITICAL_SECTION_END
+      if (dry_ms < PLANNER_UNDERRUN_WINDOW) {
+        underrun_count++;
+        underrun_ms += dry_ms;
+      }
+    }
+  #endif
+
   // Move buffer head
   block_buffer_head = next_buffer_head;
 
@@ -1648,3 +1688,25 @@ void Planner::refresh_positioning() {
   }
 
 #endif
+
+#if ENABLED(PLANNER_UNDERRUN_STATS)
+
+  void Planner::reset_underrun_stats() {
+    drain_expected();
+    underrun_count = slowdown_count = 0;
+    underrun_ms = 0;
+  }
+
+  void Planner::report_underrun_stats() {
+    SERIAL_ECHO_START();
+    SERIAL_ECHOPAIR("Queued:", (uint32_t)block_buffer_runtime());
+    SERIAL_ECHOPAIR("ms in ", (int)movesplanned());
+    SERIAL_ECHOLNPGM(" blocks");
+    SERIAL_ECHO_START();
+    SERIAL_ECHOPAIR("Underruns:", (uint32_t)underrun_count);
+    SERIAL_ECHOPAIR(" Starved:", underrun_ms);
+    SERIAL_ECHOPAIR("ms Slowed segments:", (uint32_t)slowdown_count);
+    SERIAL_EOL();
+  }
+
+#endif
@@ -121,6 +121,10 @@ typedef struct {
 
   uint32_t segment_time;
 
+  #if HAS_EXTRUSION_RATE
+    float extrusion_rate;                   // Volumetric flow at the nominal speed (mm³/s), 0 for travels and retracts
+  #endif
+
 	#if ENABLED(QUICK_PAUSE)
 		uint32_t filePos;		// By LYN (the position of this block in the print file. The beginning of the gcode Or The gcode_LastN from serial.)
 		float block_speed;	// By LYN (the speed of this block. Come from the feedrate_mm_s.)
@@ -219,10 +223,15 @@ class Planner {
       static float position_float[NUM_AXIS];
     #endif
 
-    #if ENABLED(ULTRA_LCD)
+    #if HAS_BLOCK_BUFFER_RUNTIME
       volatile static uint32_t block_buffer_runtime_us; //Theoretical block buffer runtime in µs
     #endif
 
+    #if ENABLED(PLANNER_UNDERRUN_STATS)
+      static volatile bool buffer_ran_dry;    // Set by the stepper ISR when it finishes the last queued block
+      static volatile millis_t ran_dry_ms;    // ...and when that happened
+    #endif
+
   public:
 
     /**
@@ -376,21 +385,40 @@ class Planner {
     static block_t* get_current_block() {
       if (blocks_queued()) {
         block_t* block = &block_buffer[block_buffer_tail];
-        #if ENABLED(ULTRA_LCD)
+        #if HAS_BLOCK_BUFFER_RUNTIME
           block_buffer_runtime_us -= block->segment_time; //We can't be sure how long an active block will take, so don't count it.
         #endif
         SBI(block->flag, BLOCK_BIT_BUSY);
         return block;
       }
       else {
-        #if ENABLED(ULTRA_LCD)
+        #if HAS_BLOCK_BUFFER_RUNTIME
           clear_block_buffer_runtime(); // paranoia. Buffer is empty now - so reset accumulated time to zero.
         #endif
         return NULL;
       }
     }
 
-    #if ENABLED(ULTRA_LCD)
+    #if HAS_EXTRUSION_RATE
+
+      /**
+       * Volumetric flow (mm³/s) of the block the stepper is executing,
+       * if it extrudes with hotend 'e'. Else 0.
+       */
+      static float extrusion_rate(const uint8_t e) {
+        float rate = 0;
+        CRITICAL_SECTION_START
+          if (blocks_queued()) {
+            const block_t * const block = &block_buffer[block_buffer_tail];
+            if (TEST(block->flag, BLOCK_BIT_BUSY) && block->active_extruder == e) rate = block->extrusion_rate;
+          }
+        CRITICAL_SECTION_END
+        return rate;
+      }
+
+    #endif
+
+    #if HAS_BLOCK_BUFFER_RUNTIME
 
       static uint16_t block_buffer_runtime() {
         CRITICAL_SECTION_START
@@ -413,6 +441,26 @@ class Planner {
 
     #endif
 
+    #if ENABLED(PLANNER_UNDERRUN_STATS)
+
+      static uint16_t underrun_count,   // Times the stepper ran dry while moves were still coming
+                      slowdown_count;   // Segments stretched by SLOWDOWN
+      static millis_t underrun_ms;      // Total time spent waiting for the next move
+
+      /**
+       * Called by the stepper ISR when it has finished the last block in the buffer.
+       * A new block arriving within PLANNER_UNDERRUN_WINDOW counts as an underrun.
+       */
+      static void buffer_drained() { ran_dry_ms = millis(); buffer_ran_dry = true; }
+
+      // Called when the buffer is emptied on purpose (synchronize, quickstop)
+      static void drain_expected() { buffer_ran_dry = false; }
+
+      static void reset_underrun_stats();
+      static void report_underrun_stats();
+
+    #endif
+
     #if ENABLED(AUTOTEMP)
       static float autotemp_min, autotemp_max, autotemp_factor;
       static bool autotemp_enabled;
@@ -0,0 +1,163 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * print_area.cpp - Find the XY area covered by the file being printed
+ */
+
+#include "Marlin.h"
+
+#if ENABLED(ABL_PRINT_AREA)
+
+#include "print_area.h"
+
+#define PRINT_AREA_CHUNK 128
+
+typedef struct {
+  float x, y, e;
+  bool relative, relative_e,
+       moves;                 // An extruding move was found
+  uint8_t header;             // Bits of the ;MINX: ;MINY: ;MAXX: ;MAXY: values found
+  float header_min[2], header_max[2];
+} area_scan_t;
+
+// Find 'code' in the line and read the number after it
+static bool seen_value(const char * const p, const char code, float &value) {
+  const char * const c = strchr(p, code);
+  if (!c) return false;
+  value = strtod(c + 1, NULL);
+  return true;
+}
+
+static void add_point(const float &x, const float &y, float area_min[2], float area_max[2]) {
+  NOMORE(area_min[X_AXIS], x);
+  NOLESS(area_max[X_AXIS], x);
+  NOMORE(area_min[Y_AXIS], y);
+  NOLESS(area_max[Y_AXIS], y);
+}
+
+/**
+ * Take the header values from comment lines and the ends of extruding moves
+ * from the others. An extruding arc adds the box of its whole circle. With R
+ * the centre is somewhere within R of the end, so the box is 2R around it.
+ */
+static void parse_line(area_scan_t &s, char * const line, float area_min[2], float area_max[2]) {
+  if (line[0] == ';') {
+    // ;MINX:12.3 ;MAXY:45.6 ...
+    const bool is_min = !strncmp_P(line + 1, PSTR("MIN"), 3), is_max = !strncmp_P(line + 1, PSTR("MAX"), 3);
+    if ((is_min || is_max) && (line[4] == 'X' || line[4] == 'Y') && line[5] == ':') {
+      const uint8_t axis = line[4] == 'Y' ? Y_AXIS : X_AXIS;
+      (is_min ? s.header_min : s.header_max)[axis] = strtod(line + 6, NULL);
+      SBI(s.header, axis + (is_min ? 0 : 2));
+    }
+    return;
+  }
+
+  char * const comment = strchr(line, ';');
+  if (comment) *comment = '\0';
+
+  float value;
+  const int code = atoi(line + 1);
+  if (line[0] == 'G') switch (code) {
+    case 0: case 1: case 2: case 3: {
+      const float x = seen_value(line, 'X', value) ? (s.relative ? s.x + value : value) : s.x,
+                  y = seen_value(line, 'Y', value) ? (s.relative ? s.y + value : value) : s.y;
+      if (seen_value(line, 'E', value)) {
+        const float e = s.relative_e ? s.e + value : value;
+        if (e > s.e) {
+          s.moves = true;
+          add_point(s.x, s.y, area_min, area_max);
+          add_point(x, y, area_min, area_max);
+          if (code >= 2) {
+            float i = 0, j = 0, r;
+            const bool has_ij = seen_value(line, 'I', i) | seen_value(line, 'J', j);
+            if (has_ij) r = HYPOT(i, j);
+            else if (seen_value(line, 'R', r)) r *= 2;
+            else r = 0;
+            const float cx = has_ij ? s.x + i : x, cy = has_ij ? s.y + j : y;
+            r = FABS(r);
+            add_point(cx - r, cy - r, area_min, area_max);
+            add_point(cx + r, cy + r, area_min, area_max);
+          }
+        }
+        s.e = e;
+      }
+      s.x = x;
+      s.y = y;
+    } break;
+    case 28: s.x = s.y = 0; break;
+    case 90: s.relative = s.relative_e = false; break;
+    case 91: s.relative = s.relative_e = true; break;
+    case 92:
+      if (seen_value(line, 'X', value)) s.x = value;
+      if (seen_value(line, 'Y', value)) s.y = value;
+      if (seen_value(line, 'E', value)) s.e = value;
+      break;
+  }
+  else if (line[0] == 'M') switch (code) {
+    case 82: s.relative_e = false; break;
+    case 83: s.relative_e = true; break;
+  }
+}
+
+bool print_area_scan(float area_min[2], float area_max[2]) {
+  area_scan_t s = {};
+  area_min[X_AXIS] = area_min[Y_AXIS] = 99999;
+  area_max[X_AXIS] = area_max[Y_AXIS] = -99999;
+
+  // Of a long file only the start is read, where slicers put the header
+  const uint32_t limit = FILE_READER.getFileSize() > PRINT_AREA_SCAN_LIMIT ? PRINT_AREA_HEADER_SCAN : PRINT_AREA_SCAN_LIMIT;
+
+  char buf[PRINT_AREA_CHUNK], line[MAX_CMD_SIZE];
+  uint8_t line_length = 0;
+  for (uint32_t index = 0;;) {
+    const int16_t n = FILE_READER.readAhead(index, buf, COUNT(buf));
+    if (n < 0) return false;
+    for (int16_t i = 0; i <= n; i++) {
+      // A last line without a newline ends at the end of the file
+      const char c = i < n ? buf[i] : n < int16_t(COUNT(buf)) ? '\n' : '\0';
+      if (c == '\n' || c == '\r') {
+        if (line_length) {
+          line[line_length] = '\0';
+          parse_line(s, line, area_min, area_max);
+          line_length = 0;
+          if (s.header == 0x0F) {
+            area_min[X_AXIS] = s.header_min[X_AXIS];
+            area_min[Y_AXIS] = s.header_min[Y_AXIS];
+            area_max[X_AXIS] = s.header_max[X_AXIS];
+            area_max[Y_AXIS] = s.header_max[Y_AXIS];
+            return true;
+          }
+        }
+      }
+      else if (c && line_length < MAX_CMD_SIZE - 1 && (line_length || c != ' '))
+        line[line_length++] = c;
+    }
+    index += n;
+    if (n < int16_t(COUNT(buf))) break;
+    if (index >= limit) return false;
+    if (!(index & 0x7FF)) idle();
+  }
+  return s.moves;
+}
+
+#endif // ABL_PRINT_AREA
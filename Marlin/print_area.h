@@ -0,0 +1,44 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * print_area.h - Find the XY area covered by the file being printed
+ *
+ * G29 uses it to probe only the part of the grid under the print. The area
+ * comes from the ;MINX: ;MINY: ;MAXX: ;MAXY: header that Cura writes, or
+ * else from the extruding moves of the whole file.
+ */
+
+#ifndef PRINT_AREA_H
+#define PRINT_AREA_H
+
+#include "MarlinConfig.h"
+
+/**
+ * Read the file being printed from the start and set area_min and area_max
+ * (X and Y) to the area it prints in. Return false if the file can't be read,
+ * has no extruding moves, or is longer than PRINT_AREA_SCAN_LIMIT and has no
+ * header in its first PRINT_AREA_HEADER_SCAN bytes.
+ */
+bool print_area_scan(float area_min[2], float area_max[2]);
+
+#endif // PRINT_AREA_H
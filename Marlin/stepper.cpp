@@ -54,6 +54,10 @@
 #include "cardreader.h"
 #include "speed_lookuptable.h"
 
+#if ENABLED(ISR_TIMING_STATS)
+  #include "isr_timing.h"
+#endif
+
 #if HAS_DIGIPOTSS
   #include <SPI.h>
 #endif
@@ -140,6 +144,15 @@ unsigned short Stepper::acc_step_rate; // needed for deceleration start point
 uint8_t Stepper::step_loops, Stepper::step_loops_nominal;
 unsigned short Stepper::OCR1A_nominal;
 
+#if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+  uint8_t Stepper::oversampling_level,
+          Stepper::oversampling_level_nominal,
+          Stepper::event_delta;
+  int8_t Stepper::counter_event;
+  long Stepper::step_delta[NUM_AXIS],
+       Stepper::step_event_scaled;
+#endif
+
 volatile long Stepper::endstops_trigsteps[XYZ];
 
 #if ENABLED(X_DUAL_STEPPER_DRIVERS)
@@ -266,6 +279,16 @@ volatile long Stepper::endstops_trigsteps[XYZ];
 #define ENABLE_STEPPER_DRIVER_INTERRUPT()  SBI(TIMSK1, OCIE1A)
 #define DISABLE_STEPPER_DRIVER_INTERRUPT() CBI(TIMSK1, OCIE1A)
 
+// Don't run the ISR faster than possible. When profiling, count each time the deadline was missed.
+#if ENABLED(ISR_TIMING_STATS)
+  #define ISR_DEADLINE_CHECK() do{ \
+    const uint16_t min_ocr = TCNT1 + 16; \
+    if (OCR1A < min_ocr) { OCR1A = min_ocr; isr_timing.late_compares++; } \
+  }while(0)
+#else
+  #define ISR_DEADLINE_CHECK() NOLESS(OCR1A, TCNT1 + 16)
+#endif
+
 /**
  *         __________________________
  *        /|                        |\     _________________         ^
@@ -352,8 +375,15 @@ void Stepper::set_directions() {
  *  4000   500  Hz - init rate
  */
 ISR(TIMER1_COMPA_vect) {
+  #if ENABLED(ISR_TIMING_STATS)
+    isr_timing.compare_latency(TCNT1); // Timer 1 restarts from 0 on the compare match
+  #endif
   #if ENABLED(LIN_ADVANCE)
     Stepper::advance_isr_scheduler();
+  #elif ENABLED(ISR_TIMING_STATS)
+    const uint16_t start = isr_timing.now();
+    Stepper::isr();
+    isr_timing.record(ISR_TIMING_STEPPER, start);
   #else
     Stepper::isr();
   #endif
@@ -402,7 +432,7 @@ void Stepper::isr() {
 
       _NEXT_ISR(ocr_val);
 
-      NOLESS(OCR1A, TCNT1 + 16);
+      ISR_DEADLINE_CHECK();
 
       _ENABLE_ISRs(); // re-enable ISRs
       return;
@@ -428,8 +458,16 @@ void Stepper::isr() {
     if (current_block) {
       trapezoid_generator_reset();
 
+      #if ENABLED(ISR_TIMING_STATS)
+        isr_timing.block_started(step_loops_nominal);
+      #endif
+
       // Initialize Bresenham counters to 1/2 the ceiling
-      counter_X = counter_Y = counter_Z = counter_E = -(current_block->step_event_count >> 1);
+      counter_X = counter_Y = counter_Z = counter_E = -(STEP_EVENT_COUNT >> 1);
+
+      #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+        counter_event = -(int8_t)_BV(ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL - 1);
+      #endif
 
       #if ENABLED(MIXING_EXTRUDER)
         MIXING_STEPPERS_LOOP(i)
@@ -474,9 +512,9 @@ void Stepper::isr() {
   for (uint8_t i = step_loops; i--;) {
     #if ENABLED(LIN_ADVANCE)
 
-      counter_E += current_block->steps[E_AXIS];
+      counter_E += STEP_DELTA(E_AXIS);
       if (counter_E > 0) {
-        counter_E -= current_block->step_event_count;
+        counter_E -= STEP_EVENT_COUNT;
         #if DISABLED(MIXING_EXTRUDER)
           // Don't step E here for mixing extruder
           count_position[E_AXIS] += count_direction[E_AXIS];
@@ -504,13 +542,13 @@ void Stepper::isr() {
 
     // Advance the Bresenham counter; start a pulse if the axis needs a step
     #define PULSE_START(AXIS) \
-      _COUNTER(AXIS) += current_block->steps[_AXIS(AXIS)]; \
+      _COUNTER(AXIS) += STEP_DELTA(_AXIS(AXIS)); \
       if (_COUNTER(AXIS) > 0) { _APPLY_STEP(AXIS)(!_INVERT_STEP_PIN(AXIS),0); }
 
     // Stop an active pulse, reset the Bresenham counter, update the position
     #define PULSE_STOP(AXIS) \
       if (_COUNTER(AXIS) > 0) { \
-        _COUNTER(AXIS) -= current_block->step_event_count; \
+        _COUNTER(AXIS) -= STEP_EVENT_COUNT; \
         count_position[_AXIS(AXIS)] += count_direction[_AXIS(AXIS)]; \
         _APPLY_STEP(AXIS)(_INVERT_STEP_PIN(AXIS),0); \
       }
@@ -645,10 +683,22 @@ void Stepper::isr() {
       #endif
     #endif // !LIN_ADVANCE
 
-    if (++step_events_completed >= current_block->step_event_count) {
-      all_steps_done = true;
-      break;
-    }
+    #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+      // An oversampled ISR completes a whole step event only every 2^level passes
+      counter_event += event_delta;
+      if (counter_event > 0) {
+        counter_event -= _BV(ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL);
+        if (++step_events_completed >= current_block->step_event_count) {
+          all_steps_done = true;
+          break;
+        }
+      }
+    #else
+      if (++step_events_completed >= current_block->step_event_count) {
+        all_steps_done = true;
+        break;
+      }
+    #endif
 
     // For minimum pulse time wait after stopping pulses also
     #if EXTRA_CYCLES_XYZE > 20
@@ -758,10 +808,13 @@ void Stepper::isr() {
 
     // ensure we're running at the correct step rate, even if we just came off an acceleration
     step_loops = step_loops_nominal;
+    #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+      set_oversampling(oversampling_level_nominal);
+    #endif
   }
 
   #if DISABLED(LIN_ADVANCE)
-    NOLESS(OCR1A, TCNT1 + 16);
+    ISR_DEADLINE_CHECK();
   #endif
 
   // If current block is finished, reset pointer
@@ -784,6 +837,9 @@ void Stepper::isr() {
 	#endif
     current_block = NULL;
     planner.discard_current_block();
+    #if ENABLED(PLANNER_UNDERRUN_STATS)
+      if (!planner.blocks_queued()) planner.buffer_drained();
+    #endif
   }
   #if DISABLED(LIN_ADVANCE)
     _ENABLE_ISRs(); // re-enable ISRs
@@ -892,11 +948,18 @@ void Stepper::isr() {
     DISABLE_STEPPER_DRIVER_INTERRUPT();
     sei();
 
+    #if ENABLED(ISR_TIMING_STATS)
+      uint16_t start = isr_timing.now();
+      #define ISR_TIMING_RECORD(S) do{ isr_timing.record(S, start); start = isr_timing.now(); }while(0)
+    #else
+      #define ISR_TIMING_RECORD(S) NOOP
+    #endif
+
     // Run main stepping ISR if flagged
-    if (!nextMainISR) isr();
+    if (!nextMainISR) { isr(); ISR_TIMING_RECORD(ISR_TIMING_STEPPER); }
 
     // Run Advance stepping ISR if flagged
-    if (!nextAdvanceISR) advance_isr();
+    if (!nextAdvanceISR) { advance_isr(); ISR_TIMING_RECORD(ISR_TIMING_ADVANCE); }
 
     // Is the next advance ISR scheduled before the next main ISR?
     if (nextAdvanceISR <= nextMainISR) {
@@ -918,7 +981,7 @@ void Stepper::isr() {
     }
 
     // Don't run the ISR faster than possible
-    NOLESS(OCR1A, TCNT1 + 16);
+    ISR_DEADLINE_CHECK();
 
     // Restore original ISR settings
     _ENABLE_ISRs();
@@ -1122,7 +1185,15 @@ void Stepper::init() {
 /**
  * Block until all buffered steps are executed
  */
-void Stepper::synchronize() { while (planner.blocks_queued()) idle(true); }
+void Stepper::synchronize() {
+  #if ENABLED(SEGMENT_COALESCING)
+    flush_coalesced_move();
+  #endif
+  while (planner.blocks_queued()) idle(true);
+  #if ENABLED(PLANNER_UNDERRUN_STATS)
+    planner.drain_expected();
+  #endif
+}
 
 /**
  * Set the stepper positions directly in steps
@@ -1234,6 +1305,9 @@ void Stepper::finish_and_disable() {
 }
 
 void Stepper::quick_stop() {
+  #if ENABLED(SEGMENT_COALESCING)
+    discard_coalesced_move();
+  #endif
 #if DISABLED(QUICK_PAUSE)
   #if ENABLED(AUTO_BED_LEVELING_UBL) && ENABLED(ULTIPANEL)
     if (!ubl_lcd_map_control)
@@ -1272,9 +1346,12 @@ void Stepper::quick_stop() {
   while (planner.blocks_queued()) planner.discard_current_block();
   current_block = NULL;
   ENABLE_STEPPER_DRIVER_INTERRUPT();
-  #if ENABLED(ULTRA_LCD)
+  #if HAS_BLOCK_BUFFER_RUNTIME
     planner.clear_block_buffer_runtime();
   #endif
+  #if ENABLED(PLANNER_UNDERRUN_STATS)
+    planner.drain_expected();
+  #endif
 }
 
 void Stepper::endstop_triggered(AxisEnum axis) {
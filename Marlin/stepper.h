@@ -133,6 +133,20 @@ class Stepper {
     static uint8_t step_loops, step_loops_nominal;
     static unsigned short OCR1A_nominal;
 
+    #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+      static uint8_t oversampling_level,        // The ISR runs 2^level times per step event
+                     oversampling_level_nominal,
+                     event_delta;               // Step event fraction completed by each ISR
+      static int8_t counter_event;              // Bresenham counter for whole step events
+      static long step_delta[NUM_AXIS],         // Bresenham increments scaled to the oversampling level
+                  step_event_scaled;            // step_event_count scaled to the highest oversampling level
+      #define STEP_DELTA(AXIS) step_delta[AXIS]
+      #define STEP_EVENT_COUNT step_event_scaled
+    #else
+      #define STEP_DELTA(AXIS) current_block->steps[AXIS]
+      #define STEP_EVENT_COUNT current_block->step_event_count
+    #endif
+
     static volatile long endstops_trigsteps[XYZ];
     static volatile long endstops_stepsTotal, endstops_stepsDone;
 
@@ -282,11 +296,34 @@ class Stepper {
 
   private:
 
+    #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+
+      // Rescale the Bresenham increments when the oversampling level changes
+      static FORCE_INLINE void set_oversampling(const uint8_t level) {
+        if (level == oversampling_level) return;
+        oversampling_level = level;
+        const uint8_t shift = ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL - level;
+        LOOP_XYZE(i) step_delta[i] = current_block->steps[i] << shift;
+        event_delta = _BV(shift);
+      }
+
+    #endif
+
     static FORCE_INLINE unsigned short calc_timer(uint32_t step_rate) {
       unsigned short timer;
 
       NOMORE(step_rate, MAX_STEP_FREQUENCY);
 
+      #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+        // Oversample slow step rates, keeping the ISR below the smoothing limit
+        uint8_t level = 0;
+        while (level < ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL && step_rate <= (ADAPTIVE_STEP_SMOOTHING_MAX_RATE) / 2) {
+          step_rate <<= 1;
+          level++;
+        }
+        set_oversampling(level);
+      #endif
+
       if (step_rate > 20000) { // If steprate > 20kHz >> step 4 times
         step_rate >>= 2;
         step_loops = 4;
@@ -335,10 +372,19 @@ class Stepper {
       }
 
       deceleration_time = 0;
+
+      #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+        step_event_scaled = current_block->step_event_count << (ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL);
+        oversampling_level = 0xFF; // Force the increments to be scaled for the new block
+      #endif
+
       // step_rate to timer interval
       OCR1A_nominal = calc_timer(current_block->nominal_rate);
       // make a note of the number of step loops required at nominal speed
       step_loops_nominal = step_loops;
+      #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+        oversampling_level_nominal = oversampling_level;
+      #endif
       acc_step_rate = current_block->initial_rate;
       acceleration_time = calc_timer(acc_step_rate);
       _NEXT_ISR(acceleration_time);
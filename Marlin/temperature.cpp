@@ -31,6 +31,10 @@
 #include "planner.h"
 #include "language.h"
 
+#if ENABLED(ISR_TIMING_STATS)
+  #include "isr_timing.h"
+#endif
+
 #if ENABLED(HEATER_0_USES_MAX6675)
   #include "spi.h"
 #endif
@@ -99,13 +103,31 @@ int16_t Temperature::current_temperature_raw[HOTENDS] = { 0 },
   #endif
 #endif
 
+#if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+  float Temperature::Kf[HOTENDS]; // Initialized by settings.load()
+#endif
+
+#if ENABLED(MPCTEMP)
+  Temperature::mpc_t Temperature::mpc[HOTENDS]; // Initialized by settings.load()
+#endif
+
+#if ENABLED(PIDTEMP) && ENABLED(PID_FIXED_POINT)
+  pid_value_t Temperature::Kp_fixed[PID_GAIN_SETS], Temperature::Ki_fixed[PID_GAIN_SETS], Temperature::Kd_fixed[PID_GAIN_SETS];
+#endif
+
 // Initialized by settings.load()
 #if ENABLED(PIDTEMPBED)
   float Temperature::bedKp, Temperature::bedKi, Temperature::bedKd;
+  #if ENABLED(PID_FIXED_POINT)
+    pid_value_t Temperature::bedKp_fixed, Temperature::bedKi_fixed, Temperature::bedKd_fixed;
+  #endif
 #endif
 
 #if ENABLED(PIDTEMP_CHAMBER)
   float Temperature::chamberKp, Temperature::chamberKi, Temperature::chamberKd;
+  #if ENABLED(PID_FIXED_POINT)
+    pid_value_t Temperature::chamberKp_fixed, Temperature::chamberKi_fixed, Temperature::chamberKd_fixed;
+  #endif
 #endif
 
 #if ENABLED(BABYSTEPPING)
@@ -137,11 +159,11 @@ int16_t Temperature::current_temperature_raw[HOTENDS] = { 0 },
 volatile bool Temperature::temp_meas_ready = false;
 
 #if ENABLED(PIDTEMP)
-  float Temperature::temp_iState[HOTENDS] = { 0 },
-        Temperature::temp_dState[HOTENDS] = { 0 },
-        Temperature::pTerm[HOTENDS],
-        Temperature::iTerm[HOTENDS],
-        Temperature::dTerm[HOTENDS];
+  pid_value_t Temperature::temp_iState[HOTENDS] = { 0 },
+              Temperature::temp_dState[HOTENDS] = { 0 },
+              Temperature::pTerm[HOTENDS],
+              Temperature::iTerm[HOTENDS],
+              Temperature::dTerm[HOTENDS];
 
   #if ENABLED(PID_EXTRUSION_SCALING)
     float Temperature::cTerm[HOTENDS];
@@ -150,28 +172,39 @@ volatile bool Temperature::temp_meas_ready = false;
     int Temperature::lpq_ptr = 0;
   #endif
 
-  float Temperature::pid_error[HOTENDS];
+  #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+    float Temperature::fTerm[HOTENDS];
+  #endif
+
+  pid_value_t Temperature::pid_error[HOTENDS];
   bool Temperature::pid_reset[HOTENDS];
 #endif
 
 #if ENABLED(PIDTEMPBED)
-  float Temperature::temp_iState_bed = { 0 },
-        Temperature::temp_dState_bed = { 0 },
-        Temperature::pTerm_bed,
-        Temperature::iTerm_bed,
-        Temperature::dTerm_bed,
-        Temperature::pid_error_bed;
+  pid_value_t Temperature::temp_iState_bed = { 0 },
+              Temperature::temp_dState_bed = { 0 },
+              Temperature::pTerm_bed,
+              Temperature::iTerm_bed,
+              Temperature::dTerm_bed,
+              Temperature::pid_error_bed;
 #else
   millis_t Temperature::next_bed_check_ms;
 #endif
 
+#if ENABLED(MPCTEMP)
+  float Temperature::mpc_block_temp[HOTENDS],
+        Temperature::mpc_sensor_temp[HOTENDS],
+        Temperature::mpc_ambient_temp[HOTENDS];
+  bool Temperature::mpc_model_valid[HOTENDS] = { false };
+#endif
+
 #if ENABLED(PIDTEMP_CHAMBER)
-  float Temperature::temp_iState_chamber = 0.0,
-        Temperature::temp_dState_chamber = 0.0,
-        Temperature::pTerm_chamber,
-        Temperature::iTerm_chamber,
-        Temperature::dTerm_chamber,
-        Temperature::pid_error_chamber;
+  pid_value_t Temperature::temp_iState_chamber = 0,
+              Temperature::temp_dState_chamber = 0,
+              Temperature::pTerm_chamber,
+              Temperature::iTerm_chamber,
+              Temperature::dTerm_chamber,
+              Temperature::pid_error_chamber;
   bool Temperature::pid_reset_chamber;
 #endif
 
@@ -179,6 +212,13 @@ uint16_t Temperature::raw_temp_value[MAX_EXTRUDERS] = { 0 },
          Temperature::raw_temp_bed_value = 0,
          Temperature::raw_temp_chamber_value = 0;
 
+#if ENABLED(ADC_IIR_FILTER)
+  uint16_t Temperature::adc_filter[ADC_CHANNELS];
+  uint8_t Temperature::adc_schedule[ADC_CHANNELS * 8],
+          Temperature::adc_schedule_length,
+          Temperature::adc_schedule_index;
+#endif
+
 // Init min and max temp with extreme values to prevent false errors during startup
 int16_t Temperature::minttemp_raw[HOTENDS] = ARRAY_BY_HOTENDS(HEATER_0_RAW_LO_TEMP , HEATER_1_RAW_LO_TEMP , HEATER_2_RAW_LO_TEMP, HEATER_3_RAW_LO_TEMP, HEATER_4_RAW_LO_TEMP),
         Temperature::maxttemp_raw[HOTENDS] = ARRAY_BY_HOTENDS(HEATER_0_RAW_HI_TEMP , HEATER_1_RAW_HI_TEMP , HEATER_2_RAW_HI_TEMP, HEATER_3_RAW_HI_TEMP, HEATER_4_RAW_HI_TEMP),
@@ -221,6 +261,14 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         Temperature::soft_pwm_amount_bed,
 				Temperature::soft_pwm_amount_chamber;
 
+#if ENABLED(HEATER_POWER_BUDGET)
+  uint8_t Temperature::pwm_request[HOTENDS],
+          Temperature::pwm_request_bed,
+          Temperature::pwm_request_chamber,
+          Temperature::budget_held,
+          Temperature::budget_starved;
+#endif
+
 #if ENABLED(FAN_SOFT_PWM)
   uint8_t Temperature::soft_pwm_amount_fan[FAN_COUNT],
           Temperature::soft_pwm_count_fan[FAN_COUNT];
@@ -248,6 +296,86 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
   uint8_t Temperature::ADCKey_count = 0;
 #endif
 
+#if ENABLED(PID_AUTOTUNE_FAST)
+
+  /**
+   * Relay cycle measurements shared by PID_autotune and PID_autotune_Chamber.
+   * Power is on the 0-255 scale of the PID output.
+   */
+  typedef struct {
+    float ambient,                    // Temperature at the start
+          rise, rise_power,           // First heat-up: temperature rise and power
+          temp_sum, power_sum,        // Sums over the current cycle
+          gain,                       // degC per unit of power, 0 if unknown
+          last_Ku, last_Tu;
+    millis_t start_ms, rise_ms,       // Start and length of the first heat-up
+             sample_ms, time_sum;     // Last sample, length of the current cycle
+  } autotune_cycle_t;
+
+  static void autotune_start(autotune_cycle_t &at, const float input) {
+    memset(&at, 0, sizeof(at));
+    at.ambient = input;
+    at.start_ms = at.sample_ms = millis();
+  }
+
+  // Add a reading at the given power to the cycle sums
+  static void autotune_sample(autotune_cycle_t &at, const float input, const long power, const millis_t ms) {
+    const millis_t dt = ms - at.sample_ms;
+    at.sample_ms = ms;
+    at.temp_sum += input * dt;
+    at.power_sum += float(power) * dt;
+    at.time_sum += dt;
+  }
+
+  // Call when first switching to cooling
+  static void autotune_rise(autotune_cycle_t &at, const float input, const long power, const millis_t ms) {
+    at.rise = input - at.ambient;
+    at.rise_power = power;
+    at.rise_ms = ms - at.start_ms;
+  }
+
+  /**
+   * Finish a cycle with the relay output 'd' it ran with and the time it
+   * spent heating. Work out Ku and Tu, allowing for the uneven relay, and
+   * report the model. Return true once Ku and Tu have settled.
+   */
+  static bool autotune_cycle(autotune_cycle_t &at, const long d, const long t_high, const long t_low, const float max, const float min, float &Ku, float &Tu) {
+    const float period = t_high + t_low;
+    Tu = period * 0.001;
+    Ku = (4.0 * d * sin(M_PI * t_high / period)) / (M_PI * (max - min) * 0.5);
+
+    // Gain from the means of the cycle, time constant from the first heat-up
+    // and dead time from the phase lag of 180° at Tu
+    at.gain = at.time_sum && at.power_sum > 0 ? (at.temp_sum / at.time_sum - at.ambient) / (at.power_sum / at.time_sum) : 0;
+    if (at.gain > 0 && at.rise > 0 && at.rise < at.gain * at.rise_power) {
+      const float tau = -(at.rise_ms * 0.001) / log(1.0 - at.rise / (at.gain * at.rise_power)),
+                  w = 2.0 * M_PI / Tu;
+      SERIAL_PROTOCOLPAIR(" Gain: ", at.gain);
+      SERIAL_PROTOCOLPAIR(" Tau: ", tau);
+      SERIAL_PROTOCOLLNPAIR(" Dead time: ", (M_PI - atan(w * tau)) / w);
+    }
+
+    const bool settled = at.last_Ku > 0
+                      && FABS(Ku - at.last_Ku) <= (PID_AUTOTUNE_TOLERANCE) * Ku
+                      && FABS(Tu - at.last_Tu) <= (PID_AUTOTUNE_TOLERANCE) * Tu;
+    at.last_Ku = Ku;
+    at.last_Tu = Tu;
+    return settled;
+  }
+
+  // Call on every switch to heating, after autotune_cycle
+  static void autotune_next(autotune_cycle_t &at) {
+    at.temp_sum = at.power_sum = 0;
+    at.time_sum = 0;
+  }
+
+  // The power that holds 'temp', for feed-forward
+  static void autotune_report_hold(const autotune_cycle_t &at, const float temp) {
+    if (at.gain > 0) SERIAL_PROTOCOLLNPAIR("Hold power: ", (temp - at.ambient) / at.gain);
+  }
+
+#endif // PID_AUTOTUNE_FAST
+
 #if HAS_PID_HEATING
 
   void Temperature::PID_autotune(float temp, int hotend, int ncycles, bool set_result/*=false*/) {
@@ -263,6 +391,11 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
     float workKp = 0, workKi = 0, workKd = 0;
     float max = 0, min = 10000;
 
+    #if ENABLED(PID_AUTOTUNE_FAST)
+      autotune_cycle_t at;
+      bool settled = false;
+    #endif
+
     #if HAS_AUTO_FAN
       next_auto_fan_check_ms = temp_ms + 2500UL;
     #endif
@@ -299,6 +432,18 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
       soft_pwm_amount_bed = bias = d = (MAX_BED_POWER) >> 1;
     #endif
 
+    #if ENABLED(PID_AUTOTUNE_FAST)
+      autotune_start(at,
+        #if HAS_PID_FOR_BOTH
+          hotend < 0 ? current_temperature_bed : current_temperature[hotend]
+        #elif ENABLED(PIDTEMP)
+          current_temperature[hotend]
+        #else
+          current_temperature_bed
+        #endif
+      );
+    #endif
+
     wait_for_heatup = true;
 
     // PID Tuning loop
@@ -322,6 +467,10 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         NOLESS(max, input);
         NOMORE(min, input);
 
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          autotune_sample(at, input, heating ? bias + d : bias - d, ms);
+        #endif
+
         #if HAS_AUTO_FAN
           if (ELAPSED(ms, next_auto_fan_check_ms)) {
             checkExtruderAutoFans();
@@ -332,6 +481,9 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         if (heating && input > temp) {
           if (ELAPSED(ms, t2 + 5000UL)) {
             heating = false;
+            #if ENABLED(PID_AUTOTUNE_FAST)
+              if (cycles == 0) autotune_rise(at, input, bias + d, ms);
+            #endif
             #if HAS_PID_FOR_BOTH
               if (hotend < 0)
                 soft_pwm_amount_bed = (bias - d) >> 1;
@@ -363,6 +515,9 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
                   MAX_BED_POWER
                 #endif
               ;
+              #if ENABLED(PID_AUTOTUNE_FAST)
+                const long cycle_d = d; // Relay output of the cycle just finished
+              #endif
               bias += (d * (t_high - t_low)) / (t_low + t_high);
               bias = constrain(bias, 20, max_pow - 20);
               d = (bias > max_pow / 2) ? max_pow - 1 - bias : bias;
@@ -371,9 +526,14 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
               SERIAL_PROTOCOLPAIR(MSG_D, d);
               SERIAL_PROTOCOLPAIR(MSG_T_MIN, min);
               SERIAL_PROTOCOLPAIR(MSG_T_MAX, max);
-              if (cycles > 2) {
-                Ku = (4.0 * d) / (M_PI * (max - min) * 0.5);
-                Tu = ((float)(t_low + t_high) * 0.001);
+              #if ENABLED(PID_AUTOTUNE_FAST)
+                if (cycles > 1) {
+                  settled = autotune_cycle(at, cycle_d, t_high, t_low, max, min, Ku, Tu);
+              #else
+                if (cycles > 2) {
+                  Ku = (4.0 * d) / (M_PI * (max - min) * 0.5);
+                  Tu = ((float)(t_low + t_high) * 0.001);
+              #endif
                 SERIAL_PROTOCOLPAIR(MSG_KU, Ku);
                 SERIAL_PROTOCOLPAIR(MSG_TU, Tu);
                 workKp = 0.6 * Ku;
@@ -401,6 +561,9 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
                 */
               }
             }
+            #if ENABLED(PID_AUTOTUNE_FAST)
+              autotune_next(at);
+            #endif
             #if HAS_PID_FOR_BOTH
               if (hotend < 0)
                 soft_pwm_amount_bed = (bias + d) >> 1;
@@ -435,8 +598,15 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         SERIAL_PROTOCOLLNPGM(MSG_PID_TIMEOUT);
         return;
       }
-      if (cycles > ncycles) {
+      if (cycles > ncycles
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          || settled
+        #endif
+      ) {
         SERIAL_PROTOCOLLNPGM(MSG_PID_AUTOTUNE_FINISHED);
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          autotune_report_hold(at, temp);
+        #endif
 
         #if HAS_PID_FOR_BOTH
           const char* estring = hotend < 0 ? "bed" : "";
@@ -502,12 +672,21 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
     float workKp = 0, workKi = 0, workKd = 0;
     float max = 0, min = 10000;
 
+    #if ENABLED(PID_AUTOTUNE_FAST)
+      autotune_cycle_t at;
+      bool settled = false;
+    #endif
+
     SERIAL_ECHOLNPGM("PID (Chamber) Auto Tune Start >>>>>>");
 
     disable_all_heaters();
 
     soft_pwm_amount_chamber = bias = d = (MAX_CHAMBER_POWER) >> 1;
 
+    #if ENABLED(PID_AUTOTUNE_FAST)
+      autotune_start(at, current_temperature_chamber);
+    #endif
+
     wait_for_heatup = true;
 
     // PID Tuning loop
@@ -521,9 +700,16 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         NOLESS(max, input);
         NOMORE(min, input);
 
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          autotune_sample(at, input, heating ? bias + d : bias - d, ms);
+        #endif
+
         if(heating && input > temp){
           if(ELAPSED(ms, t2 + 40000UL)){
             heating = false;
+            #if ENABLED(PID_AUTOTUNE_FAST)
+              if (cycles == 0) autotune_rise(at, input, bias + d, ms);
+            #endif
             soft_pwm_amount_chamber = (bias - d) >> 1;
             t1 = ms;
             t_high = t1 - t2;
@@ -537,6 +723,9 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
             t2 = ms;
             t_low = t2 - t1;
             if(cycles > 0){
+              #if ENABLED(PID_AUTOTUNE_FAST)
+                const long cycle_d = d; // Relay output of the cycle just finished
+              #endif
               bias += (d * (t_high - t_low)) / (t_low + t_high);
               bias = constrain(bias, 20, MAX_CHAMBER_POWER - 20);
               d = (bias > MAX_CHAMBER_POWER / 2) ? MAX_CHAMBER_POWER - 1 - bias : bias;
@@ -548,9 +737,14 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
               SERIAL_ECHOLNPAIR(" min: ", min);
               SERIAL_ECHOLNPAIR(" max: ", max);
 
-              if(cycles > 2){
-                Ku = (4.0 * d) / (M_PI * (max - min) * 0.5);
-                Tu = ((float)(t_low + t_high) * 0.001);
+              #if ENABLED(PID_AUTOTUNE_FAST)
+                if(cycles > 1){
+                  settled = autotune_cycle(at, cycle_d, t_high, t_low, max, min, Ku, Tu);
+              #else
+                if(cycles > 2){
+                  Ku = (4.0 * d) / (M_PI * (max - min) * 0.5);
+                  Tu = ((float)(t_low + t_high) * 0.001);
+              #endif
                 SERIAL_ECHOLNPAIR(" Ku: ", Ku);
                 SERIAL_ECHOLNPAIR(" Tu: ", Tu);
                 workKp = 0.6 * Ku;
@@ -562,6 +756,9 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
                 SERIAL_ECHOLNPAIR(" Kd: ", workKd);
               }
             }
+            #if ENABLED(PID_AUTOTUNE_FAST)
+              autotune_next(at);
+            #endif
             soft_pwm_amount_chamber = (bias + d) >> 1;
             cycles++;
             min = temp;
@@ -586,8 +783,15 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
         SERIAL_ECHOLNPGM("PID Auto tune failed! Timeout");
         return;
       }
-      if(cycles > 20){
+      if(cycles > 20
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          || settled
+        #endif
+      ){
         SERIAL_ECHOLNPGM("PID Auto tune finished!");
+        #if ENABLED(PID_AUTOTUNE_FAST)
+          autotune_report_hold(at, temp);
+        #endif
 
         SERIAL_ECHOLNPAIR("#define  KP ", workKp);
         SERIAL_ECHOLNPAIR("#define  KI ", workKi);
@@ -599,18 +803,220 @@ uint8_t Temperature::soft_pwm_amount[HOTENDS],
   }
 #endif
 
+#if ENABLED(MPCTEMP)
+
+  // The part cooling fan that blows on a hotend
+  #if FAN_COUNT > 1 && FAN_COUNT >= HOTENDS
+    #define MPC_FAN_INDEX(E) (E)
+  #else
+    #define MPC_FAN_INDEX(E) 0
+  #endif
+
+  #define MPC_UPDATES(S) uint16_t((S) / (MPC_dT))
+
+  /**
+   * Wait for the next temperature reading during MPC_autotune.
+   * With 'hold' the heater is run by manage_heater(), otherwise its power is left alone.
+   * Return false if the user aborted.
+   */
+  bool Temperature::mpc_autotune_wait(const bool hold) {
+    static millis_t next_report_ms = 0;
+    while (wait_for_heatup) {
+      if (temp_meas_ready) {
+        if (hold) manage_heater(); else updateTemperaturesFromRawValues();
+        const millis_t ms = millis();
+        if (ELAPSED(ms, next_report_ms)) {
+          #if HAS_TEMP_HOTEND || HAS_TEMP_BED
+            print_heaterstates();
+            SERIAL_EOL();
+          #endif
+          next_report_ms = ms + 2000UL;
+        }
+        return true;
+      }
+      lcd_update();
+    }
+    return false;
+  }
+
+  /**
+   * Identify the thermal model of a hotend (M306 T)
+   *
+   *  - Cool to ambient with the fan on.
+   *  - Heat at full power to 'temp'. The shape of the heating curve gives the
+   *    block heat capacity and the sensor responsiveness.
+   *  - Hold 'temp' with the fan off, then on. The average power gives the heat
+   *    lost to ambient and the extra loss with the fan.
+   */
+  void Temperature::MPC_autotune(const uint8_t e, const int16_t temp) {
+    SERIAL_ECHOLNPGM(MSG_MPC_AUTOTUNE_START);
+
+    disable_all_heaters();
+    wait_for_heatup = true;
+
+    #if FAN_COUNT > 0
+      const int16_t old_fan_speed = fanSpeeds[MPC_FAN_INDEX(e)];
+      #define MPC_SET_FAN(S) do{ fanSpeeds[MPC_FAN_INDEX(e)] = S; planner.check_axes_activity(); }while(0)
+    #else
+      #define MPC_SET_FAN(S) NOOP
+    #endif
+
+    mpc_t &model = mpc[e];
+    const mpc_t old_model = model;
+    uint16_t n;
+    bool ok = false;
+
+    do {
+      // Cool until the temperature falls by less than 0.2K in 10s
+      SERIAL_ECHOLNPGM(MSG_MPC_COOLING_TO_AMBIENT);
+      MPC_SET_FAN(255);
+      float last_temp = 9999;
+      for (n = 0;; n++) {
+        if (!mpc_autotune_wait(false)) break;
+        if (n % MPC_UPDATES(10) == 0) {
+          if (last_temp - current_temperature[e] < 0.2) break;
+          last_temp = current_temperature[e];
+        }
+      }
+      if (!wait_for_heatup) break;
+      const float ambient_temp = current_temperature[e];
+      MPC_SET_FAN(0);
+
+      // Heat at full power, sampling the curve once the sensor lag has settled.
+      // When the buffer fills, every other sample is dropped and the spacing doubles.
+      SERIAL_ECHOLNPGM(MSG_MPC_HEATING);
+      soft_pwm_amount[e] = (MPC_MAX) >> 1;
+      const float sample_start = ambient_temp + (temp - ambient_temp) * 0.3;
+      float samples[16], t1_time = 0;
+      uint8_t count = 0;
+      uint16_t sample_distance = 1, skip = 0;
+      for (n = 0;; n++) {
+        if (!mpc_autotune_wait(false)) break;
+        const float current = current_temperature[e];
+        if (current >= temp) break;
+        if (n > MPC_UPDATES(20 * 60)) break;    // Heater too weak for the target
+        if (!count) {
+          if (current < sample_start) continue;
+          t1_time = (n + 1) * (MPC_dT);
+        }
+        else if (++skip < sample_distance) continue;
+        skip = 0;
+        if (count == COUNT(samples)) {
+          for (uint8_t i = 0; i < COUNT(samples) / 2; i++) samples[i] = samples[i * 2];
+          count = COUNT(samples) / 2;
+          sample_distance *= 2;
+        }
+        samples[count++] = current;
+      }
+      soft_pwm_amount[e] = 0;
+      if (!wait_for_heatup || current_temperature[e] < temp || count < 3) break;
+
+      // Fit T(t) = asymp - (asymp - T1) * exp(-k * t) through three equally spaced samples
+      const uint8_t mid = (count - 1) >> 1;
+      const float t1 = samples[0], t2 = samples[mid], t3 = samples[mid * 2],
+                  asymp_temp = (t2 * t2 - t1 * t3) / (2 * t2 - t1 - t3),
+                  block_responsiveness = -log((t2 - asymp_temp) / (t1 - asymp_temp)) / (mid * sample_distance * (MPC_dT));
+      if (!(asymp_temp > temp) || !(block_responsiveness > 0)) break;
+
+      model.ambient_xfer_coeff_fan0 = model.heater_power * (MPC_MAX) * (1.0 / 255) / (asymp_temp - ambient_temp);
+      model.block_heat_capacity = model.ambient_xfer_coeff_fan0 / block_responsiveness;
+      model.sensor_responsiveness = block_responsiveness / (1 - (ambient_temp - asymp_temp) * exp(-block_responsiveness * t1_time) / (t1 - asymp_temp));
+      if (!(model.sensor_responsiveness > 0)) break;
+
+      // Hold the temperature with the new model and measure the average power
+      mpc_block_temp[e] = mpc_sensor_temp[e] = current_temperature[e];
+      mpc_ambient_temp[e] = ambient_temp;
+      mpc_model_valid[e] = true;
+      target_temperature[e] = temp;
+
+      float total_power = 0;
+      SERIAL_ECHOLNPGM(MSG_MPC_MEASURING_AMBIENT);
+      for (n = 0; n < MPC_UPDATES(60); n++) {
+        if (!mpc_autotune_wait(true)) break;
+        if (n >= MPC_UPDATES(30)) total_power += soft_pwm_amount[e];  // After 30s to settle
+      }
+      if (!wait_for_heatup) break;
+      const float fan0_power = total_power * model.heater_power * (1.0 / 127) / (n - MPC_UPDATES(30));
+      model.ambient_xfer_coeff_fan0 = fan0_power / (temp - ambient_temp);
+
+      #if FAN_COUNT > 0
+        SERIAL_ECHOLNPGM(MSG_MPC_MEASURING_FAN);
+        MPC_SET_FAN(255);
+        total_power = 0;
+        for (n = 0; n < MPC_UPDATES(60); n++) {
+          if (!mpc_autotune_wait(true)) break;
+          if (n >= MPC_UPDATES(30)) total_power += soft_pwm_amount[e];
+        }
+        if (!wait_for_heatup) break;
+        const float fan255_power = total_power * model.heater_power * (1.0 / 127) / (n - MPC_UPDATES(30));
+        model.fan255_adjustment = (fan255_power - fan0_power) / (temp - ambient_temp);
+      #endif
+
+      ok = true;
+    } while (0);
+
+    disable_all_heaters();
+    #if FAN_COUNT > 0
+      MPC_SET_FAN(old_fan_speed);
+    #endif
+
+    if (!ok) {
+      SERIAL_ECHOLNPGM(wait_for_heatup ? MSG_MPC_AUTOTUNE_FAILED : MSG_MPC_AUTOTUNE_INTERRUPTED);
+      model = old_model;
+      mpc_model_valid[e] = false;
+      wait_for_heatup = false;
+      return;
+    }
+    wait_for_heatup = false;
+
+    SERIAL_ECHOLNPGM(MSG_MPC_AUTOTUNE_FINISHED);
+    SERIAL_ECHOLNPAIR("#define MPC_BLOCK_HEAT_CAPACITY ", model.block_heat_capacity);
+    SERIAL_ECHOLNPAIR("#define MPC_SENSOR_RESPONSIVENESS ", model.sensor_responsiveness);
+    SERIAL_ECHOLNPAIR("#define MPC_AMBIENT_XFER_COEFF ", model.ambient_xfer_coeff_fan0);
+    #if FAN_COUNT > 0
+      SERIAL_ECHOLNPAIR("#define MPC_AMBIENT_XFER_COEFF_FAN255 ", model.ambient_xfer_coeff_fan0 + model.fan255_adjustment);
+    #endif
+  }
+
+#endif // MPCTEMP
+
 /**
  * Class and Instance Methods
  */
 
 Temperature::Temperature() { }
 
+#if ENABLED(PID_FIXED_POINT)
+  // Gains beyond the 16.16 range are clamped
+  static pid_value_t pid_gain_fixed(const float k) { return PID_FIXED(constrain(k, -32767, 32767)); }
+#endif
+
 void Temperature::updatePID() {
   #if ENABLED(PIDTEMP)
     #if ENABLED(PID_EXTRUSION_SCALING)
       last_e_position = 0;
     #endif
   #endif
+  #if ENABLED(PID_FIXED_POINT)
+    // Convert the gains here, not on every PID update
+    #if ENABLED(PIDTEMP)
+      for (uint8_t g = 0; g < PID_GAIN_SETS; g++) {
+        Kp_fixed[g] = pid_gain_fixed(PID_PARAM(Kp, g));
+        Ki_fixed[g] = pid_gain_fixed(PID_PARAM(Ki, g));
+        Kd_fixed[g] = pid_gain_fixed(PID_PARAM(Kd, g));
+      }
+    #endif
+    #if ENABLED(PIDTEMPBED)
+      bedKp_fixed = pid_gain_fixed(bedKp);
+      bedKi_fixed = pid_gain_fixed(bedKi);
+      bedKd_fixed = pid_gain_fixed(bedKd);
+    #endif
+    #if ENABLED(PIDTEMP_CHAMBER)
+      chamberKp_fixed = pid_gain_fixed(chamberKp);
+      chamberKi_fixed = pid_gain_fixed(chamberKi);
+      chamberKd_fixed = pid_gain_fixed(chamberKd);
+    #endif
+  #endif
 }
 
 int Temperature::getHeaterPower(int heater) {
@@ -717,31 +1123,34 @@ float Temperature::get_pid_output(const int8_t e) {
   #else
     #define _HOTEND_TEST     e == active_extruder
   #endif
-  float pid_output;
-  #if ENABLED(PIDTEMP)
+  #if ENABLED(MPCTEMP)
+    return get_mpc_output(HOTEND_INDEX);
+  #elif ENABLED(PIDTEMP)
+    pid_value_t pid_output;
     #if DISABLED(PID_OPENLOOP)
       #if PID_PARAMS_USE_TEMP_RANGE
         static int16_t pidTempRange[PID_PARAMS_TEMP_RANGE_NUM] =  PID_TEMP_RANGE_ARRAY;
-        float pParam = PID_PARAM(Kp, 0);
-        float iParam = PID_PARAM(Ki, 0);
-        float dParam = PID_PARAM(Kd, 0);
+        pid_value_t pParam = PID_GAIN(Kp, 0);
+        pid_value_t iParam = PID_GAIN(Ki, 0);
+        pid_value_t dParam = PID_GAIN(Kd, 0);
         for (int8_t s = PID_PARAMS_TEMP_RANGE_NUM - 1; s >= 0; s--){
           if(target_temperature[HOTEND_INDEX] > pidTempRange[s]){
-            pParam = PID_PARAM(Kp, s);
-            iParam = PID_PARAM(Ki, s);
-            dParam = PID_PARAM(Kd, s);
+            pParam = PID_GAIN(Kp, s);
+            iParam = PID_GAIN(Ki, s);
+            dParam = PID_GAIN(Kd, s);
             break;
           }
         }
       #else
-        float pParam = PID_PARAM(Kp, HOTEND_INDEX);
-        float iParam = PID_PARAM(Ki, HOTEND_INDEX);
-        float dParam = PID_PARAM(Kd, HOTEND_INDEX);
+        pid_value_t pParam = PID_GAIN(Kp, HOTEND_INDEX);
+        pid_value_t iParam = PID_GAIN(Ki, HOTEND_INDEX);
+        pid_value_t dParam = PID_GAIN(Kd, HOTEND_INDEX);
       #endif
 
-      pid_error[HOTEND_INDEX] = target_temperature[HOTEND_INDEX] - current_temperature[HOTEND_INDEX];
-      dTerm[HOTEND_INDEX] = K2 * dParam * (current_temperature[HOTEND_INDEX] - temp_dState[HOTEND_INDEX]) + K1 * dTerm[HOTEND_INDEX];
-      temp_dState[HOTEND_INDEX] = current_temperature[HOTEND_INDEX];
+      const pid_value_t current = PID_VALUE(current_temperature[HOTEND_INDEX]);
+      pid_error[HOTEND_INDEX] = PID_TARGET(target_temperature[HOTEND_INDEX]) - current;
+      dTerm[HOTEND_INDEX] = PID_MUL_K(K2, PID_MUL_GAIN(dParam, current - temp_dState[HOTEND_INDEX])) + PID_MUL_K(K1, dTerm[HOTEND_INDEX]);
+      temp_dState[HOTEND_INDEX] = current;
       #if HEATER_IDLE_HANDLER
         if (heater_idle_timeout_exceeded[HOTEND_INDEX]) {
           pid_output = 0;
@@ -749,11 +1158,11 @@ float Temperature::get_pid_output(const int8_t e) {
         }
         else
       #endif
-      if (pid_error[HOTEND_INDEX] > PID_FUNCTIONAL_RANGE) {
-        pid_output = BANG_MAX;
+      if (pid_error[HOTEND_INDEX] > PID_VALUE(PID_FUNCTIONAL_RANGE)) {
+        pid_output = PID_VALUE(BANG_MAX);
         pid_reset[HOTEND_INDEX] = true;
       }
-      else if (pid_error[HOTEND_INDEX] < -(PID_FUNCTIONAL_RANGE) || target_temperature[HOTEND_INDEX] == 0
+      else if (pid_error[HOTEND_INDEX] < -PID_VALUE(PID_FUNCTIONAL_RANGE) || target_temperature[HOTEND_INDEX] == 0
         #if HEATER_IDLE_HANDLER
           || heater_idle_timeout_exceeded[HOTEND_INDEX]
         #endif
@@ -763,12 +1172,12 @@ float Temperature::get_pid_output(const int8_t e) {
       }
       else {
         if (pid_reset[HOTEND_INDEX]) {
-          temp_iState[HOTEND_INDEX] = 0.0;
+          temp_iState[HOTEND_INDEX] = 0;
           pid_reset[HOTEND_INDEX] = false;
         }
-        pTerm[HOTEND_INDEX] = pParam * pid_error[HOTEND_INDEX];
-        temp_iState[HOTEND_INDEX] += pid_error[HOTEND_INDEX];
-        iTerm[HOTEND_INDEX] = iParam * temp_iState[HOTEND_INDEX];
+        pTerm[HOTEND_INDEX] = PID_MUL_GAIN(pParam, pid_error[HOTEND_INDEX]);
+        temp_iState[HOTEND_INDEX] = PID_I_LIMIT(temp_iState[HOTEND_INDEX] + pid_error[HOTEND_INDEX]);
+        iTerm[HOTEND_INDEX] = PID_MUL_GAIN(iParam, temp_iState[HOTEND_INDEX]);
 
         pid_output = pTerm[HOTEND_INDEX] + iTerm[HOTEND_INDEX] - dTerm[HOTEND_INDEX];
 
@@ -785,13 +1194,18 @@ float Temperature::get_pid_output(const int8_t e) {
             }
             if (++lpq_ptr >= lpq_len) lpq_ptr = 0;
             cTerm[HOTEND_INDEX] = (lpq[lpq_ptr] * planner.steps_to_mm[E_AXIS]) * PID_PARAM(Kc, HOTEND_INDEX);
-            pid_output += cTerm[HOTEND_INDEX];
+            pid_output += PID_VALUE(cTerm[HOTEND_INDEX]);
           }
         #endif // PID_EXTRUSION_SCALING
 
-        if (pid_output > PID_MAX) {
+        #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+          fTerm[HOTEND_INDEX] = Kf[HOTEND_INDEX] * planner.extrusion_rate(HOTEND_INDEX);
+          pid_output += PID_VALUE(fTerm[HOTEND_INDEX]);
+        #endif
+
+        if (pid_output > PID_VALUE(PID_MAX)) {
           if (pid_error[HOTEND_INDEX] > 0) temp_iState[HOTEND_INDEX] -= pid_error[HOTEND_INDEX]; // conditional un-integration
-          pid_output = PID_MAX;
+          pid_output = PID_VALUE(PID_MAX);
         }
         else if (pid_output < 0) {
           if (pid_error[HOTEND_INDEX] < 0) temp_iState[HOTEND_INDEX] -= pid_error[HOTEND_INDEX]; // conditional un-integration
@@ -802,59 +1216,69 @@ float Temperature::get_pid_output(const int8_t e) {
           pid_output = 0;
         }
       }
+
+      #if ENABLED(PID_FEEDFORWARD_LEARN)
+        feedforward_learn(HOTEND_INDEX, PID_TO_FLOAT(pid_output), !pid_reset[HOTEND_INDEX]);
+      #endif
     #else
-      pid_output = constrain(target_temperature[HOTEND_INDEX], 0, PID_MAX);
+      pid_output = PID_VALUE(constrain(target_temperature[HOTEND_INDEX], 0, PID_MAX));
     #endif // PID_OPENLOOP
 
     #if ENABLED(PID_DEBUG)
       SERIAL_ECHO_START();
       SERIAL_ECHOPAIR(MSG_PID_DEBUG, HOTEND_INDEX);
       SERIAL_ECHOPAIR(MSG_PID_DEBUG_INPUT, current_temperature[HOTEND_INDEX]);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_OUTPUT, pid_output);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_PTERM, pTerm[HOTEND_INDEX]);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_ITERM, iTerm[HOTEND_INDEX]);
-      SERIAL_ECHOPAIR(MSG_PID_DEBUG_DTERM, dTerm[HOTEND_INDEX]);
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG_OUTPUT, PID_TO_FLOAT(pid_output));
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG_PTERM, PID_TO_FLOAT(pTerm[HOTEND_INDEX]));
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG_ITERM, PID_TO_FLOAT(iTerm[HOTEND_INDEX]));
+      SERIAL_ECHOPAIR(MSG_PID_DEBUG_DTERM, PID_TO_FLOAT(dTerm[HOTEND_INDEX]));
       #if ENABLED(PID_EXTRUSION_SCALING)
         SERIAL_ECHOPAIR(MSG_PID_DEBUG_CTERM, cTerm[HOTEND_INDEX]);
       #endif
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        SERIAL_ECHOPAIR(MSG_PID_DEBUG_FTERM, fTerm[HOTEND_INDEX]);
+      #endif
       SERIAL_EOL();
     #endif // PID_DEBUG
 
+    return PID_TO_FLOAT(pid_output);
+
   #else /* PID off */
+    float pid_output;
     #if HEATER_IDLE_HANDLER
       if (heater_idle_timeout_exceeded[HOTEND_INDEX])
         pid_output = 0;
       else
     #endif
     pid_output = (current_temperature[HOTEND_INDEX] < target_temperature[HOTEND_INDEX]) ? PID_MAX : 0;
+    return pid_output;
   #endif
-
-  return pid_output;
 }
 
 #if ENABLED(PIDTEMPBED)
   float Temperature::get_pid_output_bed() {
-    float pid_output;
+    pid_value_t pid_output;
     #if DISABLED(PID_OPENLOOP)
-      pid_error_bed = target_temperature_bed - current_temperature_bed;
-      pTerm_bed = bedKp * pid_error_bed;
-      temp_iState_bed += pid_error_bed;
-      iTerm_bed = bedKi * temp_iState_bed;
+      const pid_value_t current = PID_VALUE(current_temperature_bed);
+      pid_error_bed = PID_TARGET(target_temperature_bed) - current;
+      pTerm_bed = PID_MUL_GAIN(PID_GAIN_OF(bedKp), pid_error_bed);
+      temp_iState_bed = PID_I_LIMIT(temp_iState_bed + pid_error_bed);
+      iTerm_bed = PID_MUL_GAIN(PID_GAIN_OF(bedKi), temp_iState_bed);
 
-      dTerm_bed = K2 * bedKd * (current_temperature_bed - temp_dState_bed) + K1 * dTerm_bed;
-      temp_dState_bed = current_temperature_bed;
+      dTerm_bed = PID_MUL_K(K2, PID_MUL_GAIN(PID_GAIN_OF(bedKd), current - temp_dState_bed)) + PID_MUL_K(K1, dTerm_bed);
+      temp_dState_bed = current;
 
       pid_output = pTerm_bed + iTerm_bed - dTerm_bed;
-      if (pid_output > MAX_BED_POWER) {
+      if (pid_output > PID_VALUE(MAX_BED_POWER)) {
         if (pid_error_bed > 0) temp_iState_bed -= pid_error_bed; // conditional un-integration
-        pid_output = MAX_BED_POWER;
+        pid_output = PID_VALUE(MAX_BED_POWER);
       }
       else if (pid_output < 0) {
         if (pid_error_bed < 0) temp_iState_bed -= pid_error_bed; // conditional un-integration
         pid_output = 0;
       }
     #else
-      pid_output = constrain(target_temperature_bed, 0, MAX_BED_POWER);
+      pid_output = PID_VALUE(constrain(target_temperature_bed, 0, MAX_BED_POWER));
     #endif // PID_OPENLOOP
 
     #if ENABLED(PID_BED_DEBUG)
@@ -863,31 +1287,32 @@ float Temperature::get_pid_output(const int8_t e) {
       SERIAL_ECHOPGM(": Input ");
       SERIAL_ECHO(current_temperature_bed);
       SERIAL_ECHOPGM(" Output ");
-      SERIAL_ECHO(pid_output);
+      SERIAL_ECHO(PID_TO_FLOAT(pid_output));
       SERIAL_ECHOPGM(" pTerm ");
-      SERIAL_ECHO(pTerm_bed);
+      SERIAL_ECHO(PID_TO_FLOAT(pTerm_bed));
       SERIAL_ECHOPGM(" iTerm ");
-      SERIAL_ECHO(iTerm_bed);
+      SERIAL_ECHO(PID_TO_FLOAT(iTerm_bed));
       SERIAL_ECHOPGM(" dTerm ");
-      SERIAL_ECHOLN(dTerm_bed);
+      SERIAL_ECHOLN(PID_TO_FLOAT(dTerm_bed));
     #endif // PID_BED_DEBUG
 
-    return pid_output;
+    return PID_TO_FLOAT(pid_output);
   }
 #endif // PIDTEMPBED
 
 #if ENABLED(PIDTEMP_CHAMBER)
   float Temperature::get_pid_output_chamber() {
-    float pid_output;
+    pid_value_t pid_output;
 
-    pid_error_chamber = target_temperature_chamber - current_temperature_chamber;
-    dTerm_chamber = (1.0 - chamberK1) * chamberKd * (current_temperature_chamber - temp_dState_chamber) + chamberK1 * dTerm_chamber;
-    temp_dState_chamber = current_temperature_chamber;
+    const pid_value_t current = PID_VALUE(current_temperature_chamber);
+    pid_error_chamber = PID_TARGET(target_temperature_chamber) - current;
+    dTerm_chamber = PID_MUL_K(1.0 - chamberK1, PID_MUL_GAIN(PID_GAIN_OF(chamberKd), current - temp_dState_chamber)) + PID_MUL_K(chamberK1, dTerm_chamber);
+    temp_dState_chamber = current;
 
-    if(pid_error_chamber > PID_RANGE_CHAMBER){
-      pid_output = MAX_CHAMBER_POWER;
+    if(pid_error_chamber > PID_VALUE(PID_RANGE_CHAMBER)){
+      pid_output = PID_VALUE(MAX_CHAMBER_POWER);
       pid_reset_chamber = true;
-    }else if(pid_error_chamber < -(PID_RANGE_CHAMBER) || target_temperature_chamber == 0){
+    }else if(pid_error_chamber < -PID_VALUE(PID_RANGE_CHAMBER) || target_temperature_chamber == 0){
       pid_output = 0;
       pid_reset_chamber = true;
     }else{
@@ -895,24 +1320,118 @@ float Temperature::get_pid_output(const int8_t e) {
         temp_iState_chamber = 0;
         pid_reset_chamber = false;
       }
-      pTerm_chamber = chamberKp * pid_error_chamber;
-      temp_iState_chamber += pid_error_chamber;
-      iTerm_chamber = chamberKi * temp_iState_chamber;
+      pTerm_chamber = PID_MUL_GAIN(PID_GAIN_OF(chamberKp), pid_error_chamber);
+      temp_iState_chamber = PID_I_LIMIT(temp_iState_chamber + pid_error_chamber);
+      iTerm_chamber = PID_MUL_GAIN(PID_GAIN_OF(chamberKi), temp_iState_chamber);
 
       pid_output = pTerm_chamber + iTerm_chamber - dTerm_chamber;
 
-      if(pid_output > MAX_CHAMBER_POWER){
+      if(pid_output > PID_VALUE(MAX_CHAMBER_POWER)){
         if(pid_error_chamber > 0) temp_iState_chamber -= pid_error_chamber;
-        pid_output = MAX_CHAMBER_POWER;
+        pid_output = PID_VALUE(MAX_CHAMBER_POWER);
       }else if(pid_output < 0){
         if(pid_error_chamber < 0) temp_iState_chamber -= pid_error_chamber;
         pid_output = 0;
       }
     }
-    return pid_output;
+    return PID_TO_FLOAT(pid_output);
   }
 #endif
 
+#if ENABLED(MPCTEMP)
+  /**
+   * Model predictive control: advance the thermal model of the hotend by one
+   * update, pull it toward the measured temperature, then plan the power that
+   * brings the block to the target and covers the losses there.
+   */
+  float Temperature::get_mpc_output(const uint8_t e) {
+    const mpc_t &model = mpc[e];
+    float &block_temp = mpc_block_temp[e],
+          &sensor_temp = mpc_sensor_temp[e],
+          &ambient_temp = mpc_ambient_temp[e];
+    const float current = current_temperature[e];
+
+    if (!mpc_model_valid[e]) {
+      block_temp = sensor_temp = current;
+      ambient_temp = min(current, 30);
+      mpc_model_valid[e] = true;
+    }
+
+    // Heat lost to ambient, more with the part cooling fan on
+    float ambient_xfer_coeff = model.ambient_xfer_coeff_fan0;
+    #if FAN_COUNT > 0
+      ambient_xfer_coeff += fanSpeeds[MPC_FAN_INDEX(e)] * (1.0 / 255) * model.fan255_adjustment;
+    #endif
+
+    // Heat carried off by the filament, at the flow of the block being executed.
+    // The planned flow is known as soon as the block starts, while the E steps
+    // counted over an update lag behind it.
+    float e_speed = planner.extrusion_rate(e);
+    if (e_speed) {
+      const float dia = filament_size[e] ? filament_size[e] : DEFAULT_NOMINAL_FILAMENT_DIA;
+      e_speed /= (M_PI / 4) * sq(dia);
+    }
+    const float filament_xfer_coeff = e_speed * model.filament_heat_capacity_permm;
+
+    // Advance the model with the power applied since the last update
+    const float heater_power = soft_pwm_amount[e] * (1.0 / 127) * model.heater_power,
+                block_delta = (heater_power - (ambient_xfer_coeff + filament_xfer_coeff) * (block_temp - ambient_temp))
+                              * (MPC_dT) / model.block_heat_capacity;
+    block_temp += block_delta;
+    sensor_temp += (block_temp - sensor_temp) * model.sensor_responsiveness * (MPC_dT);
+
+    // Model drift is slow and sensor noise is fast, so only part of the error is applied
+    const float correction = (current - sensor_temp) * (MPC_SMOOTHING_FACTOR);
+    block_temp += correction;
+    sensor_temp += correction;
+
+    // Blame what is left on the ambient estimate, but only while the hotend is near steady state
+    if (WITHIN(soft_pwm_amount[e], 1, 126) || FABS(block_delta + correction) < (MPC_STEADYSTATE) * (MPC_dT)) {
+      if (correction > 0)
+        ambient_temp += max(correction, (MPC_MIN_AMBIENT_CHANGE) * (MPC_dT));
+      else if (correction < 0)
+        ambient_temp += min(correction, -(MPC_MIN_AMBIENT_CHANGE) * (MPC_dT));
+    }
+
+    float power = 0;
+    if (target_temperature[e]
+      #if HEATER_IDLE_HANDLER
+        && !heater_idle_timeout_exceeded[e]
+      #endif
+    ) {
+      // Reach the target in 2 seconds, plus the losses to ambient and filament at the target
+      power = (target_temperature[e] - block_temp) * model.block_heat_capacity * 0.5
+            + (target_temperature[e] - ambient_temp) * (ambient_xfer_coeff + filament_xfer_coeff);
+    }
+
+    // 0-255 like the PID output. The +1 rounds the >> 1 to soft PWM.
+    // manage_heater() turns the heater off at maxttemp[e].
+    const float mpc_output = power * 254 / model.heater_power + 1;
+    return constrain(mpc_output, 0, MPC_MAX);
+  }
+#endif // MPCTEMP
+
+/**
+ * With HEATER_POWER_BUDGET the heaters ask for power in pwm_request and
+ * apply_power_budget() writes each soft PWM once, so the ISR never sees
+ * the power before the budget.
+ */
+#if ENABLED(HEATER_POWER_BUDGET)
+  #define HOTEND_PWM(E) pwm_request[E]
+#else
+  #define HOTEND_PWM(E) soft_pwm_amount[E]
+#endif
+#if ENABLED(HEATER_POWER_BUDGET) && BED_HEATER_WATTS > 0
+  #define BED_PWM pwm_request_bed
+#else
+  #define BED_PWM soft_pwm_amount_bed
+#endif
+#if ENABLED(HEATER_POWER_BUDGET) && CHAMBER_HEATER_WATTS > 0
+  #define CHAMBER_PWM pwm_request_chamber
+#else
+  #define CHAMBER_PWM soft_pwm_amount_chamber
+#endif
+
 /**
  * Manage heating activities for extruder hot-ends and a heated bed
  *  - Acquire updated temperature readings
@@ -944,10 +1463,16 @@ void Temperature::manage_heater() {
     if (current_temperature[0] < max(HEATER_0_MINTEMP, MAX6675_TMIN + .01)) min_temp_error(0);
   #endif
 
-  #if WATCH_HOTENDS || WATCH_THE_BED || DISABLED(PIDTEMPBED) || HAS_AUTO_FAN || HEATER_IDLE_HANDLER
+  #if WATCH_HOTENDS || WATCH_THE_BED || DISABLED(PIDTEMPBED) || HAS_AUTO_FAN || HEATER_IDLE_HANDLER || ENABLED(THERMAL_PROTECTION_MODEL)
     millis_t ms = millis();
   #endif
 
+  #if ENABLED(THERMAL_PROTECTION_MODEL)
+    // Start the models over after a gap, as when an autotune read the sensors itself
+    const bool tm_restart = !thermal_model_ms || ms - thermal_model_ms > 2000UL * (PID_dT);
+    thermal_model_ms = ms;
+  #endif
+
   HOTEND_LOOP() {
 
     #if HEATER_IDLE_HANDLER
@@ -960,7 +1485,12 @@ void Temperature::manage_heater() {
       thermal_runaway_protection(&thermal_runaway_state_machine[e], &thermal_runaway_timer[e], current_temperature[e], target_temperature[e], e, THERMAL_PROTECTION_PERIOD, THERMAL_PROTECTION_HYSTERESIS);
     #endif
 
-    soft_pwm_amount[e] = (current_temperature[e] > minttemp[e] || is_preheating(e)) && current_temperature[e] < maxttemp[e] ? (int)get_pid_output(e) >> 1 : 0;
+    #if ENABLED(THERMAL_PROTECTION_MODEL)
+      // Before the new power is set, so the model sees the power of the last update
+      thermal_model_protection(e, tm_restart);
+    #endif
+
+    HOTEND_PWM(e) = (current_temperature[e] > minttemp[e] || is_preheating(e)) && current_temperature[e] < maxttemp[e] ? (int)get_pid_output(e) >> 1 : 0;
 
     #if WATCH_HOTENDS
       // Make sure temperature is increasing
@@ -1012,7 +1542,12 @@ void Temperature::manage_heater() {
   #endif // WATCH_THE_BED
 
   #if DISABLED(PIDTEMPBED)
-    if (PENDING(ms, next_bed_check_ms)) return;
+    if (PENDING(ms, next_bed_check_ms)) {
+      #if ENABLED(HEATER_POWER_BUDGET)
+        apply_power_budget();
+      #endif
+      return;
+    }
     next_bed_check_ms = ms + BED_CHECK_INTERVAL;
   #endif
 
@@ -1030,7 +1565,7 @@ void Temperature::manage_heater() {
     #if HEATER_IDLE_HANDLER
       if (bed_idle_timeout_exceeded)
       {
-        soft_pwm_amount_bed = 0;
+        BED_PWM = 0;
 
         #if DISABLED(PIDTEMPBED)
           WRITE_HEATER_BED(LOW);
@@ -1040,27 +1575,27 @@ void Temperature::manage_heater() {
     #endif
     {
       #if ENABLED(PIDTEMPBED)
-        soft_pwm_amount_bed = WITHIN(current_temperature_bed, BED_MINTEMP, BED_MAXTEMP) ? (int)get_pid_output_bed() >> 1 : 0;
+        BED_PWM = WITHIN(current_temperature_bed, BED_MINTEMP, BED_MAXTEMP) ? (int)get_pid_output_bed() >> 1 : 0;
 
       #elif ENABLED(BED_LIMIT_SWITCHING)
         // Check if temperature is within the correct band
         if (WITHIN(current_temperature_bed, BED_MINTEMP, BED_MAXTEMP)) {
           if (current_temperature_bed >= target_temperature_bed + BED_HYSTERESIS)
-            soft_pwm_amount_bed = 0;
+            BED_PWM = 0;
           else if (current_temperature_bed <= target_temperature_bed - (BED_HYSTERESIS))
-            soft_pwm_amount_bed = MAX_BED_POWER >> 1;
+            BED_PWM = MAX_BED_POWER >> 1;
         }
         else {
-          soft_pwm_amount_bed = 0;
+          BED_PWM = 0;
           WRITE_HEATER_BED(LOW);
         }
       #else // !PIDTEMPBED && !BED_LIMIT_SWITCHING
         // Check if temperature is within the correct range
         if (WITHIN(current_temperature_bed, BED_MINTEMP, BED_MAXTEMP)) {
-          soft_pwm_amount_bed = current_temperature_bed < target_temperature_bed ? MAX_BED_POWER >> 1 : 0;
+          BED_PWM = current_temperature_bed < target_temperature_bed ? MAX_BED_POWER >> 1 : 0;
         }
         else {
-          soft_pwm_amount_bed = 0;
+          BED_PWM = 0;
           WRITE_HEATER_BED(LOW);
         }
       #endif
@@ -1069,30 +1604,139 @@ void Temperature::manage_heater() {
 
 	#if HAS_TEMP_CHAMBER
     #if ENABLED(PIDTEMP_CHAMBER)
-      soft_pwm_amount_chamber = WITHIN(current_temperature_chamber, CHAMBER_MINTEMP, CHAMBER_MAXTEMP) ? (int)get_pid_output_chamber() >> 1 : 0;
+      CHAMBER_PWM = WITHIN(current_temperature_chamber, CHAMBER_MINTEMP, CHAMBER_MAXTEMP) ? (int)get_pid_output_chamber() >> 1 : 0;
 		#elif defined(CHAMBER_HYSTERESIS)
 			if (WITHIN(current_temperature_chamber, CHAMBER_MINTEMP, CHAMBER_MAXTEMP)) {
 				if (current_temperature_chamber >= target_temperature_chamber)
-					soft_pwm_amount_chamber = 0;
+					CHAMBER_PWM = 0;
 				else if (current_temperature_chamber <= target_temperature_chamber - (CHAMBER_HYSTERESIS))
-					soft_pwm_amount_chamber = MAX_BED_POWER >> 1;
+					CHAMBER_PWM = MAX_BED_POWER >> 1;
 			} else {
-				soft_pwm_amount_chamber = 0;
+				CHAMBER_PWM = 0;
 				WRITE_HEATER_CHAMBER(LOW);
 			}
 		#else
 			if(WITHIN(current_temperature_chamber, CHAMBER_MINTEMP, CHAMBER_MAXTEMP)){
-				soft_pwm_amount_chamber = current_temperature_chamber < target_temperature_chamber ? MAX_CHAMBER_POWER >> 1 : 0;
+				CHAMBER_PWM = current_temperature_chamber < target_temperature_chamber ? MAX_CHAMBER_POWER >> 1 : 0;
 			} else {
-				soft_pwm_amount_chamber = 0;
+				CHAMBER_PWM = 0;
 				WRITE_HEATER_CHAMBER(LOW);
 			}
 		#endif
 	#endif //HAS_TEMP_CHAMBER
+
+  #if ENABLED(HEATER_POWER_BUDGET)
+    apply_power_budget();
+  #endif
 }
 
+#if ENABLED(HEATER_POWER_BUDGET)
+  /**
+   * Limit the heaters to PSU_POWER_BUDGET when they want more together.
+   * Heaters holding their target come first, then the rest by estimated
+   * time to target, longest first. The first one that doesn't fit gets the
+   * power that is left and the others wait.
+   *
+   * A heater's heating watch starts over when it is first held back, as
+   * it won't heat at the usual rate. It is off while the heater gets no
+   * power at all, and starts over when power comes back.
+   */
+  void Temperature::apply_power_budget() {
+    struct { uint8_t *pwm, power; uint16_t watts; float time_left; uint8_t bit; } heater[HOTENDS + 2], h;
+    uint8_t count = 0;
+    int32_t total = 0;
+
+    #define BUDGET_HEATER(REQUEST, PWM, WATTS, CURRENT, TARGET, RATE, BIT) do{ \
+      const float to_go = (TARGET) - (CURRENT); \
+      heater[count].pwm = &(PWM); \
+      heater[count].power = REQUEST; \
+      heater[count].watts = WATTS; \
+      heater[count].time_left = to_go > TEMP_HYSTERESIS ? to_go * (1.0 / (RATE)) : 1e6; \
+      heater[count].bit = BIT; \
+      total += int32_t(REQUEST) * (WATTS); \
+      count++; \
+    }while(0)
+
+    // Bits of budget_held and budget_starved: the hotends, then the bed and chamber
+    #define BUDGET_BIT_BED      (HOTENDS)
+    #define BUDGET_BIT_CHAMBER  (HOTENDS + 1)
+
+    HOTEND_LOOP() BUDGET_HEATER(pwm_request[e], soft_pwm_amount[e], HOTEND_HEATER_WATTS, current_temperature[e], target_temperature[e], HOTEND_HEATUP_RATE, e);
+    #if HAS_TEMP_BED && BED_HEATER_WATTS > 0
+      BUDGET_HEATER(pwm_request_bed, soft_pwm_amount_bed, BED_HEATER_WATTS, current_temperature_bed, target_temperature_bed, BED_HEATUP_RATE, BUDGET_BIT_BED);
+    #endif
+    #if HAS_TEMP_CHAMBER && CHAMBER_HEATER_WATTS > 0
+      BUDGET_HEATER(pwm_request_chamber, soft_pwm_amount_chamber, CHAMBER_HEATER_WATTS, current_temperature_chamber, target_temperature_chamber, CHAMBER_HEATUP_RATE, BUDGET_BIT_CHAMBER);
+    #endif
+
+    // Soft PWM runs 0..127, so the budget is in watts * 127
+    int32_t left = int32_t(PSU_POWER_BUDGET) * 127;
+    uint8_t held = 0, starved = 0;
+    if (total > left) {
+      // Insertion sort, longest time to target first
+      for (uint8_t i = 1; i < count; i++) {
+        h = heater[i];
+        uint8_t j = i;
+        for (; j && heater[j - 1].time_left < h.time_left; j--) heater[j] = heater[j - 1];
+        heater[j] = h;
+      }
+
+      for (uint8_t i = 0; i < count; i++) {
+        if (int32_t(heater[i].power) * heater[i].watts > left) {
+          heater[i].power = left / heater[i].watts;
+          SBI(held, heater[i].bit);
+          if (!heater[i].power) SBI(starved, heater[i].bit);
+        }
+        left -= int32_t(heater[i].power) * heater[i].watts;
+      }
+    }
+
+    // Each soft PWM is written once, with the power after the budget
+    for (uint8_t i = 0; i < count; i++) *heater[i].pwm = heater[i].power;
+
+    #if WATCH_HOTENDS || WATCH_THE_BED
+      const uint8_t restart = ((held & ~budget_held) | (budget_starved & ~starved)) & ~starved;
+      #if WATCH_HOTENDS
+        HOTEND_LOOP() {
+          if (TEST(starved, e)) watch_heater_next_ms[e] = 0;
+          else if (TEST(restart, e)) start_watching_heater(e);
+        }
+      #endif
+      #if WATCH_THE_BED
+        if (TEST(starved, BUDGET_BIT_BED)) watch_bed_next_ms = 0;
+        else if (TEST(restart, BUDGET_BIT_BED)) start_watching_bed();
+      #endif
+    #endif
+    budget_held = held;
+    budget_starved = starved;
+  }
+#endif // HEATER_POWER_BUDGET
+
 #define PGM_RD_W(x)   (short)pgm_read_word(&x)
 
+/**
+ * Look up a raw ADC value in a PROGMEM { raw, celsius } table.
+ * Tables are sorted by raw value, so a binary search finds the two entries
+ * around the reading, and the result is interpolated in 1/256 °C steps.
+ * Readings below the table are extrapolated from the first two entries.
+ * Readings above the table return the last entry.
+ */
+static float temp_from_table(const short (*tt)[2], const uint8_t len, const int raw) {
+  // Find the first entry (after the first) with a raw value above the reading
+  uint8_t l = 1, r = len;
+  while (l < r) {
+    const uint8_t m = l + ((r - l) >> 1);
+    if (PGM_RD_W(tt[m][0]) > raw) r = m; else l = m + 1;
+  }
+
+  // Overflow: Set to last value in the table
+  if (l == len) return PGM_RD_W(tt[len - 1][1]);
+
+  const short r0 = PGM_RD_W(tt[l - 1][0]), t0 = PGM_RD_W(tt[l - 1][1]);
+  const int32_t t_fixed = (int32_t)(raw - r0) * (PGM_RD_W(tt[l][1]) - t0) * 256L / (PGM_RD_W(tt[l][0]) - r0);
+  return t0 + t_fixed * (1.0 / 256);
+}
+
 // Derived from RepRap FiveD extruder::getTemperature()
 // For hot end temperature measurement.
 float Temperature::analog2temp(int raw, uint8_t e) {
@@ -1113,26 +1757,9 @@ float Temperature::analog2temp(int raw, uint8_t e) {
     if (e == 0) return 0.25 * raw;
   #endif
 
-  if (heater_ttbl_map[e] != NULL) {
-    float celsius = 0;
-    uint8_t i;
-    short(*tt)[][2] = (short(*)[][2])(heater_ttbl_map[e]);
+  if (heater_ttbl_map[e] != NULL)
+    return temp_from_table((const short(*)[2])heater_ttbl_map[e], heater_ttbllen_map[e], raw);
 
-    for (i = 1; i < heater_ttbllen_map[e]; i++) {
-      if (PGM_RD_W((*tt)[i][0]) > raw) {
-        celsius = PGM_RD_W((*tt)[i - 1][1]) +
-                  (raw - PGM_RD_W((*tt)[i - 1][0])) *
-                  (float)(PGM_RD_W((*tt)[i][1]) - PGM_RD_W((*tt)[i - 1][1])) /
-                  (float)(PGM_RD_W((*tt)[i][0]) - PGM_RD_W((*tt)[i - 1][0]));
-        break;
-      }
-    }
-
-    // Overflow: Set to last value in the table
-    if (i == heater_ttbllen_map[e]) celsius = PGM_RD_W((*tt)[i - 1][1]);
-
-    return celsius;
-  }
   return raw ? ((map(raw, 0, 0x3FF * OVERSAMPLENR, 0, 0x400 * OVERSAMPLENR) * ((5.0 * 100.0) / 1024.0) / OVERSAMPLENR) * TEMP_SENSOR_AD595_GAIN) + TEMP_SENSOR_AD595_OFFSET : 0;
 }
 
@@ -1140,23 +1767,8 @@ float Temperature::analog2temp(int raw, uint8_t e) {
 // For bed temperature measurement.
 float Temperature::analog2tempBed(const int raw) {
   #if ENABLED(BED_USES_THERMISTOR)
-    float celsius = 0;
-    byte i;
-
-    for (i = 1; i < BEDTEMPTABLE_LEN; i++) {
-      if (PGM_RD_W(BEDTEMPTABLE[i][0]) > raw) {
-        celsius  = PGM_RD_W(BEDTEMPTABLE[i - 1][1]) +
-                   (raw - PGM_RD_W(BEDTEMPTABLE[i - 1][0])) *
-                   (float)(PGM_RD_W(BEDTEMPTABLE[i][1]) - PGM_RD_W(BEDTEMPTABLE[i - 1][1])) /
-                   (float)(PGM_RD_W(BEDTEMPTABLE[i][0]) - PGM_RD_W(BEDTEMPTABLE[i - 1][0]));
-        break;
-      }
-    }
-
-    // Overflow: Set to last value in the table
-    if (i == BEDTEMPTABLE_LEN) celsius = PGM_RD_W(BEDTEMPTABLE[i - 1][1]);
 
-    return celsius;
+    return temp_from_table(BEDTEMPTABLE, BEDTEMPTABLE_LEN, raw);
 
   #elif defined(BED_USES_AD595)
 
@@ -1172,21 +1784,7 @@ float Temperature::analog2tempBed(const int raw) {
 
 float Temperature::analog2tempChamber(const int raw) {
 #ifdef CHAMBER_USES_THERMISTOR
-	float celsius = 0;
-	uint8_t i;
-	for (i = 1; i < CHAMBERTABLE_LEN; i++){
-		if(PGM_RD_W(CHAMBERTABLE[i][0]) > raw){
-			celsius = PGM_RD_W(CHAMBERTABLE[i - 1][1]) +
-					(raw - PGM_RD_W(CHAMBERTABLE[i - 1][0])) *
-					(float)(PGM_RD_W(CHAMBERTABLE[i][1]) - PGM_RD_W(CHAMBERTABLE[i - 1][1])) /
-					(float)(PGM_RD_W(CHAMBERTABLE[i][0]) - PGM_RD_W(CHAMBERTABLE[i - 1][0]));
-			break;
-		}
-	}
-
-	if(i == CHAMBERTABLE_LEN) celsius = PGM_RD_W(CHAMBERTABLE[i-1][1]);
-
-	return celsius;
+	return temp_from_table(CHAMBERTABLE, CHAMBERTABLE_LEN, raw);
 #elif defined(CHAMBER_USES_AD595)
 	return ((raw * ((5.0 * 100.0) / 1024.0) / OVERSAMPLENR) * TEMP_SENSOR_AD595_GAIN) + TEMP_SENSOR_AD595_OFFSET;
 #else
@@ -1317,6 +1915,10 @@ void Temperature::init() {
     #endif
   #endif
 
+  #if ENABLED(SOFT_PWM_BAM)
+    bam_init();
+  #endif
+
   #if ENABLED(HEATER_0_USES_MAX6675)
 
     OUT_WRITE(SCK_PIN, LOW);
@@ -1367,6 +1969,10 @@ void Temperature::init() {
     ANALOG_SELECT(FILWIDTH_PIN);
   #endif
 
+  #if ENABLED(ADC_IIR_FILTER)
+    adc_init();
+  #endif
+
   #if HAS_AUTO_FAN_0
     #if E0_AUTO_FAN_PIN == FAN1_PIN
       SET_OUTPUT(E0_AUTO_FAN_PIN);
@@ -1639,6 +2245,134 @@ void Temperature::init() {
 
 #endif // THERMAL_PROTECTION_HOTENDS || THERMAL_PROTECTION_BED
 
+#if ENABLED(PID_FEEDFORWARD_LEARN)
+
+  Temperature::ff_learn_t Temperature::ff_learn[HOTENDS];
+
+  #define FF_WINDOW_UPDATES uint16_t((PID_FEEDFORWARD_WINDOW) / (PID_dT) + 0.5)
+
+  /**
+   * Learn Kf of a hotend from the PID output of each update. On average over
+   * a window the heater power is the hold power plus Kf times the flow, so Kf
+   * is the slope of the window mean power over the window mean flow. Windows
+   * with the PID out of its band or a target change are left out, and older
+   * windows are forgotten over PID_FEEDFORWARD_WINDOWS.
+   */
+  void Temperature::feedforward_learn(const uint8_t e, const float output, const bool valid) {
+    ff_learn_t &l = ff_learn[e];
+    if (!valid || l.target != target_temperature[e]) {
+      l.valid = false;
+      l.target = target_temperature[e];
+    }
+    l.flow += planner.extrusion_rate(e);
+    l.power += output;
+    if (++l.count < FF_WINDOW_UPDATES) return;
+
+    if (l.valid) {
+      const float x = l.flow / l.count, y = l.power / l.count;
+      l.weight = l.weight * (1.0 - 1.0 / (PID_FEEDFORWARD_WINDOWS)) + 1.0;
+      const float dx = x - l.mean_flow, dy = y - l.mean_power;
+      l.mean_flow += dx / l.weight;
+      l.mean_power += dy / l.weight;
+      l.sxx = l.sxx * (1.0 - 1.0 / (PID_FEEDFORWARD_WINDOWS)) + dx * (x - l.mean_flow);
+      l.sxy = l.sxy * (1.0 - 1.0 / (PID_FEEDFORWARD_WINDOWS)) + dx * (y - l.mean_power);
+      // Only once the flow has varied by more than 1mm³/s (RMS)
+      if (l.weight > 3 && l.sxx > l.weight) {
+        Kf[e] = l.sxy / l.sxx;
+        NOLESS(Kf[e], 0);
+      }
+    }
+    l.flow = l.power = 0;
+    l.count = 0;
+    l.valid = true;
+  }
+
+#endif // PID_FEEDFORWARD_LEARN
+
+#if ENABLED(THERMAL_PROTECTION_MODEL)
+
+  float Temperature::tm_block_temp[HOTENDS],
+        Temperature::tm_sensor_temp[HOTENDS],
+        Temperature::tm_heat_flows[HOTENDS];
+  uint16_t Temperature::tm_fail_count[HOTENDS] = { 0 };
+  millis_t Temperature::thermal_model_ms = 0;
+
+  #if ENABLED(MPCTEMP)
+    #define TM_HEATER_POWER(E)       mpc[E].heater_power
+    #define TM_HEAT_CAPACITY(E)      mpc[E].block_heat_capacity
+    #define TM_RESPONSIVENESS(E)     mpc[E].sensor_responsiveness
+    #define TM_XFER_COEFF(E)         mpc[E].ambient_xfer_coeff_fan0
+    #define TM_FAN255_ADJUSTMENT(E)  mpc[E].fan255_adjustment
+    #define TM_AMBIENT(E)            (mpc_model_valid[E] ? mpc_ambient_temp[E] : THERMAL_MODEL_AMBIENT)
+  #else
+    #define TM_HEATER_POWER(E)       (THERMAL_MODEL_HEATER_POWER)
+    #define TM_HEAT_CAPACITY(E)      (THERMAL_MODEL_HEAT_CAPACITY)
+    #define TM_RESPONSIVENESS(E)     (THERMAL_MODEL_SENSOR_RESPONSIVENESS)
+    #define TM_XFER_COEFF(E)         (THERMAL_MODEL_AMBIENT_XFER_COEFF)
+    #define TM_FAN255_ADJUSTMENT(E)  ((THERMAL_MODEL_AMBIENT_XFER_COEFF_FAN255) - (THERMAL_MODEL_AMBIENT_XFER_COEFF))
+    #if HAS_TEMP_CHAMBER
+      #define TM_AMBIENT(E)          current_temperature_chamber
+    #else
+      #define TM_AMBIENT(E)          (THERMAL_MODEL_AMBIENT)
+    #endif
+  #endif
+
+  // The part cooling fan that blows on a hotend
+  #if FAN_COUNT > 1 && FAN_COUNT >= HOTENDS
+    #define TM_FAN_INDEX(E) (E)
+  #else
+    #define TM_FAN_INDEX(E) 0
+  #endif
+
+  #define TM_FAIL_UPDATES uint16_t((THERMAL_MODEL_PERIOD) / (PID_dT) + 0.5)
+
+  /**
+   * Advance the thermal model of a hotend by one update with the power applied
+   * since the last one, and compare it with the reading. The model follows the
+   * reading at THERMAL_MODEL_CORRECTION, so model errors only leave a limited
+   * offset: THERMAL_MODEL_MARGIN of the recent heat flows, over how fast they
+   * are corrected. Halt if the reading stays further off for THERMAL_MODEL_PERIOD.
+   * 'restart' starts the model from the reading.
+   */
+  void Temperature::thermal_model_protection(const uint8_t e, const bool restart) {
+    float &block_temp = tm_block_temp[e],
+          &sensor_temp = tm_sensor_temp[e],
+          &heat_flows = tm_heat_flows[e];
+    const float current = current_temperature[e];
+
+    if (restart) {
+      block_temp = sensor_temp = current;
+      heat_flows = 0;
+      tm_fail_count[e] = 0;
+      return;
+    }
+
+    float xfer_coeff = TM_XFER_COEFF(e);
+    #if FAN_COUNT > 0
+      xfer_coeff += fanSpeeds[TM_FAN_INDEX(e)] * (1.0 / 255) * TM_FAN255_ADJUSTMENT(e);
+    #endif
+
+    const float heat_capacity = TM_HEAT_CAPACITY(e),
+                heater_power = soft_pwm_amount[e] * (1.0 / 127) * TM_HEATER_POWER(e),
+                loss = xfer_coeff * (block_temp - TM_AMBIENT(e));
+    block_temp += (heater_power - loss) * (PID_dT) / heat_capacity;
+    sensor_temp += (block_temp - sensor_temp) * TM_RESPONSIVENESS(e) * (PID_dT);
+    heat_flows += (heater_power + FABS(loss) - heat_flows) * (THERMAL_MODEL_CORRECTION) * (PID_dT);
+
+    const float error = current - sensor_temp,
+                limit = (THERMAL_MODEL_TOLERANCE) + (THERMAL_MODEL_MARGIN) * heat_flows / (heat_capacity * (THERMAL_MODEL_CORRECTION)),
+                correction = error * (THERMAL_MODEL_CORRECTION) * (PID_dT);
+    block_temp += correction;
+    sensor_temp += correction;
+
+    if (FABS(error) <= limit)
+      tm_fail_count[e] = 0;
+    else if (++tm_fail_count[e] >= TM_FAIL_UPDATES)
+      _temp_error(e, PSTR(MSG_T_THERMAL_MODEL), PSTR(MSG_THERMAL_RUNAWAY));
+  }
+
+#endif // THERMAL_PROTECTION_MODEL
+
 void Temperature::disable_all_heaters() {
 
   #if ENABLED(AUTOTEMP)
@@ -1679,6 +2413,11 @@ void Temperature::disable_all_heaters() {
     #endif // HOTENDS > 1
   #endif
 
+  #if ENABLED(HEATER_POWER_BUDGET)
+    ZERO(pwm_request);
+    pwm_request_bed = pwm_request_chamber = 0;
+  #endif
+
   #if HAS_TEMP_BED
     target_temperature_bed = 0;
     soft_pwm_amount_bed = 0;
@@ -1800,6 +2539,35 @@ void Temperature::disable_all_heaters() {
  * Get raw temperatures
  */
 void Temperature::set_current_temp_raw() {
+  #if ENABLED(ADC_IIR_FILTER)
+    // Scale the filtered readings to the OVERSAMPLENR sums the tables expect.
+    // The ADC interrupt updates the filters, so copy them out in one go.
+    #define ADC_RAW(C) uint16_t((uint32_t(adc_filter[C]) * (OVERSAMPLENR)) >> (ADC_IIR_FRACTION))
+    CRITICAL_SECTION_START;
+    #if HAS_TEMP_0
+      raw_temp_value[0] = ADC_RAW(ADC_TEMP_0);
+    #endif
+    #if HAS_TEMP_1
+      raw_temp_value[1] = ADC_RAW(ADC_TEMP_1);
+    #endif
+    #if HAS_TEMP_2
+      raw_temp_value[2] = ADC_RAW(ADC_TEMP_2);
+    #endif
+    #if HAS_TEMP_3
+      raw_temp_value[3] = ADC_RAW(ADC_TEMP_3);
+    #endif
+    #if HAS_TEMP_4
+      raw_temp_value[4] = ADC_RAW(ADC_TEMP_4);
+    #endif
+    #if HAS_TEMP_BED
+      raw_temp_bed_value = ADC_RAW(ADC_TEMP_BED);
+    #endif
+    #if HAS_TEMP_CHAMBER
+      raw_temp_chamber_value = ADC_RAW(ADC_TEMP_CHAMBER);
+    #endif
+    CRITICAL_SECTION_END;
+  #endif
+
   #if HAS_TEMP_0 && DISABLED(HEATER_0_USES_MAX6675)
     current_temperature_raw[0] = raw_temp_value[0];
   #endif
@@ -1921,6 +2689,276 @@ void Temperature::set_current_temp_raw() {
  */
 ISR(TIMER0_COMPB_vect) { Temperature::isr(); }
 
+#if ENABLED(ADC_IIR_FILTER)
+
+  /**
+   * The ADC is auto-triggered by the timer 0 overflow, so each conversion
+   * starts ~1ms after the previous one ended and the channel was switched.
+   */
+  #ifdef MUX5
+    #define SELECT_ADC(pin) ADCSRB = _BV(ADTS2) | ((pin) > 7 ? _BV(MUX5) : 0); ADMUX = _BV(REFS0) | ((pin) & 0x07)
+  #else
+    #define SELECT_ADC(pin) ADCSRB = _BV(ADTS2); ADMUX = _BV(REFS0) | ((pin) & 0x07)
+  #endif
+
+  static const uint8_t adc_pin[ADC_CHANNELS] PROGMEM = {
+    #if HAS_TEMP_0
+      TEMP_0_PIN,
+    #endif
+    #if HAS_TEMP_1
+      TEMP_1_PIN,
+    #endif
+    #if HAS_TEMP_2
+      TEMP_2_PIN,
+    #endif
+    #if HAS_TEMP_3
+      TEMP_3_PIN,
+    #endif
+    #if HAS_TEMP_4
+      TEMP_4_PIN,
+    #endif
+    #if HAS_TEMP_BED
+      TEMP_BED_PIN,
+    #endif
+    #if HAS_TEMP_CHAMBER
+      TEMP_CHAMBER_PIN,
+    #endif
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      FILWIDTH_PIN,
+    #endif
+    #if ENABLED(ADC_KEYPAD)
+      ADC_KEYPAD_PIN,
+    #endif
+  };
+
+  static const uint8_t adc_priority[ADC_CHANNELS] PROGMEM = {
+    #if HAS_TEMP_0
+      ADC_PRIORITY_HOTEND,
+    #endif
+    #if HAS_TEMP_1
+      ADC_PRIORITY_HOTEND,
+    #endif
+    #if HAS_TEMP_2
+      ADC_PRIORITY_HOTEND,
+    #endif
+    #if HAS_TEMP_3
+      ADC_PRIORITY_HOTEND,
+    #endif
+    #if HAS_TEMP_4
+      ADC_PRIORITY_HOTEND,
+    #endif
+    #if HAS_TEMP_BED
+      ADC_PRIORITY_BED,
+    #endif
+    #if HAS_TEMP_CHAMBER
+      ADC_PRIORITY_CHAMBER,
+    #endif
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      ADC_PRIORITY_FILWIDTH,
+    #endif
+    #if ENABLED(ADC_KEYPAD)
+      ADC_PRIORITY_KEYPAD,
+    #endif
+  };
+
+  /**
+   * Build the round of conversions, spreading each channel's slots evenly
+   * (smooth weighted round-robin), fill the filters with a first reading
+   * and start the ADC.
+   */
+  void Temperature::adc_init() {
+    uint8_t total = 0;
+    for (uint8_t c = 0; c < ADC_CHANNELS; c++) total += pgm_read_byte(&adc_priority[c]);
+
+    int8_t credit[ADC_CHANNELS] = { 0 };
+    for (uint8_t i = 0; i < total; i++) {
+      uint8_t best = 0;
+      for (uint8_t c = 0; c < ADC_CHANNELS; c++) {
+        credit[c] += pgm_read_byte(&adc_priority[c]);
+        if (credit[c] > credit[best]) best = c;
+      }
+      credit[best] -= total;
+      adc_schedule[i] = best;
+    }
+    adc_schedule_length = total;
+    adc_schedule_index = 0;
+
+    // Start from a real reading so the filters don't trip MINTEMP/MAXTEMP.
+    // The first conversion after switching channels is thrown away.
+    for (uint8_t c = 0; c < ADC_CHANNELS; c++) {
+      SELECT_ADC(pgm_read_byte(&adc_pin[c]));
+      for (uint8_t n = 2; n--;) {
+        SBI(ADCSRA, ADSC);
+        while (TEST(ADCSRA, ADSC)) { /* nada */ }
+      }
+      adc_filter[c] = ADC << (ADC_IIR_FRACTION);
+    }
+
+    SELECT_ADC(pgm_read_byte(&adc_pin[adc_schedule[0]]));
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIF) | _BV(ADIE) | 0x07;
+  }
+
+  ISR(ADC_vect) { Temperature::adc_isr(); }
+
+  void Temperature::adc_isr() {
+    const uint16_t reading = ADC;
+    const uint8_t c = adc_schedule[adc_schedule_index];
+
+    // Switch to the next channel now, so it settles until the next trigger
+    if (++adc_schedule_index >= adc_schedule_length) adc_schedule_index = 0;
+    SELECT_ADC(pgm_read_byte(&adc_pin[adc_schedule[adc_schedule_index]]));
+
+    switch (c) {
+
+      #if ENABLED(FILAMENT_WIDTH_SENSOR)
+        case ADC_FILWIDTH: {
+          static unsigned long raw_filwidth_value = 0;
+          if (reading > 102) { // Make sure ADC is reading > 0.5 volts, otherwise don't read.
+            raw_filwidth_value -= (raw_filwidth_value >> 7); // Subtract 1/128th of the raw_filwidth_value
+            raw_filwidth_value += ((unsigned long)reading << 7); // Add new ADC reading, scaled by 128
+          }
+          current_raw_filwidth = raw_filwidth_value >> 10;  // Divide to get to 0-16384 range since we used 1/128 IIR filter approach
+        } break;
+      #endif
+
+      #if ENABLED(ADC_KEYPAD)
+        case ADC_KEY:
+          if (ADCKey_count < 16) {
+            if (reading > 900) {
+              //ADC Key release
+              ADCKey_count = 0;
+              current_ADCKey_raw = 0;
+            }
+            else {
+              current_ADCKey_raw += reading;
+              ADCKey_count++;
+            }
+          }
+          break;
+      #endif
+
+      default:
+        // filter += (reading - filter) / 2^ADC_IIR_SHIFT, all in unsigned 16 bits.
+        // The sum may wrap on the way, the result doesn't.
+        adc_filter[c] += (reading << ((ADC_IIR_FRACTION) - (ADC_IIR_SHIFT))) - (adc_filter[c] >> (ADC_IIR_SHIFT));
+        break;
+    }
+  }
+
+#endif // ADC_IIR_FILTER
+
+#if ENABLED(SOFT_PWM_BAM)
+
+  /**
+   * Bit-angle modulation of the soft PWM outputs
+   *
+   * A period of BAM_PERIOD ticks is split into one slot per duty bit, slot n
+   * lasting 2^n ticks. An output is on in the slots of the bits set in its
+   * duty, so it is on for 'duty' ticks of the period. The value of each port
+   * in each slot is worked out when a duty changes; the ISR only writes the
+   * ports at the start of each slot.
+   */
+  #define BAM_BITS (7 - (SOFT_PWM_SCALE))
+  #define BAM_PERIOD (_BV(BAM_BITS) - 1)
+
+  typedef struct {
+    uint8_t pin;
+    bool inverted;
+    uint8_t *amount;  // 0..127, or 0..255 for a fan
+    bool fan;
+  } bam_channel_t;
+
+  static const bam_channel_t bam_channels[] = {
+    { HEATER_0_PIN, false, &Temperature::soft_pwm_amount[0], false },
+    #if ENABLED(HEATERS_PARALLEL)
+      { HEATER_1_PIN, false, &Temperature::soft_pwm_amount[0], false },
+    #endif
+    #if HOTENDS > 1
+      { HEATER_1_PIN, false, &Temperature::soft_pwm_amount[1], false },
+      #if HOTENDS > 2
+        { HEATER_2_PIN, false, &Temperature::soft_pwm_amount[2], false },
+        #if HOTENDS > 3
+          { HEATER_3_PIN, false, &Temperature::soft_pwm_amount[3], false },
+          #if HOTENDS > 4
+            { HEATER_4_PIN, false, &Temperature::soft_pwm_amount[4], false },
+          #endif
+        #endif
+      #endif
+    #endif
+    #if HAS_HEATER_BED && DISABLED(SLOW_PID_BED)
+      { HEATER_BED_PIN, HEATER_BED_INVERTING, &Temperature::soft_pwm_amount_bed, false },
+    #endif
+    #if HAS_HEATER_CHAMBER && DISABLED(SLOW_PID_CHAMBER)
+      { HEATER_CHAMBER_PIN, false, &Temperature::soft_pwm_amount_chamber, false },
+    #endif
+    #if ENABLED(FAN_SOFT_PWM)
+      #if HAS_FAN0
+        { FAN_PIN, false, &Temperature::soft_pwm_amount_fan[0], true },
+      #endif
+      #if HAS_FAN1
+        { FAN1_PIN, false, &Temperature::soft_pwm_amount_fan[1], true },
+      #endif
+      #if HAS_FAN2
+        { FAN2_PIN, false, &Temperature::soft_pwm_amount_fan[2], true },
+      #endif
+    #endif
+  };
+
+  #define BAM_CHANNELS COUNT(bam_channels)
+
+  static volatile uint8_t *bam_port[BAM_CHANNELS]; // The ports of the channels, each once
+  static uint8_t bam_port_count,
+                 bam_port_mask[BAM_CHANNELS],      // The channels' bits on each port
+                 bam_channel_port[BAM_CHANNELS],   // Index of each channel's port
+                 bam_channel_bit[BAM_CHANNELS],
+                 bam_amount[BAM_CHANNELS],         // The duties of the current slot values
+                 bam_slot[BAM_BITS][BAM_CHANNELS]; // Channel bits of each port in each slot
+
+  // Work out the port values of the slots for the current duties
+  static void bam_update() {
+    bool changed = false;
+    for (uint8_t c = 0; c < BAM_CHANNELS; c++) {
+      const uint8_t amount = *bam_channels[c].amount >> (bam_channels[c].fan ? 1 : 0);
+      if (amount != bam_amount[c]) { bam_amount[c] = amount; changed = true; }
+    }
+    if (!changed) return;
+
+    // Only the temperature ISR reads the slots, and it calls this between periods
+    ZERO(bam_slot);
+    for (uint8_t c = 0; c < BAM_CHANNELS; c++)
+      for (uint8_t b = 0; b < BAM_BITS; b++)
+        if (TEST(bam_amount[c] >> (SOFT_PWM_SCALE), b) != bam_channels[c].inverted)
+          bam_slot[b][bam_channel_port[c]] |= bam_channel_bit[c];
+  }
+
+  static void bam_init() {
+    for (uint8_t c = 0; c < BAM_CHANNELS; c++) {
+      volatile uint8_t * const port = portOutputRegister(digitalPinToPort(bam_channels[c].pin));
+      uint8_t p = 0;
+      while (p < bam_port_count && bam_port[p] != port) p++;
+      if (p == bam_port_count) bam_port[bam_port_count++] = port;
+      bam_channel_port[c] = p;
+      bam_channel_bit[c] = digitalPinToBitMask(bam_channels[c].pin);
+      bam_port_mask[p] |= bam_channel_bit[c];
+      bam_amount[c] = 0xFF; // Force the first update
+    }
+    bam_update();
+  }
+
+  // Output slot 'b' of the period
+  FORCE_INLINE static void bam_write(const uint8_t b) {
+    for (uint8_t p = 0; p < bam_port_count; p++) {
+      volatile uint8_t * const port = bam_port[p];
+      const uint8_t mask = bam_port_mask[p], value = bam_slot[b][p];
+      // Other pins of the port may be written by the stepper ISR
+      CRITICAL_SECTION_START;
+      *port = (*port & ~mask) | value;
+      CRITICAL_SECTION_END;
+    }
+  }
+
+#endif // SOFT_PWM_BAM
+
 volatile bool Temperature::in_temp_isr = false;
 
 void Temperature::isr() {
@@ -1929,16 +2967,23 @@ void Temperature::isr() {
   if (in_temp_isr) return;
   in_temp_isr = true;
 
+  #if ENABLED(ISR_TIMING_STATS)
+    const uint16_t isr_start = isr_timing.now();
+    isr_timing.temperature_isr_start();
+  #endif
+
   // Allow UART and stepper ISRs
   CBI(TIMSK0, OCIE0B); //Disable Temperature ISR
   sei();
 
   static int8_t temp_count = -1;
-  static ADCSensorState adc_sensor_state = StartupDelay;
+  #if DISABLED(ADC_IIR_FILTER)
+    static ADCSensorState adc_sensor_state = StartupDelay;
+  #endif
   static uint8_t pwm_count = _BV(SOFT_PWM_SCALE);
   // avoid multiple loads of pwm_count
   uint8_t pwm_count_tmp = pwm_count;
-  #if ENABLED(ADC_KEYPAD)
+  #if ENABLED(ADC_KEYPAD) && DISABLED(ADC_IIR_FILTER)
     static unsigned int raw_ADCKey_value = 0;
   #endif
 
@@ -1991,11 +3036,29 @@ void Temperature::isr() {
     #endif
 	#endif
 
-  #if ENABLED(FILAMENT_WIDTH_SENSOR)
+  #if ENABLED(FILAMENT_WIDTH_SENSOR) && DISABLED(ADC_IIR_FILTER)
     static unsigned long raw_filwidth_value = 0;
   #endif
 
   #if DISABLED(SLOW_PWM_HEATERS)
+
+  #if ENABLED(SOFT_PWM_BAM)
+
+    /**
+     * Bit-angle modulation: write the ports at the start of each slot,
+     * and pick up changed duties at the start of each period
+     */
+    static uint8_t bam_tick = 0, bam_next = 0, bam_bit = 0;
+    UNUSED(pwm_count_tmp);
+    if (bam_tick == bam_next) {
+      if (!bam_tick) bam_update();
+      bam_write(bam_bit++);
+      bam_next = (bam_next << 1) | 1;
+    }
+    if (++bam_tick >= BAM_PERIOD) bam_tick = bam_next = bam_bit = 0;
+
+  #else // !SOFT_PWM_BAM
+
     constexpr uint8_t pwm_mask =
       #if ENABLED(SOFT_PWM_DITHER)
         _BV(SOFT_PWM_SCALE) - 1
@@ -2099,6 +3162,7 @@ void Temperature::isr() {
     // 5:                /  4 = 244.1406 Hz
     pwm_count = pwm_count_tmp + _BV(SOFT_PWM_SCALE);
 
+  #endif // !SOFT_PWM_BAM
 
   //SLOW PID (BY LYN)
   #if ENABLED(SLOW_PID_BED) || ENABLED(SLOW_PID_CHAMBER)
@@ -2317,6 +3381,8 @@ void Temperature::isr() {
   static bool do_buttons;
   if ((do_buttons ^= true)) lcd_buttons_update();
 
+  #if DISABLED(ADC_IIR_FILTER) // Else the ADC interrupt reads the sensors
+
   /**
    * One sensor is sampled on every other call of the ISR.
    * Each sensor is read 16 (OVERSAMPLENR) times, taking the average.
@@ -2450,21 +3516,29 @@ void Temperature::isr() {
 
   } // switch(adc_sensor_state)
 
-  if (!adc_sensor_state && ++temp_count >= OVERSAMPLENR) { // 10 * 16 * 1/(16000000/64/256)  = 164ms.
+  #endif // !ADC_IIR_FILTER
+
+  #if ENABLED(ADC_IIR_FILTER)
+    if (++temp_count >= ADC_READY_LOOPS) {
+  #else
+    if (!adc_sensor_state && ++temp_count >= OVERSAMPLENR) { // 10 * 16 * 1/(16000000/64/256)  = 164ms.
+  #endif
 
     temp_count = 0;
 
     // Update the raw values if they've been read. Else we could be updating them during reading.
     if (!temp_meas_ready) set_current_temp_raw();
 
-    // Filament Sensor - can be read any time since IIR filtering is used
-    #if ENABLED(FILAMENT_WIDTH_SENSOR)
-      current_raw_filwidth = raw_filwidth_value >> 10;  // Divide to get to 0-16384 range since we used 1/128 IIR filter approach
-    #endif
+    #if DISABLED(ADC_IIR_FILTER)
+      // Filament Sensor - can be read any time since IIR filtering is used
+      #if ENABLED(FILAMENT_WIDTH_SENSOR)
+        current_raw_filwidth = raw_filwidth_value >> 10;  // Divide to get to 0-16384 range since we used 1/128 IIR filter approach
+      #endif
 
-    ZERO(raw_temp_value);
-    raw_temp_bed_value = 0;
-    raw_temp_chamber_value = 0;
+      ZERO(raw_temp_value);
+      raw_temp_bed_value = 0;
+      raw_temp_chamber_value = 0;
+    #endif
 
     #define TEMPDIR(N) ((HEATER_##N##_RAW_LO_TEMP) > (HEATER_##N##_RAW_HI_TEMP) ? -1 : 1)
 
@@ -2525,8 +3599,10 @@ void Temperature::isr() {
 
   } // temp_count >= OVERSAMPLENR
 
-  // Go to the next state, up to SensorsReady
-  adc_sensor_state = (ADCSensorState)((int(adc_sensor_state) + 1) % int(StartupDelay));
+  #if DISABLED(ADC_IIR_FILTER)
+    // Go to the next state, up to SensorsReady
+    adc_sensor_state = (ADCSensorState)((int(adc_sensor_state) + 1) % int(StartupDelay));
+  #endif
 
   #if ENABLED(BABYSTEPPING)
     LOOP_XYZ(axis) {
@@ -2561,6 +3637,9 @@ void Temperature::isr() {
   #endif
 
   cli();
+  #if ENABLED(ISR_TIMING_STATS)
+    isr_timing.record(ISR_TIMING_TEMPERATURE, isr_start);
+  #endif
   in_temp_isr = false;
   SBI(TIMSK0, OCIE0B); //re-enable Temperature ISR
 }
@@ -102,6 +102,45 @@ enum ADCSensorState {
 
 #define ACTUAL_ADC_SAMPLES max(int(MIN_ADC_ISR_LOOPS), int(SensorsReady))
 
+#if ENABLED(ADC_IIR_FILTER)
+  /**
+   * Channels read by the ADC interrupt, each with its own filter
+   */
+  enum ADCChannel : uint8_t {
+    #if HAS_TEMP_0
+      ADC_TEMP_0,
+    #endif
+    #if HAS_TEMP_1
+      ADC_TEMP_1,
+    #endif
+    #if HAS_TEMP_2
+      ADC_TEMP_2,
+    #endif
+    #if HAS_TEMP_3
+      ADC_TEMP_3,
+    #endif
+    #if HAS_TEMP_4
+      ADC_TEMP_4,
+    #endif
+    #if HAS_TEMP_BED
+      ADC_TEMP_BED,
+    #endif
+    #if HAS_TEMP_CHAMBER
+      ADC_TEMP_CHAMBER,
+    #endif
+    #if ENABLED(FILAMENT_WIDTH_SENSOR)
+      ADC_FILWIDTH,
+    #endif
+    #if ENABLED(ADC_KEYPAD)
+      ADC_KEY,
+    #endif
+    ADC_CHANNELS
+  };
+
+  // Fraction bits of the filtered readings. 1023 << 6 still fits 16 bits.
+  #define ADC_IIR_FRACTION 6
+#endif
+
 #if !HAS_HEATER_BED
   constexpr int16_t target_temperature_bed = 0;
 #endif
@@ -110,6 +149,48 @@ enum ADCSensorState {
   constexpr int16_t target_temperature_chamber = 0;
 #endif
 
+#if ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED) || ENABLED(PIDTEMP_CHAMBER)
+  /**
+   * PID arithmetic, in float or in fixed point (PID_FIXED_POINT).
+   * Fixed point: gains are 16.16, temperatures, errors, terms and output are 24.8.
+   */
+  #if ENABLED(PID_FIXED_POINT)
+    typedef int32_t pid_value_t;
+    #define PID_FIXED(F)        pid_value_t((F) * 65536.0)                              // 16.16 gain from float
+    #define PID_VALUE(F)        pid_value_t((F) * 256.0)                                // 24.8 temperature or power from float
+    #define PID_TARGET(T)       (pid_value_t(T) << 8)                                   // 24.8 from an integer temperature
+    #define PID_TO_FLOAT(X)     ((X) * (1.0 / 256))
+    #define PID_MUL_GAIN(G, X)  pid_mul_gain(G, X)                                      // 16.16 gain * 24.8 value = 24.8
+    #define PID_MUL_K(K, X)     PID_MUL_GAIN(PID_FIXED(K), X)                           // Constant factor * 24.8 value
+    #define PID_GAIN_OF(G)      G##_fixed
+    #define PID_I_LIMIT(X)      constrain(X, -0x3FFFFFFFL, 0x3FFFFFFFL)                 // Keep the integral from wrapping
+
+    /**
+     * ((int64_t)g * x) >> 16, without the 64-bit multiply and shift that
+     * avr-gcc does with __muldi3 and a 64-bit shift loop. With g = gh:gl and
+     * x = xh:xl in 16-bit halves (gl, xl unsigned) the product is
+     * gh * x + gl * xh + ((gl * xl) >> 16), a 16x32, a 16x16 and an
+     * unsigned 16x16->32 multiply. The result is the same, bit for bit.
+     */
+    FORCE_INLINE pid_value_t pid_mul_gain(const pid_value_t g, const pid_value_t x) {
+      const int16_t gh = g >> 16, xh = x >> 16;
+      const uint16_t gl = g, xl = x;
+      // Summed as uint32_t: gh * x alone may wrap when the result doesn't
+      return pid_value_t((uint32_t)(int32_t)gh * (uint32_t)x + (uint32_t)((int32_t)gl * xh) + (((uint32_t)gl * xl) >> 16));
+    }
+  #else
+    typedef float pid_value_t;
+    #define PID_FIXED(F)        (F)
+    #define PID_VALUE(F)        (F)
+    #define PID_TARGET(T)       (T)
+    #define PID_TO_FLOAT(X)     (X)
+    #define PID_MUL_GAIN(G, X)  ((G) * (X))
+    #define PID_MUL_K(K, X)     ((K) * (X))
+    #define PID_GAIN_OF(G)      G
+    #define PID_I_LIMIT(X)      (X)
+  #endif
+#endif
+
 class Temperature {
 
   public:
@@ -142,8 +223,28 @@ class Temperature {
                      soft_pwm_count_fan[FAN_COUNT];
     #endif
 
-    #if ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED) || ENABLED(PIDTEMP_CHAMBER)
-      #define PID_dT ((OVERSAMPLENR * float(ACTUAL_ADC_SAMPLES)) / (F_CPU / 64.0 / 256.0))
+    #if ENABLED(PIDTEMP) || ENABLED(PIDTEMPBED) || ENABLED(PIDTEMP_CHAMBER) || ENABLED(MPCTEMP)
+      #if ENABLED(ADC_IIR_FILTER)
+        #define PID_dT (float(ADC_READY_LOOPS) / (F_CPU / 64.0 / 256.0))
+      #else
+        #define PID_dT ((OVERSAMPLENR * float(ACTUAL_ADC_SAMPLES)) / (F_CPU / 64.0 / 256.0))
+      #endif
+    #endif
+
+    #if ENABLED(MPCTEMP)
+      #define MPC_dT PID_dT
+
+      // Thermal model of a hotend, set by M306
+      typedef struct {
+        float heater_power,                 // (W)
+              block_heat_capacity,          // (J/K)
+              sensor_responsiveness,        // (K/s per K)
+              ambient_xfer_coeff_fan0,      // (W/K)
+              fan255_adjustment,            // (W/K) Added at full fan speed
+              filament_heat_capacity_permm; // (J/K/mm)
+      } mpc_t;
+
+      static mpc_t mpc[HOTENDS];
     #endif
 
     #if ENABLED(PIDTEMP)
@@ -171,6 +272,25 @@ class Temperature {
 
       #endif // PID_PARAMS_PER_HOTEND
 
+      #if ENABLED(PID_FIXED_POINT)
+        // Fixed-point copies of the gains, refreshed by updatePID()
+        #if PID_PARAMS_USE_TEMP_RANGE
+          #define PID_GAIN_SETS PID_PARAMS_TEMP_RANGE_NUM
+        #elif ENABLED(PID_PARAMS_PER_HOTEND) && HOTENDS > 1
+          #define PID_GAIN_SETS HOTENDS
+        #else
+          #define PID_GAIN_SETS 1
+        #endif
+        static pid_value_t Kp_fixed[PID_GAIN_SETS], Ki_fixed[PID_GAIN_SETS], Kd_fixed[PID_GAIN_SETS];
+        #define PID_GAIN(param, s) Temperature::param##_fixed[(PID_GAIN_SETS) > 1 ? (s) : 0]
+      #else
+        #define PID_GAIN(param, s) PID_PARAM(param, s)
+      #endif
+
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        static float Kf[HOTENDS];           // PID output per mm³/s of flow
+      #endif
+
       // Apply the scale factors to the PID values
       #define scalePID_i(i)   ( (i) * PID_dT )
       #define unscalePID_i(i) ( (i) / PID_dT )
@@ -181,10 +301,16 @@ class Temperature {
 
     #if ENABLED(PIDTEMPBED)
       static float bedKp, bedKi, bedKd;
+      #if ENABLED(PID_FIXED_POINT)
+        static pid_value_t bedKp_fixed, bedKi_fixed, bedKd_fixed;
+      #endif
     #endif
 
     #if ENABLED(PIDTEMP_CHAMBER)
       static float chamberKp, chamberKi, chamberKd;
+      #if ENABLED(PID_FIXED_POINT)
+        static pid_value_t chamberKp_fixed, chamberKi_fixed, chamberKd_fixed;
+      #endif
     #endif
 
     #if ENABLED(BABYSTEPPING)
@@ -231,11 +357,11 @@ class Temperature {
     static volatile bool temp_meas_ready;
 
     #if ENABLED(PIDTEMP)
-      static float temp_iState[HOTENDS],
-                   temp_dState[HOTENDS],
-                   pTerm[HOTENDS],
-                   iTerm[HOTENDS],
-                   dTerm[HOTENDS];
+      static pid_value_t temp_iState[HOTENDS],
+                         temp_dState[HOTENDS],
+                         pTerm[HOTENDS],
+                         iTerm[HOTENDS],
+                         dTerm[HOTENDS];
 
       #if ENABLED(PID_EXTRUSION_SCALING)
         static float cTerm[HOTENDS];
@@ -244,28 +370,39 @@ class Temperature {
         static int lpq_ptr;
       #endif
 
-      static float pid_error[HOTENDS];
+      #if ENABLED(PID_EXTRUSION_FEEDFORWARD)
+        static float fTerm[HOTENDS];
+      #endif
+
+      static pid_value_t pid_error[HOTENDS];
       static bool pid_reset[HOTENDS];
     #endif
 
     #if ENABLED(PIDTEMPBED)
-      static float temp_iState_bed,
-                   temp_dState_bed,
-                   pTerm_bed,
-                   iTerm_bed,
-                   dTerm_bed,
-                   pid_error_bed;
+      static pid_value_t temp_iState_bed,
+                         temp_dState_bed,
+                         pTerm_bed,
+                         iTerm_bed,
+                         dTerm_bed,
+                         pid_error_bed;
     #else
       static millis_t next_bed_check_ms;
     #endif
 
+    #if ENABLED(MPCTEMP)
+      static float mpc_block_temp[HOTENDS],   // Modeled heater block temperature
+                   mpc_sensor_temp[HOTENDS],  // Modeled sensor temperature
+                   mpc_ambient_temp[HOTENDS]; // Estimated ambient temperature
+      static bool mpc_model_valid[HOTENDS];
+    #endif
+
     #if ENABLED(PIDTEMP_CHAMBER)
-      static float temp_iState_chamber,
-                   temp_dState_chamber,
-                   pTerm_chamber,
-                   iTerm_chamber,
-                   dTerm_chamber,
-                   pid_error_chamber;
+      static pid_value_t temp_iState_chamber,
+                         temp_dState_chamber,
+                         pTerm_chamber,
+                         iTerm_chamber,
+                         dTerm_chamber,
+                         pid_error_chamber;
       static bool pid_reset_chamber;
     #endif
 
@@ -273,6 +410,13 @@ class Temperature {
                     raw_temp_bed_value,
 										raw_temp_chamber_value;
 
+    #if ENABLED(ADC_IIR_FILTER)
+      static uint16_t adc_filter[ADC_CHANNELS];   // Filtered readings << ADC_IIR_FRACTION
+      static uint8_t adc_schedule[ADC_CHANNELS * 8], // Channel of each conversion in a round
+                     adc_schedule_length,
+                     adc_schedule_index;
+    #endif
+
     // Init min and max temp with extreme values to prevent false errors during startup
     static int16_t minttemp_raw[HOTENDS],
                    maxttemp_raw[HOTENDS],
@@ -354,6 +498,13 @@ class Temperature {
      */
     static void isr();
 
+    #if ENABLED(ADC_IIR_FILTER)
+      /**
+       * Called from the ADC conversion complete ISR
+       */
+      static void adc_isr();
+    #endif
+
     /**
      * Call periodically to manage heaters
      */
@@ -540,6 +691,13 @@ class Temperature {
       static void PID_autotune_Chamber(float temp);
     #endif
 
+    /**
+     * Identify the thermal model of a hotend in response to M306 T
+     */
+    #if ENABLED(MPCTEMP)
+      static void MPC_autotune(const uint8_t e, const int16_t temp);
+    #endif
+
     /**
      * Update the temp manager when PID values change
      */
@@ -635,6 +793,10 @@ class Temperature {
 
     static void set_current_temp_raw();
 
+    #if ENABLED(ADC_IIR_FILTER)
+      static void adc_init();
+    #endif
+
     static void updateTemperaturesFromRawValues();
 
     #if ENABLED(HEATER_0_USES_MAX6675)
@@ -645,6 +807,11 @@ class Temperature {
 
     static float get_pid_output(const int8_t e);
 
+    #if ENABLED(MPCTEMP)
+      static float get_mpc_output(const uint8_t e);
+      static bool mpc_autotune_wait(const bool hold);
+    #endif
+
     #if ENABLED(PIDTEMPBED)
       static float get_pid_output_bed();
     #endif
@@ -653,6 +820,15 @@ class Temperature {
       static float get_pid_output_chamber();
     #endif
 
+    #if ENABLED(HEATER_POWER_BUDGET)
+      static uint8_t pwm_request[HOTENDS],  // Power the heaters ask for, before the budget
+                     pwm_request_bed,
+                     pwm_request_chamber,
+                     budget_held,           // Heaters held back on the last update, one bit each
+                     budget_starved;        // Held back to no power at all
+      static void apply_power_budget();
+    #endif
+
     static void _temp_error(const int8_t e, const char * const serial_msg, const char * const lcd_msg);
     static void min_temp_error(const int8_t e);
     static void max_temp_error(const int8_t e);
@@ -678,6 +854,30 @@ class Temperature {
 
     #endif // THERMAL_PROTECTION
 
+    #if ENABLED(PID_FEEDFORWARD_LEARN)
+      typedef struct {
+        float flow, power;                    // Sums over the window
+        uint16_t count;                       // Updates in the window
+        bool valid;                           // In the PID band the whole window
+        int16_t target;
+        float weight,                         // Regression of the window means
+              mean_flow, mean_power,
+              sxx, sxy;
+      } ff_learn_t;
+
+      static ff_learn_t ff_learn[HOTENDS];
+      static void feedforward_learn(const uint8_t e, const float output, const bool valid);
+    #endif
+
+    #if ENABLED(THERMAL_PROTECTION_MODEL)
+      static float tm_block_temp[HOTENDS],    // Modeled heater block temperature
+                   tm_sensor_temp[HOTENDS],   // Modeled sensor temperature
+                   tm_heat_flows[HOTENDS];    // (W) Recent heat flows of the model
+      static uint16_t tm_fail_count[HOTENDS]; // Updates in a row off the model
+      static millis_t thermal_model_ms;       // Last update
+      static void thermal_model_protection(const uint8_t e, const bool restart);
+    #endif
+
 };
 
 extern Temperature thermalManager;
@@ -0,0 +1,353 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * toolchange_preheat.cpp - Heat the next tool before its tool change
+ */
+
+#include "Marlin.h"
+
+#if ENABLED(TOOLCHANGE_PREHEAT)
+
+#include "toolchange_preheat.h"
+#include "temperature.h"
+#include "planner.h"
+
+ToolchangePreheat toolchange_preheat;
+
+uint32_t ToolchangePreheat::scan_index;
+millis_t ToolchangePreheat::scan_start_ms,
+         ToolchangePreheat::next_update_ms,
+         ToolchangePreheat::rescan_ms,
+         ToolchangePreheat::preheat_due_ms;
+float ToolchangePreheat::scan_time,
+      ToolchangePreheat::scan_position[XYZE],
+      ToolchangePreheat::scan_feedrate_mm_s;
+bool ToolchangePreheat::scan_relative,
+     ToolchangePreheat::scan_relative_e,
+     ToolchangePreheat::comment,
+     ToolchangePreheat::waiting;
+char ToolchangePreheat::line[MAX_CMD_SIZE];
+uint8_t ToolchangePreheat::line_length;
+
+int8_t ToolchangePreheat::next_tool = -1;
+bool ToolchangePreheat::after_next_tool;
+int16_t ToolchangePreheat::next_tool_temp,
+        ToolchangePreheat::scan_temp[HOTENDS],
+        ToolchangePreheat::standby_saved_temp[HOTENDS];
+bool ToolchangePreheat::standby[HOTENDS],
+     ToolchangePreheat::reheated[HOTENDS];
+
+static const char axis_letters[XYZE] = { 'X', 'Y', 'Z', 'E' };
+static const float preheat_rate[] = TOOLCHANGE_PREHEAT_RATE;
+static_assert(COUNT(preheat_rate) >= HOTENDS, "TOOLCHANGE_PREHEAT_RATE needs a rate for each hotend.");
+
+// Find 'code' in the line and read the number after it
+static bool seen_value(const char * const p, const char code, float &value) {
+  const char * const c = strchr(p, code);
+  if (!c) return false;
+  value = strtod(c + 1, NULL);
+  return true;
+}
+
+void ToolchangePreheat::update(const bool relative) {
+  if (!FILE_IS_PRINT) {
+    if (FILE_IS_IDLE) {
+      // The print is over: forget the scan and any standby
+      scan_index = 0;
+      waiting = false;
+      next_tool = -1;
+      HOTEND_LOOP() standby[e] = reheated[e] = false;
+    }
+    return;
+  }
+
+  const millis_t ms = millis();
+  if (PENDING(ms, next_update_ms)) return;
+  next_update_ms = ms + TOOLCHANGE_PREHEAT_INTERVAL;
+
+  // A nozzle set to another temperature by the print itself is no longer in standby
+  HOTEND_LOOP()
+    if (standby[e] && thermalManager.degTargetHotend(e) != TOOLCHANGE_STANDBY_TEMP) standby[e] = false;
+
+  // Nothing found within the horizon: look again once the print has moved on
+  if (waiting && rescan_ms && ELAPSED(ms, rescan_ms)) {
+    waiting = false;
+    scan_index = 0;
+  }
+
+  if (!waiting) {
+    // The reader stops after a newline, so the scan starts at a line boundary.
+    // If the print has caught up with the scan, start again from the print.
+    const uint32_t read_index = FILE_READER.getSdPos();
+    if (!scan_index || read_index >= scan_index) {
+      if (after_next_tool) finish_scan(true, false); else restart(relative);
+    }
+  }
+
+  if (!waiting) {
+    // Read on to the end of the 512-byte block, so that the reader loads it
+    // once and the print's own block is reloaded once per update.
+    const uint32_t block_end = (scan_index | 0x1FF) + 1;
+    char buf[TOOLCHANGE_PREHEAT_CHUNK];
+    do {
+      const int16_t len = min(uint32_t(COUNT(buf)), block_end - scan_index),
+                    n = FILE_READER.readAhead(scan_index, buf, len);
+      if (n < 0) {
+        scan_index = 0; // Try again from the print position
+        return;
+      }
+      scan_index += n;
+      for (int16_t i = 0; i < n && !waiting; i++) {
+        const char c = buf[i];
+        if (c == '\n' || c == '\r') {
+          if (line_length) {
+            line[line_length] = '\0';
+            parse_line();
+            line_length = 0;
+          }
+          comment = false;
+        }
+        else if (c == ';')
+          comment = true;
+        else if (!comment && line_length < MAX_CMD_SIZE - 1 && (line_length || c != ' '))
+          line[line_length++] = c;
+      }
+      if (!waiting) {
+        if (n < len)
+          finish_scan(after_next_tool, true);
+        else if (!after_next_tool && scan_time > TOOLCHANGE_PREHEAT_HORIZON)
+          finish_scan(false, false);
+      }
+    } while (!waiting && scan_index < block_end);
+  }
+
+  check_preheat();
+}
+
+void ToolchangePreheat::tool_change(const uint8_t tool) {
+  scan_index = 0;
+  next_tool = -1;
+  after_next_tool = false;
+  if (tool < HOTENDS) {
+    // The preheat may have started late, or not at all (TOOLCHANGE_PREHEAT_MAX_HEATING).
+    // A nozzle still near TOOLCHANGE_STANDBY_TEMP would have its E moves dropped as cold extrusion.
+    if (standby[tool] || reheated[tool]) {
+      leave_standby(tool);
+      waiting = true; // No reading ahead while the tool changes
+      wait_for_nozzle(tool);
+    }
+    reheated[tool] = false;
+  }
+  waiting = false;
+}
+
+/**
+ * Start reading ahead from the print position. The moves read will run after
+ * those already in the planner.
+ */
+void ToolchangePreheat::restart(const bool relative) {
+  scan_index = FILE_READER.getSdPos();
+  rescan_ms = 0;
+  scan_start_ms = millis() + planner.block_buffer_runtime();
+  scan_time = 0;
+  COPY(scan_position, current_position);
+  scan_feedrate_mm_s = feedrate_mm_s;
+  scan_relative = relative;
+  scan_relative_e = relative || axis_relative_modes[E_AXIS];
+  comment = false;
+  line_length = 0;
+  next_tool = -1;
+  after_next_tool = false;
+  HOTEND_LOOP() scan_temp[e] = 0;
+}
+
+/**
+ * Add up the time of the moves and look for the next T command, and for
+ * M104/M109 that set its temperature just before or after it.
+ */
+void ToolchangePreheat::parse_line() {
+  float value;
+  const char letter = line[0];
+  const int code = atoi(line + 1);
+
+  if (after_next_tool) {
+    // The lines up to the first move after the T command can set its temperature
+    if (letter == 'G' && code <= 3)
+      finish_scan(true, false);
+    else if (letter == 'M' && (code == 104 || code == 109) && !strchr(line, 'T') && seen_value(line, 'S', value))
+      next_tool_temp = value;
+    return;
+  }
+
+  switch (letter) {
+    case 'T':
+      if (code < HOTENDS && code != active_extruder) {
+        next_tool = code;
+        next_tool_temp = scan_temp[code];
+        after_next_tool = true;
+        preheat_due_ms = scan_start_ms + millis_t(scan_time * 1000);
+      }
+      break;
+
+    case 'G':
+      switch (code) {
+        case 0: case 1: case 2: case 3: {
+          // Arcs are counted as their chord, acceleration is ignored
+          float distance = 0;
+          if (seen_value(line, 'F', value) && value > 0) scan_feedrate_mm_s = MMM_TO_MMS(value);
+          LOOP_XYZ(i) {
+            if (seen_value(line, axis_letters[i], value)) {
+              const float target = scan_relative ? scan_position[i] + value : value;
+              distance += sq(target - scan_position[i]);
+              scan_position[i] = target;
+            }
+          }
+          distance = SQRT(distance);
+          if (seen_value(line, 'E', value)) {
+            const float e_target = scan_relative_e ? scan_position[E_AXIS] + value : value;
+            if (distance < 0.001) distance = FABS(e_target - scan_position[E_AXIS]);
+            scan_position[E_AXIS] = e_target;
+          }
+          if (scan_feedrate_mm_s > 0) scan_time += distance / MMS_SCALED(scan_feedrate_mm_s);
+        } break;
+        case 4:
+          if (seen_value(line, 'S', value)) scan_time += value;
+          else if (seen_value(line, 'P', value)) scan_time += value * 0.001;
+          break;
+        case 90: scan_relative = false; scan_relative_e = axis_relative_modes[E_AXIS]; break;
+        case 91: scan_relative = scan_relative_e = true; break;
+        case 92: LOOP_XYZE(i) if (seen_value(line, axis_letters[i], value)) scan_position[i] = value; break;
+      }
+      break;
+
+    case 'M':
+      switch (code) {
+        case 82: scan_relative_e = false; break;
+        case 83: scan_relative_e = true; break;
+        case 104: case 109: {
+          float tool;
+          if (seen_value(line, 'T', tool) && tool < HOTENDS && seen_value(line, 'S', value)) scan_temp[int(tool)] = value;
+        } break;
+      }
+      break;
+  }
+}
+
+/**
+ * The scan is over: the next tool change was found, the file ended, or the
+ * scan went past TOOLCHANGE_PREHEAT_HORIZON. Nozzles that won't be needed
+ * for long go to standby.
+ */
+void ToolchangePreheat::finish_scan(const bool found, const bool eof) {
+  after_next_tool = false;
+  const float until_scan_s = (int32_t(scan_start_ms - millis()) * 0.001) + scan_time,
+              next_use_s = found ? (int32_t(preheat_due_ms - millis()) * 0.001) : eof ? 1e6 : until_scan_s;
+
+  // Other nozzles aren't used before the next tool change either
+  HOTEND_LOOP() if (e != active_extruder) set_standby(e, next_use_s);
+
+  // Wait for the tool change or the end of the print. Past the horizon the
+  // estimate gets worse, so read again when half of it has been printed.
+  waiting = true;
+  if (!found && !eof) rescan_ms = millis() + (TOOLCHANGE_PREHEAT_HORIZON) * 500UL;
+}
+
+void ToolchangePreheat::check_preheat() {
+  if (next_tool < 0) return;
+  const uint8_t tool = next_tool;
+  const int16_t temp = standby[tool] ? standby_saved_temp[tool] : next_tool_temp;
+  if (!temp) return;                                            // Nothing known to heat to
+  if (thermalManager.degTargetHotend(tool) >= temp && !standby[tool]) { next_tool = -1; return; }
+
+  // Don't add to the load while too many hotends heat at once
+  uint8_t heating = 0;
+  HOTEND_LOOP()
+    if (thermalManager.degTargetHotend(e) > thermalManager.degHotend(e) + TEMP_HYSTERESIS) heating++;
+  if (heating >= TOOLCHANGE_PREHEAT_MAX_HEATING) return;
+
+  const millis_t start_ms = preheat_due_ms - millis_t((heatup_time(tool, temp) + TOOLCHANGE_PREHEAT_MARGIN) * 1000);
+  if (ELAPSED(millis(), start_ms)) {
+    if (standby[tool]) reheated[tool] = true;
+    standby[tool] = false;
+    thermalManager.setTargetHotend(temp, tool);
+    next_tool = -1;
+    SERIAL_ECHO_START();
+    SERIAL_ECHOLNPAIR("Preheat T", int(tool));
+  }
+}
+
+/**
+ * Drop a nozzle to TOOLCHANGE_STANDBY_TEMP if it won't be used for at least
+ * TOOLCHANGE_STANDBY_TIME after reheating from there.
+ */
+void ToolchangePreheat::set_standby(const uint8_t e, const float next_use_s) {
+  if (standby[e]) return;
+  const int16_t temp = thermalManager.degTargetHotend(e);
+  if (temp <= TOOLCHANGE_STANDBY_TEMP) return;
+  if (next_use_s - (temp - (TOOLCHANGE_STANDBY_TEMP)) / preheat_rate[e] < TOOLCHANGE_STANDBY_TIME) return;
+  standby_saved_temp[e] = temp;
+  standby[e] = true;
+  thermalManager.setTargetHotend(TOOLCHANGE_STANDBY_TEMP, e);
+  SERIAL_ECHO_START();
+  SERIAL_ECHOLNPAIR("Standby T", int(e));
+}
+
+void ToolchangePreheat::leave_standby(const uint8_t e) {
+  if (!standby[e]) return;
+  standby[e] = false;
+  thermalManager.setTargetHotend(standby_saved_temp[e], e);
+}
+
+// Wait like M109 for a nozzle to reach its target. M108 stops waiting.
+void ToolchangePreheat::wait_for_nozzle(const uint8_t e) {
+  if (DEBUGGING(DRYRUN)) return;
+
+  #if DISABLED(BUSY_WHILE_HEATING)
+    KEEPALIVE_STATE(NOT_BUSY);
+  #endif
+
+  wait_for_heatup = true;
+  millis_t next_temp_ms = 0;
+  while (wait_for_heatup && thermalManager.degHotend(e) < thermalManager.degTargetHotend(e) - (TEMP_WINDOW)) {
+    const millis_t now = millis();
+    if (ELAPSED(now, next_temp_ms)) { // Print temps every 1s while waiting
+      next_temp_ms = now + 1000UL;
+      print_heaterstates();
+      SERIAL_EOL();
+    }
+    idle();
+    refresh_cmd_timeout(); // to prevent stepper_inactive_time from running out
+  }
+
+  #if DISABLED(BUSY_WHILE_HEATING)
+    KEEPALIVE_STATE(IN_HANDLER);
+  #endif
+}
+
+// Seconds for a nozzle to reach 'temp' at its TOOLCHANGE_PREHEAT_RATE
+float ToolchangePreheat::heatup_time(const uint8_t e, const int16_t temp) {
+  const float rise = temp - thermalManager.degHotend(e);
+  return rise > 0 ? rise / preheat_rate[e] : 0;
+}
+
+#endif // TOOLCHANGE_PREHEAT
@@ -0,0 +1,90 @@
+/**
+ * Marlin 3D Printer Firmware
+ * Copyright (C) 2016 MarlinFirmware [https://github.com/MarlinFirmware/Marlin]
+ *
+ * Based on Sprinter and grbl.
+ * Copyright (C) 2011 Camiel Gubbels / Erik van der Zalm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * toolchange_preheat.h - Heat the next tool before its tool change
+ *
+ * While a file prints, the file is read ahead a block at a time for the
+ * next T command. The moves read on the way give the time until it comes, and
+ * the nozzle is heated early enough to be hot by then. Nozzles that won't be
+ * used for a while are dropped to a standby temperature.
+ */
+
+#ifndef TOOLCHANGE_PREHEAT_H
+#define TOOLCHANGE_PREHEAT_H
+
+#include "MarlinConfig.h"
+
+class ToolchangePreheat {
+
+  public:
+
+    /**
+     * Read the next piece of the file and start or stop heaters as needed.
+     * Call often while printing; it limits itself to TOOLCHANGE_PREHEAT_INTERVAL.
+     * 'relative' is the G91 state of the command being executed.
+     */
+    static void update(const bool relative);
+
+    /**
+     * Call before switching to 'tool'. Restores its temperature if it is
+     * in standby, waits for a nozzle back from standby to reach it, and
+     * starts looking for the next tool change.
+     */
+    static void tool_change(const uint8_t tool);
+
+  private:
+
+    static uint32_t scan_index;       // Next file byte to read ahead, 0 to start from the print
+    static millis_t scan_start_ms,    // When the scan started, plus the queued moves then
+                    next_update_ms,
+                    rescan_ms,        // When to read again after a scan without a tool change
+                    preheat_due_ms;   // When the next tool change is expected
+    static float scan_time,           // Seconds of moves read since the scan started
+                 scan_position[XYZE],
+                 scan_feedrate_mm_s;
+    static bool scan_relative, scan_relative_e, comment,
+                waiting;              // Scan done, wait for the tool change, the end of the file or rescan_ms
+    static char line[MAX_CMD_SIZE];
+    static uint8_t line_length;
+
+    static int8_t next_tool;          // Tool of the next T command, -1 if none found yet
+    static bool after_next_tool;      // Reading the lines just after it
+    static int16_t next_tool_temp,    // Its temperature from M104/M109 near the T command
+                   scan_temp[HOTENDS], // M104/M109 T<n> temperatures read so far
+                   standby_saved_temp[HOTENDS];
+    static bool standby[HOTENDS],
+                reheated[HOTENDS];    // Preheated from standby, not yet waited for
+
+    static void restart(const bool relative);
+    static void parse_line();
+    static void finish_scan(const bool found, const bool eof);
+    static void check_preheat();
+    static void set_standby(const uint8_t e, const float next_use_s);
+    static void leave_standby(const uint8_t e);
+    static void wait_for_nozzle(const uint8_t e);
+    static float heatup_time(const uint8_t e, const int16_t temp);
+};
+
+extern ToolchangePreheat toolchange_preheat;
+
+#endif // TOOLCHANGE_PREHEAT_H
@@ -137,8 +137,8 @@
         static bool exit_from_g26();
         static bool parse_G26_parameters();
         static void G26_line_to_destination(const float &feed_rate);
-        static mesh_index_pair find_closest_circle_to_print(const float&, const float&);
-        static bool look_for_lines_to_connect();
+        static bool look_for_lines_to_connect(const uint8_t, const uint8_t);
+        static void connect_circles(const uint8_t, const uint8_t, const bool);
         static bool turn_on_heaters();
         static bool prime_nozzle();
         static void retract_filament(const float where[XYZE]);
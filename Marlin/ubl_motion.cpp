@@ -207,273 +207,90 @@
     }
 
     /**
-     * If we get here, we are processing a move that crosses at least one Mesh Line. We will check
-     * for the simple case of just crossing X or just crossing Y Mesh Lines after we get all the details
-     * of the move figured out. We can process the easy case of just crossing an X or Y Mesh Line with less
-     * computation and in fact most lines are of this nature. We will check for that in the following
-     * blocks of code:
+     * If we get here, we are processing a move that crosses at least one Mesh Line. The X and Y
+     * Mesh Line crossings are taken in order of their fraction along the move, and a piece of the
+     * move is buffered at each. The Mesh Lines are evenly spaced, so after the first crossing on
+     * each axis the next one is a fixed step further along the move. The fractions are kept in
+     * fixed point, so there is no divide and no float compare for each crossing, and the steps
+     * don't add up rounding errors on long moves.
      */
 
-    const float dx = end[X_AXIS] - start[X_AXIS],
-                dy = end[Y_AXIS] - start[Y_AXIS];
+    #define UBL_T_ONE 16777216UL  // A whole move, in fixed point
 
-    const int left_flag = dx < 0.0 ? 1 : 0,
-              down_flag = dy < 0.0 ? 1 : 0;
+    const int8_t sx = cell_dest_xi > cell_start_xi ? 1 : -1,
+                 sy = cell_dest_yi > cell_start_yi ? 1 : -1;
 
-    const float adx = left_flag ? -dx : dx,
-                ady = down_flag ? -dy : dy;
+    int8_t gx = sx > 0 ? cell_start_xi + 1 : cell_start_xi,   // The Mesh Lines crossed next: the left/front
+           gy = sy > 0 ? cell_start_yi + 1 : cell_start_yi,   // border of the right/back cell
+           cy = cell_start_yi;                                // The Y cell at each X crossing
+    uint8_t nx = abs(cell_dest_xi - cell_start_xi),
+            ny = abs(cell_dest_yi - cell_start_yi);
 
-    const int dxi = cell_start_xi == cell_dest_xi ? 0 : left_flag ? -1 : 1,
-              dyi = cell_start_yi == cell_dest_yi ? 0 : down_flag ? -1 : 1;
+    float dist[XYZE];
+    LOOP_XYZE(i) dist[i] = end[i] - start[i];
 
-    /**
-     * Compute the scaling factor for the extruder for each partial move.
-     * We need to watch out for zero length moves because it will cause us to
-     * have an infinate scaling factor. We are stuck doing a floating point
-     * divide to get our scaling factor, but after that, we just multiply by this
-     * number. We also pick our scaling factor based on whether the X or Y
-     * component is larger. We use the biggest of the two to preserve precision.
-     */
-
-    const bool use_x_dist = adx > ady;
-
-    float on_axis_distance = use_x_dist ? dx : dy,
-          e_position = end[E_AXIS] - start[E_AXIS],
-          z_position = end[Z_AXIS] - start[Z_AXIS];
-
-    const float e_normalized_dist = e_position / on_axis_distance,
-                z_normalized_dist = z_position / on_axis_distance;
-
-    int current_xi = cell_start_xi,
-        current_yi = cell_start_yi;
-
-    const float m = dy / dx,
-                c = start[Y_AXIS] - m * start[X_AXIS];
-
-    const bool inf_normalized_flag = (isinf(e_normalized_dist) != 0),
-               inf_m_flag = (isinf(m) != 0);
-    /**
-     * This block handles vertical lines. These are lines that stay within the same
-     * X Cell column. They do not need to be perfectly vertical. They just can
-     * not cross into another X Cell column.
-     */
-    if (dxi == 0) {       // Check for a vertical line
-      current_yi += down_flag;  // Line is heading down, we just want to go to the bottom
-      while (current_yi != cell_dest_yi + down_flag) {
-        current_yi += dyi;
-        const float next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
-
-        /**
-         * if the slope of the line is infinite, we won't do the calculations
-         * else, we know the next X is the same so we can recover and continue!
-         * Calculate X at the next Y mesh line
-         */
-        const float x = inf_m_flag ? start[X_AXIS] : (next_mesh_line_y - c) / m;
-
-        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi, current_yi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        const float y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
-
-        /**
-         * Without this check, it is possible for the algorithm to generate a zero length move in the case
-         * where the line is heading down and it is starting right on a Mesh Line boundary. For how often that
-         * happens, it might be best to remove the check and always 'schedule' the move because
-         * the planner._buffer_line() routine will filter it if that happens.
-         */
-        if (y != start[Y_AXIS]) {
-          if (!inf_normalized_flag) {
-            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
-            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-          }
-          else {
-            e_position = end[E_AXIS];
-            z_position = end[Z_AXIS];
-          }
-
-          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        } //else printf("FIRST MOVE PRUNED  ");
-      }
-
-      if (g26_debug_flag)
-        debug_current_and_destination(PSTR("vertical move done in ubl.line_to_destination()"));
-
-      //
-      // Check if we are at the final destination. Usually, we won't be, but if it is on a Y Mesh Line, we are done.
-      //
-      if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
-        goto FINAL_MOVE;
-
-      set_current_to_destination();
-      return;
+    // Fraction of the move at the first crossing on each axis, and from one crossing to the next
+    uint32_t tx = UBL_T_ONE + 1, ty = UBL_T_ONE + 1, tx_step = 0, ty_step = 0;
+    if (nx) {
+      const float t = (LOGICAL_X_POSITION(mesh_index_to_xpos(gx)) - start[X_AXIS]) / dist[X_AXIS] * UBL_T_ONE;
+      tx = t > 0 ? t : 0; // A start on the Mesh Line can come out a hair below 0
+      if (nx > 1) tx_step = (MESH_X_DIST) / FABS(dist[X_AXIS]) * UBL_T_ONE;
+    }
+    if (ny) {
+      const float t = (LOGICAL_Y_POSITION(mesh_index_to_ypos(gy)) - start[Y_AXIS]) / dist[Y_AXIS] * UBL_T_ONE;
+      ty = t > 0 ? t : 0;
+      if (ny > 1) ty_step = (MESH_Y_DIST) / FABS(dist[Y_AXIS]) * UBL_T_ONE;
     }
 
-    /**
-     *
-     * This block handles horizontal lines. These are lines that stay within the same
-     * Y Cell row. They do not need to be perfectly horizontal. They just can
-     * not cross into another Y Cell row.
-     *
-     */
+    const float fade_scaling_factor = fade_scaling_factor_for_z(end[Z_AXIS]);
 
-    if (dyi == 0) {             // Check for a horizontal line
-      current_xi += left_flag;  // Line is heading left, we just want to go to the left
-                                // edge of this cell for the first move.
-      while (current_xi != cell_dest_xi + left_flag) {
-        current_xi += dxi;
-        const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi)),
-                    y = m * next_mesh_line_x + c;   // Calculate Y at the next X mesh line
-
-        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi, current_yi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        const float x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi));
-
-        /**
-         * Without this check, it is possible for the algorithm to generate a zero length move in the case
-         * where the line is heading left and it is starting right on a Mesh Line boundary. For how often
-         * that happens, it might be best to remove the check and always 'schedule' the move because
-         * the planner._buffer_line() routine will filter it if that happens.
-         */
-        if (x != start[X_AXIS]) {
-          if (!inf_normalized_flag) {
-            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
-            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;  // is based on X or Y because this is a horizontal move
-            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-          }
-          else {
-            e_position = end[E_AXIS];
-            z_position = end[Z_AXIS];
-          }
+    while (nx || ny) {
+      const uint32_t t = min(tx, ty);
+      const float normalized_dist = t * (1.0 / (UBL_T_ONE));
+      float x, y, z0;
 
-          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        } //else printf("FIRST MOVE PRUNED  ");
+      /**
+       * The crossing is on the Mesh Line, so only the other coordinate is interpolated,
+       * and not even that on a move along a Mesh Line.
+       * The correction on a Mesh Line is the linear interpolation between its two Mesh Points.
+       * If part of the Mesh is undefined, it will show up as NAN in z_values[][] and propagate
+       * through the calculations. If our correction is NAN, we throw it out because part of the
+       * Mesh is undefined and we don't have the information we need to complete the height correction.
+       */
+      if (tx <= t) {
+        x = LOGICAL_X_POSITION(mesh_index_to_xpos(gx));
+        y = ty <= t ? LOGICAL_Y_POSITION(mesh_index_to_ypos(gy))          // A crossing at a Mesh Point
+                    : dist[Y_AXIS] ? start[Y_AXIS] + dist[Y_AXIS] * normalized_dist : start[Y_AXIS];
+        z0 = z_correction_for_y_on_vertical_mesh_line(y, gx, cy);
       }
+      else {
+        x = dist[X_AXIS] ? start[X_AXIS] + dist[X_AXIS] * normalized_dist : start[X_AXIS];
+        y = LOGICAL_Y_POSITION(mesh_index_to_ypos(gy));
+        z0 = z_correction_for_x_on_horizontal_mesh_line(x, gx - (sx > 0), gy);
+      }
+      z0 *= fade_scaling_factor;
+      if (isnan(z0)) z0 = 0.0;
 
-      if (g26_debug_flag)
-        debug_current_and_destination(PSTR("horizontal move done in ubl.line_to_destination()"));
-
-      if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
-        goto FINAL_MOVE;
-
-      set_current_to_destination();
-      return;
-    }
-
-    /**
-     *
-     * This block handles the generic case of a line crossing both X and Y Mesh lines.
-     *
-     */
+      // A move starting on a Mesh Line crosses it first, with nothing to buffer
+      if (t) planner._buffer_line(x, y, start[Z_AXIS] + dist[Z_AXIS] * normalized_dist + z0 + state.z_offset,
+                                  start[E_AXIS] + dist[E_AXIS] * normalized_dist, feed_rate, extruder);
 
-    int xi_cnt = cell_start_xi - cell_dest_xi,
-        yi_cnt = cell_start_yi - cell_dest_yi;
-
-    if (xi_cnt < 0) xi_cnt = -xi_cnt;
-    if (yi_cnt < 0) yi_cnt = -yi_cnt;
-
-    current_xi += left_flag;
-    current_yi += down_flag;
-
-    while (xi_cnt > 0 || yi_cnt > 0) {
-
-      const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi + dxi)),
-                  next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi + dyi)),
-                  y = m * next_mesh_line_x + c,   // Calculate Y at the next X mesh line
-                  x = (next_mesh_line_y - c) / m; // Calculate X at the next Y mesh line
-                                                  // (No need to worry about m being zero.
-                                                  //  If that was the case, it was already detected
-                                                  //  as a vertical line move above.)
-
-      if (left_flag == (x > next_mesh_line_x)) { // Check if we hit the Y line first
-        // Yes!  Crossing a Y Mesh Line next
-        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi - left_flag, current_yi + dyi);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        if (!inf_normalized_flag) {
-          on_axis_distance = use_x_dist ? x - start[X_AXIS] : next_mesh_line_y - start[Y_AXIS];
-          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-        }
-        else {
-          e_position = end[E_AXIS];
-          z_position = end[Z_AXIS];
-        }
-        planner._buffer_line(x, next_mesh_line_y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        current_yi += dyi;
-        yi_cnt--;
+      // A crossing at a Mesh Point advances both axes
+      if (tx <= t) {
+        gx += sx;
+        tx = --nx ? tx + tx_step : UBL_T_ONE + 1;
       }
-      else {
-        // Yes!  Crossing a X Mesh Line next
-        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi + dxi, current_yi - down_flag);
-
-        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
-
-        /**
-         * If part of the Mesh is undefined, it will show up as NAN
-         * in z_values[][] and propagate through the
-         * calculations. If our correction is NAN, we throw it out
-         * because part of the Mesh is undefined and we don't have the
-         * information we need to complete the height correction.
-         */
-        if (isnan(z0)) z0 = 0.0;
-
-        if (!inf_normalized_flag) {
-          on_axis_distance = use_x_dist ? next_mesh_line_x - start[X_AXIS] : y - start[Y_AXIS];
-          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
-          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
-        }
-        else {
-          e_position = end[E_AXIS];
-          z_position = end[Z_AXIS];
-        }
-
-        planner._buffer_line(next_mesh_line_x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
-        current_xi += dxi;
-        xi_cnt--;
+      if (ty <= t) {
+        cy += sy;
+        gy += sy;
+        ty = --ny ? ty + ty_step : UBL_T_ONE + 1;
       }
-
-      if (xi_cnt < 0 || yi_cnt < 0) break; // we've gone too far, so exit the loop and move on to FINAL_MOVE
     }
 
     if (g26_debug_flag)
-      debug_current_and_destination(PSTR("generic move done in ubl.line_to_destination()"));
-
-    if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
-      goto FINAL_MOVE;
+      debug_current_and_destination(PSTR("split move done in ubl.line_to_destination()"));
 
-    set_current_to_destination();
+    goto FINAL_MOVE;
   }
 
   #if UBL_DELTA
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+
+""" Compare the ADC oversampling of the temperature ISR with ADC_IIR_FILTER.
+
+A sensor channel reads a constant ADC value with gaussian noise, which steps
+up by a given amount. Both pipelines are run with the integer math of the
+firmware and the temperatures they hand to manage_heater() are recorded:
+  oversample  the default state machine: one conversion per channel every
+              ACTUAL_ADC_SAMPLES ISR calls, summed over OVERSAMPLENR rounds
+  iir         ADC_IIR_FILTER: one conversion per timer 0 overflow, shared
+              out by priority, each channel with its exponential filter,
+              copied out every ADC_READY_LOOPS ms
+
+Printed per pipeline: the update period, the time after the step until the
+reported value is 63% and 95% of the way, and the noise (standard deviation)
+of the reported value before the step, all in OVERSAMPLENR units.
+Exits with status 1 if the filter is slower to 63% than the oversampling.
+
+Example:
+  adcFilterSim.py
+  adcFilterSim.py --noise 4 --shift 3 --channels 4 2 1 1
+"""
+
+import argparse
+import random
+import statistics
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--adc', type=int, default=500, help='ADC reading before the step (default=500)')
+parser.add_argument('--step', type=int, default=40, help='ADC step (default=40)')
+parser.add_argument('--noise', type=float, default=2.0, help='ADC noise sigma in counts (default=2.0)')
+parser.add_argument('--shift', type=int, default=4, help='ADC_IIR_SHIFT (default=4)')
+parser.add_argument('--ready', type=int, default=82, help='ADC_READY_LOOPS (default=82)')
+parser.add_argument('--priority', type=int, default=4, help='ADC_PRIORITY of the simulated channel (default=4)')
+parser.add_argument('--channels', type=int, nargs='*', default=[4, 2, 1], help='priorities of the other channels (default=4 2 1, i.e. T1, bed, chamber)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+args = parser.parse_args()
+
+OVERSAMPLENR = 16
+ADC_IIR_FRACTION = 6
+MIN_ADC_ISR_LOOPS = 10
+ISR_MS = 1000 / (16000000 / 64.0 / 256.0)   # temperature ISR and timer 0 overflow period
+STEP_AT = 3000                              # ISR calls before the step
+RUN = 6000
+
+
+def schedule(priorities):
+  """ Temperature::adc_init(): smooth weighted round-robin """
+  total = sum(priorities)
+  credit = [0] * len(priorities)
+  out = []
+  for _ in range(total):
+    for c, p in enumerate(priorities):
+      credit[c] += p
+    best = max(range(len(priorities)), key=lambda c: (credit[c], -c))
+    credit[best] -= total
+    out.append(best)
+  return out
+
+
+def reading(rng, n):
+  return max(0, min(1023, int(round(args.adc + (args.step if n >= STEP_AT else 0) + rng.gauss(0, args.noise)))))
+
+
+def oversample():
+  """ Returns [(ISR call, value)] as set_current_temp_raw() sees them """
+  rng = random.Random(args.seed)
+  states = 2 * (1 + len(args.channels)) + 1    # Prepare/Measure per sensor, SensorsReady
+  loops = max(MIN_ADC_ISR_LOOPS, states - 1)
+  out, acc, count = [], 0, 0
+  for n in range(RUN):
+    state = n % loops
+    if state == 1: acc += reading(rng, n)      # MeasureTemp of the first sensor
+    if state == 0 and n:
+      count += 1
+      if count >= OVERSAMPLENR:
+        out.append((n, acc))
+        acc, count = 0, 0
+  return out
+
+
+def iir():
+  rng = random.Random(args.seed)
+  slots = schedule([args.priority] + args.channels)
+  filt = reading(rng, 0) << ADC_IIR_FRACTION
+  out, idx = [], 0
+  for n in range(RUN):
+    if slots[idx] == 0:
+      filt = (filt + (reading(rng, n) << (ADC_IIR_FRACTION - args.shift)) - (filt >> args.shift)) & 0xFFFF
+    idx = (idx + 1) % len(slots)
+    if n % args.ready == args.ready - 1:
+      out.append((n, filt * OVERSAMPLENR >> ADC_IIR_FRACTION))
+  return out
+
+
+def analyse(samples):
+  before = [v for n, v in samples if n < STEP_AT]
+  base = statistics.mean(before[len(before) // 2:])
+  goal = (args.adc + args.step) * OVERSAMPLENR
+
+  def reach(frac):
+    level = base + (goal - base) * frac
+    return next(((n - STEP_AT) * ISR_MS for n, v in samples if n >= STEP_AT and v >= level), None)
+
+  period = (samples[-1][0] - samples[0][0]) / (len(samples) - 1) * ISR_MS
+  return period, reach(0.63), reach(0.95), statistics.pstdev(before[len(before) // 2:])
+
+
+print('%-12s %10s %10s %10s %10s' % ('pipeline', 'period ms', '63% ms', '95% ms', 'noise'))
+results = {}
+for name, run in (('oversample', oversample), ('iir', iir)):
+  period, t63, t95, noise = analyse(run())
+  results[name] = t63
+  fmt = lambda t: '-' if t is None else '%.0f' % t
+  print('%-12s %10.1f %10s %10s %10.2f' % (name, period, fmt(t63), fmt(t95), noise))
+
+failed = results['iir'] is None or (results['oversample'] is not None and results['iir'] > results['oversample'])
+sys.exit(1 if failed else 0)
@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+
+""" Compare fixed and adaptive G2/G3 arc segmentation.
+
+Takes plan_arc() from Marlin/Marlin_main.cpp and builds it with the host C++
+compiler, with -fsingle-precision-constant so constants are floats as on AVR,
+next to the version it replaced (a fixed --fixed-segment length and the 2nd
+order small angle terms). Both run for a set of radii and feedrates, and the
+segments given to the planner are compared with the true arc: the segment
+counts, the worst distance of a segment end or chord middle from the arc, and
+the longest segment of the new version are printed.
+
+Exits with status 1 if an adaptive arc strays further from the true arc than
+the sagitta of its longest segment allows.
+
+Example:
+  arcSegmentTest.py
+  arcSegmentTest.py --radius 0.5 2 10 100 --feedrate 20 60 150 --chord-error 0.005
+"""
+
+import argparse
+import math
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-r', '--radius', type=float, nargs='+', default=[0.5, 1, 2, 5, 10, 25, 50, 100], help='arc radii in mm')
+parser.add_argument('-f', '--feedrate', type=float, nargs='+', default=[10, 40, 100, 200], help='feedrates in mm/s')
+parser.add_argument('-a', '--angle', type=float, default=360, help='arc angle in degrees (default=360)')
+parser.add_argument('-e', '--chord-error', type=float, default=0.01, help='ARC_MAX_CHORD_ERROR in mm (default=0.01)')
+parser.add_argument('-s', '--segments-per-sec', type=float, default=100, help='ARC_SEGMENTS_PER_SEC (default=100)')
+parser.add_argument('--min-segment', type=float, default=0.1, help='MIN_ARC_SEGMENT_MM (default=0.1)')
+parser.add_argument('--max-segment', type=float, default=3.0, help='MM_PER_ARC_SEGMENT (default=3)')
+parser.add_argument('--fixed-segment', type=float, default=1.0, help='MM_PER_ARC_SEGMENT of the fixed segmentation (default=1)')
+parser.add_argument('-n', '--correction', type=int, default=25, help='N_ARC_CORRECTION (default=25)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "macros.h"
+#define sq(x) ((x) * (x))
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define ARC_MAX_CHORD_ERROR %(chord_error)s
+#define ARC_SEGMENTS_PER_SEC %(segments_per_sec)s
+#define MIN_ARC_SEGMENT_MM %(min_segment)s
+#define MM_PER_ARC_SEGMENT %(max_segment)s
+#define FIXED_MM_PER_ARC_SEGMENT %(fixed_segment)s
+#define N_ARC_CORRECTION %(correction)d
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS, E_AXIS };
+#define XYZE 4
+typedef uint32_t millis_t;
+millis_t millis() { return 0; }
+void idle() {}
+struct { void manage_heater() {} } thermalManager;
+float current_position[XYZE], destination[XYZE], feedrate_mm_s;
+int feedrate_percentage = 100;
+uint8_t active_extruder;
+#define MMS_SCALED(MM_S) ((MM_S)*feedrate_percentage*0.01)
+void clamp_to_software_endstops(float[XYZE]) {}
+void set_current_to_destination() { for (int i = 0; i < XYZE; i++) current_position[i] = destination[i]; }
+
+// planner.buffer_line_kinematic() records the segment ends
+std::vector<float> points;
+struct {
+  void buffer_line_kinematic(const float target[XYZE], const float &, const uint8_t) { points.push_back(target[X_AXIS]); points.push_back(target[Y_AXIS]); }
+} planner;
+'''
+
+# plan_arc() as it was, without its comments
+REFERENCE = r'''
+  void old_plan_arc(float logical[XYZE], float *offset, uint8_t clockwise) {
+    constexpr AxisEnum p_axis = X_AXIS, q_axis = Y_AXIS, l_axis = Z_AXIS;
+    float r_P = -offset[0], r_Q = -offset[1];
+    const float radius = HYPOT(r_P, r_Q),
+                center_P = current_position[p_axis] - r_P,
+                center_Q = current_position[q_axis] - r_Q,
+                rt_X = logical[p_axis] - center_P,
+                rt_Y = logical[q_axis] - center_Q,
+                linear_travel = logical[l_axis] - current_position[l_axis],
+                extruder_travel = logical[E_AXIS] - current_position[E_AXIS];
+    float angular_travel = ATAN2(r_P * rt_Y - r_Q * rt_X, r_P * rt_X + r_Q * rt_Y);
+    if (angular_travel < 0) angular_travel += RADIANS(360);
+    if (clockwise) angular_travel -= RADIANS(360);
+    if (angular_travel == 0 && current_position[p_axis] == logical[p_axis] && current_position[q_axis] == logical[q_axis])
+      angular_travel = RADIANS(360);
+    const float mm_of_travel = HYPOT(angular_travel * radius, FABS(linear_travel));
+    if (mm_of_travel < 0.001) return;
+    uint16_t segments = FLOOR(mm_of_travel / (FIXED_MM_PER_ARC_SEGMENT));
+    if (segments == 0) segments = 1;
+    float arc_target[XYZE];
+    const float theta_per_segment = angular_travel / segments,
+                linear_per_segment = linear_travel / segments,
+                extruder_per_segment = extruder_travel / segments,
+                sin_T = theta_per_segment,
+                cos_T = 1 - 0.5 * sq(theta_per_segment);
+    arc_target[l_axis] = current_position[l_axis];
+    arc_target[E_AXIS] = current_position[E_AXIS];
+    const float fr_mm_s = MMS_SCALED(feedrate_mm_s);
+    int8_t arc_recalc_count = N_ARC_CORRECTION;
+    for (uint16_t i = 1; i < segments; i++) {
+      if (--arc_recalc_count) {
+        const float r_new_Y = r_P * sin_T + r_Q * cos_T;
+        r_P = r_P * cos_T - r_Q * sin_T;
+        r_Q = r_new_Y;
+      }
+      else {
+        arc_recalc_count = N_ARC_CORRECTION;
+        const float cos_Ti = cos(i * theta_per_segment), sin_Ti = sin(i * theta_per_segment);
+        r_P = -offset[0] * cos_Ti + offset[1] * sin_Ti;
+        r_Q = -offset[0] * sin_Ti - offset[1] * cos_Ti;
+      }
+      arc_target[p_axis] = center_P + r_P;
+      arc_target[q_axis] = center_Q + r_Q;
+      arc_target[l_axis] += linear_per_segment;
+      arc_target[E_AXIS] += extruder_per_segment;
+      clamp_to_software_endstops(arc_target);
+      planner.buffer_line_kinematic(arc_target, fr_mm_s, active_extruder);
+    }
+    planner.buffer_line_kinematic(logical, fr_mm_s, active_extruder);
+    set_current_to_destination();
+  }
+'''
+
+MAIN = r'''
+// Segment count, worst distance of a segment end or chord middle from the arc, longest segment
+void report(const double radius) {
+  const size_t n = points.size() / 2;
+  double worst = 0, longest = 0, x = radius, y = 0;
+  for (size_t k = 0; k < n; k++) {
+    const double px = points[2 * k], py = points[2 * k + 1];
+    worst = std::fmax(worst, std::fabs(std::hypot(px, py) - radius));
+    worst = std::fmax(worst, std::fabs(std::hypot((x + px) / 2, (y + py) / 2) - radius));
+    longest = std::fmax(longest, std::hypot(px - x, py - y));
+    x = px;
+    y = py;
+  }
+  printf(" %zu %.6f %.6f", n, worst, longest);
+}
+
+int main(int, char **argv) {
+  const double radius = atof(argv[1]), degrees = atof(argv[3]), angle = RADIANS(degrees);
+  feedrate_mm_s = atof(argv[2]);
+  // A full circle ends where it starts, as a G2 with only I and J
+  const bool full = fmod(degrees, 360) == 0;
+  float target[XYZE] = { float(full ? radius : radius * cos(angle)), float(full ? 0 : radius * sin(angle)), 0, 0 },
+        offset[2] = { float(-radius), 0 };
+  for (int version = 0; version < 2; version++) {
+    current_position[X_AXIS] = radius;
+    current_position[Y_AXIS] = current_position[Z_AXIS] = current_position[E_AXIS] = 0;
+    for (int i = 0; i < XYZE; i++) destination[i] = target[i];
+    points.clear();
+    if (version) plan_arc(target, offset, 0); else old_plan_arc(target, offset, 0);
+    report(radius);
+  }
+  printf("\n");
+  return 0;
+}
+'''
+
+
+def extract():
+  return host.extract(args, 'Marlin_main.cpp', r'\n  void plan_arc\(\n.*?\n  } // plan_arc\n', 'plan_arc()')
+
+
+src = PRELUDE % vars(args) + REFERENCE + extract() + MAIN
+failed = False
+with host.HostBuild(args) as build:
+  exe = build.build(src, flags=['-fsingle-precision-constant'])
+
+  print('%8s %8s | %8s %10s | %8s %10s %8s' % ('radius', 'mm/s', 'fixed', 'max dev', 'adaptive', 'max dev', 'seg mm'))
+  for radius in args.radius:
+    for feedrate in args.feedrate:
+      v = host.output(exe, radius, feedrate, args.angle).split()
+      old_segments, old_dev, new_segments, new_dev, length = int(v[0]), float(v[1]), int(v[3]), float(v[4]), float(v[5])
+      # The deviation can't exceed the sagitta of the longest segment (plus float noise)
+      bound = radius - math.sqrt(max(0, radius * radius - (length / 2) ** 2)) if length < 2 * radius else radius
+      ok = new_dev <= bound + 1e-4
+      failed |= not ok
+      print('%8.2f %8.1f | %8d %10.5f | %8d %10.5f %8.3f%s'
+            % (radius, feedrate, old_segments, old_dev, new_segments, new_dev, length, '' if ok else '  FAIL'))
+
+sys.exit(1 if failed else 0)
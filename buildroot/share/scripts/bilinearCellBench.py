@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+""" Benchmark bilinear_z_offset() with and without ABL_BILINEAR_CELL_CACHE.
+
+Takes bilinear_z_offset() and the cell table from Marlin/Marlin_main.cpp,
+builds it twice with the host C++ compiler (cache off and on) on a random
+PROBE_XY_NUM x PROBE_XY_NUM grid, and runs both over the same XY stream:
+  random   points anywhere on the bed, beyond the grid edges included
+  walk     short segments from point to point, as bilinear_line_to_destination()
+           and the planner feed it while printing
+Prints the time per call of each, and exits with status 1 if the offsets
+differ by more than --tolerance anywhere.
+
+Host times only show the relative cost; on AVR every float operation is a
+library call and the difference is larger.
+
+Example:
+  bilinearCellBench.py
+  bilinearCellBench.py --points 5 --calls 2000000 --extrapolate
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--spacing', type=int, default=50, help='grid spacing in mm (default=50)')
+parser.add_argument('--calls', type=int, default=1000000, help='calls per stream (default=1000000)')
+parser.add_argument('--extrapolate', action='store_true', help='with EXTRAPOLATE_BEYOND_GRID')
+parser.add_argument('--tolerance', type=float, default=1e-4, help='max difference in mm (default=1e-4)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include "macros.h"
+using std::min;
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define GRID_MAX_POINTS_X %(points)d
+#define GRID_MAX_POINTS_Y %(points)d
+#define RAW_X_POSITION(P) (P)
+#define RAW_Y_POSITION(P) (P)
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS };
+#define XYZ 3
+int bilinear_grid_spacing[2] = { %(spacing)d, %(spacing)d }, bilinear_start[2] = { 10, 10 };
+float bilinear_grid_factor[2] = { 1.0f / %(spacing)d, 1.0f / %(spacing)d },
+      z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+'''
+
+MAIN = r'''
+int main() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> z(-0.5f, 0.5f), u(0, 1);
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      z_values[x][y] = z(rng);
+  #if ENABLED(ABL_BILINEAR_CELL_CACHE)
+    bilinear_cell_refresh();
+  #endif
+
+  // The bed reaches 20mm past the grid on each side
+  const float lo = bilinear_start[X_AXIS] - 20,
+              hi = bilinear_start[X_AXIS] + (GRID_MAX_POINTS_X - 1) * bilinear_grid_spacing[X_AXIS] + 20;
+  static float pts[%(calls)d][XYZ];
+  for (int stream = 0; stream < 2; stream++) {
+    float px = lo, py = lo, tx = lo, ty = lo;
+    for (int i = 0; i < %(calls)d; i++) {
+      if (stream == 0) {
+        pts[i][X_AXIS] = lo + u(rng) * (hi - lo);
+        pts[i][Y_AXIS] = lo + u(rng) * (hi - lo);
+      }
+      else {
+        // 1mm steps toward a random target
+        const float dx = tx - px, dy = ty - py, d = sqrtf(dx * dx + dy * dy);
+        if (d < 1) { tx = lo + u(rng) * (hi - lo); ty = lo + u(rng) * (hi - lo); }
+        else { px += dx / d; py += dy / d; }
+        pts[i][X_AXIS] = px;
+        pts[i][Y_AXIS] = py;
+      }
+      pts[i][Z_AXIS] = 0;
+    }
+    float sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < %(calls)d; i++) sum += bilinear_z_offset(pts[i]);
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("time %%d %%.2f %%f\n", stream, ns / %(calls)d, sum);
+    for (int i = 0; i < %(calls)d; i += 997) printf("z %%d %%.6f\n", stream, bilinear_z_offset(pts[i]));
+  }
+  return 0;
+}
+'''
+
+
+def extract():
+  """ The ABL_BG_* macros, the cell table and bilinear_z_offset() """
+  return host.extract(args, 'Marlin_main.cpp', r'\n  #if ENABLED\(ABL_BILINEAR_SUBDIVISION\)\n    #define ABL_BG_SPACING.*?\n  float bilinear_z_offset\(.*?\n  }\n', 'bilinear_z_offset()')
+
+
+def run(cache, code):
+  defines = ''.join('#define %s\n' % d for d, on in (('ABL_BILINEAR_CELL_CACHE', cache), ('EXTRAPOLATE_BEYOND_GRID', args.extrapolate)) if on)
+  src = defines + PRELUDE % vars(args) + code + MAIN % vars(args)
+  with host.HostBuild(args) as build:
+    out = host.output(build.build(src))
+  times, values = {}, {}
+  for line in out.splitlines():
+    kind, stream, *rest = line.split()
+    if kind == 'time':
+      times[int(stream)] = float(rest[0])
+    else:
+      values.setdefault(int(stream), []).append(float(rest[0]))
+  return times, values
+
+
+code = extract()
+base_times, base_values = run(False, code)
+cache_times, cache_values = run(True, code)
+
+failed = False
+print('%-8s %12s %12s %8s %12s' % ('stream', 'ns/call', 'cached', 'speedup', 'max diff mm'))
+for stream, name in enumerate(('random', 'walk')):
+  diff = max(abs(a - b) for a, b in zip(base_values[stream], cache_values[stream]))
+  print('%-8s %12.2f %12.2f %7.2fx %12.2g' % (name, base_times[stream], cache_times[stream], base_times[stream] / cache_times[stream], diff))
+  failed |= diff > args.tolerance
+
+sys.exit(1 if failed else 0)
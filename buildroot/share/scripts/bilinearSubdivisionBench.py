@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+
+""" Check and time bed_level_virt_interpolate() (ABL_BILINEAR_SUBDIVISION).
+
+Takes the subdivision code from Marlin/Marlin_main.cpp and builds it with
+the host C++ compiler, next to the previous version that evaluated the
+Catmull-Rom polynomials for each of the 16 neighbours of every subdivided
+point. Both fill the subdivided grid from the same random
+PROBE_XY_NUM x PROBE_XY_NUM grids, for each BILINEAR_SUBDIVISIONS from 2
+to --max-subdivisions. Prints the time per refresh of each, and exits with
+status 1 if the grids differ by more than --tolerance anywhere. The new
+version is also built with AddressSanitizer and must not read outside the
+grid or its rows (the previous one does, with a weight of 0).
+
+Host times only show the relative cost; on AVR every float operation is a
+library call and the difference is larger.
+
+Example:
+  bilinearSubdivisionBench.py
+  bilinearSubdivisionBench.py --points 5 --max-subdivisions 4 --runs 2000
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--spacing', type=int, default=90, help='grid spacing in mm (default=90)')
+parser.add_argument('--max-subdivisions', type=int, default=5, help='largest BILINEAR_SUBDIVISIONS (default=5)')
+parser.add_argument('--runs', type=int, default=5000, help='random grids per build (default=5000)')
+parser.add_argument('--tolerance', type=float, default=1e-6, help='max difference in mm (default=1e-6)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include "macros.h"
+#define ABL_BILINEAR_SUBDIVISION
+#define GRID_MAX_POINTS_X %(points)d
+#define GRID_MAX_POINTS_Y %(points)d
+#define BILINEAR_SUBDIVISIONS %(subdivisions)d
+#define sq(x) ((x) * (x))
+#define SERIAL_ECHOLNPGM(S)
+template<typename F> void print_2d_array(const uint8_t, const uint8_t, const uint8_t, F) {}
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS };
+int bilinear_grid_spacing[2] = { %(spacing)d, %(spacing)d };
+float z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+'''
+
+# The previous version, one 4x4 Catmull-Rom patch per subdivided point
+REFERENCE = r'''
+float ref_values_virt[ABL_GRID_POINTS_VIRT_X][ABL_GRID_POINTS_VIRT_Y];
+
+static float ref_cmr(const float p[4], const uint8_t i, const float t) {
+  return (
+      p[i-1] * -t * sq(1 - t)
+    + p[i]   * (2 - 5 * sq(t) + 3 * t * sq(t))
+    + p[i+1] * t * (1 + 4 * t - 3 * sq(t))
+    - p[i+2] * sq(t) * (1 - t)
+  ) * 0.5;
+}
+
+static float ref_2cmr(const uint8_t x, const uint8_t y, const float &tx, const float &ty) {
+  float row[4], column[4];
+  for (uint8_t i = 0; i < 4; i++) {
+    for (uint8_t j = 0; j < 4; j++) {
+      column[j] = bed_level_virt_coord(i + x - 1, j + y - 1);
+    }
+    row[i] = ref_cmr(column, 1, ty);
+  }
+  return ref_cmr(row, 1, tx);
+}
+
+void ref_interpolate() {
+  for (uint8_t y = 0; y < GRID_MAX_POINTS_Y; y++)
+    for (uint8_t x = 0; x < GRID_MAX_POINTS_X; x++)
+      for (uint8_t ty = 0; ty < BILINEAR_SUBDIVISIONS; ty++)
+        for (uint8_t tx = 0; tx < BILINEAR_SUBDIVISIONS; tx++) {
+          if ((ty && y == GRID_MAX_POINTS_Y - 1) || (tx && x == GRID_MAX_POINTS_X - 1))
+            continue;
+          ref_values_virt[x * (BILINEAR_SUBDIVISIONS) + tx][y * (BILINEAR_SUBDIVISIONS) + ty] =
+            ref_2cmr(x + 1, y + 1, (float)tx / (BILINEAR_SUBDIVISIONS), (float)ty / (BILINEAR_SUBDIVISIONS));
+        }
+}
+'''
+
+MAIN = r'''
+int main() {
+  #ifdef BOUNDS_CHECK
+    bed_level_virt_interpolate();
+    return 0;
+  #endif
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> z(-0.5f, 0.5f);
+  double ref_ns = 0, new_ns = 0, diff = 0;
+  for (int run = 0; run < %(runs)d; run++) {
+    for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+      for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+        z_values[x][y] = z(rng);
+    auto start = std::chrono::steady_clock::now();
+    ref_interpolate();
+    ref_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    bed_level_virt_interpolate();
+    new_ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    for (int x = 0; x < ABL_GRID_POINTS_VIRT_X; x++)
+      for (int y = 0; y < ABL_GRID_POINTS_VIRT_Y; y++)
+        diff = std::max(diff, (double)std::fabs(ref_values_virt[x][y] - z_values_virt[x][y]));
+  }
+  printf("%%.1f %%.1f %%g\n", ref_ns / %(runs)d, new_ns / %(runs)d, diff);
+  return 0;
+}
+'''
+
+
+def extract():
+  """ The ABL_BILINEAR_SUBDIVISION block after print_bilinear_leveling_grid() """
+  return host.extract(args, 'Marlin_main.cpp', r'\n  #if ENABLED\(ABL_BILINEAR_SUBDIVISION\)\n\n    #define ABL_GRID_POINTS_VIRT_X.*?\n  #endif // ABL_BILINEAR_SUBDIVISION\n', 'bed_level_virt_interpolate()')
+
+
+def run(subdivisions, code):
+  values = dict(vars(args), subdivisions=subdivisions)
+  src = PRELUDE % values + code + REFERENCE + MAIN % values
+  with host.HostBuild(args) as build:
+    in_bounds = host.run(build.build(src, 'bounds', ['-O1', '-fsanitize=address', '-DBOUNDS_CHECK']))[0] == 0
+    return [float(v) for v in host.output(build.build(src)).split()] + [in_bounds]
+
+
+code = extract()
+failed = False
+print('%-12s %14s %14s %8s %12s %10s' % ('subdivisions', 'per-point ns', 'separable ns', 'speedup', 'max diff mm', 'in bounds'))
+for subdivisions in range(2, args.max_subdivisions + 1):
+  ref_ns, new_ns, diff, in_bounds = run(subdivisions, code)
+  print('%-12d %14.1f %14.1f %7.2fx %12.2g %10s' % (subdivisions, ref_ns, new_ns, ref_ns / new_ns, diff, 'yes' if in_bounds else 'NO'))
+  failed |= diff > args.tolerance or not in_bounds
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+
+""" Compare hotend temperature dips at flow changes with PID_EXTRUSION_FEEDFORWARD.
+
+A hotend (heater block with a lagging sensor, losses to ambient, and the heat
+taken by the filament) is held at the target by the PID at PID_dT while the
+print switches at random between perimeters, infill and travels at different
+volumetric flows.
+The heater power is worked out four ways:
+  pid          the PID alone
+  scaling      PID_EXTRUSION_SCALING: the E steps of one update, taken
+               LPQ_LEN updates late, times Kc (Kc set to match the hotend)
+  feedforward  the extrusion rate of the executing block times Kf, with Kf
+               set to the heat the filament takes
+  learned      the same, with Kf starting at 0 and learned while printing:
+               the slope of the mean heater power over the mean flow of
+               PID_FEEDFORWARD_WINDOW second windows
+
+For each the largest dip below and rise above the target over the last
+--measure seconds is printed, with the final Kf.
+Exits with status 1 if the learned feed-forward doesn't halve the dips of
+the PID alone, or Kf doesn't end up within 30% of the true coefficient.
+
+Example:
+  flowFeedforwardSim.py
+  flowFeedforwardSim.py --watts 80 --flows 2 25 --window 5
+"""
+
+import argparse
+import math
+import random
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--temp', type=float, default=220, help='target temperature (default=220)')
+parser.add_argument('--watts', type=float, default=40, help='heater power (default=40)')
+parser.add_argument('--flows', type=float, nargs=2, default=[3, 15], help='perimeter and infill flow in mm3/s (default=3 15)')
+parser.add_argument('--times', type=float, nargs=2, default=[2, 15], help='shortest and longest segment in seconds (default=2 15)')
+parser.add_argument('--window', type=float, default=10, help='PID_FEEDFORWARD_WINDOW (default=10)')
+parser.add_argument('--windows', type=float, default=30, help='PID_FEEDFORWARD_WINDOWS (default=30)')
+parser.add_argument('--minutes', type=float, default=20, help='print time (default=20)')
+parser.add_argument('--measure', type=float, default=120, help='seconds at the end to measure (default=120)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+args = parser.parse_args()
+
+DT = 16 * 10 / (16000000 / 64.0 / 256.0)   # PID_dT
+AMBIENT = 25
+CAPACITY, LOSS, SENSOR = 16.7 * args.watts / 40, 0.068, 0.22
+FILAMENT_J_PER_MM3_K = 2.33e-3             # PLA
+KP, KI, KD, K1 = 12.9, 0.76, 55.0, 0.95    # DEFAULT_Kp/Ki/Kd of the 40W hotend in _Config.h
+FUNCTIONAL_RANGE = 20
+LPQ_LEN = 20
+AREA = math.pi / 4 * 1.75 ** 2
+
+# Heater power per mm3/s (0..255) that the filament takes at the target
+KF_TRUE = FILAMENT_J_PER_MM3_K * (args.temp - AMBIENT) / args.watts * 255
+
+
+def profile():
+  """ Segments of (end time, flow): perimeters, infill and short travels """
+  rng = random.Random(args.seed)
+  t, out = 0.0, []
+  while t < args.minutes * 60:
+    t += rng.uniform(*args.times)
+    out.append((t, rng.choice((args.flows[0], args.flows[1], args.flows[1], 0))))
+  return out
+
+PROFILE = profile()
+
+
+def flow_at(t):
+  return next(f for end, f in PROFILE if t < end)
+
+
+def simulate(mode):
+  block = sensor = args.temp
+  i_state = (LOSS * (args.temp - AMBIENT) / args.watts * 255) / (KI * DT)   # start at the hold power
+  d_state, d_term = sensor, 0.0
+  kf = KF_TRUE if mode == 'feedforward' else 0.0
+  # Window sums, and the regression of the mean power on the mean flow
+  win_flow = win_power = win_time = 0.0
+  win_valid = True
+  n = mx = my = sxx = sxy = 0.0
+  lpq = [0.0] * LPQ_LEN
+  lpq_ptr = 0
+  out = 0.0
+  t = 0.0
+  low = high = 0.0
+  end = args.minutes * 60
+  while t < end:
+    # Plant over one update
+    flow = flow_at(t)
+    sub = 10
+    for _ in range(sub):
+      dt = DT / sub
+      heat = args.watts * (int(out) >> 1) / 127.0
+      loss = (LOSS + FILAMENT_J_PER_MM3_K * flow) * (block - AMBIENT)
+      block += (heat - loss) * dt / CAPACITY
+      sensor += (block - sensor) * SENSOR * dt
+    t += DT
+    current = int(sensor * 256) / 256.0
+
+    # Temperature::get_pid_output()
+    error = args.temp - current
+    d_term = (1 - K1) * KD / DT * (current - d_state) + K1 * d_term
+    d_state = current
+    if abs(error) > FUNCTIONAL_RANGE:
+      out = 255 if error > 0 else 0
+    else:
+      i_state += error
+      out = KP * error + KI * DT * i_state - d_term
+      if mode == 'scaling':
+        # E steps of the last update, LPQ_LEN updates late, with Kc to match the hotend
+        lpq[lpq_ptr] = flow / AREA * DT
+        lpq_ptr = (lpq_ptr + 1) % LPQ_LEN
+        out += lpq[lpq_ptr] * KF_TRUE * AREA / DT
+      elif mode in ('feedforward', 'learned'):
+        out += kf * flow
+      if out > 255:
+        if error > 0: i_state -= error
+        out = 255
+      elif out < 0:
+        if error < 0: i_state -= error
+        out = 0
+
+    if mode == 'learned':
+      # Heater power = hold power + Kf * flow, on average over a window
+      if abs(error) > FUNCTIONAL_RANGE: win_valid = False
+      win_flow += flow
+      win_power += int(out)
+      win_time += 1
+      if win_time * DT >= args.window:
+        if win_valid:
+          x, y = win_flow / win_time, win_power / win_time
+          forget = 1 - 1 / args.windows
+          n = n * forget + 1
+          dx, dy = x - mx, y - my
+          mx += dx / n
+          my += dy / n
+          sxx = sxx * forget + dx * (x - mx)
+          sxy = sxy * forget + dx * (y - my)
+          if n > 3 and sxx > n * 1.0:
+            kf = max(0.0, sxy / sxx)
+        win_flow = win_power = win_time = 0
+        win_valid = True
+
+    if t > end - args.measure:
+      low, high = min(low, current - args.temp), max(high, current - args.temp)
+  return low, high, kf
+
+
+print('Kf of the hotend: %.2f per mm3/s' % KF_TRUE)
+print('%-12s %8s %8s %8s' % ('control', 'dip', 'rise', 'Kf'))
+results = {}
+for mode in ('pid', 'scaling', 'feedforward', 'learned'):
+  low, high, kf = simulate(mode)
+  results[mode] = (low, high, kf)
+  print('%-12s %8.2f %8.2f %8.2f' % (mode, low, high, kf))
+
+pid_swing = results['pid'][1] - results['pid'][0]
+learned_swing = results['learned'][1] - results['learned'][0]
+failed = learned_swing > pid_swing / 2 or abs(results['learned'][2] - KF_TRUE) > 0.3 * KF_TRUE
+sys.exit(1 if failed else 0)
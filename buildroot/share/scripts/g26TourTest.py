@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+
+""" Compare the G26 circle order planned by plan_circle_tour() with the old search.
+
+Takes plan_circle_tour() from Marlin/G26_Mesh_Validation_Tool.cpp and builds it
+with the host C++ compiler, next to the search it replaced: for every circle,
+scan the grid for the closest unprinted one (weighted toward the start), then
+scan the whole grid again for lines to connect. Both run on a GRID x GRID mesh
+from several start points:
+  square   every mesh point reachable
+  round    only points within --radius of the bed centre, as on a delta
+  repeat   R --repeats, which must print the same circles as before
+For each the travel between circle centres, the number of jumps (travels to a
+circle that isn't a grid neighbour, which retract) and the time spent choosing
+are printed. The time is the host CPU time, and an estimate for a 16MHz AVR
+from the squares and square roots taken, at --avr-cycles each.
+
+Exits with status 1 if a tour misses or repeats a circle, prints other circles
+than the old search, doesn't start at the circle closest to the start, makes
+more jumps or costs more (travel plus TOUR_JUMP_COST for each jump).
+
+Example:
+  g26TourTest.py
+  g26TourTest.py --grid 15 --spacing 20 --radius 150
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--grid', type=int, default=10, help='GRID_MAX_POINTS_X and _Y (default=10)')
+parser.add_argument('--spacing', type=float, default=30, help='mesh spacing in mm (default=30)')
+parser.add_argument('--radius', type=float, default=120, help='reachable radius for the round bed (default=120)')
+parser.add_argument('--repeats', type=int, default=12, help='R for the repeat case (default=12)')
+parser.add_argument('--avr-cycles', type=int, default=600, help='AVR cycles for a float square or square root with its adds (default=600)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "macros.h"
+using std::min;
+// Count the float squares and square roots, for the AVR estimate
+long float_ops;
+#undef HYPOT2
+#undef SQRT
+float count_hypot2(const float x, const float y) { float_ops++; return x * x + y * y; }
+float count_sqrt(const float x) { float_ops++; return sqrtf(x); }
+#define HYPOT2(x,y) count_hypot2(x, y)
+#define SQRT(x) count_sqrt(x)
+#define GRID_MAX_POINTS_X %(grid)d
+#define GRID_MAX_POINTS_Y %(grid)d
+#define GRID_MAX_POINTS (GRID_MAX_POINTS_X * GRID_MAX_POINTS_Y)
+#define MESH_DIST %(spacing)f
+#define MESH_X_DIST MESH_DIST
+#define _BV(b) (1UL << (b))
+#define sq(x) ((x) * (x))
+#define TOUR_X(P) ((P) >> 4)
+#define TOUR_Y(P) ((P) & 0x0F)
+struct {
+  static float mesh_index_to_xpos(const uint8_t i) { return 10 + i * MESH_DIST; }
+  static float mesh_index_to_ypos(const uint8_t i) { return 10 + i * MESH_DIST; }
+} ubl;
+const float centre = 10 + (GRID_MAX_POINTS_X - 1) * MESH_DIST / 2;
+float radius = 99999;
+bool position_is_reachable_raw_xy(const float &x, const float &y) { return HYPOT(x - centre, y - centre) <= radius; }
+float random_deviation = 0;
+long random(long lo, long hi) { return lo + rand() %% (hi - lo); }
+void idle() {}
+'''
+
+# find_closest_circle_to_print() and look_for_lines_to_connect() as they were,
+# with the line printing left out
+REFERENCE = r'''
+uint16_t circle_flags[16], horizontal_mesh_line_flags[16], vertical_mesh_line_flags[16];
+void bit_set(uint16_t bits[16], uint8_t x, uint8_t y) { SBI(bits[y], x); }
+bool is_bit_set(uint16_t bits[16], uint8_t x, uint8_t y) { return TEST(bits[y], x); }
+int lines;
+
+bool find_closest_circle_to_print(const float &X, const float &Y, const float &sx, const float &sy, uint8_t &ri, uint8_t &rj) {
+  float closest = 99999.99;
+  bool found = false;
+  for (uint8_t i = 0; i < GRID_MAX_POINTS_X; i++)
+    for (uint8_t j = 0; j < GRID_MAX_POINTS_Y; j++)
+      if (!is_bit_set(circle_flags, i, j)) {
+        const float mx = ubl.mesh_index_to_xpos(i), my = ubl.mesh_index_to_ypos(j);
+        float f = HYPOT(X - mx, Y - my);
+        f += HYPOT(sx - mx, sy - my) / 15.0;
+        if (f < closest) { closest = f; ri = i; rj = j; found = true; }
+      }
+  if (found) bit_set(circle_flags, ri, rj);
+  return found;
+}
+
+void look_for_lines_to_connect() {
+  for (uint8_t i = 0; i < GRID_MAX_POINTS_X; i++)
+    for (uint8_t j = 0; j < GRID_MAX_POINTS_Y; j++) {
+      if (is_bit_set(circle_flags, i, j) && is_bit_set(circle_flags, i + 1, j) && !is_bit_set(horizontal_mesh_line_flags, i, j)) {
+        lines++;
+        bit_set(horizontal_mesh_line_flags, i, j);
+      }
+      if (is_bit_set(circle_flags, i, j) && is_bit_set(circle_flags, i, j + 1) && !is_bit_set(vertical_mesh_line_flags, i, j)) {
+        lines++;
+        bit_set(vertical_mesh_line_flags, i, j);
+      }
+    }
+}
+
+// Returns the circles in printing order, as the old G26 loop chose them
+int old_order(uint8_t tour[], const float &sx, const float &sy, int repeats) {
+  std::fill(circle_flags, circle_flags + 16, 0);
+  std::fill(horizontal_mesh_line_flags, horizontal_mesh_line_flags + 16, 0);
+  std::fill(vertical_mesh_line_flags, vertical_mesh_line_flags + 16, 0);
+  int n = 0;
+  float x = sx, y = sy;
+  uint8_t i, j;
+  do {
+    if (!find_closest_circle_to_print(x, y, sx, sy, i, j)) break;
+    if (!position_is_reachable_raw_xy(ubl.mesh_index_to_xpos(i), ubl.mesh_index_to_ypos(j))) continue;
+    tour[n++] = i << 4 | j;
+    x = ubl.mesh_index_to_xpos(i);
+    y = ubl.mesh_index_to_ypos(j);
+    look_for_lines_to_connect();
+  } while (--repeats);
+  return n;
+}
+'''
+
+MAIN = r'''
+void report(const char *name, const uint8_t tour[], const int n, const float &sx, const float &sy, const double ns, const long ops) {
+  float travel = 0, x = sx, y = sy;
+  int jumps = 0;
+  printf("%s %d %.0f %ld", name, n, ns, ops);
+  for (int k = 0; k < n; k++) {
+    const float cx = ubl.mesh_index_to_xpos(TOUR_X(tour[k])), cy = ubl.mesh_index_to_ypos(TOUR_Y(tour[k])), d = hypotf(cx - x, cy - y);
+    if (k) {
+      travel += d;
+      if (abs(TOUR_X(tour[k]) - TOUR_X(tour[k - 1])) + abs(TOUR_Y(tour[k]) - TOUR_Y(tour[k - 1])) > 1) jumps++;
+    }
+    x = cx; y = cy;
+    printf(" %d", tour[k]);
+  }
+  printf(" | %.1f %d\n", travel, jumps);
+}
+
+int main(int, char **argv) {
+  radius = atof(argv[1]);
+  const int repeats = atoi(argv[2]);
+  const float sx = atof(argv[3]), sy = atof(argv[4]);
+  uint8_t tour[GRID_MAX_POINTS];
+  const int runs = 200;
+  int n = 0;
+  float_ops = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < runs; r++) n = old_order(tour, sx, sy, repeats);
+  double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+  report("old", tour, n, sx, sy, ns, float_ops / runs);
+  float_ops = 0;
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < runs; r++) n = plan_circle_tour(tour, sx, sy, std::min(repeats, GRID_MAX_POINTS));
+  ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+  report("new", tour, n, sx, sy, ns, float_ops / runs);
+  return 0;
+}
+'''
+
+
+def extract(pattern, what):
+  return host.extract(args, 'G26_Mesh_Validation_Tool.cpp', pattern, what)
+
+
+def pos(i):
+  return 10 + i * args.spacing
+
+
+tuning = extract(r'\n  #define TOUR_JUMP_COST .*?\n  #define TOUR_2OPT_PASSES [^\n]*\n', 'TOUR_JUMP_COST')
+jump_cost = float(tuning.split()[2]) * args.spacing
+src = PRELUDE % vars(args) + tuning + extract(r'\n  static float tour_distance2\(.*?\n    return n;\n  }\n', 'plan_circle_tour()') + REFERENCE + MAIN
+failed = False
+with host.HostBuild(args) as build:
+  exe = build.build(src)
+
+  size = pos(args.grid - 1) + 10
+  starts = [(0, 0), (size / 2, size / 2), (size * 0.8, size * 0.3)]
+  print('%-8s %-14s %7s %14s %8s %10s %10s %10s %12s %10s' % ('bed', 'start', 'circles', 'travel old', 'new', 'jumps', 'old us', 'new us', 'AVR ms old', 'new'))
+  for bed, radius, repeats in (('square', 99999, 999), ('round', args.radius, 999), ('repeat', 99999, args.repeats)):
+    for sx, sy in starts:
+      out = host.output(exe, radius, repeats, sx, sy).splitlines()
+      res = {}
+      for line in out:
+        head, tail = line.split(' | ')
+        name, n, ns, ops, *tour = head.split()
+        travel, jumps = tail.split()
+        res[name] = (int(n), float(ns), [int(t) for t in tour], float(travel), int(jumps), int(ops) * args.avr_cycles / 16e3)
+
+      # The reachable circles, and the ones closest to the start for R
+      reach = [i << 4 | j for i in range(args.grid) for j in range(args.grid)
+               if ((pos(i) - (size - 10) / 2 - 5) ** 2 + (pos(j) - (size - 10) / 2 - 5) ** 2) ** 0.5 <= radius]
+      dist = lambda p: ((pos(p >> 4) - sx) ** 2 + (pos(p & 15) - sy) ** 2) ** 0.5
+      tour = res['new'][2]
+      ok = len(tour) == min(repeats, len(reach)) and len(set(tour)) == len(tour) and set(tour) <= set(reach)
+      ok &= abs(dist(tour[0]) - min(dist(p) for p in reach)) < 1e-3
+      ok &= set(tour) == set(res['old'][2])
+      ok &= res['new'][4] <= res['old'][4]
+      ok &= res['new'][3] + res['new'][4] * jump_cost <= res['old'][3] + res['old'][4] * jump_cost + 1e-3
+      failed |= not ok
+      print('%-8s %-14s %7d %14.0f %8.0f %4d -> %-3d %10.1f %10.1f %12.0f %10.0f%s' % (
+        bed, '%.0f,%.0f' % (sx, sy), res['new'][0], res['old'][3], res['new'][3], res['old'][4], res['new'][4],
+        res['old'][1] / 1000, res['new'][1] / 1000, res['old'][5], res['new'][5], '' if ok else '  FAIL'))
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+
+""" Estimate the time of a G29 grid with and without G29_FAST_PROBE.
+
+Walks the serpentine G29 probe order over a warped bed (a tilt, a bowl and
+some noise, --warp mm from lowest to highest) and adds up the moves and
+BLTouch delays of each point the way Marlin_main.cpp makes them:
+  stock  probe_pt(): raise Z_CLEARANCE_BETWEEN_PROBES, travel, deploy, probe
+         at Z_PROBE_SPEED_SLOW, stow
+  fast   fast_probe_pt(): lift to G29_FAST_PROBE_CLEARANCE above the last
+         trigger height during the travel, deploy, descend at
+         Z_PROBE_SPEED_FAST to G29_FAST_PROBE_MARGIN above it, probe the
+         rest slowly, and back off and probe slowly again on an early trigger
+Moves are trapezoids with the axis accelerations and speeds below, Z limited
+by its own acceleration on combined moves. The lowest nozzle height over
+the bed during fast travel is printed as well.
+
+Exits with status 1 if fast probing isn't faster or the nozzle touches the bed.
+
+Example:
+  g29ProbeTimeSim.py
+  g29ProbeTimeSim.py --points 5 --span 300 --warp 1.5
+"""
+
+import argparse
+import math
+import random
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--span', type=float, default=540, help='probed width and depth in mm (default=540)')
+parser.add_argument('--warp', type=float, default=0.8, help='bed height range in mm (default=0.8)')
+parser.add_argument('--zoffset', type=float, default=-1, help='Z_PROBE_OFFSET_FROM_EXTRUDER (default=-1)')
+parser.add_argument('--clearance', type=float, default=2, help='G29_FAST_PROBE_CLEARANCE (default=2)')
+parser.add_argument('--margin', type=float, default=1, help='G29_FAST_PROBE_MARGIN (default=1)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+args = parser.parse_args()
+
+XY_SPEED, XY_ACCEL = 6000 / 60.0, 800          # XY_PROBE_SPEED, DEFAULT_TRAVEL_ACCELERATION
+Z_FAST, Z_ACCEL = 10.0, 10                     # Z_PROBE_SPEED_FAST (HOMING_FEEDRATE_Z), max Z acceleration
+Z_SLOW = Z_FAST / 10                           # Z_PROBE_SPEED_SLOW
+Z_CLEARANCE_BETWEEN_PROBES = 5
+BLTOUCH_DELAY = 0.375
+TRIGGER_LAG = 0.005                            # Seconds from touch to stop
+
+
+def move_time(dist, speed, accel):
+  """ Time of a trapezoid (or triangle) move from and to a stop """
+  dist = abs(dist)
+  if dist * accel < speed * speed:
+    return 2 * math.sqrt(dist / accel)
+  return dist / speed + speed / accel
+
+
+def line_time(dxy, dz):
+  """ A combined move, at XY speed, with the acceleration Z allows """
+  length = math.hypot(dxy, dz)
+  if length == 0: return 0
+  accel = XY_ACCEL if dz == 0 else min(XY_ACCEL, Z_ACCEL * length / abs(dz))
+  speed = XY_SPEED if dz == 0 else min(XY_SPEED, Z_FAST * length / abs(dz))
+  return move_time(length, speed, accel)
+
+
+def bed():
+  rng = random.Random(args.seed)
+  tx, ty, bowl = rng.uniform(-1, 1), rng.uniform(-1, 1), rng.uniform(-1, 1)
+  def raw(x, y):
+    u, v = x / args.span - 0.5, y / args.span - 0.5
+    return tx * u + ty * v + bowl * (u * u + v * v) * 2 + 0.05 * math.sin(9 * u + 5 * v)
+  samples = [raw(i * args.span / 20, j * args.span / 20) for i in range(21) for j in range(21)]
+  lo, hi = min(samples), max(samples)
+  return lambda x, y: (raw(x, y) - lo) / (hi - lo) * args.warp
+
+BED = bed()
+
+
+def points():
+  """ The serpentine order of G29 """
+  step = args.span / (args.points - 1)
+  zig = args.points & 1
+  for j in range(args.points):
+    xs = range(args.points) if zig else reversed(range(args.points))
+    zig ^= 1
+    for i in xs:
+      yield i * step, j * step
+
+
+def probe(z_from, bed_z, speed):
+  """ Descend from z_from until the nozzle is -zoffset above bed_z; time and trigger Z """
+  trigger = bed_z - args.zoffset - speed * TRIGGER_LAG
+  return move_time(z_from - trigger, speed, Z_ACCEL), trigger
+
+
+def stock():
+  total, z, pos = 0.0, None, None
+  for x, y in points():
+    if pos is not None:
+      total += move_time(Z_CLEARANCE_BETWEEN_PROBES, Z_FAST, Z_ACCEL)
+      z += Z_CLEARANCE_BETWEEN_PROBES
+      total += line_time(math.hypot(x - pos[0], y - pos[1]), 0)
+    else:
+      z = Z_CLEARANCE_BETWEEN_PROBES - args.zoffset
+    pos = (x, y)
+    t, z = probe(z, BED(x, y), Z_SLOW)
+    total += BLTOUCH_DELAY + t + BLTOUCH_DELAY
+  return total, 0
+
+
+def fast():
+  total, z, pos, retries = 0.0, None, None, 0
+  lowest = float('inf')
+  for x, y in points():
+    if pos is None:
+      # The first point is a stock probe_pt()
+      t, z = probe(Z_CLEARANCE_BETWEEN_PROBES - args.zoffset, BED(x, y), Z_SLOW)
+      total += 2 * BLTOUCH_DELAY + t
+      pos = (x, y)
+      continue
+    expect = z
+    travel = expect + args.clearance
+    dxy = math.hypot(x - pos[0], y - pos[1])
+    total += line_time(dxy, travel - z)
+    for s in range(51):
+      f = s / 50.0
+      nz = z + (travel - z) * f
+      lowest = min(lowest, nz - BED(pos[0] + (x - pos[0]) * f, pos[1] + (y - pos[1]) * f))
+    pos = (x, y)
+    z = travel
+    total += BLTOUCH_DELAY
+    bed_z = BED(x, y)
+    t, trigger = probe(z, bed_z, Z_FAST)
+    if trigger > expect + args.margin:
+      # Early trigger: back off and probe slowly
+      retries += 1
+      total += t + move_time(args.clearance, Z_FAST, Z_ACCEL) + BLTOUCH_DELAY
+      z = trigger + args.clearance
+    else:
+      total += move_time(z - expect - args.margin, Z_FAST, Z_ACCEL)
+      z = expect + args.margin
+    t, z = probe(z, bed_z, Z_SLOW)
+    total += t
+  total += BLTOUCH_DELAY  # Stow after the last point
+  return total, retries, lowest
+
+
+stock_time, _ = stock()
+fast_time, retries, lowest = fast()
+print('grid %dx%d, %.0fmm spacing, %.2fmm warp' % (args.points, args.points, args.span / (args.points - 1), args.warp))
+print('stock  %7.1fs' % stock_time)
+print('fast   %7.1fs  (%.2fx, %d slow confirms, lowest nozzle %.2fmm over the bed)' % (fast_time, stock_time / fast_time, retries, lowest))
+sys.exit(1 if fast_time >= stock_time or lowest <= 0 else 0)
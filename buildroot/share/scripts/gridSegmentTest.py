@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+
+""" Check the grid-line splitting of leveled moves, and its stack use.
+
+Takes grid_line_to_destination() and bilinear_line_to_destination() from
+Marlin/Marlin_main.cpp and builds them with the host C++ compiler next to
+the recursive bilinear_line_to_destination() they replaced (x_splits/y_splits
+bitmasks, a copy of the destination per level). Both run over the same
+moves on a PROBE_XY_NUM x PROBE_XY_NUM grid: random moves, long diagonals
+corner to corner, and moves along grid lines. The pieces given to
+planner.buffer_line() are checked against the grid line crossings worked
+out in double precision, and the deepest stack use seen at
+planner.buffer_line() is printed for both.
+
+The recursive version only split at more than one line per axis when
+float rounding put a split point in the cell before the line, so it is
+not checked, just measured. Stack sizes are of the host build; AVR frames
+are smaller, but the recursive version grows with the cells crossed and
+the new one doesn't.
+Exits with status 1 if any move is split wrong.
+
+Example:
+  gridSegmentTest.py
+  gridSegmentTest.py --points 15 --spacing 20 --moves 100000
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--spacing', type=int, default=50, help='grid spacing in mm (default=50)')
+parser.add_argument('--moves', type=int, default=20000, help='random moves (default=20000)')
+parser.add_argument('--tolerance', type=float, default=1e-3, help='max difference of the piece ends in mm (default=1e-3)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "macros.h"
+using std::min;
+using std::max;
+#define _BV(b) (1UL << (b))
+#define AUTO_BED_LEVELING_BILINEAR
+#define IS_KINEMATIC 0
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define GRID_MAX_POINTS_X %(points)d
+#define GRID_MAX_POINTS_Y %(points)d
+#define ABL_BG_SPACING(A) bilinear_grid_spacing[A]
+#define ABL_BG_FACTOR(A)  bilinear_grid_factor[A]
+#define ABL_BG_POINTS_X   GRID_MAX_POINTS_X
+#define ABL_BG_POINTS_Y   GRID_MAX_POINTS_Y
+#define RAW_X_POSITION(P) (P)
+#define RAW_Y_POSITION(P) (P)
+#define LOGICAL_X_POSITION(P) (P)
+#define LOGICAL_Y_POSITION(P) (P)
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS, E_AXIS };
+#define XYZE 4
+#define LOOP_XYZE(VAR) for (uint8_t VAR = X_AXIS; VAR <= E_AXIS; VAR++)
+int bilinear_grid_spacing[2] = { %(spacing)d, %(spacing)d }, bilinear_start[2] = { 10, 10 };
+float bilinear_grid_factor[2] = { 1.0f / %(spacing)d, 1.0f / %(spacing)d };
+float current_position[XYZE], destination[XYZE];
+uint8_t active_extruder = 0;
+
+// planner.buffer_line() records the pieces and the stack depth
+char *stack_base;
+size_t max_stack;
+std::vector<float> pieces;
+struct {
+  __attribute__((noinline)) void buffer_line(float x, float y, float z, float e, float, uint8_t) {
+    const size_t depth = stack_base - (char*)__builtin_frame_address(0);
+    if (depth > max_stack) max_stack = depth;
+    pieces.push_back(x); pieces.push_back(y); pieces.push_back(z); pieces.push_back(e);
+  }
+} planner;
+inline void line_to_destination(const float fr_mm_s) {
+  planner.buffer_line(destination[X_AXIS], destination[Y_AXIS], destination[Z_AXIS], destination[E_AXIS], fr_mm_s, active_extruder);
+}
+inline void set_current_to_destination() { COPY(current_position, destination); }
+'''
+
+# The recursive version, as it was before grid_line_to_destination()
+RECURSIVE = r'''
+namespace recursive {
+  void bilinear_line_to_destination(float fr_mm_s, uint16_t x_splits = 0xFFFF, uint16_t y_splits = 0xFFFF) {
+    int cx1 = CELL_INDEX(X, current_position[X_AXIS]),
+        cy1 = CELL_INDEX(Y, current_position[Y_AXIS]),
+        cx2 = CELL_INDEX(X, destination[X_AXIS]),
+        cy2 = CELL_INDEX(Y, destination[Y_AXIS]);
+    cx1 = constrain(cx1, 0, ABL_BG_POINTS_X - 2);
+    cy1 = constrain(cy1, 0, ABL_BG_POINTS_Y - 2);
+    cx2 = constrain(cx2, 0, ABL_BG_POINTS_X - 2);
+    cy2 = constrain(cy2, 0, ABL_BG_POINTS_Y - 2);
+
+    if (cx1 == cx2 && cy1 == cy2) {
+      line_to_destination(fr_mm_s);
+      set_current_to_destination();
+      return;
+    }
+
+    float normalized_dist, end[XYZE];
+    const int8_t gcx = max(cx1, cx2), gcy = max(cy1, cy2);
+    if (cx2 != cx1 && TEST(x_splits, gcx)) {
+      COPY(end, destination);
+      destination[X_AXIS] = LOGICAL_X_POSITION(bilinear_start[X_AXIS] + ABL_BG_SPACING(X_AXIS) * gcx);
+      normalized_dist = (destination[X_AXIS] - current_position[X_AXIS]) / (end[X_AXIS] - current_position[X_AXIS]);
+      destination[Y_AXIS] = LINE_SEGMENT_END(Y);
+      CBI(x_splits, gcx);
+    }
+    else if (cy2 != cy1 && TEST(y_splits, gcy)) {
+      COPY(end, destination);
+      destination[Y_AXIS] = LOGICAL_Y_POSITION(bilinear_start[Y_AXIS] + ABL_BG_SPACING(Y_AXIS) * gcy);
+      normalized_dist = (destination[Y_AXIS] - current_position[Y_AXIS]) / (end[Y_AXIS] - current_position[Y_AXIS]);
+      destination[X_AXIS] = LINE_SEGMENT_END(X);
+      CBI(y_splits, gcy);
+    }
+    else {
+      line_to_destination(fr_mm_s);
+      set_current_to_destination();
+      return;
+    }
+
+    destination[Z_AXIS] = LINE_SEGMENT_END(Z);
+    destination[E_AXIS] = LINE_SEGMENT_END(E);
+    bilinear_line_to_destination(fr_mm_s, x_splits, y_splits);
+    COPY(destination, end);
+    bilinear_line_to_destination(fr_mm_s, x_splits, y_splits);
+  }
+}
+'''
+
+MAIN = r'''
+// Run one move with either version. Returns the pieces, without zero length ones
+static std::vector<float> run(const bool iterative, const float from[XYZE], const float to[XYZE], size_t &stack) {
+  pieces.clear();
+  memcpy(current_position, from, sizeof(current_position));
+  memcpy(destination, to, sizeof(destination));
+  char here;
+  stack_base = &here;
+  max_stack = 0;
+  if (iterative) bilinear_line_to_destination(50);
+  else recursive::bilinear_line_to_destination(50);
+  stack = max_stack;
+  std::vector<float> out;
+  float last[2] = { from[X_AXIS], from[Y_AXIS] };
+  for (size_t i = 0; i < pieces.size(); i += 4) {
+    if (fabsf(pieces[i] - last[0]) < 1e-3f && fabsf(pieces[i + 1] - last[1]) < 1e-3f) continue;
+    out.insert(out.end(), pieces.begin() + i, pieces.begin() + i + 4);
+    last[0] = pieces[i]; last[1] = pieces[i + 1];
+  }
+  return out;
+}
+
+// The pieces of a move: ends at each grid line crossed, in double precision
+static std::vector<float> expected(const float from[XYZE], const float to[XYZE]) {
+  std::vector<double> ts;
+  for (int i = 1; i < GRID_MAX_POINTS_X - 1; i++) {
+    const double x = bilinear_start[X_AXIS] + bilinear_grid_spacing[X_AXIS] * i;
+    if ((from[X_AXIS] - x) * (to[X_AXIS] - x) < 0) ts.push_back((x - from[X_AXIS]) / (double(to[X_AXIS]) - from[X_AXIS]));
+  }
+  for (int i = 1; i < GRID_MAX_POINTS_Y - 1; i++) {
+    const double y = bilinear_start[Y_AXIS] + bilinear_grid_spacing[Y_AXIS] * i;
+    if ((from[Y_AXIS] - y) * (to[Y_AXIS] - y) < 0) ts.push_back((y - from[Y_AXIS]) / (double(to[Y_AXIS]) - from[Y_AXIS]));
+  }
+  ts.push_back(1);
+  std::sort(ts.begin(), ts.end());
+  std::vector<float> out;
+  float last[2] = { from[X_AXIS], from[Y_AXIS] };
+  for (const double t : ts) {
+    float p[XYZE];
+    LOOP_XYZE(i) p[i] = from[i] + (double(to[i]) - from[i]) * t;
+    if (fabsf(p[X_AXIS] - last[0]) < 1e-3f && fabsf(p[Y_AXIS] - last[1]) < 1e-3f) continue;
+    out.insert(out.end(), p, p + XYZE);
+    last[0] = p[X_AXIS]; last[1] = p[Y_AXIS];
+  }
+  return out;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  const float lo = bilinear_start[X_AXIS] - 20,
+              hi = bilinear_start[X_AXIS] + (GRID_MAX_POINTS_X - 1) * bilinear_grid_spacing[X_AXIS] + 20,
+              g0 = bilinear_start[X_AXIS], g1 = g0 + (GRID_MAX_POINTS_X - 1) * bilinear_grid_spacing[X_AXIS];
+  std::uniform_real_distribution<float> u(lo, hi);
+  size_t stack[2] = { 0 }, most_pieces[2] = { 0 };
+  float max_diff = 0;
+  int wrong = 0;
+  for (int m = 0; m < %(moves)d + 4; m++) {
+    float from[XYZE], to[XYZE];
+    switch (m) {
+      case 0: from[0] = g0; from[1] = g0; to[0] = g1; to[1] = g1; break;    // through every corner
+      case 1: from[0] = g1; from[1] = g0; to[0] = g0; to[1] = g1; break;
+      case 2: from[0] = lo; from[1] = g0 + bilinear_grid_spacing[Y_AXIS]; to[0] = hi; to[1] = from[1]; break;  // along a grid line
+      case 3: from[0] = hi; from[1] = hi; to[0] = lo; to[1] = lo + 1; break;
+      default: from[0] = u(rng); from[1] = u(rng); to[0] = u(rng); to[1] = u(rng);
+    }
+    from[2] = 0.2f; to[2] = 0.4f; from[3] = 0; to[3] = 10;
+    size_t s[2];
+    const std::vector<float> a = run(false, from, to, s[0]), b = run(true, from, to, s[1]), e = expected(from, to);
+    for (int i = 0; i < 2; i++) if (s[i] > stack[i]) stack[i] = s[i];
+    most_pieces[0] = max(most_pieces[0], a.size() / 4);
+    most_pieces[1] = max(most_pieces[1], b.size() / 4);
+    if (b.size() != e.size()) { wrong++; continue; }
+    float d = 0;
+    for (size_t i = 0; i < b.size(); i++) d = max(d, fabsf(b[i] - e[i]));
+    if (d > %(tolerance)g) wrong++;
+    max_diff = max(max_diff, d);
+  }
+  printf("%%zu %%zu %%zu %%zu %%d %%g\n", stack[0], stack[1], most_pieces[0], most_pieces[1], wrong, max_diff);
+  return 0;
+}
+'''
+
+
+def extract():
+  """ CELL_INDEX, grid_line_to_destination() and bilinear_line_to_destination() """
+  grid = host.extract(args, 'Marlin_main.cpp', r'\n  /\*\*\n   \* Buffer the move from current_position.*?\n  }\n', 'grid_line_to_destination()')
+  abl = host.extract(args, 'Marlin_main.cpp', r'\n  #define CELL_INDEX.*?\n  void bilinear_line_to_destination\(.*?\n  }\n', 'bilinear_line_to_destination()')
+  lines = '#define GRID_LINE_X(I) LOGICAL_X_POSITION(bilinear_start[X_AXIS] + ABL_BG_SPACING(X_AXIS) * (I))\n' \
+          '#define GRID_LINE_Y(I) LOGICAL_Y_POSITION(bilinear_start[Y_AXIS] + ABL_BG_SPACING(Y_AXIS) * (I))\n'
+  segment_end = '#define LINE_SEGMENT_END(A) (current_position[A ##_AXIS] + (destination[A ##_AXIS] - current_position[A ##_AXIS]) * normalized_dist)\n'
+  return lines + grid + abl + segment_end
+
+
+code = extract()
+src = PRELUDE % vars(args) + code + RECURSIVE + MAIN % vars(args)
+with host.HostBuild(args) as build:
+  out = host.output(build.build(src)).split()
+
+stack_recursive, stack_iterative, pieces_recursive, pieces_iterative, wrong, max_diff = int(out[0]), int(out[1]), int(out[2]), int(out[3]), int(out[4]), float(out[5])
+print('grid %dx%d, %d moves' % (args.points, args.points, args.moves + 4))
+print('%-10s %14s %22s' % ('', 'max pieces', 'max stack at buffer_line'))
+print('%-10s %14d %16d bytes' % ('recursive', pieces_recursive, stack_recursive))
+print('%-10s %14d %16d bytes' % ('iterative', pieces_iterative, stack_iterative))
+print('moves split wrong: %d (largest difference %.2g mm)' % (wrong, max_diff))
+sys.exit(1 if wrong else 0)
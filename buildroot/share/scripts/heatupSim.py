@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+
+""" Compare serial and concurrent heat-up of the bed, chamber and hotends.
+
+Each heater is a first order thermal model (power, heat capacity, loss to
+ambient) driven by a simple controller through the 0..127 soft PWM at PID_dT.
+Two start sequences are timed until every heater has reached its target:
+  serial      M190, chamber wait, M109 T0, M109 T1 ...  (each heater starts
+              when the one before is done and then holds its target)
+  concurrent  all targets set, then M116, with HEATER_POWER_BUDGET sharing
+              the PSU as apply_power_budget() does
+The heating watch (WATCH_TEMP_PERIOD / WATCH_BED_TEMP_PERIOD) runs as in
+manage_heater(). Each concurrent heat-up is then run again with the sensor of
+one heater detached (stuck at ambient), which the watch must catch.
+
+Exits with status 1 if the concurrent heat-up is slower or goes over the
+budget, the watch reports a heating failure of a working heater, or misses a
+detached sensor.
+
+Example:
+  heatupSim.py
+  heatupSim.py --budget 480 --hotends 2 --hotend-target 380 --chamber-on-psu
+"""
+
+import argparse
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-b', '--budget', type=float, default=360, help='PSU_POWER_BUDGET in W (default=360)')
+parser.add_argument('--hotends', type=int, default=2, help='number of hotends (default=2)')
+parser.add_argument('--hotend-target', type=float, default=300, help='hotend target (default=300)')
+parser.add_argument('--bed-target', type=float, default=120, help='bed target (default=120)')
+parser.add_argument('--chamber-target', type=float, default=60, help='chamber target, 0 for none (default=60)')
+parser.add_argument('--chamber-on-psu', action='store_true', help='count the chamber heater in the budget (CHAMBER_HEATER_WATTS > 0)')
+parser.add_argument('--bed-residency', type=float, default=10, help='TEMP_BED_RESIDENCY_TIME of M190 (default=10)')
+parser.add_argument('--ambient', type=float, default=25, help='ambient temperature (default=25)')
+parser.add_argument('--watch', type=float, default=30, help='WATCH_TEMP_PERIOD (default=30)')
+parser.add_argument('--watch-bed', type=float, default=60, help='WATCH_BED_TEMP_PERIOD (default=60)')
+parser.add_argument('--dt', type=float, default=16 * 10 / (16000000 / 64.0 / 256.0), help='PID_dT in seconds')
+args = parser.parse_args()
+
+TEMP_HYSTERESIS, TEMP_WINDOW, WATCH_TEMP_INCREASE = 3, 1, 2
+
+
+class Heater:
+  """ name, watts, heat capacity J/K, loss W/K, target, full power heat rate estimate (K/s), counted in the budget """
+
+  def __init__(self, name, watts, capacity, loss, target, rate, on_psu, watch):
+    self.name, self.watts, self.capacity, self.loss, self.target, self.rate, self.on_psu = name, watts, capacity, loss, target, rate, on_psu
+    self.temp = args.ambient
+    self.on = False
+    self.pwm = 0
+    self.detached = False
+    self.watch_period, self.watch_ms, self.watch_target = watch, None, 0
+    self.held = self.starved = False
+
+  def reading(self):
+    return args.ambient if self.detached else self.temp
+
+  def start_watching(self, t):
+    """ start_watching_heater() / start_watching_bed() """
+    if self.watch_period and self.reading() < self.target - (WATCH_TEMP_INCREASE + TEMP_HYSTERESIS + 1):
+      self.watch_target, self.watch_ms = self.reading() + WATCH_TEMP_INCREASE, t + self.watch_period
+    else:
+      self.watch_ms = None
+
+  def check_watch(self, t):
+    """ True if manage_heater() reports the heating failed """
+    if self.watch_ms is None or t < self.watch_ms: return False
+    if self.reading() < self.watch_target: return True
+    self.start_watching(t)
+    return False
+
+  def request(self):
+    """ Full power far from the target, proportional near it around the holding power """
+    if not self.on: return 0
+    error = self.target - self.reading()
+    hold = self.loss * (self.target - args.ambient) / self.watts * 127
+    return int(max(0, min(127, hold + error * 40)))
+
+  def step(self):
+    self.temp += (self.watts * self.pwm / 127.0 - self.loss * (self.temp - args.ambient)) * args.dt / self.capacity
+
+  def reached(self):
+    return self.temp >= self.target - TEMP_WINDOW
+
+
+def heaters():
+  """ The CreatBot defaults of HEATER_POWER_BUDGET with rough PEEK300 hotends, bed and chamber """
+  h = [Heater('bed', 300, 700, 0.9, args.bed_target, 0.3, True, args.watch_bed)]
+  if args.chamber_target:
+    h.append(Heater('chamber', 400, 6000, 4.0, args.chamber_target, 0.05, args.chamber_on_psu, 0))
+  h += [Heater('hotend %d' % e, 40, 16.7, 0.068, args.hotend_target, 2.0, True, args.watch) for e in range(args.hotends)]
+  return h
+
+
+def apply_power_budget(hs, t):
+  """ Mirror Temperature::apply_power_budget(), with its restarts of the heating watch """
+  budgeted = [h for h in hs if h.on_psu]
+  left = int(args.budget) * 127
+  held, starved = set(), set()
+  if sum(h.pwm * h.watts for h in budgeted) > left:
+    def time_left(h):
+      to_go = h.target - h.reading()
+      return to_go / h.rate if to_go > TEMP_HYSTERESIS else 1e6
+
+    for h in sorted(budgeted, key=time_left, reverse=True):   # stable, like the insertion sort
+      if h.pwm * h.watts > left:
+        h.pwm = left // h.watts
+        held.add(h.name)
+        if not h.pwm: starved.add(h.name)
+      left -= h.pwm * h.watts
+  for h in budgeted:
+    now_held, now_starved = h.name in held, h.name in starved
+    if now_starved:
+      h.watch_ms = None
+    elif (now_held and not h.held) or h.starved:
+      h.start_watching(t)
+    h.held, h.starved = now_held, now_starved
+
+
+def simulate(concurrent, detach=None):
+  """ Returns (seconds until all targets are reached, peak PSU watts, per heater reach times, heating failures) """
+  hs = heaters()
+  order = list(hs)
+  if concurrent:
+    for h in hs:
+      h.on = True
+      h.start_watching(0)
+      h.detached = h.name == detach
+  reached_at, failures = {}, {}
+  t, residency, peak = 0.0, None, 0
+  while len(reached_at) < len(hs):
+    if not concurrent:
+      # Start the next heater when the current wait is over
+      cur = next(h for h in order if h.name not in reached_at)
+      if not cur.on: cur.start_watching(t)
+      cur.on = True
+    for h in hs:
+      if h.check_watch(t): failures.setdefault(h.name, t)
+    if detach and failures: break
+    for h in hs:
+      h.pwm = h.request()
+    if concurrent:
+      apply_power_budget(hs, t)
+    peak = max(peak, sum(h.watts * h.pwm / 127.0 for h in hs if h.on_psu))
+    for h in hs:
+      h.step()
+    t += args.dt
+    for h in hs:
+      if h.name in reached_at or not h.on or not h.reached(): continue
+      if not concurrent and h.name == 'bed' and args.bed_residency:
+        # M190 waits TEMP_BED_RESIDENCY_TIME in the window
+        if residency is None: residency = t
+        if t - residency < args.bed_residency: continue
+      if not concurrent and h is not cur: continue
+      reached_at[h.name] = t
+    if t > 4 * 3600:
+      break
+  return t, peak, reached_at, failures
+
+
+print('%-12s %10s %10s   %s' % ('sequence', 'total s', 'peak W', 'reached (s)'))
+results = {}
+for name, concurrent in (('serial', False), ('concurrent', True)):
+  total, peak, reached_at, failures = simulate(concurrent)
+  results[name] = (total, peak, failures)
+  print('%-12s %10.1f %10.1f   %s' % (name, total, peak, '  '.join('%s %.0f' % r for r in sorted(reached_at.items(), key=lambda r: r[1]))))
+  for h, t in failures.items():
+    print('  FAIL heating failed reported for working %s at %.0fs' % (h, t))
+
+serial, concurrent = results['serial'][0], results['concurrent'][0]
+print('\nconcurrent heat-up takes %.0f%% of the serial time, budget %.0f W' % (100 * concurrent / serial, args.budget))
+failed = concurrent > serial or results['concurrent'][1] > args.budget + 0.5 or any(r[2] for r in results.values())
+
+print('\ndetached sensor   heating failed reported at')
+for h in heaters():
+  if not h.watch_period: continue
+  _, _, _, failures = simulate(True, h.name)
+  caught = h.name in failures
+  print('  %-14s  %s' % (h.name, '%.0fs' % failures[h.name] if caught else 'never  FAIL'))
+  failed |= not caught
+sys.exit(1 if failed else 0)
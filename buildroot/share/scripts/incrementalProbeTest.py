@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+
+""" Check G29 U (ABL_INCREMENTAL_PROBE) against a full G29.
+
+Takes bilinear_update_grid() from Marlin/Marlin_main.cpp and builds it with
+the host C++ compiler, with probe_pt() reading a simulated bed (plus
+--noise mm of probe scatter). A PROBE_XY_NUM x PROBE_XY_NUM grid is probed
+on the bed, the bed is changed, and G29 U is run on the stored grid:
+  stable   the bed is unchanged
+  tilt     the bed is re-seated 0.3mm higher at the back right corner
+  warp     a 0.3mm bump, twice the grid spacing wide, somewhere on the bed
+  dent     a 0.3mm dent one grid spacing wide (narrower than the samples)
+For each the probes taken and the largest difference of the updated grid
+from the bed are printed.
+
+Exits with status 1 if a stable bed takes more than the sample points, or
+the tilt or warp leaves a point off by more than twice the threshold.
+Features narrower than INCREMENTAL_PROBE_STRIDE can fall between the
+samples, so the dent is only reported.
+
+Example:
+  incrementalProbeTest.py
+  incrementalProbeTest.py --points 5 --stride 2 --threshold 0.03
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--spacing', type=int, default=90, help='grid spacing in mm (default=90)')
+parser.add_argument('--stride', type=int, default=3, help='INCREMENTAL_PROBE_STRIDE (default=3)')
+parser.add_argument('--threshold', type=float, default=0.05, help='INCREMENTAL_PROBE_THRESHOLD (default=0.05)')
+parser.add_argument('--noise', type=float, default=0.005, help='probe scatter in mm (default=0.005)')
+parser.add_argument('--runs', type=int, default=50, help='random beds per case (default=50)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include "macros.h"
+using std::max;
+using std::isnan;
+#define ABL_INCREMENTAL_PROBE
+#define GRID_MAX_POINTS_X %(points)d
+#define GRID_MAX_POINTS_Y %(points)d
+#define INCREMENTAL_PROBE_STRIDE %(stride)d
+#define INCREMENTAL_PROBE_THRESHOLD %(threshold)f
+#define LOGICAL_X_POSITION(P) (P)
+#define LOGICAL_Y_POSITION(P) (P)
+#define SERIAL_PROTOCOLPAIR(N, V) ((void)(V))
+#define SERIAL_PROTOCOLPGM(S)
+#define SERIAL_PROTOCOLLNPGM(S)
+#define SERIAL_PROTOCOL_F(V, P) ((void)(V))
+#define SERIAL_EOL()
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS };
+int bilinear_grid_spacing[2] = { %(spacing)d, %(spacing)d }, bilinear_start[2] = { 10, 10 };
+float z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+void idle() {}
+
+std::mt19937 rng(1);
+std::normal_distribution<float> scatter(0, %(noise)f);
+int probes;
+float (*bed)(float, float);
+
+float probe_pt(const float &lx, const float &ly, const bool, const uint8_t, const bool=true) {
+  probes++;
+  return bed(lx, ly) + scatter(rng);
+}
+'''
+
+MAIN = r'''
+const float SPAN = (GRID_MAX_POINTS_X - 1) * %(spacing)d;
+float cx, cy, width, height;
+
+float base(float x, float y) { return 0.002f * (x - 10) - 0.001f * (y - 10) + 0.1f * sinf(x / SPAN * 3) * cosf(y / SPAN * 2); }
+float tilt(float x, float y) { return base(x, y) + 0.3f * ((x - 10) + (y - 10)) / (2 * SPAN); }
+float bump(float x, float y) {
+  const float dx = (x - cx) / width, dy = (y - cy) / width;
+  return base(x, y) + height * expf(-(dx * dx + dy * dy) / 2);
+}
+
+int main() {
+  std::uniform_real_distribution<float> u(10, 10 + SPAN);
+  float (*cases[])(float, float) = { base, tilt, bump, bump };
+  for (int c = 0; c < 4; c++) {
+    int most = 0;
+    float worst = 0;
+    for (int run = 0; run < %(runs)d; run++) {
+      cx = u(rng); cy = u(rng);
+      width = c == 2 ? 2 * %(spacing)d : %(spacing)d;
+      height = c == 2 ? 0.3f : -0.3f;
+      for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+          z_values[x][y] = base(10 + x * %(spacing)d, 10 + y * %(spacing)d) + scatter(rng);
+      bed = cases[c];
+      probes = 0;
+      if (!bilinear_grid_complete() || std::isnan(bilinear_update_grid(0, false, 0))) return 1;
+      most = max(most, probes);
+      for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+          worst = max(worst, fabsf(z_values[x][y] - bed(10 + x * %(spacing)d, 10 + y * %(spacing)d)));
+    }
+    printf("%%d %%d %%f\n", c, most, worst);
+  }
+  return 0;
+}
+'''
+
+
+def extract():
+  """ bilinear_grid_complete() and bilinear_update_grid() """
+  return host.extract(args, 'Marlin_main.cpp', r'\n  #if ENABLED\(ABL_INCREMENTAL_PROBE\)\n\n    static bool bilinear_grid_complete\(.*?\n  #endif // ABL_INCREMENTAL_PROBE\n', 'bilinear_update_grid()')
+
+
+src = PRELUDE % vars(args) + extract() + MAIN % vars(args)
+with host.HostBuild(args) as build:
+  out = host.output(build.build(src))
+
+samples = len([i for i in range(args.points) if i % args.stride == 0 or i == args.points - 1]) ** 2
+print('%dx%d grid, %d sample points, %.3fmm threshold' % (args.points, args.points, samples, args.threshold))
+print('%-8s %12s %12s' % ('bed', 'most probes', 'max error'))
+failed = False
+for line in out.splitlines():
+  c, most, worst = line.split()
+  c, most, worst = int(c), int(most), float(worst)
+  print('%-8s %12d %12.3f' % (('stable', 'tilt', 'warp', 'dent')[c], most, worst))
+  if c == 0: failed |= most > samples
+  elif c in (1, 2): failed |= worst > 2 * args.threshold
+
+sys.exit(1 if failed else 0)
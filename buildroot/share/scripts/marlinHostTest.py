@@ -0,0 +1,76 @@
+""" Shared parts of the tests that build Marlin code with the host compiler.
+
+A test takes a piece of the firmware from its source with extract(), puts
+stubs for the rest of Marlin around it and builds it in a HostBuild, with
+the warnings of WARNINGS on. The -m/--marlin and --cxx options of the tests
+come from add_arguments().
+
+Example:
+  import marlinHostTest as host
+  host.add_arguments(parser)
+  args = parser.parse_args()
+  code = host.extract(args, 'print_area.cpp', r'...', 'print_area_scan()')
+  with host.HostBuild(args) as build:
+    out = host.output(build.build(PRELUDE + code + MAIN))
+"""
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+MARLIN = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', '..', 'Marlin')
+
+# As for the firmware, less the extracted functions that a test doesn't call
+WARNINGS = ['-Wall', '-Wextra', '-Wno-unused-function']
+
+
+def add_arguments(parser):
+  parser.add_argument('-m', '--marlin', default=MARLIN, help='path to the Marlin sources')
+  parser.add_argument('--cxx', default='g++', help='host C++ compiler (default=g++)')
+
+
+def extract(args, name, pattern, what, group=0):
+  """ The part of Marlin/<name> that pattern matches (with re.S), else exit saying what wasn't found """
+  with open(os.path.join(args.marlin, name)) as f:
+    m = re.search(pattern, f.read(), re.S)
+  if not m:
+    sys.exit('%s not found in %s' % (what, name))
+  return m.group(group)
+
+
+class HostBuild:
+  """ A temporary directory to build test programs and write their input in """
+
+  def __init__(self, args):
+    self.args = args
+
+  def __enter__(self):
+    self.tmp = tempfile.TemporaryDirectory()
+    return self
+
+  def __exit__(self, *exc):
+    self.tmp.cleanup()
+
+  def path(self, name):
+    return os.path.join(self.tmp.name, name)
+
+  def build(self, src, name='test', flags=()):
+    """ Build src with -O2, WARNINGS and flags, and return the program """
+    cpp, exe = self.path(name + '.cpp'), self.path(name)
+    with open(cpp, 'w') as f:
+      f.write(src)
+    subprocess.check_call([self.args.cxx, '-O2'] + WARNINGS + list(flags) + ['-I', self.args.marlin, '-o', exe, cpp])
+    return exe
+
+
+def output(exe, *argv):
+  """ What the program prints, failing if it does """
+  return subprocess.check_output([exe] + [str(a) for a in argv]).decode()
+
+
+def run(exe, *argv):
+  """ The exit status of the program and what it prints """
+  r = subprocess.run([exe] + [str(a) for a in argv], stdout=subprocess.PIPE)
+  return r.returncode, r.stdout.decode()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+
+""" Check EEPROM_MESH_COMPRESSION: leveling grids stored as 16-bit steps.
+
+Takes MarlinSettings::store_grid() and load_grid() from
+Marlin/configuration_store.cpp, with MESH_STORE_SIZE from
+Marlin/configuration_store.h and crc16() from Marlin/utility.cpp, and builds
+them with the host C++ compiler on an emulated EEPROM, with and without
+EEPROM_MESH_COMPRESSION. For each grid size random grids are stored and read
+back:
+  range     grids spanning 0.05 to 5mm, some with unprobed (NAN) points,
+            one flat grid and one with no heights at all
+  corrupt   each byte of a stored grid in turn is changed, which load_grid()
+            must refuse
+  bytes     EEPROM bytes read by M501, and written by G29 on an erased
+            grid and by G29 again on the same bed (a few microns of noise)
+Write times are for the 3.4ms the ATmega2560 takes per EEPROM byte.
+
+Exits with status 1 if a height comes back off by more than half a step,
+NAN doesn't come back as NAN, or a corrupted grid is loaded.
+
+Example:
+  meshCompressionTest.py
+  meshCompressionTest.py --grids 5,12 --runs 2000
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--grids', default='3,7,10,15', help='GRID_MAX_POINTS_X and _Y to check (default=3,7,10,15)')
+parser.add_argument('--runs', type=int, default=500, help='random grids of each size (default=500)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "macros.h"
+using std::isnan;
+#define EEPROM_SETTINGS
+#define AUTO_BED_LEVELING_BILINEAR
+%(compress)s
+#define GRID_MAX_POINTS_X %(grid)d
+#define GRID_MAX_POINTS_Y %(grid)d
+#define GRID_MAX_POINTS (GRID_MAX_POINTS_X * GRID_MAX_POINTS_Y)
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define SERIAL_ERROR_START() NOOP
+#define SERIAL_ERRORLNPGM(S) NOOP
+
+uint8_t eeprom[4096];
+long eeprom_read, eeprom_written;
+uint8_t eeprom_read_byte(const uint8_t *a) { eeprom_read++; return eeprom[(size_t)a]; }
+void eeprom_read_block(void *dst, const void *src, size_t n) { eeprom_read += n; memcpy(dst, eeprom + (size_t)src, n); }
+void eeprom_update_block(const void *src, void *dst, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    eeprom_read++;
+    if (eeprom[(size_t)dst + i] != ((const uint8_t *)src)[i]) { eeprom[(size_t)dst + i] = ((const uint8_t *)src)[i]; eeprom_written++; }
+  }
+}
+#define EEPROM_UPDATE_VAR(address, var) eeprom_update_block((const void *)&(var), (void *)(size_t)(address), sizeof(var))
+#define EEPROM_READ_VAR(address, var) eeprom_read_block((void *)&(var), (const void *)(size_t)(address), sizeof(var))
+
+class MarlinSettings {
+  public:
+    static void store_grid(const int pos, const float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+    static bool load_grid(const int pos, float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+    static bool grid_is_valid(const int pos);
+    static float grid_z(const int pos, const uint8_t x, const uint8_t y);
+};
+'''
+
+MAIN = r'''
+typedef float grid_t[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+const int POS = 332;
+int failed;
+
+int main() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> u(0, 1);
+  grid_t z, back;
+  double worst = 0;
+
+  // range
+  for (int run = 0; run < %(runs)d + 2; run++) {
+    const float range = 0.05f * powf(100, u(rng)), offset = (u(rng) - 0.5f) * 4;
+    for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+      for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+        z[x][y] = run == %(runs)d ? 0.125f : run > %(runs)d || (run & 1 && u(rng) < 0.1f) ? NAN : offset + range * u(rng);
+    float lo = 1e9, hi = -1e9;
+    for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+      for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+        if (!isnan(z[x][y])) { lo = fmin(lo, z[x][y]); hi = fmax(hi, z[x][y]); }
+    MarlinSettings::store_grid(POS, z);
+    if (!MarlinSettings::load_grid(POS, back)) { printf("FAIL grid %%d not loaded\n", run); failed = 1; }
+    for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+      for (int y = 0; y < GRID_MAX_POINTS_Y; y++) {
+        const float g = MarlinSettings::grid_z(POS, x, y);
+        if (isnan(z[x][y]) != isnan(back[x][y]) || isnan(back[x][y]) != isnan(g) || (!isnan(g) && g != back[x][y])) {
+          printf("FAIL NAN or grid_z() differs at %%d,%%d of grid %%d\n", x, y, run);
+          failed = 1;
+        }
+        if (isnan(z[x][y])) continue;
+        const double e = fabs(back[x][y] - z[x][y]), half_step = (hi - lo) / 65532.0 / 2 + 1e-6 * fabs(z[x][y]);
+        if (e > half_step) { printf("FAIL %%g off at %%d,%%d of grid %%d (half a step is %%g)\n", e, x, y, run, half_step); failed = 1; }
+        worst = fmax(worst, e / fmax(hi - lo, 1e-9));
+      }
+  }
+
+  // corrupt
+  int missed = 0, bytes = MESH_STORE_SIZE;
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      z[x][y] = u(rng) - 0.5f;
+  MarlinSettings::store_grid(POS, z);
+  for (int i = 0; i < bytes; i++) {
+    eeprom[POS + i] ^= 1 << (i & 7);
+    if (MarlinSettings::load_grid(POS, back) || MarlinSettings::grid_is_valid(POS)) missed++;
+    eeprom[POS + i] ^= 1 << (i & 7);
+  }
+
+  // bytes
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  eeprom_read = eeprom_written = 0;
+  MarlinSettings::store_grid(POS, z);
+  const long first = eeprom_written;
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      z[x][y] += (u(rng) - 0.5f) * 0.004f;
+  eeprom_written = 0;
+  MarlinSettings::store_grid(POS, z);
+  const long again = eeprom_written;
+  eeprom_read = 0;
+  MarlinSettings::load_grid(POS, back);
+  printf("%%d %%g %%d %%d %%ld %%ld %%ld\n", bytes, worst, missed, bytes, eeprom_read, first, again);
+  return failed;
+}
+'''
+
+
+def extract(name, pattern):
+  return host.extract(args, name, pattern, 'EEPROM_MESH_COMPRESSION code')
+
+
+code = (extract('configuration_store.h', r'\n\t#if ENABLED\(EEPROM_MESH_COMPRESSION\)\n.*?\n\t#endif\n')
+        + extract('utility.cpp', r'\n  void crc16\(.*?\n  }\n')
+        + extract('configuration_store.cpp', r'\n  #if ENABLED\(MESH_BED_LEVELING\) \|\| ENABLED\(AUTO_BED_LEVELING_BILINEAR\)\n.*?#endif // MESH_BED_LEVELING \|\| AUTO_BED_LEVELING_BILINEAR\n'))
+
+# EEPROM addresses are ints, the size of a pointer on AVR but not here
+HOST_FLAGS = ['-Wno-int-to-pointer-cast']
+
+failed = False
+results = {}
+with host.HostBuild(args) as build:
+  for grid in [int(g) for g in args.grids.split(',')]:
+    for compress in (False, True):
+      values = dict(vars(args), grid=grid, compress='#define EEPROM_MESH_COMPRESSION' if compress else '')
+      returncode, out = host.run(build.build(PRELUDE % values + code + MAIN % values, flags=HOST_FLAGS))
+      out = out.splitlines()
+      for line in out:
+        if line.startswith('FAIL'):
+          print('%dx%d%s: %s' % (grid, grid, ' packed' if compress else '', line))
+      size, worst, missed, _, read, first, again = out[-1].split()
+      results[grid, compress] = (int(size), float(worst), int(missed), int(read), int(first), int(again))
+      failed |= returncode != 0 or (compress and int(missed) > 0)
+
+print('%-6s %14s %14s %12s %14s %12s %16s' % ('grid', 'bytes', 'M501 read', 'max error', 'corrupt loads', 'G29 erased', 'G29 again'))
+for grid in [int(g) for g in args.grids.split(',')]:
+  raw, packed = results[grid, False], results[grid, True]
+  print('%-6s %6d -> %-5d %6d -> %-5d %11.1e %14d %5.2fs -> %.2fs %6.2fs -> %.2fs' % (
+    '%dx%d' % (grid, grid), raw[0], packed[0], raw[3], packed[3], packed[1], packed[2],
+    raw[4] * 0.0034, packed[4] * 0.0034, raw[5] * 0.0034, packed[5] * 0.0034))
+print('max error is a fraction of the range of the grid')
+
+sys.exit(1 if failed else 0)
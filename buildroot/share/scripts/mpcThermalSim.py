@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+
+""" Simulate MPCTEMP against PID on a hotend thermal model.
+
+The plant is a heater block with a heat capacity, losses to ambient (more with
+the part cooling fan), heat carried off by the filament and a lagging sensor
+with noise and the 1/256 degC resolution of the thermistor lookup. Both
+get_mpc_output() and get_pid_output() run on it at PID_dT, each driving the
+soft PWM (output >> 1, 0..127), through:
+  - a heat-up from ambient to the target
+  - the part cooling fan switching to full speed
+  - extrusion starting at the given filament speed
+
+Then M306 T is run against the plant and the identified model compared to the
+true one. Exits with status 1 if MPC doesn't settle or the autotune is off by
+more than the tolerance.
+
+Example:
+  mpcThermalSim.py
+  mpcThermalSim.py --target 380 --power 80 --flow 4
+"""
+
+import argparse
+import math
+import random
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-t', '--target', type=float, default=300, help='target temperature (default=300)')
+parser.add_argument('--ambient', type=float, default=25, help='ambient temperature (default=25)')
+parser.add_argument('--power', type=float, default=40, help='heater power in W (default=40)')
+parser.add_argument('--capacity', type=float, default=16.7, help='block heat capacity in J/K (default=16.7)')
+parser.add_argument('--sensor', type=float, default=0.22, help='sensor responsiveness in 1/s (default=0.22)')
+parser.add_argument('--loss', type=float, default=0.068, help='loss to ambient in W/K, fan off (default=0.068)')
+parser.add_argument('--loss-fan', type=float, default=0.097, help='loss to ambient in W/K, fan at 255 (default=0.097)')
+parser.add_argument('--flow', type=float, default=3, help='filament speed in mm/s during extrusion (default=3)')
+parser.add_argument('--noise', type=float, default=0.2, help='sensor noise sigma in degC (default=0.2)')
+parser.add_argument('--model-error', type=float, default=0.15, help='error of the MPC defaults vs the plant (default=0.15)')
+parser.add_argument('--tolerance', type=float, default=0.25, help='allowed relative autotune error (default=0.25)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+parser.add_argument('--dt', type=float, default=16 * 10 / (16000000 / 64.0 / 256.0), help='PID_dT in seconds')
+args = parser.parse_args()
+
+FILAMENT_HEAT_CAPACITY_PERMM = 5.6e-3
+SUBSTEPS = 10
+
+
+class Plant:
+  """ The hotend: block and sensor temperatures, advanced between readings """
+
+  def __init__(self):
+    self.block = self.sensor = args.ambient
+    self.fan = 0
+    self.e_speed = 0
+    self.rng = random.Random(args.seed)
+
+  def step(self, pwm):
+    """ Run one PID_dT with soft PWM 'pwm' (0..127), return the next reading """
+    h = args.loss + self.fan / 255.0 * (args.loss_fan - args.loss) + self.e_speed * FILAMENT_HEAT_CAPACITY_PERMM
+    dt = args.dt / SUBSTEPS
+    for _ in range(SUBSTEPS):
+      self.block += (args.power * pwm / 127.0 - h * (self.block - args.ambient)) * dt / args.capacity
+      self.sensor += (self.block - self.sensor) * args.sensor * dt
+    return self.reading()
+
+  def reading(self):
+    return int((self.sensor + self.rng.gauss(0, args.noise)) * 256) / 256.0
+
+
+class Model:
+  """ Temperature::mpc_t """
+
+  def __init__(self, power, capacity, sensor, loss, fan255_adjustment, filament):
+    self.heater_power, self.block_heat_capacity, self.sensor_responsiveness = power, capacity, sensor
+    self.ambient_xfer_coeff_fan0, self.fan255_adjustment, self.filament_heat_capacity_permm = loss, fan255_adjustment, filament
+
+
+class Mpc:
+  """ get_mpc_output() """
+
+  SMOOTHING_FACTOR, MIN_AMBIENT_CHANGE, STEADYSTATE, MAX = 0.5, 1.0, 0.5, 255
+
+  def __init__(self, model):
+    self.model = model
+    self.valid = False
+
+  def update(self, current, target, pwm, fan, e_speed):
+    m = self.model
+    if not self.valid:
+      self.block = self.sensor = current
+      self.ambient = min(current, 30)
+      self.valid = True
+    h = m.ambient_xfer_coeff_fan0 + fan / 255.0 * m.fan255_adjustment
+    f = e_speed * m.filament_heat_capacity_permm
+    block_delta = (pwm / 127.0 * m.heater_power - (h + f) * (self.block - self.ambient)) * args.dt / m.block_heat_capacity
+    self.block += block_delta
+    self.sensor += (self.block - self.sensor) * m.sensor_responsiveness * args.dt
+    correction = (current - self.sensor) * self.SMOOTHING_FACTOR
+    self.block += correction
+    self.sensor += correction
+    if 1 <= pwm <= 126 or abs(block_delta + correction) < self.STEADYSTATE * args.dt:
+      if correction > 0:
+        self.ambient += max(correction, self.MIN_AMBIENT_CHANGE * args.dt)
+      elif correction < 0:
+        self.ambient += min(correction, -self.MIN_AMBIENT_CHANGE * args.dt)
+    power = 0
+    if target:
+      power = (target - self.block) * m.block_heat_capacity * 0.5 + (target - self.ambient) * (h + f)
+    return max(0, min(self.MAX, power * 254 / m.heater_power + 1))
+
+
+class Pid:
+  """ get_pid_output() for the CreatBot PEEK300 hotend """
+
+  def __init__(self, kp=8.53, ki=0.42, kd=43, k1=0.95, functional_range=20):
+    self.kp, self.ki, self.kd, self.k1, self.range = kp, ki * args.dt, kd / args.dt, k1, functional_range
+    self.i_state = self.d_state = self.d_term = 0
+    self.reset = True
+
+  def update(self, current, target, pwm, fan, e_speed):
+    error = target - current
+    self.d_term = (1 - self.k1) * self.kd * (current - self.d_state) + self.k1 * self.d_term
+    self.d_state = current
+    if error > self.range:
+      self.reset = True
+      return 255
+    if error < -self.range or target == 0:
+      self.reset = True
+      return 0
+    if self.reset:
+      self.i_state = 0
+      self.reset = False
+    self.i_state += error
+    out = self.kp * error + self.ki * self.i_state - self.d_term
+    if out > 255:
+      if error > 0: self.i_state -= error
+      out = 255
+    elif out < 0:
+      if error < 0: self.i_state -= error
+      out = 0
+    return out
+
+
+def updates(seconds):
+  return int(seconds / args.dt)
+
+
+def run(controller):
+  """ Heat-up, fan and extrusion disturbances. Returns a dict of results """
+  plant = Plant()
+  reading, pwm = plant.reading(), 0
+  trace = []
+
+  def go(seconds):
+    nonlocal reading, pwm
+    for _ in range(updates(seconds)):
+      pwm = int(controller.update(reading, args.target, pwm, plant.fan, plant.e_speed)) >> 1
+      reading = plant.step(pwm)
+      trace.append(plant.sensor)
+
+  go(300)
+  heatup = list(trace)
+  settled = next((i for i in range(len(heatup)) if all(abs(t - args.target) <= 1 for t in heatup[i:])), None)
+  results = {
+    'settle': None if settled is None else settled * args.dt,
+    'overshoot': max(0, max(heatup) - args.target),
+  }
+  for name, setup in (('fan', lambda: setattr(plant, 'fan', 255)), ('flow', lambda: setattr(plant, 'e_speed', args.flow))):
+    del trace[:]
+    setup()
+    go(120)
+    results[name] = max(abs(t - args.target) for t in trace)
+    results[name + ' end'] = abs(trace[-1] - args.target)
+  return results
+
+
+def autotune(model):
+  """ MPC_autotune() against the plant, starting from ambient. Returns the identified model or None """
+  plant = Plant()
+  reading = plant.reading()
+  tune_temp = min(args.target, 200)
+
+  # Heat at full power, sampling once the sensor lag has settled
+  ambient_temp = reading
+  sample_start = ambient_temp + (tune_temp - ambient_temp) * 0.3
+  samples, t1_time, sample_distance, skip = [], 0, 1, 0
+  n = 0
+  while reading < tune_temp:
+    reading = plant.step(127)
+    n += 1
+    if n > updates(20 * 60): return None
+    if not samples:
+      if reading < sample_start: continue
+      t1_time = n * args.dt
+    else:
+      skip += 1
+      if skip < sample_distance: continue
+    skip = 0
+    if len(samples) == 16:
+      samples = samples[0::2]
+      sample_distance *= 2
+    samples.append(reading)
+  if len(samples) < 3: return None
+
+  mid = (len(samples) - 1) >> 1
+  t1, t2, t3 = samples[0], samples[mid], samples[mid * 2]
+  asymp = (t2 * t2 - t1 * t3) / (2 * t2 - t1 - t3)
+  block_responsiveness = -math.log((t2 - asymp) / (t1 - asymp)) / (mid * sample_distance * args.dt)
+  if not (asymp > tune_temp and block_responsiveness > 0): return None
+
+  m = Model(model.heater_power, 0, 0, 0, 0, model.filament_heat_capacity_permm)
+  m.ambient_xfer_coeff_fan0 = m.heater_power * 255 / 255.0 / (asymp - ambient_temp)
+  m.block_heat_capacity = m.ambient_xfer_coeff_fan0 / block_responsiveness
+  m.sensor_responsiveness = block_responsiveness / (1 - (ambient_temp - asymp) * math.exp(-block_responsiveness * t1_time) / (t1 - asymp))
+
+  # Hold with the new model, fan off then on, and average the power over the last 30s
+  mpc = Mpc(m)
+  mpc.block = mpc.sensor = reading
+  mpc.ambient = ambient_temp
+  mpc.valid = True
+  pwm = 0
+  powers = []
+  for fan in (0, 255):
+    plant.fan, total = fan, 0
+    for i in range(updates(60)):
+      pwm = int(mpc.update(reading, tune_temp, pwm, fan, 0)) >> 1
+      reading = plant.step(pwm)
+      if i >= updates(30): total += pwm
+    powers.append(total * m.heater_power / 127.0 / (updates(60) - updates(30)))
+  m.ambient_xfer_coeff_fan0 = powers[0] / (tune_temp - ambient_temp)
+  m.fan255_adjustment = (powers[1] - powers[0]) / (tune_temp - ambient_temp)
+  return m
+
+
+failed = False
+err = 1 + args.model_error
+defaults = Model(args.power, args.capacity * err, args.sensor / err, args.loss * err, (args.loss_fan - args.loss) / err, FILAMENT_HEAT_CAPACITY_PERMM)
+
+print('%-28s %10s %10s %10s %10s %10s %10s' % ('controller', 'settle s', 'overshoot', 'fan max', 'fan end', 'flow max', 'flow end'))
+
+
+def report(name, r):
+  settle = '-' if r['settle'] is None else '%.1f' % r['settle']
+  print('%-28s %10s %10.2f %10.2f %10.2f %10.2f %10.2f' % (name, settle, r['overshoot'], r['fan'], r['fan end'], r['flow'], r['flow end']))
+
+
+report('PID', run(Pid()))
+r = run(Mpc(defaults))
+report('MPC (defaults %+d%%)' % round(args.model_error * 100), r)
+failed |= r['settle'] is None
+
+tuned = autotune(defaults)
+if tuned is None:
+  print('autotune FAILED')
+  failed = True
+else:
+  r = run(Mpc(tuned))
+  report('MPC (autotuned)', r)
+  failed |= r['settle'] is None
+  print()
+  print('%-28s %10s %10s %8s' % ('autotune', 'plant', 'tuned', 'error'))
+  for name, true, got in (('block heat capacity J/K', args.capacity, tuned.block_heat_capacity),
+                          ('sensor responsiveness 1/s', args.sensor, tuned.sensor_responsiveness),
+                          ('ambient xfer W/K', args.loss, tuned.ambient_xfer_coeff_fan0),
+                          ('fan255 adjustment W/K', args.loss_fan - args.loss, tuned.fan255_adjustment)):
+    rel = abs(got - true) / true
+    ok = rel <= args.tolerance
+    failed |= not ok
+    print('%-28s %10.4f %10.4f %7.1f%%%s' % (name, true, got, rel * 100, '' if ok else '  FAIL'))
+
+sys.exit(1 if failed else 0)
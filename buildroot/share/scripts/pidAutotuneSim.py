@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+
+""" Run the relay autotune of M303/M305 on hotend, bed and chamber models.
+
+Each plant is a heater with a heat capacity and losses to ambient, read
+through a lagging sensor with the 1/256 degC resolution of the tables, and
+driven by the soft PWM at PID_dT. The autotune loop is run twice per plant:
+  classic  a fixed number of relay cycles (M303 C5, or 20 for the chamber)
+  fast     PID_AUTOTUNE_FAST: Ku compensated for the relay asymmetry, and a
+           stop as soon as Ku and Tu change by less than the tolerance
+
+For each run the time taken, the cycles, Ku, Tu and the resulting PID are
+printed, and the PID is tried on the plant (settle time within 1 degC).
+The fast run also prints its first order plus dead time model, with the
+plant's true static gain and time constant next to it.
+
+Exits with status 1 if the fast tune is slower, its Ku or Tu is off from
+the classic tune by more than --match, or its gain by more than --match.
+
+Example:
+  pidAutotuneSim.py
+  pidAutotuneSim.py --tolerance 0.02 --plants chamber
+"""
+
+import argparse
+import math
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--plants', nargs='+', default=['hotend', 'bed', 'chamber'], help='plants to tune (default=hotend bed chamber)')
+parser.add_argument('--tolerance', type=float, default=0.05, help='PID_AUTOTUNE_TOLERANCE (default=0.05)')
+parser.add_argument('--match', type=float, default=0.2, help='allowed relative difference to the classic tune (default=0.2)')
+parser.add_argument('--ambient', type=float, default=25, help='ambient temperature (default=25)')
+parser.add_argument('--dt', type=float, default=16 * 10 / (16000000 / 64.0 / 256.0), help='PID_dT in seconds')
+args = parser.parse_args()
+
+# name: watts, heat capacity J/K, loss W/K, sensor responsiveness 1/s, target, cycles, least half cycle (s)
+PLANTS = {
+  'hotend':  (40, 16.7, 0.068, 0.22, 200, 5, 5),
+  'bed':     (300, 700, 0.9, 0.05, 70, 5, 5),
+  'chamber': (400, 6000, 4.0, 0.01, 50, 20, 40),
+}
+
+
+class Plant:
+
+  def __init__(self, watts, capacity, loss, sensor):
+    self.watts, self.capacity, self.loss, self.sensor_k = watts, capacity, loss, sensor
+    self.block = self.sensor = args.ambient
+
+  def step(self, pwm):
+    """ Run one PID_dT at soft PWM 'pwm' (0..127), return the reading """
+    sub = 10
+    dt = args.dt / sub
+    for _ in range(sub):
+      self.block += (self.watts * pwm / 127.0 - self.loss * (self.block - args.ambient)) * dt / self.capacity
+      self.sensor += (self.block - self.sensor) * self.sensor_k * dt
+    return int(self.sensor * 256) / 256.0
+
+  def gain(self):
+    """ Static gain in degC per unit of power (0..255) """
+    return self.watts / 255.0 / self.loss
+
+
+def autotune(name, fast):
+  """ Mirror PID_autotune() / PID_autotune_Chamber(). Returns a dict or None """
+  watts, capacity, loss, sensor, temp, ncycles, half = PLANTS[name]
+  plant = Plant(watts, capacity, loss, sensor)
+  max_pow = 255
+  bias = d = max_pow >> 1
+  heating = True
+  cycles = 0
+  t = t1 = t2 = 0.0
+  t_high = t_low = 0.0
+  mx, mn = 0, 10000
+  Ku = Tu = None
+  converged = False
+  ambient = reading = plant.sensor
+  temp_sum = power_sum = time_sum = 0.0
+  last_Ku = last_Tu = 0
+  model = None
+  while True:
+    power = bias + d if heating else bias - d
+    reading = plant.step(power >> 1)
+    t += args.dt
+    temp_sum += reading * args.dt
+    power_sum += power * args.dt
+    time_sum += args.dt
+    mx, mn = max(mx, reading), min(mn, reading)
+    if heating and reading > temp and t >= t2 + half:
+      heating = False
+      t1 = t
+      t_high = t1 - t2
+      mx = temp
+      if cycles == 0: rise = (reading - ambient, t1, bias + d)
+    if not heating and reading < temp and t >= t1 + half:
+      heating = True
+      t2 = t
+      t_low = t2 - t1
+      if cycles > 0:
+        cycle_d = d
+        bias += int(d * (t_high - t_low) / (t_low + t_high))
+        bias = max(20, min(max_pow - 20, bias))
+        d = max_pow - 1 - bias if bias > max_pow / 2 else bias
+        if fast and cycles > 1:
+          period = t_high + t_low
+          Tu = period
+          Ku = 4.0 * cycle_d * math.sin(math.pi * t_high / period) / (math.pi * (mx - mn) * 0.5)
+          mean_temp, mean_power = temp_sum / time_sum, power_sum / time_sum
+          gain = (mean_temp - ambient) / mean_power if mean_power > 0 else 0
+          # Time constant from the first heat-up at full power, dead time from the phase at Tu
+          if 0 < rise[0] < gain * rise[2]:
+            tau = -rise[1] / math.log(1 - rise[0] / (gain * rise[2]))
+            dead = Tu / (2 * math.pi) * (math.pi - math.atan(2 * math.pi * tau / Tu))
+            model = (gain, tau, dead)
+          converged = last_Ku > 0 and abs(Ku - last_Ku) <= args.tolerance * Ku and abs(Tu - last_Tu) <= args.tolerance * Tu
+          last_Ku, last_Tu = Ku, Tu
+        elif not fast and cycles > 2:
+          Ku = 4.0 * d / (math.pi * (mx - mn) * 0.5)
+          Tu = t_low + t_high
+      temp_sum = power_sum = time_sum = 0.0
+      cycles += 1
+      mn = temp
+    if reading > temp + 20:
+      return None
+    if cycles > ncycles or converged:
+      break
+    if t > 6 * 3600:
+      return None
+  kp = 0.6 * Ku
+  return {'time': t, 'cycles': cycles, 'Ku': Ku, 'Tu': Tu, 'pid': (kp, 2 * kp / Tu, kp * Tu * 0.125), 'model': model, 'plant': plant}
+
+
+def settle(name, pid):
+  """ Heat from ambient with the tuned PID, seconds until within 1 degC for good """
+  watts, capacity, loss, sensor, temp, _, _ = PLANTS[name]
+  plant = Plant(watts, capacity, loss, sensor)
+  kp, ki, kd = pid[0], pid[1] * args.dt, pid[2] / args.dt
+  reading, i_state, d_state, d_term, reset = plant.sensor, 0.0, plant.sensor, 0.0, True
+  trace = []
+  for _ in range(int(3 * 3600 / args.dt)):
+    error = temp - reading
+    d_term = 0.05 * kd * (reading - d_state) + 0.95 * d_term
+    d_state = reading
+    if error > 10:
+      out, reset = 255, True
+    elif error < -10:
+      out, reset = 0, True
+    else:
+      if reset:
+        i_state, reset = 0.0, False
+      i_state += error
+      out = kp * error + ki * i_state - d_term
+      if out > 255:
+        if error > 0: i_state -= error
+        out = 255
+      elif out < 0:
+        if error < 0: i_state -= error
+        out = 0
+    reading = plant.step(int(out) >> 1)
+    trace.append(reading)
+  last_out = max((i for i, r in enumerate(trace) if abs(r - temp) > 1), default=-1)
+  return None if last_out >= len(trace) - 1 else (last_out + 1) * args.dt
+
+
+failed = False
+print('%-8s %-8s %9s %7s %9s %8s %9s %9s %9s %10s' % ('plant', 'tune', 'time s', 'cycles', 'Ku', 'Tu', 'Kp', 'Ki', 'Kd', 'settle s'))
+for name in args.plants:
+  results = {}
+  for fast in (False, True):
+    r = autotune(name, fast)
+    tune = 'fast' if fast else 'classic'
+    if r is None:
+      print('%-8s %-8s FAILED' % (name, tune))
+      failed = True
+      continue
+    results[tune] = r
+    s = settle(name, r['pid'])
+    print('%-8s %-8s %9.0f %7d %9.2f %8.1f %9.2f %9.3f %9.1f %10s' % (name, tune, r['time'], r['cycles'], r['Ku'], r['Tu'], r['pid'][0], r['pid'][1], r['pid'][2], '-' if s is None else '%.0f' % s))
+  if len(results) < 2: continue
+  c, f = results['classic'], results['fast']
+  if f['model']:
+    gain, tau, dead = f['model']
+    true_gain = f['plant'].gain()
+    true_tau = PLANTS[name][1] / PLANTS[name][2]
+    print('%-8s model    gain %.4f (plant %.4f)  tau %.0fs (plant %.0fs)  dead time %.1fs  hold power %.0f/255 at %d' % (name, gain, true_gain, tau, true_tau, dead, (PLANTS[name][4] - args.ambient) / gain, PLANTS[name][4]))
+    failed |= abs(gain - true_gain) > args.match * true_gain
+  else:
+    print('%-8s model    none' % name)
+    failed = True
+  failed |= f['time'] > c['time']
+  failed |= abs(f['Ku'] - c['Ku']) > args.match * c['Ku'] or abs(f['Tu'] - c['Tu']) > args.match * c['Tu']
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+
+""" Check the PID_AUTOTUNE_FAST helpers of temperature.cpp.
+
+Takes autotune_start(), autotune_sample(), autotune_rise(), autotune_cycle()
+and autotune_next() from Marlin/temperature.cpp and builds them with the
+host C++ compiler. The cycle measurements are kept in memory filled with
+junk first, as a stack local would be, and:
+  start    autotune_start() must clear every field but the ambient
+           temperature and the start time
+  relay    the relay loop of PID_autotune() runs on a hotend (a heater with
+           heat capacity and losses, read through a lagging sensor with
+           1/256 degC resolution) for --cycles cycles
+For the relay the cycle the helpers settle on, its Ku and Tu, those of the
+last cycle and the model gain next to the plant's are printed.
+
+Exits with status 1 if a field isn't cleared, the tune settles on the first
+cycle that has Ku and Tu, it doesn't settle, its Ku or Tu is off from the
+last cycle by more than --match, or its gain from the plant's by more than
+--match.
+
+Example:
+  pidAutotuneTest.py
+  pidAutotuneTest.py --tolerance 0.02 --cycles 20
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--tolerance', type=float, default=0.05, help='PID_AUTOTUNE_TOLERANCE (default=0.05)')
+parser.add_argument('--match', type=float, default=0.2, help='allowed relative difference (default=0.2)')
+parser.add_argument('--cycles', type=int, default=12, help='relay cycles to run (default=12)')
+parser.add_argument('--target', type=float, default=200, help='autotune temperature (default=200)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "macros.h"
+#define PID_AUTOTUNE_TOLERANCE %(tolerance)f
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define SERIAL_PROTOCOLPAIR(N, V) ((void)(V))
+#define SERIAL_PROTOCOLLNPAIR(N, V) ((void)(V))
+typedef uint32_t millis_t;
+millis_t now;
+millis_t millis() { return now; }
+'''
+
+MAIN = r'''
+// 40W hotend of 16.7J/K losing 0.068W/K, sensor lagging at 0.22/s
+const float WATTS = 40, CAPACITY = 16.7, LOSS = 0.068, SENSOR = 0.22, AMBIENT = 25, DT = 16 * 10 / (16000000 / 64.0 / 256.0);
+float block = AMBIENT, sensor = AMBIENT;
+
+float step(const long pwm) {
+  for (int i = 0; i < 10; i++) {
+    block += (WATTS * pwm / 127.0 - LOSS * (block - AMBIENT)) * DT / 10 / CAPACITY;
+    sensor += (block - sensor) * SENSOR * DT / 10;
+  }
+  now += DT * 1000;
+  return int(sensor * 256) / 256.0;
+}
+
+int main() {
+  union { autotune_cycle_t at; uint8_t raw[sizeof(autotune_cycle_t)]; } junk;
+  memset(junk.raw, 0x41, sizeof(junk.raw));
+  autotune_cycle_t &at = junk.at;
+
+  now = 12345;
+  autotune_start(at, AMBIENT);
+  printf("start %%d\n", at.ambient == AMBIENT && at.start_ms == now && at.sample_ms == now
+    && !at.rise && !at.rise_power && !at.temp_sum && !at.power_sum && !at.gain
+    && !at.last_Ku && !at.last_Tu && !at.rise_ms && !at.time_sum);
+
+  // The relay loop of PID_autotune() for a hotend
+  const float temp = %(target)f;
+  const long max_pow = 255;
+  long bias = max_pow >> 1, d = bias, t_high = 0, t_low = 0;
+  millis_t t1 = now, t2 = now;
+  float max = 0, min = 10000, Ku = 0, Tu = 0, settled_Ku = 0, settled_Tu = 0, settled_gain = 0;
+  int cycles = 0, first = 0, settled = 0;
+  bool heating = true;
+  while (cycles <= %(cycles)d) {
+    const float input = step((heating ? bias + d : bias - d) >> 1);
+    const millis_t ms = now;
+    NOLESS(max, input);
+    NOMORE(min, input);
+    autotune_sample(at, input, heating ? bias + d : bias - d, ms);
+    if (heating && input > temp && ms - t2 > 5000UL) {
+      heating = false;
+      if (cycles == 0) autotune_rise(at, input, bias + d, ms);
+      t1 = ms;
+      t_high = t1 - t2;
+      max = temp;
+    }
+    if (!heating && input < temp && ms - t1 > 5000UL) {
+      heating = true;
+      t2 = ms;
+      t_low = t2 - t1;
+      if (cycles > 0) {
+        const long cycle_d = d;
+        bias += (d * (t_high - t_low)) / (t_low + t_high);
+        bias = constrain(bias, 20, max_pow - 20);
+        d = (bias > max_pow / 2) ? max_pow - 1 - bias : bias;
+        if (cycles > 1) {
+          if (!first) first = cycles;
+          if (autotune_cycle(at, cycle_d, t_high, t_low, max, min, Ku, Tu) && !settled) {
+            settled = cycles;
+            settled_Ku = Ku;
+            settled_Tu = Tu;
+            settled_gain = at.gain;
+          }
+        }
+      }
+      autotune_next(at);
+      cycles++;
+      min = temp;
+    }
+    if (input > temp + 20) return 1;
+  }
+  printf("relay %%d %%d %%f %%f %%f %%f %%f %%f\n", first, settled, settled_Ku, settled_Tu, Ku, Tu, settled_gain, WATTS / 255.0 / LOSS);
+  return 0;
+}
+'''
+
+
+def extract():
+  """ autotune_cycle_t and the autotune_* helpers """
+  return host.extract(args, 'temperature.cpp', r'\n  typedef struct {\n    float ambient,.*?\n(?=#endif // PID_AUTOTUNE_FAST)', 'autotune_start()')
+
+
+src = PRELUDE % vars(args) + extract() + MAIN % vars(args)
+with host.HostBuild(args) as build:
+  out = host.output(build.build(src))
+
+failed = False
+for line in out.splitlines():
+  name, *v = line.split()
+  if name == 'start':
+    ok = v[0] == '1'
+    print('start    %s' % ('cleared' if ok else 'FAIL: fields left uncleared'))
+  else:
+    first, settled = int(v[0]), int(v[1])
+    Ku, Tu, last_Ku, last_Tu, gain, plant_gain = map(float, v[2:])
+    ok = first < settled and abs(Ku - last_Ku) <= args.match * last_Ku and abs(Tu - last_Tu) <= args.match * last_Tu \
+         and abs(gain - plant_gain) <= args.match * plant_gain
+    print('relay    settled at cycle %d (first Ku/Tu at %d)  Ku %.2f Tu %.1f  last Ku %.2f Tu %.1f  gain %.4f (plant %.4f)%s' % (
+      settled, first, Ku, Tu, last_Ku, last_Tu, gain, plant_gain, '' if ok else '  FAIL'))
+  failed |= not ok
+
+sys.exit(1 if failed else 0)
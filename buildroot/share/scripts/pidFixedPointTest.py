@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+
+""" Compare the float and PID_FIXED_POINT heater PID loops.
+
+Runs the hotend, bed and chamber PID loops of temperature.cpp in closed loop
+with a simple first order heater model (or on a recorded temperature trace)
+twice: once with float math and once with the fixed-point math used by
+PID_FIXED_POINT (16.16 gains, 24.8 temperatures and terms). Fails if the PWM
+outputs differ by more than the tolerance at any step.
+
+First pid_mul_gain() is taken from Marlin/temperature.h and built with the
+host C++ compiler. Fails if its 16-bit split multiply ever differs from a
+64-bit multiply and shift, or from the model used for the loops here (checked
+on --products random and edge case operands).
+
+A trace file has one temperature per line (degC, one line per PID update).
+
+Example:
+  pidFixedPointTest.py
+  pidFixedPointTest.py --trace hotend.txt --target 230 --kp 22.2 --ki 1.08 --kd 114
+"""
+
+import argparse
+import random
+import struct
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-t', '--tolerance', type=float, default=1.0, help='max output difference in PWM units (default=1)')
+parser.add_argument('--trace', help='file of recorded temperatures, replaces the heater model')
+parser.add_argument('--target', type=int, help='target for --trace')
+parser.add_argument('--kp', type=float, default=22.2, help='Kp for --trace')
+parser.add_argument('--ki', type=float, default=1.08, help='Ki for --trace (unscaled)')
+parser.add_argument('--kd', type=float, default=114, help='Kd for --trace (unscaled)')
+parser.add_argument('--products', type=int, default=200000, help='random operands for the pid_mul_gain() check (default=200000)')
+parser.add_argument('--dt', type=float, default=16 * 10 / (16000000 / 64.0 / 256.0), help='PID_dT in seconds')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cstdint>
+#include <cstdio>
+#define FORCE_INLINE inline
+typedef int32_t pid_value_t;
+'''
+
+# Reads operand pairs, prints their products
+MAIN = r'''
+int main(int, char **argv) {
+  FILE *f = fopen(argv[1], "r");
+  long g, x;
+  while (fscanf(f, "%ld %ld", &g, &x) == 2) printf("%ld\n", (long)pid_mul_gain(g, x));
+  fclose(f);
+  return 0;
+}
+'''
+
+
+def f32(x):
+  """ Round to single precision, like float math on AVR """
+  return struct.unpack('f', struct.pack('f', x))[0]
+
+
+def i32(x):
+  """ Truncate toward zero into an int32_t, as a C cast does """
+  x = int(x)
+  assert -2**31 <= x < 2**31, 'int32_t overflow'
+  return x
+
+
+def mul_gain(g, x):
+  """ pid_mul_gain() in temperature.h: gh * x + gl * xh + ((gl * xl) >> 16) """
+  gh, gl, xh, xl = g >> 16, g & 0xFFFF, x >> 16, x & 0xFFFF
+  return i32(gh * x + gl * xh + ((gl * xl) >> 16))
+
+
+class FloatMath:
+  fixed = lambda self, f: f32(f)
+  value = lambda self, v: f32(v)
+  target = lambda self, t: float(t)
+  to_float = lambda self, x: x
+  mul_gain = lambda self, g, x: f32(g * x)
+  mul_k = lambda self, k, x: f32(k * x)
+  limit = lambda self, x: f32(x)
+
+
+class FixedMath:
+  fixed = lambda self, f: i32(f * 65536.0)
+  value = lambda self, v: i32(v * 256.0)
+  target = lambda self, t: t << 8
+  to_float = lambda self, x: x / 256.0
+  mul_gain = lambda self, g, x: mul_gain(g, x)
+  mul_k = lambda self, k, x: self.mul_gain(self.fixed(k), x)
+  limit = lambda self, x: max(-0x3FFFFFFF, min(0x3FFFFFFF, x))
+
+
+class Pid:
+  """ get_pid_output() / get_pid_output_bed() / get_pid_output_chamber() """
+
+  def __init__(self, m, kp, ki, kd, k1, max_power, bang_max, functional_range):
+    self.m = m
+    gain = lambda k: m.fixed(max(-32767, min(32767, k))) if isinstance(m, FixedMath) else f32(k)
+    self.kp, self.ki, self.kd = gain(kp), gain(ki * args.dt), gain(kd / args.dt)
+    self.k1, self.max_power, self.bang_max, self.range = k1, max_power, bang_max, functional_range
+    self.i_state = self.d_state = self.d_term = 0
+    self.reset = True
+
+  def update(self, current, target):
+    m = self.m
+    cur = m.value(current)
+    error = m.target(target) - cur
+    self.d_term = m.mul_k(1.0 - self.k1, m.mul_gain(self.kd, cur - self.d_state)) + m.mul_k(self.k1, self.d_term)
+    self.d_state = cur
+    if self.range is not None and error > m.value(self.range):
+      out = m.value(self.bang_max)
+      self.reset = True
+    elif self.range is not None and (error < -m.value(self.range) or target == 0):
+      out = 0
+      self.reset = True
+    else:
+      if self.reset:
+        self.i_state = 0
+        self.reset = False
+      p_term = m.mul_gain(self.kp, error)
+      self.i_state = m.limit(self.i_state + error)
+      i_term = m.mul_gain(self.ki, self.i_state)
+      out = p_term + i_term - self.d_term
+      if out > m.value(self.max_power):
+        if error > 0: self.i_state -= error
+        out = m.value(self.max_power)
+      elif out < 0:
+        if error < 0: self.i_state -= error
+        out = 0
+    return m.to_float(out)
+
+
+def heater(gain, tau, ambient):
+  """ First order heater: returns a step function of (temperature, pwm) """
+  def step(temp, pwm):
+    return temp + (ambient + gain * pwm / 255.0 - temp) * args.dt / tau
+  return step
+
+
+CASES = [
+  # name, Kp, Ki, Kd, K1, max power, bang max, functional range, target, model
+  ('hotend 210', 22.2, 1.08, 114, 0.95, 255, 255, 20, 210, heater(400, 60, 25)),
+  ('hotend 300', 22.2, 1.08, 114, 0.95, 255, 255, 30, 300, heater(450, 60, 25)),
+  ('hotend 400', 30.0, 2.00, 150, 0.95, 255, 255, 30, 400, heater(500, 50, 25)),
+  ('bed 100', 10.0, 0.023, 305.4, 0.95, 255, 255, None, 100, heater(140, 400, 25)),
+  ('chamber 60', 40.0, 0.05, 800, 0.95, 255, 255, 3, 60, heater(90, 900, 25)),
+]
+
+runs = []
+if args.trace:
+  with open(args.trace) as f:
+    temps = [float(l) for l in f if l.strip()]
+  runs.append(('trace', args.kp, args.ki, args.kd, 0.95, 255, 255, 20, args.target, temps))
+else:
+  runs = CASES
+
+# pid_mul_gain() against ((int64_t)g * x) >> 16, which shifts arithmetically
+failed = False
+rnd = random.Random(1)
+edges = [0, 1, -1, 0xFFFF, 0x10000, -0x10000, 0x7FFF, -0x8000, 32767 << 16, -32767 << 16, 0x3FFFFFFF, -0x3FFFFFFF]
+pairs = [(g, x) for g in edges for x in edges] + [(rnd.randint(-32767 << 16, 32767 << 16), rnd.randint(-0x3FFFFFFF, 0x3FFFFFFF) >> rnd.randint(0, 30)) for _ in range(args.products)]
+code = host.extract(args, 'temperature.h', r'\n    FORCE_INLINE pid_value_t pid_mul_gain\(.*?\n    }\n', 'pid_mul_gain()')
+with host.HostBuild(args) as build:
+  exe = build.build(PRELUDE + code + MAIN)
+  with open(build.path('pairs'), 'w') as f:
+    f.writelines('%d %d\n' % p for p in pairs)
+  products = [int(l) for l in host.output(exe, build.path('pairs')).split()]
+mismatch = 0
+for (g, x), p in zip(pairs, products):
+  ref = (g * x) >> 16
+  if -2**31 <= ref < 2**31 and (p != ref or mul_gain(g, x) != p):
+    mismatch += 1
+    if mismatch <= 5: print('pid_mul_gain(%d, %d) = %d, not %d (model %d)' % (g, x, p, ref, mul_gain(g, x)))
+print('pid_mul_gain     %6d products  %d differ from the 64-bit multiply  %s' % (len(pairs), mismatch, 'ok' if not mismatch else 'FAIL'))
+failed |= mismatch > 0
+
+for name, kp, ki, kd, k1, max_power, bang_max, rng, target, model in runs:
+  fp = Pid(FloatMath(), kp, ki, kd, k1, max_power, bang_max, rng)
+  xp = Pid(FixedMath(), kp, ki, kd, k1, max_power, bang_max, rng)
+  worst = 0
+  if callable(model):
+    # Closed loop on the float controller, the fixed one sees the same temperatures
+    temp = 25.0
+    temps = []
+    for _ in range(int(1800 / args.dt)):
+      reading = int(temp * 256) / 256.0  # Thermistor tables resolve 1/256 degC
+      temps.append(reading)
+      temp = model(temp, fp.update(reading, target))
+    fp = Pid(FloatMath(), kp, ki, kd, k1, max_power, bang_max, rng)
+  else:
+    temps = model
+  for temp in temps:
+    a, b = fp.update(temp, target), xp.update(temp, target)
+    # The firmware truncates to int before use
+    diff = max(abs(int(a) - int(b)), abs(a - b))
+    worst = max(worst, diff)
+  ok = worst <= args.tolerance
+  failed |= not ok
+  print('%-12s %6d updates  final %6.2f degC  max output diff %.3f  %s' % (name, len(temps), temps[-1], worst, 'ok' if ok else 'FAIL'))
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+
+""" Check the print area that ABL_PRINT_AREA reads from a file.
+
+Takes print_area_scan() from Marlin/print_area.cpp and builds it with the
+host C++ compiler, with FILE_READER.readAhead() reading a generated file:
+  header    Cura style, the ;MINX: ;MINY: ;MAXX: ;MAXY: header must win
+  moves     no header: a purge line, layers of absolute and relative (M83,
+            G91) extrusion, G92 E0 resets, arcs, and travels outside the
+            part that must not count; no newline at the end
+  arc       no header, one R-form G3 arc of 270 degrees: the area must hold
+            its whole circle, and at most 2R more
+  long      no header and longer than PRINT_AREA_SCAN_LIMIT: no area, with
+            no more than PRINT_AREA_HEADER_SCAN bytes read
+  long hdr  the header, then more than PRINT_AREA_SCAN_LIMIT of moves
+The area of the moves is worked out here too, and the grid points G29 would
+probe on a PROBE_XY_NUM x PROBE_XY_NUM grid are printed for each file.
+
+Exits with status 1 if an area differs by more than 0.01mm, or one is found
+where it shouldn't be, or a long file is read past PRINT_AREA_HEADER_SCAN.
+
+Example:
+  printAreaTest.py
+  printAreaTest.py --layers 200 --seed 4
+"""
+
+import argparse
+import math
+import random
+import re
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--points', type=int, default=7, help='PROBE_XY_NUM (default=7)')
+parser.add_argument('--bed', type=float, default=600, help='bed size in mm (default=600)')
+parser.add_argument('--margin', type=float, default=10, help='PRINT_AREA_MARGIN (default=10)')
+parser.add_argument('--limit', type=int, default=1000000, help='PRINT_AREA_SCAN_LIMIT (default=1000000)')
+parser.add_argument('--header-scan', type=int, default=4096, help='PRINT_AREA_HEADER_SCAN (default=4096)')
+parser.add_argument('--layers', type=int, default=40, help='layers of the generated part (default=40)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "macros.h"
+#define MAX_CMD_SIZE 96
+#define _BV(b) (1 << (b))
+#define sq(x) ((x) * (x))
+#define PRINT_AREA_SCAN_LIMIT %(limit)d
+#define PRINT_AREA_HEADER_SCAN %(header_scan)d
+#define PSTR(S) (S)
+#define strncmp_P strncmp
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS, E_AXIS };
+void idle() {}
+
+struct {
+  std::string data;
+  size_t bytes_read;
+  uint32_t getFileSize() { return data.size(); }
+  int16_t readAhead(const uint32_t index, char *buf, const uint16_t len) {
+    if (index > data.size()) return -1;
+    const size_t n = std::min<size_t>(len, data.size() - index);
+    memcpy(buf, data.data() + index, n);
+    bytes_read += n;
+    return n;
+  }
+} FILE_READER;
+'''
+
+MAIN = r'''
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    FILE * const f = fopen(argv[i], "rb");
+    FILE_READER.data.clear();
+    FILE_READER.bytes_read = 0;
+    char buf[4096];
+    for (size_t n; (n = fread(buf, 1, sizeof(buf), f)) > 0;) FILE_READER.data.append(buf, n);
+    fclose(f);
+    float lo[2], hi[2];
+    if (print_area_scan(lo, hi))
+      printf("%zu %f %f %f %f\n", FILE_READER.bytes_read, lo[X_AXIS], lo[Y_AXIS], hi[X_AXIS], hi[Y_AXIS]);
+    else
+      printf("%zu none\n", FILE_READER.bytes_read);
+  }
+  return 0;
+}
+'''
+
+
+def extract():
+  return host.extract(args, 'print_area.cpp', r'#include "print_area.h"\n(.*)#endif // ABL_PRINT_AREA', 'print_area_scan()', group=1)
+
+
+class Writer:
+  """ Writes G-code and keeps the area of the extruding moves """
+  def __init__(self):
+    self.lines, self.x, self.y, self.e = [], 0.0, 0.0, 0.0
+    self.relative = self.relative_e = False
+    self.area = [1e9, 1e9, -1e9, -1e9]
+
+  def add(self, x, y):
+    self.area = [min(self.area[0], x), min(self.area[1], y), max(self.area[2], x), max(self.area[3], y)]
+
+  def move(self, x, y, de=0.0, arc=None):
+    words = 'G%d' % (arc[0] if arc else (1 if de else 0))
+    words += ' X%.3f Y%.3f' % ((x - self.x, y - self.y) if self.relative else (x, y))
+    if arc:
+      words += ' I%.3f J%.3f' % (arc[1], arc[2])
+    if de:
+      words += ' E%.5f' % (de if self.relative_e else self.e + de)
+      self.add(self.x, self.y)
+      self.add(x, y)
+      if arc:
+        r = math.hypot(arc[1], arc[2])
+        cx, cy = self.x + arc[1], self.y + arc[2]
+        self.add(cx - r, cy - r)
+        self.add(cx + r, cy + r)
+      self.e += de
+    self.lines.append(words + (' ; comment X999 E5' if random.random() < 0.05 else ''))
+    self.x, self.y = x, y
+
+
+def part(w, header):
+  rng = random.Random(args.seed)
+  cx, cy = rng.uniform(100, args.bed - 100), rng.uniform(100, args.bed - 100)
+  size = rng.uniform(20, 80)
+  if header:
+    # Values that differ from the moves, to see which wins
+    w.lines[:0] = [';FLAVOR:Marlin', ';MINX:%.3f' % (cx - size - 5), ';MINY:%.3f' % (cy - size - 5),
+                   ';MINZ:0.2', ';MAXX:%.3f' % (cx + size + 5), ';MAXY:%.3f' % (cy + size + 5), ';MAXZ:12']
+  w.lines += ['G28', 'G29', 'G92 E0']
+  # Purge line at the front left
+  w.move(5, 20)
+  w.move(5, 150, 10)
+  w.lines.append('G92 E0')
+  w.e = 0
+  for layer in range(args.layers):
+    if layer % 3 == 1:
+      w.lines.append('M83')
+      w.relative_e = True
+    elif layer % 3 == 2:
+      w.lines.append('G91')
+      w.relative = w.relative_e = True
+    # Travel far outside the part, e.g. to a wipe position
+    w.move(args.bed - 5, args.bed - 5)
+    points = [(cx + size * math.cos(a) * rng.uniform(0.8, 1), cy + size * math.sin(a) * rng.uniform(0.8, 1))
+              for a in [i * 2 * math.pi / 12 for i in range(12)]]
+    w.move(*points[0])
+    for p in points[1:]:
+      w.move(p[0], p[1], 0.05)
+    # A small arc
+    w.move(cx, cy)
+    w.move(cx + 4, cy, 0.02, (2, 2, 0))
+    if layer % 3:
+      w.lines.append('G90' if layer % 3 == 2 else 'M82')
+      w.relative = w.relative_e = False
+      w.lines.append('G92 E0')
+      w.e = 0
+  w.lines.append('M84')
+
+
+def write(header, pad=0):
+  w = Writer()
+  part(w, header)
+  text = '\n'.join(w.lines)   # No newline at the end
+  if pad:
+    text = '\n'.join([';' + ' ' * 70] * (pad // 72 + 1)) + '\n' + text
+  return text, w.area
+
+
+def grid_points(area):
+  spacing = (args.bed - 20) / (args.points - 1)
+  def index(v, up):
+    i = (math.ceil if up else math.floor)((v - 10) / spacing)
+    return max(0, min(args.points - 1, i))
+  return (index(area[0] - args.margin, False), index(area[2] + args.margin, True),
+          index(area[1] - args.margin, False), index(area[3] + args.margin, True))
+
+
+def arc_part():
+  """ An R-form arc, the box of its circle, and the slack allowed """
+  rng = random.Random(args.seed)
+  x, y, r = rng.uniform(100, args.bed - 100), rng.uniform(100, args.bed - 100), rng.uniform(5, 30)
+  # R < 0 takes the long way round, 270 degrees about x + r, y
+  lines = ['G28', 'G92 E0', 'G0 X%.3f Y%.3f' % (x, y), 'G3 X%.3f Y%.3f R%.3f E1' % (x + r, y + r, -r), 'M84']
+  return '\n'.join(lines), [x, y - r, x + 2 * r, y + r], 2 * r
+
+
+cases = []
+text, area = write(True)
+header_area = [float(re.search(r';%s:([-\d.]+)' % k, text).group(1)) for k in ('MINX', 'MINY', 'MAXX', 'MAXY')]
+cases.append(('header', text, header_area, 0))
+text, area = write(False)
+cases.append(('moves', text, area, 0))
+cases.append(('arc',) + arc_part())
+cases.append(('long', write(False, args.limit)[0], None, 0))
+cases.append(('long hdr', cases[0][1] + '\n' + '\n'.join(['G1 X1 Y1 ;' + ' ' * 60] * (args.limit // 71 + 1)), header_area, 0))
+
+src = PRELUDE % vars(args) + extract() + MAIN
+with host.HostBuild(args) as build:
+  files = []
+  for name, text, _, _ in cases:
+    files.append(build.path(name.replace(' ', '_') + '.gcode'))
+    with open(files[-1], 'w') as f:
+      f.write(text)
+  out = host.output(build.build(src), *files).splitlines()
+
+
+def fits(expect, found, slack):
+  """ found holds expect, and at most slack more on each side """
+  return (all(expect[i] - slack - 0.01 <= found[i] <= expect[i] + 0.01 for i in (0, 1)) and
+          all(expect[i] - 0.01 <= found[i] <= expect[i] + slack + 0.01 for i in (2, 3)))
+
+
+failed = False
+print('%-8s %-34s %-34s %-20s %s' % ('file', 'expected', 'found', 'grid points probed', 'bytes read'))
+for (name, text, expect, slack), line in zip(cases, out):
+  words = line.split()
+  found = None if words[1] == 'none' else [float(v) for v in words[1:]]
+  fmt = lambda a: 'none' if a is None else 'X%.1f:%.1f Y%.1f:%.1f' % (a[0], a[2], a[1], a[3])
+  probed = ''
+  if found:
+    i0, i1, j0, j1 = grid_points(found)
+    probed = '%d of %d' % ((i1 - i0 + 1) * (j1 - j0 + 1), args.points ** 2)
+  print('%-8s %-34s %-34s %-20s %d of %d' % (name, fmt(expect), fmt(found), probed, int(words[0]), len(text)))
+  if (expect is None) != (found is None) or (found and not fits(expect, found, slack)):
+    failed = True
+  # A long file is searched only for the header, in chunks of 128 bytes
+  if len(text) > args.limit and int(words[0]) > args.header_scan + 128:
+    failed = True
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+""" Check the slot schedule of SOFT_PWM_BAM against the standard soft PWM.
+
+Takes the bit-angle modulation code and the soft PWM part of the temperature
+ISR from Marlin/temperature.cpp and builds both with the host C++ compiler,
+with the output pins on emulated ports: two hotends and the (inverted) bed
+on one port, the fan on another. Between ticks a stand-in for the stepper
+ISR flips the other bits of those ports. For --runs random sets of duties:
+  duty     each output must be on for its duty of every period
+  change   duties changed in the middle of a period take effect at the
+           start of the next one
+  ports    the bits of the ports that aren't soft PWM outputs must keep
+           what the stepper wrote
+The port writes and the ticks that write at all, per period, are printed for
+both ways. No AVR is emulated, so the ISR time itself isn't: M880
+(ISR_TIMING_STATS) reports it on a printer.
+
+Exits with status 1 if an output is on for the wrong number of ticks, a
+change is taken mid-period, or another bit of a port is changed.
+
+Example:
+  softPwmBamTest.py
+  softPwmBamTest.py --scale 2 --runs 1000
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--scale', type=int, default=0, help='SOFT_PWM_SCALE (default=0)')
+parser.add_argument('--runs', type=int, default=300, help='random sets of duties (default=300)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "macros.h"
+#define _BV(b) (1 << (b))
+#undef CRITICAL_SECTION_START
+#undef CRITICAL_SECTION_END
+#define CRITICAL_SECTION_START NOOP
+#define CRITICAL_SECTION_END NOOP
+#define SOFT_PWM_SCALE %(scale)d
+#define HOTENDS 2
+#define HAS_HEATER_BED 1
+#define HAS_HEATER_CHAMBER 0
+#define FAN_SOFT_PWM
+#define HAS_FAN0 1
+#define HAS_FAN1 0
+#define HAS_FAN2 0
+#define FAN_COUNT 1
+#define HEATER_0_PIN 2
+#define HEATER_1_PIN 5
+#define HEATER_BED_PIN 6
+#define HEATER_BED_INVERTING true
+#define FAN_PIN 11
+#define HIGH 1
+#define LOW 0
+
+// Two ports of 8 pins
+volatile uint8_t ports[2];
+long port_writes;
+#define digitalPinToPort(P) ((P) >> 3)
+#define digitalPinToBitMask(P) _BV((P) & 7)
+#define portOutputRegister(N) (&ports[N])
+#define WRITE_PIN(P, V) do{ port_writes++; if (V) ports[(P) >> 3] |= _BV((P) & 7); else ports[(P) >> 3] &= ~_BV((P) & 7); }while(0)
+#define WRITE_HEATER_0(V) WRITE_PIN(HEATER_0_PIN, V)
+#define WRITE_HEATER_1(V) WRITE_PIN(HEATER_1_PIN, V)
+#define WRITE_HEATER_BED(V) WRITE_PIN(HEATER_BED_PIN, (V) ^ HEATER_BED_INVERTING)
+#define WRITE_FAN(V) WRITE_PIN(FAN_PIN, V)
+
+struct Temperature {
+  static uint8_t soft_pwm_amount[HOTENDS], soft_pwm_amount_bed,
+                 soft_pwm_amount_fan[FAN_COUNT], soft_pwm_count_fan[FAN_COUNT];
+  static void bam_isr();
+  static void standard_isr();
+};
+uint8_t Temperature::soft_pwm_amount[HOTENDS], Temperature::soft_pwm_amount_bed,
+        Temperature::soft_pwm_amount_fan[FAN_COUNT], Temperature::soft_pwm_count_fan[FAN_COUNT];
+'''
+
+MAIN = r'''
+void Temperature::bam_isr() {
+  uint8_t pwm_count_tmp = 0;
+%(bam_isr)s
+}
+
+void Temperature::standard_isr() {
+  static uint8_t pwm_count = _BV(SOFT_PWM_SCALE);
+  uint8_t pwm_count_tmp = pwm_count;
+  static uint8_t soft_pwm_count_0, soft_pwm_count_1, soft_pwm_count_BED;
+%(standard_isr)s
+}
+
+// Output pins, their duty, and whether a low pin is on
+const uint8_t pins[] = { HEATER_0_PIN, HEATER_1_PIN, HEATER_BED_PIN, FAN_PIN };
+const bool inverted[] = { false, false, HEATER_BED_INVERTING, false };
+uint8_t *amounts[] = { &Temperature::soft_pwm_amount[0], &Temperature::soft_pwm_amount[1], &Temperature::soft_pwm_amount_bed, &Temperature::soft_pwm_amount_fan[0] };
+const uint8_t outputs = sizeof(pins);
+const uint8_t output_mask[2] = { _BV(HEATER_0_PIN & 7) | _BV(HEATER_1_PIN & 7) | _BV(HEATER_BED_PIN & 7), _BV(FAN_PIN & 7) };
+
+bool pin_on(const uint8_t o) { return TEST(ports[pins[o] >> 3], pins[o] & 7) != inverted[o]; }
+int expected_on(const uint8_t o, const uint8_t amount) { return (o == 3 ? amount >> 1 : amount) >> SOFT_PWM_SCALE; }
+
+#define CHECK(C, ...) do{ if (!(C)) { printf("FAIL " __VA_ARGS__); printf("\n"); } }while(0)
+
+// The stepper ISR writes the other bits of the ports between ticks
+uint8_t other[2];
+void stepper() {
+  for (int p = 0; p < 2; p++) {
+    other[p] = rand() & ~output_mask[p];
+    ports[p] = (ports[p] & output_mask[p]) | other[p];
+  }
+}
+void tick() {
+  stepper();
+  Temperature::bam_isr();
+  for (int p = 0; p < 2; p++) CHECK((ports[p] & ~output_mask[p]) == other[p], "port %%d bits %%02x changed to %%02x", p, other[p], ports[p] & ~output_mask[p]);
+}
+
+int main(int, char **argv) {
+  const int runs = atoi(argv[1]);
+  bam_init();
+  srand(1);
+  for (int run = 0; run < runs; run++) {
+    uint8_t duty[outputs], next[outputs];
+    for (uint8_t o = 0; o < outputs; o++) {
+      duty[o] = run < 2 ? (run ? (o == 3 ? 255 : 127) : 0) : rand() %% (o == 3 ? 256 : 128);
+      *amounts[o] = duty[o];
+      next[o] = rand() %% (o == 3 ? 256 : 128);
+    }
+    // The duties are taken at the start of a period
+    for (int t = 0; t < BAM_PERIOD; t++) tick();
+    int on[outputs] = { 0 };
+    for (int t = 0; t < BAM_PERIOD; t++) {
+      if (t == BAM_PERIOD / 3) for (uint8_t o = 0; o < outputs; o++) *amounts[o] = next[o];
+      tick();
+      for (uint8_t o = 0; o < outputs; o++) on[o] += pin_on(o);
+    }
+    for (uint8_t o = 0; o < outputs; o++)
+      CHECK(on[o] == expected_on(o, duty[o]), "output %%d on %%d ticks for %%d, not %%d", o, on[o], duty[o], expected_on(o, duty[o]));
+    memset(on, 0, sizeof(on));
+    for (int t = 0; t < BAM_PERIOD; t++) {
+      tick();
+      for (uint8_t o = 0; o < outputs; o++) on[o] += pin_on(o);
+    }
+    for (uint8_t o = 0; o < outputs; o++)
+      CHECK(on[o] == expected_on(o, next[o]), "changed output %%d on %%d ticks for %%d, not %%d", o, on[o], next[o], expected_on(o, next[o]));
+  }
+
+  // Port writes per period, at mid duties
+  for (uint8_t o = 0; o < outputs; o++) *amounts[o] = o == 3 ? 128 : 64;
+  const int periods = 100;
+  for (int way = 0; way < 2; way++) {
+    void (*isr)() = way ? Temperature::standard_isr : Temperature::bam_isr;
+    for (int t = 0; t < BAM_PERIOD; t++) isr();
+    long ticks_writing = 0;
+    port_writes = 0;
+    for (int t = 0; t < periods * BAM_PERIOD; t++) {
+      const long w = port_writes;
+      isr();
+      if (port_writes != w) ticks_writing++;
+    }
+    printf("%%s %%g %%g\n", way ? "standard" : "bam", double(port_writes) / periods, double(ticks_writing) / periods);
+  }
+  return 0;
+}
+'''
+
+
+def extract(pattern, what):
+  return host.extract(args, 'temperature.cpp', pattern, what, 1)
+
+
+bam = extract(r'\n#if ENABLED\(SOFT_PWM_BAM\)\n(\n  /\*\*\n   \* Bit-angle modulation of the soft PWM outputs.*?)\n#endif // SOFT_PWM_BAM\n', 'the SOFT_PWM_BAM code')
+bam_isr = extract(r'\n(    static uint8_t bam_tick = 0.*?bam_tick = bam_next = bam_bit = 0;\n)', 'the SOFT_PWM_BAM ISR')
+standard_isr = extract(r'\n  #else // !SOFT_PWM_BAM\n\n(.*?pwm_count = pwm_count_tmp \+ _BV\(SOFT_PWM_SCALE\);\n)', 'the standard soft PWM')
+
+# Count the port writes of bam_write() too
+write = '      *port = (*port & ~mask) | value;'
+if write not in bam:
+  sys.exit('bam_write() port write not found in temperature.cpp')
+bam = bam.replace(write, '      port_writes++;\n' + write)
+
+src = PRELUDE % vars(args) + bam + MAIN % { 'bam_isr': bam_isr, 'standard_isr': standard_isr }
+with host.HostBuild(args) as build:
+  out = host.output(build.build(src, flags=['-Wno-parentheses']), args.runs)
+
+failed = False
+print('%-10s %14s %16s' % ('soft PWM', 'port writes', 'ticks writing'))
+for line in out.splitlines():
+  if line.startswith('FAIL'):
+    print(line)
+    failed = True
+  else:
+    name, writes, ticks = line.split()
+    print('%-10s %14.1f %16.1f' % (name, float(writes), float(ticks)))
+print('%d sets of duties, %d ticks a period  %s' % (args.runs, (1 << (7 - args.scale)) - 1, 'FAIL' if failed else 'ok'))
+
+sys.exit(1 if failed else 0)
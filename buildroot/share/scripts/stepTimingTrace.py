@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+
+""" Generate stepper pulse timing traces for Marlin's Bresenham stepper ISR.
+
+Takes calc_timer(), the block setup and the step loop of Stepper::isr() from
+Marlin/stepper.h and stepper.cpp and builds them with the host C++ compiler,
+with and without ADAPTIVE_STEP_SMOOTHING. Each runs one constant-rate block,
+the ISRs following each other at the interval calc_timer() gives and each pass
+of the step loop taking --loop-us, and reports how far each axis step lands
+from its ideal time. Use it to compare step jitter before and after enabling
+AMASS.
+
+Exits with status 1 if an axis doesn't get the steps of the block.
+
+Example:
+  stepTimingTrace.py --steps 1600 1000 0 57 --rate 800
+  stepTimingTrace.py --steps 1600 1000 0 57 --rate 800 --level 3 --csv trace.csv
+"""
+
+import argparse
+import math
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-s', '--steps', type=int, nargs=4, metavar=('X', 'Y', 'Z', 'E'), required=True, help='step count for each axis')
+parser.add_argument('-r', '--rate', type=int, required=True, help='step rate of the major axis (steps/s)')
+parser.add_argument('-l', '--level', type=int, default=3, help='ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL (default=3)')
+parser.add_argument('--max-rate', type=int, default=10000, help='ADAPTIVE_STEP_SMOOTHING_MAX_RATE in Hz (default=10000)')
+parser.add_argument('-f', '--cpu-freq', type=int, default=16, choices=(16, 20), help='CPU clockrate in MHz (default=16)')
+parser.add_argument('-p', '--loop-us', type=float, default=2.0, help='time taken by one pass of the step loop in us (default=2)')
+parser.add_argument('-c', '--csv', help='write the step trace to this CSV file')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+TIMER_FREQ = args.cpu_freq * 1000000 / 8  # Timer 1 runs at F_CPU / 8
+AXES = 'XYZE'
+
+PRELUDE = r'''
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include "macros.h"
+#define F_CPU %(cpu_freq)d000000UL
+#define _BV(b) (1UL << (b))
+#define ADAPTIVE_STEP_SMOOTHING_MAX_LEVEL %(level)d
+#define ADAPTIVE_STEP_SMOOTHING_MAX_RATE %(max_rate)d
+#define MAX_STEP_FREQUENCY 40000
+#define STEP_PULSE_CYCLES 0
+#define HAS_X_STEP 1
+#define HAS_Y_STEP 1
+#define HAS_Z_STEP 1
+#define INVERT_X_STEP_PIN false
+#define INVERT_Y_STEP_PIN false
+#define INVERT_Z_STEP_PIN false
+#define INVERT_E_STEP_PIN false
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS, E_AXIS };
+#define _AXIS(AXIS) AXIS ##_AXIS
+#define LOOP_XYZE(VAR) for (uint8_t VAR = X_AXIS; VAR <= E_AXIS; VAR++)
+#define PROGMEM
+#define pgm_read_word_near(A) (*(const uint16_t *)(A))
+#define MSG_STEPPER_TOO_HIGH "Steprate too high: "
+struct { template<typename T> void print(T) {} template<typename T> void println(T) {} } MYSERIAL;
+
+// intRes = charIn1 * intIn2 >> 16, rounded as the AVR code does
+#define MultiU16X8toH16(intRes, charIn1, intIn2) \
+  intRes = (charIn1) * ((intIn2) >> 8) + (((charIn1) * ((intIn2) & 0xFF)) >> 8) + (((charIn1) * ((intIn2) & 0xFF)) & 1)
+
+// A step pulse starting prints its time: the ISR, plus the passes of the step loop (i counts them down) before it
+double isr_us, loop_us;
+#define STEP_PIN(AXIS, V) do{ if (V) printf("%%.2f %%c\n", isr_us + (step_loops - 1 - i) * loop_us, "XYZE"[AXIS]); }while(0)
+#define X_APPLY_STEP(v,Q) STEP_PIN(X_AXIS, v)
+#define Y_APPLY_STEP(v,Q) STEP_PIN(Y_AXIS, v)
+#define Z_APPLY_STEP(v,Q) STEP_PIN(Z_AXIS, v)
+#define E_APPLY_STEP(v,Q) STEP_PIN(E_AXIS, v)
+'''
+
+# The tables for F_CPU, without the Marlin.h include of their header
+TABLES = host.extract(args, 'speed_lookuptable.h', r'\n#if F_CPU == 16000000\n.*?\n#endif\n', 'the speed tables')
+
+STEPPER = r'''
+struct block_t {
+  long steps[NUM_AXIS];
+  uint32_t step_event_count;
+};
+
+struct Stepper {
+  static block_t *current_block;
+  static int32_t counter_X, counter_Y, counter_Z, counter_E; // long on AVR, which the unsigned start value wraps into
+  static volatile uint32_t step_events_completed;
+  static uint8_t step_loops;
+  static volatile long count_position[NUM_AXIS];
+  static volatile signed char count_direction[NUM_AXIS];
+%(members)s
+%(calc_timer)s
+  static unsigned short start_block(const uint32_t rate);
+  static bool steps();
+  static uint8_t level() {
+    #if ENABLED(ADAPTIVE_STEP_SMOOTHING)
+      return oversampling_level;
+    #else
+      return 0;
+    #endif
+  }
+};
+
+block_t *Stepper::current_block;
+int32_t Stepper::counter_X, Stepper::counter_Y, Stepper::counter_Z, Stepper::counter_E;
+volatile uint32_t Stepper::step_events_completed;
+uint8_t Stepper::step_loops;
+volatile long Stepper::count_position[NUM_AXIS];
+volatile signed char Stepper::count_direction[NUM_AXIS] = { 1, 1, 1, 1 };
+%(statics)s
+
+// As trapezoid_generator_reset() and the start of a block in isr(), at a constant rate
+unsigned short Stepper::start_block(const uint32_t rate) {
+%(reset)s
+  const unsigned short timer = calc_timer(rate);
+%(counters)s
+  step_events_completed = 0;
+  return timer;
+}
+
+// One ISR's passes of the step loop, true at the end of the block
+bool Stepper::steps() {
+%(step_loop)s
+  return all_steps_done;
+}
+'''
+
+MAIN = r'''
+int main(int, char **argv) {
+  block_t block;
+  block.step_event_count = 0;
+  LOOP_XYZE(i) {
+    block.steps[i] = atol(argv[1 + i]);
+    NOLESS(block.step_event_count, (uint32_t)block.steps[i]);
+  }
+  loop_us = atof(argv[6]);
+  Stepper::current_block = &block;
+  const unsigned short timer = Stepper::start_block(atol(argv[5]));
+  const double timer_us = timer * 8.0 / (F_CPU / 1000000);
+  printf("start %u %u %u\n", timer, Stepper::step_loops, Stepper::level());
+
+  while (!Stepper::steps()) isr_us += timer_us;
+  printf("end %.2f\n", isr_us + timer_us);
+  return 0;
+}
+'''
+
+
+def extract(name, pattern, what):
+  return host.extract(args, name, pattern, what, 1)
+
+
+members = extract('stepper.h', r'\n(    #if ENABLED\(ADAPTIVE_STEP_SMOOTHING\)\n      static uint8_t oversampling_level,.*?\n    #endif\n)', 'the AMASS members')
+calc_timer = extract('stepper.h', r'\n(    #if ENABLED\(ADAPTIVE_STEP_SMOOTHING\)\n\n      // Rescale the Bresenham increments.*?\n      return timer;\n    }\n)', 'calc_timer()')
+reset = extract('stepper.h', r'\n(      #if ENABLED\(ADAPTIVE_STEP_SMOOTHING\)\n        step_event_scaled = .*?\n      #endif\n)', 'the AMASS block reset')
+statics = extract('stepper.cpp', r'\n(#if ENABLED\(ADAPTIVE_STEP_SMOOTHING\)\n  uint8_t Stepper::oversampling_level,.*?\n#endif\n)', 'the AMASS statics')
+counters = extract('stepper.cpp', r'\n(      // Initialize Bresenham counters to 1/2 the ceiling\n.*?\n      #endif\n)', 'the Bresenham counter setup')
+step_loop = extract('stepper.cpp', r'\n(  // Take multiple steps per interrupt \(For high speed moves\)\n.*?\n  } // steps_loop\n)', 'the step loop')
+
+# The tables are read through 16 bit AVR addresses
+address = '(unsigned short)&speed_lookuptable_'
+if calc_timer.count(address) != 2:
+  sys.exit('speed table lookups not found in calc_timer()')
+calc_timer = calc_timer.replace('unsigned short table_address = ' + address, 'uintptr_t table_address = (uintptr_t)&speed_lookuptable_')
+
+src = (PRELUDE % vars(args) + TABLES
+       + STEPPER % { 'members': members, 'calc_timer': calc_timer, 'statics': statics, 'reset': reset, 'counters': counters, 'step_loop': step_loop }
+       + MAIN)
+
+
+def simulate(exe):
+  """ Run the block, returning a list of (time_us, axis) step events, the block time, timer ticks, step_loops and level """
+  trace, duration = [], 0
+  for line in host.output(exe, *args.steps, args.rate, args.loop_us).splitlines():
+    head, *tail = line.split()
+    if head == 'start':
+      timer, loops, level = (int(v) for v in tail)
+    elif head == 'end':
+      duration = float(tail[0])
+    else:
+      trace.append((float(head), tail[0]))
+  return trace, duration, timer, loops, level
+
+
+def report(name, trace, duration, timer, loops, level):
+  """ Print the jitter of each axis, returning False if an axis is missing steps """
+  ok = True
+  print('%s: ISR every %d ticks (%.0f Hz), step_loops %d, oversampling %dx, block %.1f ms'
+        % (name, timer, TIMER_FREQ / timer, loops, 1 << level, duration / 1000))
+  for i, axis in enumerate(AXES):
+    times = [t for t, a in trace if a == axis]
+    if len(times) != args.steps[i]:
+      print('  %s %6d steps, not %d  FAIL' % (axis, len(times), args.steps[i]))
+      ok = False
+      continue
+    if not times:
+      continue
+    # Jitter is the deviation from the best-fit constant step interval
+    k = len(times)
+    mk, mt = (k - 1) / 2.0, sum(times) / k
+    skk = sum((j - mk) ** 2 for j in range(k))
+    slope = sum((j - mk) * (t - mt) for j, t in enumerate(times)) / skk if skk else 0
+    err = [t - (mt + slope * (j - mk)) for j, t in enumerate(times)]
+    gaps = [b - a for a, b in zip(times, times[1:])]
+    rms = math.sqrt(sum(e * e for e in err) / len(err))
+    spread = (max(gaps) - min(gaps)) if gaps else 0
+    print('  %s %6d steps  max jitter %8.1f us  rms jitter %8.1f us  interval spread %8.1f us'
+          % (axis, len(times), max(abs(e) for e in err), rms, spread))
+  return ok
+
+
+results = {}
+failed = False
+with host.HostBuild(args) as build:
+  for name, define in (('Bresenham', ''), ('AMASS', '#define ADAPTIVE_STEP_SMOOTHING\n')):
+    trace, duration, timer, loops, level = simulate(build.build(define + src, name))
+    results[name] = trace
+    failed |= not report(name, trace, duration, timer, loops, level)
+
+if args.csv:
+  with open(args.csv, 'w') as f:
+    f.write('mode,time_us,axis\n')
+    for name, trace in results.items():
+      for t, a in trace:
+        f.write('%s,%.2f,%s\n' % (name, t, a))
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,284 @@
+#!/usr/bin/env python3
+
+""" Check ABL_THERMAL_MESHES: grids for several bed temperatures in EEPROM.
+
+Takes the thermal mesh code from Marlin/configuration_store.cpp and
+Marlin/Marlin_main.cpp, with its EEPROM addresses from
+Marlin/configuration_store.h, the grid storage it uses and crc16() from
+Marlin/utility.cpp, and builds it with the host C++ compiler on an emulated
+EEPROM (with EEPROM_MESH_COMPRESSION if --compress is given). A bed of each of the --grids sizes is modelled as a fixed
+shape plus a warp that grows with the bed temperature (--bow is how much it
+bends past linear between --low and --high). Then:
+  probe     G29 at --low, --high and in between, again close to a stored
+            temperature (must replace it) and at more temperatures than
+            there are slots (must replace the closest)
+  follow    the bed goes from 20 to 130C and back, the grid in use is
+            compared with the bed, and with the nearest stored grid alone
+  edit      a point changed as M421 and G29 W do stays through bed
+            temperature changes and M501, until the next G29, and after
+            M500 it is stored for its temperature and back after a restart
+  geometry  G29 on a grid with another start empties the other slots
+The EEPROM used by the grids is printed for each size.
+
+Exits with status 1 if a grid lands in the wrong slot, the grid changes
+within THERMAL_MESH_HYSTERESIS, the interpolated grid is further from the bed
+than the nearest stored one, an edit is undone before G29 or lost after
+M500, or stale slots survive a new geometry.
+
+Example:
+  thermalMeshTest.py
+  thermalMeshTest.py --grids 5,15 --meshes 3 --bow 0.05
+  thermalMeshTest.py --compress --meshes 8
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--grids', default='7,10', help='GRID_MAX_POINTS_X and _Y to check (default=7,10)')
+parser.add_argument('--meshes', type=int, default=4, help='THERMAL_MESHES (default=4)')
+parser.add_argument('--match', type=int, default=5, help='THERMAL_MESH_MATCH (default=5)')
+parser.add_argument('--hysteresis', type=int, default=2, help='THERMAL_MESH_HYSTERESIS (default=2)')
+parser.add_argument('--low', type=int, default=45, help='lowest probed bed temperature (default=45)')
+parser.add_argument('--high', type=int, default=110, help='highest probed bed temperature (default=110)')
+parser.add_argument('--bow', type=float, default=0.03, help='warp past linear in mm at mid temperature (default=0.03)')
+parser.add_argument('--compress', action='store_true', help='with EEPROM_MESH_COMPRESSION')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "macros.h"
+using std::isnan;
+#define EEPROM_SETTINGS
+#define AUTO_BED_LEVELING_BILINEAR
+#define ABL_THERMAL_MESHES
+%(compress_define)s
+#define GRID_MAX_POINTS_X %(grid)d
+#define GRID_MAX_POINTS_Y %(grid)d
+#define GRID_MAX_POINTS (GRID_MAX_POINTS_X * GRID_MAX_POINTS_Y)
+#define THERMAL_MESHES %(meshes)d
+#define THERMAL_MESH_MATCH %(match)d
+#define THERMAL_MESH_HYSTERESIS %(hysteresis)d
+#define E2END 4095
+#define sq(x) ((x) * (x))
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define SETTING_ADDR_END (1052 + MESH_STORE_SIZE - 36)
+#define SERIAL_ERROR_START() NOOP
+#define SERIAL_ERRORLNPGM(S) NOOP
+#define SERIAL_ECHO_START() NOOP
+#define SERIAL_ECHOPGM(S) NOOP
+#define SERIAL_ECHOPAIR(N, V) NOOP
+#define SERIAL_ECHOLNPAIR(N, V) NOOP
+#define SERIAL_EOL() NOOP
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS };
+
+uint8_t eeprom[E2END + 1];
+long eeprom_written;
+uint8_t eeprom_read_byte(const uint8_t *a) { return eeprom[(size_t)a]; }
+void eeprom_read_block(void *dst, const void *src, size_t n) { memcpy(dst, eeprom + (size_t)src, n); }
+void eeprom_update_block(const void *src, void *dst, size_t n) {
+  for (size_t i = 0; i < n; i++)
+    if (eeprom[(size_t)dst + i] != ((const uint8_t *)src)[i]) { eeprom[(size_t)dst + i] = ((const uint8_t *)src)[i]; eeprom_written++; }
+}
+#define EEPROM_UPDATE_VAR(address, var) eeprom_update_block((const void *)&(var), (void *)(size_t)(address), sizeof(var))
+#define EEPROM_READ_VAR(address, var) eeprom_read_block((void *)&(var), (const void *)(size_t)(address), sizeof(var))
+#define EEPROM_STORE(var, setting) EEPROM_UPDATE_VAR(SETTING_ADDR_ ## setting, var)
+#define EEPROM_READ(var, setting) EEPROM_READ_VAR(SETTING_ADDR_ ## setting, var)
+
+int bilinear_grid_spacing[2] = { 50, 50 }, bilinear_start[2] = { 10, 10 };
+float z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+void thermal_mesh_save();
+void thermal_mesh_save_edit();
+void thermal_mesh_update(const bool force=false);
+int refreshes;
+void refresh_bed_level() { refreshes++; }
+struct { float bed; float degBed() { return bed; } } thermalManager;
+
+class MarlinSettings {
+  public:
+    static void store_grid(const int pos, const float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+    static bool load_grid(const int pos, float (&z)[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y]);
+    static bool grid_is_valid(const int pos);
+    static float grid_z(const int pos, const uint8_t x, const uint8_t y);
+    static bool thermal_mesh_grid_matches();
+    static void clear_thermal_meshes();
+    static int16_t thermal_mesh_temp(const uint8_t slot);
+    static void store_thermal_mesh(const uint8_t slot, const int16_t temp);
+    static float thermal_mesh_z(const uint8_t slot, const uint8_t x, const uint8_t y);
+} settings;
+'''
+
+MAIN = r'''
+int failed;
+#define CHECK(C, ...) do{ if (!(C)) { printf("FAIL " __VA_ARGS__); printf("\n"); failed = 1; } }while(0)
+
+// The bed: a fixed shape and a warp growing with temperature, bending past linear by BOW
+const float LOW = %(low)d, HIGH = %(high)d, BOW = %(bow)f;
+float bed_z(const int x, const int y, const float t) {
+  const float u = (t - 25) / (HIGH - 25), w = (x - (GRID_MAX_POINTS_X - 1) * 0.5f) * (y - (GRID_MAX_POINTS_Y - 1) * 0.5f);
+  return 0.05f * sinf(x * 1.3f + y * 0.7f) + 0.3f * u * w / sq(GRID_MAX_POINTS_X) - BOW * 4 * u * (1 - u) * cosf(x + y);
+}
+void G29(const int t) {
+  thermalManager.bed = t;
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      z_values[x][y] = bed_z(x, y, t);
+  thermal_mesh_save();
+}
+int stored(int16_t temps[]) {
+  int n = 0;
+  for (uint8_t s = 0; s < THERMAL_MESHES; s++) if ((temps[s] = settings.thermal_mesh_temp(s)) >= 0) n++;
+  return n;
+}
+bool has(const int t) {
+  int16_t temps[THERMAL_MESHES];
+  stored(temps);
+  for (int s = 0; s < THERMAL_MESHES; s++) if (temps[s] == t) return true;
+  return false;
+}
+float error_to_bed(const float t) {
+  float e = 0;
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      e = fmax(e, fabs(z_values[x][y] - bed_z(x, y, t)));
+  return e;
+}
+
+int main() {
+  memset(eeprom, 0xFF, sizeof(eeprom));
+  printf("layout %%d %%d\n", (int)SETTING_ADDR_thermal_mesh_max, (int)SETTING_ADDR_thermal_mesh_END);
+
+  // Nothing stored: the grid stays as it is
+  z_values[0][0] = 1.5;
+  thermalManager.bed = 60;
+  thermal_mesh_update(true);
+  CHECK(z_values[0][0] == 1.5f && !refreshes, "blended without stored grids");
+
+  // probe
+  const int mid = (LOW + HIGH) / 2;
+  G29(LOW); G29(HIGH); G29(mid);
+  int16_t temps[THERMAL_MESHES];
+  CHECK(stored(temps) == 3 && has(LOW) && has(HIGH) && has(mid), "probed grids not stored");
+  G29(LOW + THERMAL_MESH_MATCH);
+  CHECK(stored(temps) == 3 && has(LOW + THERMAL_MESH_MATCH) && !has(LOW), "grid within THERMAL_MESH_MATCH not replaced");
+  G29(LOW);
+  for (int t = 30; stored(temps) < THERMAL_MESHES; t += 2 * THERMAL_MESH_MATCH + 7) G29(HIGH + t);
+  const int extra = HIGH + 2 * THERMAL_MESH_MATCH + 3;
+  long written = eeprom_written;
+  G29(extra);
+  printf("probe %%ld\n", eeprom_written - written);
+  CHECK(stored(temps) == THERMAL_MESHES && has(extra) && !has(HIGH) && has(LOW), "full slots: closest not replaced");
+  G29(HIGH);
+  CHECK(has(HIGH) && !has(extra), "full slots: closest not replaced");
+
+  // follow
+  float worst = 0, worst_nearest = 0, worst_stored = 0;
+  int blends = 0;
+  for (int pass = 0; pass < 2; pass++)
+    for (float t = pass ? 130 : 20; pass ? t >= 20 : t <= 130; t += pass ? -0.25f : 0.25f) {
+      float before[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+      memcpy(before, z_values, sizeof(z_values));
+      const int r = refreshes;
+      thermalManager.bed = t;
+      thermal_mesh_update();
+      if (refreshes != r) blends++;
+      else CHECK(!memcmp(before, z_values, sizeof(z_values)), "grid changed without a refresh at %%.2f", t);
+      if (t < LOW || t > HIGH) continue;
+      // Compare with the bed at the temperature the grid is for, and with the nearest stored grid
+      const int16_t used = thermal_mesh_bed_temp;
+      const float e = error_to_bed(used);
+      int nearest = 0;
+      stored(temps);
+      for (int s = 1; s < THERMAL_MESHES; s++) if (abs(temps[s] - used) < abs(temps[nearest] - used)) nearest = s;
+      float en = 0;
+      for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+        for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+          en = fmax(en, fabs(bed_z(x, y, temps[nearest]) - bed_z(x, y, used)));
+      worst = fmax(worst, e);
+      worst_nearest = fmax(worst_nearest, en);
+      if (abs(t - used) < THERMAL_MESH_HYSTERESIS && used == temps[nearest]) worst_stored = fmax(worst_stored, e);
+      CHECK(e <= en + 1e-5, "interpolated grid further from the bed than the nearest stored one at %%d", used);
+      CHECK(abs(LROUND(t) - used) < THERMAL_MESH_HYSTERESIS, "grid for %%d at %%.2f", used, t);
+    }
+  printf("follow %%d %%g %%g %%g\n", blends, worst, worst_nearest, worst_stored);
+  // Compressed grids come back within half a step, 1/131064 of their range
+  CHECK(worst_stored < %(stored_error)g, "stored grid not used at its temperature");
+
+  // edit
+  thermalManager.bed = LOW;
+  thermal_mesh_update(true);
+  z_values[1][1] += 0.2f;
+  thermal_mesh_edited = true;   // As M421 and G29 W do
+  const float edited = z_values[1][1];
+  for (int t = LOW; t <= HIGH; t++) {
+    thermalManager.bed = t;
+    thermal_mesh_update();
+  }
+  thermal_mesh_update(true);
+  CHECK(z_values[1][1] == edited && thermal_mesh_bed_temp == LOW, "edited grid replaced");
+  thermalManager.bed = HIGH;
+  thermal_mesh_save_edit();     // M500 at another temperature
+  CHECK(has(LOW) && has(HIGH) && stored(temps) == THERMAL_MESHES, "edit not stored in its slot");
+  thermal_mesh_edited = false;  // Restart
+  thermalManager.bed = LOW;
+  thermal_mesh_update(true);
+  CHECK(z_values[1][1] == edited, "saved edit lost on restart");
+  G29(mid);
+  thermalManager.bed = HIGH;
+  thermal_mesh_update();
+  CHECK(thermal_mesh_bed_temp == HIGH, "bed temperature not followed after G29");
+
+  // geometry
+  bilinear_start[X_AXIS] += 5;
+  G29(LOW);
+  CHECK(stored(temps) == 1 && has(LOW), "slots of another grid kept");
+  bilinear_start[X_AXIS] -= 5;
+  CHECK(!settings.thermal_mesh_grid_matches(), "slots used for another grid");
+
+  return failed;
+}
+'''
+
+
+def extract(name, pattern):
+  return host.extract(args, name, pattern, 'ABL_THERMAL_MESHES code')
+
+
+code = (extract('configuration_store.h', r'\n\t#if ENABLED\(EEPROM_MESH_COMPRESSION\)\n.*?\n\t#endif\n')
+        + extract('configuration_store.h', r'\n\t#if ENABLED\(ABL_THERMAL_MESHES\)\n\t\t// The grids.*?\n\t#endif\n')
+        + extract('utility.cpp', r'\n  void crc16\(.*?\n  }\n')
+        + extract('configuration_store.cpp', r'\n  #if ENABLED\(MESH_BED_LEVELING\) \|\| ENABLED\(AUTO_BED_LEVELING_BILINEAR\)\n.*?#endif // MESH_BED_LEVELING \|\| AUTO_BED_LEVELING_BILINEAR\n')
+        + extract('configuration_store.cpp', r'\n  #if ENABLED\(ABL_THERMAL_MESHES\)\n\n    /\*\*\n     \* Each slot.*?#endif // ABL_THERMAL_MESHES\n')
+        + extract('Marlin_main.cpp', r'\n  #if ENABLED\(ABL_THERMAL_MESHES\)\n\n    static int16_t thermal_mesh_bed_temp.*?#endif // ABL_THERMAL_MESHES\n'))
+
+# EEPROM addresses are ints, the size of a pointer on AVR but not here
+HOST_FLAGS = ['-Wno-int-to-pointer-cast']
+
+failed = False
+for grid in [int(g) for g in args.grids.split(',')]:
+  values = dict(vars(args), grid=grid, compress_define='#define EEPROM_MESH_COMPRESSION' if args.compress else '',
+                stored_error=1e-5 if args.compress else 1e-6)
+  src = PRELUDE % values + code + MAIN % values
+  with host.HostBuild(args) as build:
+    returncode, out = host.run(build.build(src, flags=HOST_FLAGS))
+  out = out.splitlines()
+  res = {line.split()[0]: line.split()[1:] for line in out if not line.startswith('FAIL')}
+  first, end = (int(v) for v in res['layout'])
+  blends, worst, nearest, stored = res['follow']
+  print('%dx%d grid: %d grids in EEPROM %d-%d (%d bytes), %s bytes written by G29' % (
+    grid, grid, args.meshes, first, end - 1, end - first, res['probe'][0]))
+  print('  20-130-20C: %s blends, grid within %.4fmm of the bed (nearest stored grid alone %.4fmm, stored grids %.1emm)' % (
+    blends, float(worst), float(nearest), float(stored)))
+  for line in out:
+    if line.startswith('FAIL'):
+      print('  ' + line)
+  failed |= returncode != 0
+
+sys.exit(1 if failed else 0)
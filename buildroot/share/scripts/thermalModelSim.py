@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+
+""" Test THERMAL_PROTECTION_MODEL on a simulated hotend.
+
+A hotend (heater block with a lagging sensor, losses to ambient and to the
+part cooling fan, and heat carried off by the filament) is held at the
+target by a PID at PID_dT. The detector runs a copy of the model from the
+power and fan duty, pulled slowly toward the readings, as
+Temperature::thermal_model_protection() does, with the model parameters
+off from the real hotend by --mismatch. It trips when the reading stays
+further from the model than the heat flows can explain for
+THERMAL_MODEL_PERIOD.
+
+Each fault is injected at --fault-at seconds into a print, and the time to
+detection is printed next to the time of the generic checks (thermal
+runaway with THERMAL_PROTECTION_PERIOD/HYSTERESIS, and the heating watch):
+  heater     the cartridge falls out of the block
+  sensor     the thermistor falls out of the block
+  open       the thermocouple disconnects and reads ambient
+  stuck      the heater MOSFET fails on, with the target at 0
+Clean runs (heat-up, printing with fan and flow changes, cool-down) must
+not trip the detector.
+
+Exits with status 1 on a false alarm or a fault missed by the detector.
+
+Example:
+  thermalModelSim.py
+  thermalModelSim.py --temp 480 --watts 100 --noise 1
+"""
+
+import argparse
+import math
+import random
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--temp', type=float, default=220, help='target temperature (default=220)')
+parser.add_argument('--watts', type=float, default=40, help='heater power (default=40)')
+parser.add_argument('--mismatch', type=float, default=0.2, help='relative error of the model parameters (default=0.2)')
+parser.add_argument('--period', type=float, default=2, help='THERMAL_MODEL_PERIOD (default=2)')
+parser.add_argument('--correction', type=float, default=0.1, help='THERMAL_MODEL_CORRECTION (default=0.1)')
+parser.add_argument('--tolerance', type=float, default=4, help='THERMAL_MODEL_TOLERANCE (default=4)')
+parser.add_argument('--margin', type=float, default=0.3, help='THERMAL_MODEL_MARGIN (default=0.3)')
+parser.add_argument('--fault-at', type=float, default=300, help='seconds into the print for the fault (default=300)')
+parser.add_argument('--noise', type=float, default=0.3, help='sensor noise sigma in degC (default=0.3)')
+parser.add_argument('--seed', type=int, default=1, help='random seed')
+args = parser.parse_args()
+
+DT = 16 * 10 / (16000000 / 64.0 / 256.0)    # PID_dT
+AMBIENT = 25
+TR_PERIOD, TR_HYSTERESIS = 3, 25            # THERMAL_PROTECTION_PERIOD/HYSTERESIS of Configuration_adv.h
+WATCH_PERIOD, WATCH_INCREASE = 30, 2
+RUN = 600
+
+
+class Hotend:
+
+  def __init__(self):
+    self.watts, self.capacity, self.loss, self.fan_loss, self.sensor_k = args.watts, 16.7 * args.watts / 40, 0.068, 0.029, 0.22
+    self.block = self.sensor = AMBIENT
+    self.heater_in_block = self.sensor_in_block = True
+    self.open = False
+
+  def step(self, pwm, fan, flow):
+    """ Run PID_dT at soft PWM 'pwm' (0..127), fan 0..255, flow in mm/s of filament """
+    sub = 10
+    dt = DT / sub
+    for _ in range(sub):
+      heat = self.watts * pwm / 127.0 if self.heater_in_block else 0
+      loss = (self.loss + self.fan_loss * fan / 255.0 + 5.6e-3 * flow) * (self.block - AMBIENT)
+      self.block += (heat - loss) * dt / self.capacity
+      follow = self.block if self.sensor_in_block else AMBIENT
+      self.sensor += (follow - self.sensor) * (self.sensor_k if self.sensor_in_block else 0.05) * dt
+
+  def reading(self, rng):
+    return AMBIENT if self.open else self.sensor + rng.gauss(0, args.noise)
+
+
+class Detector:
+  """ Temperature::thermal_model_protection() """
+
+  def __init__(self, rng):
+    m = lambda v: v * (1 + rng.choice((-1, 1)) * args.mismatch)
+    self.watts, self.capacity, self.loss, self.fan_loss, self.sensor_k = m(args.watts), m(16.7 * args.watts / 40), m(0.068), m(0.029), m(0.22)
+    self.block = None
+    self.flows = 0
+    self.fail_time = 0
+
+  def update(self, current, pwm, fan):
+    """ Called each update with the power applied since the last one. Returns True on a fault """
+    if self.block is None:
+      self.block = self.sensor = current
+      return False
+    heat = self.watts * pwm / 127.0
+    loss = (self.loss + self.fan_loss * fan / 255.0) * (self.block - AMBIENT)
+    self.block += (heat - loss) * DT / self.capacity
+    self.sensor += (self.block - self.sensor) * self.sensor_k * DT
+    # The model error the heat flows of the last 1/g seconds can explain
+    self.flows += (heat + abs(loss) - self.flows) * args.correction * DT
+    limit = args.tolerance + args.margin * self.flows / (self.capacity * args.correction)
+    error = current - self.sensor
+    correction = error * args.correction * DT
+    self.block += correction
+    self.sensor += correction
+    self.fail_time = self.fail_time + DT if abs(error) > limit else 0
+    return self.fail_time >= args.period
+
+
+def run(fault, rng):
+  """ Returns (detector time, runaway time, watch time) of the first trip after the start, or None """
+  h = Hotend()
+  det = Detector(rng)
+  kp, ki, kd = 20.0, 1.5 * DT, 80 / DT
+  i_state, last, pwm = 0.0, AMBIENT, 0
+  tr_state, tr_timer, watch_next, watch_target = 'first', None, WATCH_PERIOD, AMBIENT + WATCH_INCREASE
+  found = {'model': None, 'runaway': None, 'watch': None}
+  t = 0.0
+  while t < RUN:
+    t += DT
+    printing = t > 120
+    fan = (255 if int(t / 40) % 2 else 100) if printing else 0
+    flow = (3 + 2 * math.sin(t / 7)) if printing else 0
+    target = 0 if (fault == 'stuck' and t >= args.fault_at) or (fault is None and t > RUN - 120) else args.temp
+    if t >= args.fault_at:
+      if fault == 'heater': h.heater_in_block = False
+      if fault == 'sensor': h.sensor_in_block = False
+      if fault == 'open': h.open = True
+    h.step(127 if fault == 'stuck' and t >= args.fault_at else pwm, fan, flow)
+    current = h.reading(rng)
+
+    if det.update(current, pwm, fan) and found['model'] is None: found['model'] = t
+    if target:
+      if tr_state == 'first' and current >= target - 3: tr_state = 'stable'
+      if tr_state == 'stable':
+        if abs(current - target) <= TR_HYSTERESIS: tr_timer = t + TR_PERIOD
+        elif t > tr_timer and found['runaway'] is None: found['runaway'] = t
+      if watch_next is not None and t >= watch_next:
+        if current < watch_target:
+          if found['watch'] is None: found['watch'] = t
+        elif current < target - 2 * WATCH_INCREASE:
+          watch_next, watch_target = t + WATCH_PERIOD, current + WATCH_INCREASE
+        else:
+          watch_next = None
+
+    # PID (functional range 10) or off
+    error = target - current
+    if not target: out = 0
+    elif error > 10: out, i_state = 255, 0
+    elif error < -10: out, i_state = 0, 0
+    else:
+      i_state += error
+      out = max(0, min(255, kp * error + ki * i_state - kd * (current - last) * 0.05))
+    last = current
+    pwm = int(out) >> 1
+  return found
+
+
+rng = random.Random(args.seed)
+failed = False
+fmt = lambda v: '-' if v is None else '%.1f' % (v - args.fault_at)
+print('%-8s %12s %12s %12s' % ('fault', 'model s', 'runaway s', 'watch s'))
+for fault in ('heater', 'sensor', 'open', 'stuck'):
+  found = run(fault, rng)
+  early = found['model'] is not None and found['model'] < args.fault_at
+  print('%-8s %12s %12s %12s%s' % (fault, fmt(found['model']), fmt(found['runaway']), fmt(found['watch']), '  FALSE ALARM' if early else ''))
+  failed |= found['model'] is None or early
+
+clean = sum(run(None, rng)['model'] is not None for _ in range(20))
+print('false alarms in 20 clean runs: %d' % clean)
+failed |= clean > 0
+
+sys.exit(1 if failed else 0)
@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+
+""" Check the thermistor table lookup against the original linear scan.
+
+Builds every Marlin/thermistortable_*.h with the host C++ compiler to get the
+tables exactly as the firmware sees them, then converts every raw ADC value
+(0 to 1023 * OVERSAMPLENR) with:
+  - the original linear scan with float interpolation
+  - the binary search with 1/256 fixed-point interpolation (temp_from_table)
+and fails if any result differs by more than the tolerance.
+
+Example:
+  thermistorTableTest.py
+  thermistorTableTest.py --tolerance 0.05 --cxx clang++
+"""
+
+import argparse
+import glob
+import os
+import re
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('-t', '--tolerance', type=float, default=0.1, help='max difference in degC (default=0.1)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+OVERSAMPLENR = 16
+
+
+def load_tables():
+  """ Compile a program that includes every table and prints it. Returns { name: [(raw, celsius), ...] } """
+  headers = sorted(glob.glob(os.path.join(args.marlin, 'thermistortable_*.h')))
+  with open(os.path.join(args.marlin, 'thermistortables.h')) as f:
+    pt_macros = [l for l in f if re.match(r'#define Pt', l)]
+
+  src = ['#include <cstdio>', '#define PROGMEM', '#define OVERSAMPLENR %d' % OVERSAMPLENR] + pt_macros
+  dumps = []
+  for h in headers:
+    name = re.search(r'thermistortable_(\w+)\.h', h).group(1)
+    src.append('#include "%s"' % os.path.abspath(h))
+    dumps.append('  printf("%s");'
+                 ' for (unsigned i = 0; i < sizeof(temptable_%s) / sizeof(*temptable_%s); i++)'
+                 ' printf(" %%d %%d", temptable_%s[i][0], temptable_%s[i][1]);'
+                 ' printf("\\n");' % (name, name, name, name, name))
+  src += ['int main() {'] + dumps + ['  return 0;', '}']
+
+  # Fractional raw values are truncated to short, as Arduino builds with -fpermissive
+  with host.HostBuild(args) as build:
+    out = host.output(build.build('\n'.join(src) + '\n', flags=['-fpermissive', '-Wno-narrowing']))
+
+  tables = {}
+  for line in out.splitlines():
+    name, *values = line.split()
+    values = [int(v) for v in values]
+    tables[name] = list(zip(values[0::2], values[1::2]))
+  return tables
+
+
+def linear_scan(tt, raw):
+  """ The original analog2temp() loop """
+  for i in range(1, len(tt)):
+    if tt[i][0] > raw:
+      return tt[i - 1][1] + (raw - tt[i - 1][0]) * float(tt[i][1] - tt[i - 1][1]) / float(tt[i][0] - tt[i - 1][0])
+  return tt[-1][1]
+
+
+def c_div(a, b):
+  """ Integer division truncating toward zero, as in C """
+  q = abs(a) // abs(b)
+  return q if (a < 0) == (b < 0) else -q
+
+
+def temp_from_table(tt, raw):
+  """ Mirror temp_from_table() in temperature.cpp """
+  l, r = 1, len(tt)
+  while l < r:
+    m = l + ((r - l) >> 1)
+    if tt[m][0] > raw:
+      r = m
+    else:
+      l = m + 1
+  if l == len(tt):
+    return tt[-1][1]
+  r0, t0 = tt[l - 1]
+  product = (raw - r0) * (tt[l][1] - t0) * 256
+  assert -2**31 <= product < 2**31, 'int32_t overflow'
+  return t0 + c_div(product, tt[l][0] - r0) / 256.0
+
+
+failed = False
+for name, tt in sorted(load_tables().items(), key=lambda t: int(t[0])):
+  worst, worst_raw = 0, 0
+  for raw in range(0, 1024 * OVERSAMPLENR):
+    diff = abs(temp_from_table(tt, raw) - linear_scan(tt, raw))
+    if diff > worst:
+      worst, worst_raw = diff, raw
+  ok = worst <= args.tolerance
+  failed |= not ok
+  print('temptable_%-5s %3d entries  max diff %.4f degC at raw %5d  %s' % (name, len(tt), worst, worst_raw, 'ok' if ok else 'FAIL'))
+
+sys.exit(1 if failed else 0)
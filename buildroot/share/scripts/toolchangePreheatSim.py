@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+
+""" Time the waits at tool changes with and without TOOLCHANGE_PREHEAT.
+
+A two tool print is made of segments of moves at a constant speed, each
+segment starting with a T command and an M109 for its nozzle. Every nozzle
+heats and cools at a constant rate. Three strategies are run:
+  off      the previous nozzle is turned off at each tool change and the
+           next one only heats at its M109
+  idle     the idle nozzle is kept at its print temperature
+  preheat  the file is read ahead up to the horizon, as ToolchangePreheat
+           does: the next nozzle starts heating when the estimated time to
+           its T command is the heat-up time plus the margin, and a nozzle
+           not needed for at least the standby time goes to standby
+
+The preheat estimate can be made pessimistic (the print runs faster than the
+moves read) with --speedup. Exits with status 1 if the preheat waits longer
+in total than the idle strategy with a small allowance.
+
+Example:
+  toolchangePreheatSim.py
+  toolchangePreheatSim.py --temps 380 360 --segments 40 900 60 300 --speedup 1.1
+"""
+
+import argparse
+import sys
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--segments', type=float, nargs='+', default=[120, 90, 30, 200, 600, 45], help='seconds printed by each tool in turn, starting with T0')
+parser.add_argument('--temps', type=float, nargs=2, default=[220, 240], help='print temperatures of T0 and T1 (default=220 240)')
+parser.add_argument('--rate', type=float, default=2.0, help='heating rate in K/s, TOOLCHANGE_PREHEAT_RATE (default=2.0)')
+parser.add_argument('--cool', type=float, default=1.0, help='cooling rate in K/s (default=1.0)')
+parser.add_argument('--margin', type=float, default=5, help='TOOLCHANGE_PREHEAT_MARGIN (default=5)')
+parser.add_argument('--horizon', type=float, default=300, help='TOOLCHANGE_PREHEAT_HORIZON (default=300)')
+parser.add_argument('--standby-temp', type=float, default=150, help='TOOLCHANGE_STANDBY_TEMP (default=150)')
+parser.add_argument('--standby-time', type=float, default=60, help='TOOLCHANGE_STANDBY_TIME (default=60)')
+parser.add_argument('--speedup', type=float, default=1.0, help='real print speed over the estimate (default=1.0)')
+parser.add_argument('--ambient', type=float, default=25, help='ambient temperature (default=25)')
+parser.add_argument('--dt', type=float, default=0.1, help='time step in seconds (default=0.1)')
+args = parser.parse_args()
+
+TEMP_WINDOW = 1
+
+
+class Nozzle:
+
+  def __init__(self, temp):
+    self.temp = self.target = temp
+
+  def step(self):
+    if self.temp < self.target:
+      self.temp = min(self.target, self.temp + args.rate * args.dt)
+    else:
+      self.temp = max(max(self.target, args.ambient), self.temp - args.cool * args.dt)
+
+
+def simulate(strategy):
+  """ Returns (total wait, wait per tool change, seconds at standby) """
+  tools = [i % 2 for i in range(len(args.segments))]
+  # Print time of each segment start, as estimated from the file
+  starts = [sum(args.segments[:i]) for i in range(len(args.segments))]
+  nozzles = [Nozzle(args.temps[0]), Nozzle(args.ambient)]
+  if strategy == 'idle': nozzles[1].target = args.temps[1]
+  printed = 0.0
+  waits, standby_time = [], 0.0
+  standby = [False, False]
+  for seg, tool in enumerate(tools):
+    # Tool change: restore the nozzle and wait for its M109
+    n = nozzles[tool]
+    n.target = args.temps[tool]
+    standby[tool] = False
+    if strategy == 'off': nozzles[1 - tool].target = 0
+    wait = 0.0
+    while n.temp < n.target - TEMP_WINDOW:
+      for z in nozzles: z.step()
+      wait += args.dt
+    waits.append(wait)
+    if seg == 0: waits[0] = 0
+
+    # Print the segment
+    end = printed + args.segments[seg]
+    nxt = seg + 1
+    other = 1 - tool
+    while printed < end:
+      if strategy == 'preheat':
+        # Estimated time to the next tool change, as read ahead from the file
+        until = (starts[nxt] - printed) if nxt < len(tools) else None
+        if until is not None and until > args.horizon: until = None
+        o = nozzles[other]
+        if until is not None and not (o.target >= args.temps[other] and not standby[other]):
+          heatup = max(0, args.temps[other] - o.temp) / args.rate
+          if until <= heatup + args.margin:
+            o.target = args.temps[other]
+            standby[other] = False
+        # Standby when the next use is past the horizon or far enough off
+        next_use = until if until is not None else (args.horizon - (printed % (args.horizon / 2)) if nxt < len(tools) else 1e6)
+        if not standby[other] and o.target > args.standby_temp and next_use - (o.target - args.standby_temp) / args.rate >= args.standby_time:
+          o.target = args.standby_temp
+          standby[other] = True
+      if standby[other]: standby_time += args.dt
+      for z in nozzles: z.step()
+      printed += args.dt * args.speedup
+  return sum(waits), waits, standby_time
+
+
+print('%-10s %10s %12s   %s' % ('strategy', 'total wait', 'standby s', 'wait per tool change (s)'))
+results = {}
+for strategy in ('off', 'idle', 'preheat'):
+  total, waits, standby_time = simulate(strategy)
+  results[strategy] = total
+  print('%-10s %10.1f %12.1f   %s' % (strategy, total, standby_time, ' '.join('%.0f' % w for w in waits[1:])))
+
+failed = results['preheat'] > results['idle'] + args.margin * len(args.segments)
+sys.exit(1 if failed else 0)
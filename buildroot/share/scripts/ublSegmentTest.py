@@ -0,0 +1,432 @@
+#!/usr/bin/env python3
+
+""" Check and time the UBL mesh line splitting of Cartesian moves.
+
+Takes unified_bed_leveling::line_to_destination_cartesian() from
+Marlin/ubl_motion.cpp, with the cell and mesh line helpers from Marlin/ubl.h,
+and builds it with the host C++ compiler next to the version it replaced
+(separate vertical, horizontal and generic loops, each crossing found from
+the slope of the move). Both run over the same moves on a random
+GRID x GRID mesh:
+  random   anywhere on the mesh
+  long     edge to edge, crossing a whole row or column of cells
+  lines    along mesh lines and from mesh points
+  short    within a cell or across one mesh line, as most printing moves are
+The pieces given to planner._buffer_line() are checked against the crossings
+and corrections worked out in double precision, and the time per move of
+each version is printed. Moves keep just inside the last mesh lines, where
+both versions give a move ending on the line no correction.
+
+Host times only show the relative cost; on AVR every float operation is a
+library call. The lines moves come out slower: for a move along a mesh line
+the old loops took no divide per crossing either, while the new walk turns
+its fixed-point fraction into a float at each one.
+Exits with status 1 if any piece of the new version is off by more than
+--tolerance, or a move is split into a different number of pieces.
+
+Example:
+  ublSegmentTest.py
+  ublSegmentTest.py --grid 15 --spacing 20 --moves 100000
+"""
+
+import argparse
+import sys
+
+import marlinHostTest as host
+
+parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+parser.add_argument('--grid', type=int, default=10, help='GRID_MAX_POINTS_X and _Y (default=10)')
+parser.add_argument('--spacing', type=float, default=30, help='mesh spacing in mm (default=30)')
+parser.add_argument('--moves', type=int, default=20000, help='moves of each kind (default=20000)')
+parser.add_argument('--tolerance', type=float, default=1e-3, help='max difference in mm (default=1e-3)')
+host.add_arguments(parser)
+args = parser.parse_args()
+
+PRELUDE = r'''
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "macros.h"
+using std::min;
+using std::isnan;
+using std::isinf;
+#define _BV(b) (1UL << (b))
+#define constrain(v, lo, hi) ((v) < (lo) ? (lo) : (v) > (hi) ? (hi) : (v))
+#define GRID_MAX_POINTS_X %(grid)d
+#define GRID_MAX_POINTS_Y %(grid)d
+#define MESH_X_DIST %(spacing)f
+#define MESH_Y_DIST %(spacing)f
+#define UBL_MESH_MIN_X 10
+#define UBL_MESH_MIN_Y 10
+#define RAW_X_POSITION(P) (P)
+#define RAW_Y_POSITION(P) (P)
+#define LOGICAL_X_POSITION(P) (P)
+#define LOGICAL_Y_POSITION(P) (P)
+#define PSTR(S) (S)
+#define SERIAL_ECHOPAIR(N, V) ((void)(V))
+#define SERIAL_CHAR(C)
+#define SERIAL_EOL()
+void serialprintPGM(const char *) {}
+void debug_current_and_destination(const char *) {}
+enum AxisEnum { X_AXIS, Y_AXIS, Z_AXIS, E_AXIS };
+#define XYZE 4
+#define LOOP_XYZE(VAR) for (uint8_t VAR = X_AXIS; VAR <= E_AXIS; VAR++)
+float current_position[XYZE], destination[XYZE];
+void set_current_to_destination() { for (int i = 0; i < XYZE; i++) current_position[i] = destination[i]; }
+
+// planner._buffer_line() records the pieces, or just sums them for timing
+bool recording;
+float checksum;
+std::vector<float> pieces;
+struct {
+  static void _buffer_line(const float &a, const float &b, const float &c, const float &e, float, const uint8_t) {
+    if (recording) { pieces.push_back(a); pieces.push_back(b); pieces.push_back(c); pieces.push_back(e); }
+    else checksum += a + b + c + e;
+  }
+} planner;
+
+#define FADE 0.75
+struct unified_bed_leveling {
+  static struct { float z_offset; } state;
+  static bool g26_debug_flag;
+  static float z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+  static float mesh_index_to_xpos(const uint8_t i) { return UBL_MESH_MIN_X + i * (MESH_X_DIST); }
+  static float mesh_index_to_ypos(const uint8_t i) { return UBL_MESH_MIN_Y + i * (MESH_Y_DIST); }
+  static float fade_scaling_factor_for_z(const float &) { return FADE; }
+  %(helpers)s
+  static void line_to_destination_cartesian(const float &feed_rate, uint8_t extruder);
+  static void old_line_to_destination_cartesian(const float &feed_rate, uint8_t extruder);
+};
+decltype(unified_bed_leveling::state) unified_bed_leveling::state = { 0.2 };
+bool unified_bed_leveling::g26_debug_flag = false;
+float unified_bed_leveling::z_values[GRID_MAX_POINTS_X][GRID_MAX_POINTS_Y];
+'''
+
+# line_to_destination_cartesian() as it was, without its comments
+REFERENCE = r'''
+  void unified_bed_leveling::old_line_to_destination_cartesian(const float &feed_rate, uint8_t extruder) {
+    const float start[XYZE] = {
+                  current_position[X_AXIS],
+                  current_position[Y_AXIS],
+                  current_position[Z_AXIS],
+                  current_position[E_AXIS]
+                },
+                end[XYZE] = {
+                  destination[X_AXIS],
+                  destination[Y_AXIS],
+                  destination[Z_AXIS],
+                  destination[E_AXIS]
+                };
+    const int cell_start_xi = get_cell_index_x(RAW_X_POSITION(start[X_AXIS])),
+              cell_start_yi = get_cell_index_y(RAW_Y_POSITION(start[Y_AXIS])),
+              cell_dest_xi  = get_cell_index_x(RAW_X_POSITION(end[X_AXIS])),
+              cell_dest_yi  = get_cell_index_y(RAW_Y_POSITION(end[Y_AXIS]));
+    if (g26_debug_flag) {
+      SERIAL_ECHOPAIR(" ubl.line_to_destination(xe=", end[X_AXIS]);
+      SERIAL_ECHOPAIR(", ye=", end[Y_AXIS]);
+      SERIAL_ECHOPAIR(", ze=", end[Z_AXIS]);
+      SERIAL_ECHOPAIR(", ee=", end[E_AXIS]);
+      SERIAL_CHAR(')');
+      SERIAL_EOL();
+      debug_current_and_destination(PSTR("Start of ubl.line_to_destination()"));
+    }
+    if (cell_start_xi == cell_dest_xi && cell_start_yi == cell_dest_yi) {
+      if (!WITHIN(cell_dest_xi, 0, GRID_MAX_POINTS_X - 1) || !WITHIN(cell_dest_yi, 0, GRID_MAX_POINTS_Y - 1)) {
+        planner._buffer_line(end[X_AXIS], end[Y_AXIS], end[Z_AXIS] + state.z_offset, end[E_AXIS], feed_rate, extruder);
+        set_current_to_destination();
+        if (g26_debug_flag)
+          debug_current_and_destination(PSTR("out of bounds in ubl.line_to_destination()"));
+        return;
+      }
+      FINAL_MOVE:
+      const float xratio = (RAW_X_POSITION(end[X_AXIS]) - mesh_index_to_xpos(cell_dest_xi)) * (1.0 / (MESH_X_DIST));
+      float z1 = z_values[cell_dest_xi    ][cell_dest_yi    ] + xratio *
+                (z_values[cell_dest_xi + 1][cell_dest_yi    ] - z_values[cell_dest_xi][cell_dest_yi    ]),
+            z2 = z_values[cell_dest_xi    ][cell_dest_yi + 1] + xratio *
+                (z_values[cell_dest_xi + 1][cell_dest_yi + 1] - z_values[cell_dest_xi][cell_dest_yi + 1]);
+      if (cell_dest_xi >= GRID_MAX_POINTS_X - 1) z1 = z2 = 0.0;
+      const float yratio = (RAW_Y_POSITION(end[Y_AXIS]) - mesh_index_to_ypos(cell_dest_yi)) * (1.0 / (MESH_Y_DIST));
+      float z0 = cell_dest_yi < GRID_MAX_POINTS_Y - 1 ? (z1 + (z2 - z1) * yratio) * fade_scaling_factor_for_z(end[Z_AXIS]) : 0.0;
+      if (isnan(z0)) z0 = 0.0;
+      planner._buffer_line(end[X_AXIS], end[Y_AXIS], end[Z_AXIS] + z0 + state.z_offset, end[E_AXIS], feed_rate, extruder);
+      if (g26_debug_flag)
+        debug_current_and_destination(PSTR("FINAL_MOVE in ubl.line_to_destination()"));
+      set_current_to_destination();
+      return;
+    }
+    const float dx = end[X_AXIS] - start[X_AXIS],
+                dy = end[Y_AXIS] - start[Y_AXIS];
+    const int left_flag = dx < 0.0 ? 1 : 0,
+              down_flag = dy < 0.0 ? 1 : 0;
+    const float adx = left_flag ? -dx : dx,
+                ady = down_flag ? -dy : dy;
+    const int dxi = cell_start_xi == cell_dest_xi ? 0 : left_flag ? -1 : 1,
+              dyi = cell_start_yi == cell_dest_yi ? 0 : down_flag ? -1 : 1;
+    const bool use_x_dist = adx > ady;
+    float on_axis_distance = use_x_dist ? dx : dy,
+          e_position = end[E_AXIS] - start[E_AXIS],
+          z_position = end[Z_AXIS] - start[Z_AXIS];
+    const float e_normalized_dist = e_position / on_axis_distance,
+                z_normalized_dist = z_position / on_axis_distance;
+    int current_xi = cell_start_xi,
+        current_yi = cell_start_yi;
+    const float m = dy / dx,
+                c = start[Y_AXIS] - m * start[X_AXIS];
+    const bool inf_normalized_flag = (isinf(e_normalized_dist) != 0),
+               inf_m_flag = (isinf(m) != 0);
+    if (dxi == 0) {
+      current_yi += down_flag;
+      while (current_yi != cell_dest_yi + down_flag) {
+        current_yi += dyi;
+        const float next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
+        const float x = inf_m_flag ? start[X_AXIS] : (next_mesh_line_y - c) / m;
+        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi, current_yi);
+        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
+        if (isnan(z0)) z0 = 0.0;
+        const float y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi));
+        if (y != start[Y_AXIS]) {
+          if (!inf_normalized_flag) {
+            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
+            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
+            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
+          }
+          else {
+            e_position = end[E_AXIS];
+            z_position = end[Z_AXIS];
+          }
+          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+        }
+      }
+      if (g26_debug_flag)
+        debug_current_and_destination(PSTR("vertical move done in ubl.line_to_destination()"));
+      if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
+        goto FINAL_MOVE;
+      set_current_to_destination();
+      return;
+    }
+    if (dyi == 0) {
+      current_xi += left_flag;
+      while (current_xi != cell_dest_xi + left_flag) {
+        current_xi += dxi;
+        const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi)),
+                    y = m * next_mesh_line_x + c;
+        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi, current_yi);
+        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
+        if (isnan(z0)) z0 = 0.0;
+        const float x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi));
+        if (x != start[X_AXIS]) {
+          if (!inf_normalized_flag) {
+            on_axis_distance = use_x_dist ? x - start[X_AXIS] : y - start[Y_AXIS];
+            e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
+            z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
+          }
+          else {
+            e_position = end[E_AXIS];
+            z_position = end[Z_AXIS];
+          }
+          planner._buffer_line(x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+        }
+      }
+      if (g26_debug_flag)
+        debug_current_and_destination(PSTR("horizontal move done in ubl.line_to_destination()"));
+      if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
+        goto FINAL_MOVE;
+      set_current_to_destination();
+      return;
+    }
+    int xi_cnt = cell_start_xi - cell_dest_xi,
+        yi_cnt = cell_start_yi - cell_dest_yi;
+    if (xi_cnt < 0) xi_cnt = -xi_cnt;
+    if (yi_cnt < 0) yi_cnt = -yi_cnt;
+    current_xi += left_flag;
+    current_yi += down_flag;
+    while (xi_cnt > 0 || yi_cnt > 0) {
+      const float next_mesh_line_x = LOGICAL_X_POSITION(mesh_index_to_xpos(current_xi + dxi)),
+                  next_mesh_line_y = LOGICAL_Y_POSITION(mesh_index_to_ypos(current_yi + dyi)),
+                  y = m * next_mesh_line_x + c,
+                  x = (next_mesh_line_y - c) / m;
+      if (left_flag == (x > next_mesh_line_x)) {
+        float z0 = z_correction_for_x_on_horizontal_mesh_line(x, current_xi - left_flag, current_yi + dyi);
+        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
+        if (isnan(z0)) z0 = 0.0;
+        if (!inf_normalized_flag) {
+          on_axis_distance = use_x_dist ? x - start[X_AXIS] : next_mesh_line_y - start[Y_AXIS];
+          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
+          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
+        }
+        else {
+          e_position = end[E_AXIS];
+          z_position = end[Z_AXIS];
+        }
+        planner._buffer_line(x, next_mesh_line_y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+        current_yi += dyi;
+        yi_cnt--;
+      }
+      else {
+        float z0 = z_correction_for_y_on_vertical_mesh_line(y, current_xi + dxi, current_yi - down_flag);
+        z0 *= fade_scaling_factor_for_z(end[Z_AXIS]);
+        if (isnan(z0)) z0 = 0.0;
+        if (!inf_normalized_flag) {
+          on_axis_distance = use_x_dist ? next_mesh_line_x - start[X_AXIS] : y - start[Y_AXIS];
+          e_position = start[E_AXIS] + on_axis_distance * e_normalized_dist;
+          z_position = start[Z_AXIS] + on_axis_distance * z_normalized_dist;
+        }
+        else {
+          e_position = end[E_AXIS];
+          z_position = end[Z_AXIS];
+        }
+        planner._buffer_line(next_mesh_line_x, y, z_position + z0 + state.z_offset, e_position, feed_rate, extruder);
+        current_xi += dxi;
+        xi_cnt--;
+      }
+      if (xi_cnt < 0 || yi_cnt < 0) break;
+    }
+    if (g26_debug_flag)
+      debug_current_and_destination(PSTR("generic move done in ubl.line_to_destination()"));
+    if (current_position[X_AXIS] != end[X_AXIS] || current_position[Y_AXIS] != end[Y_AXIS])
+      goto FINAL_MOVE;
+    set_current_to_destination();
+  }
+
+'''
+
+MAIN = r'''
+typedef unified_bed_leveling ubl_t;
+const double lo = UBL_MESH_MIN_X, hi = UBL_MESH_MIN_X + (GRID_MAX_POINTS_X - 1) * (MESH_X_DIST);
+
+// The correction at x,y in double precision, 0 off the mesh
+double correction(const double x, const double y) {
+  const double fx = (x - lo) / (MESH_X_DIST), fy = (y - lo) / (MESH_Y_DIST);
+  if (fx < -1e-9 || fy < -1e-9 || fx > GRID_MAX_POINTS_X - 1 + 1e-9 || fy > GRID_MAX_POINTS_Y - 1 + 1e-9) return 0;
+  const int cx = std::min((int)fx, GRID_MAX_POINTS_X - 2), cy = std::min((int)fy, GRID_MAX_POINTS_Y - 2);
+  const double rx = fx - cx, ry = fy - cy,
+               z1 = ubl_t::z_values[cx][cy] + rx * (ubl_t::z_values[cx + 1][cy] - ubl_t::z_values[cx][cy]),
+               z2 = ubl_t::z_values[cx][cy + 1] + rx * (ubl_t::z_values[cx + 1][cy + 1] - ubl_t::z_values[cx][cy + 1]);
+  return (z1 + ry * (z2 - z1)) * FADE;
+}
+
+// The pieces in double precision: one at each mesh line crossing, and the end
+std::vector<double> expected(const float s[XYZE], const float d[XYZE]) {
+  std::vector<double> t;
+  for (int axis = 0; axis < 2; axis++) {
+    const int c1 = ubl_t::get_cell_index_x(s[axis]), c2 = ubl_t::get_cell_index_x(d[axis]);
+    for (int g = std::min(c1, c2) + 1; g <= std::max(c1, c2); g++) {
+      const double f = (lo + g * (MESH_X_DIST) - s[axis]) / ((double)d[axis] - s[axis]);
+      if (f > 0) t.push_back(f);
+    }
+  }
+  std::sort(t.begin(), t.end());
+  t.erase(std::unique(t.begin(), t.end(), [](double a, double b) { return b - a < 1e-9; }), t.end());
+  t.push_back(1);
+  std::vector<double> out;
+  for (const double f : t) {
+    double p[XYZE];
+    for (int i = 0; i < XYZE; i++) p[i] = s[i] + f * ((double)d[i] - s[i]);
+    out.push_back(p[X_AXIS]);
+    out.push_back(p[Y_AXIS]);
+    out.push_back(p[Z_AXIS] + correction(p[X_AXIS], p[Y_AXIS]) + ubl_t::state.z_offset);
+    out.push_back(p[E_AXIS]);
+  }
+  return out;
+}
+
+int main() {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> z(-0.5f, 0.5f), u(0, 1);
+  for (int x = 0; x < GRID_MAX_POINTS_X; x++)
+    for (int y = 0; y < GRID_MAX_POINTS_Y; y++)
+      ubl_t::z_values[x][y] = z(rng);
+
+  // Moves stay off the last mesh lines, where a move ending there is given no correction
+  const float top = hi - 0.01f, size = top - lo;
+  for (int kind = 0; kind < 4; kind++) {
+    std::vector<float> moves;
+    for (int i = 0; i < %(moves)d; i++) {
+      float s[2], d[2];
+      switch (kind) {
+        case 0: for (int a = 0; a < 2; a++) { s[a] = lo + u(rng) * size; d[a] = lo + u(rng) * size; } break;
+        case 1: {
+          const int side = rng() %% 4;
+          s[0] = side & 1 ? lo : lo + u(rng) * size; s[1] = side & 1 ? lo + u(rng) * size : lo;
+          d[0] = side & 1 ? top : lo + u(rng) * size; d[1] = side & 1 ? lo + u(rng) * size : top;
+          if (side & 2) { std::swap(s[0], d[0]); std::swap(s[1], d[1]); }
+        } break;
+        case 2: {
+          // Along a mesh line, or from one mesh point to another
+          const int a = rng() %% 2, g = rng() %% (GRID_MAX_POINTS_X - 1);
+          s[a] = d[a] = lo + g * (MESH_X_DIST);
+          s[!a] = lo + u(rng) * size; d[!a] = lo + u(rng) * size;
+          if (rng() %% 2) s[!a] = lo + (rng() %% (GRID_MAX_POINTS_X - 1)) * (MESH_X_DIST);
+        } break;
+        case 3:
+          for (int a = 0; a < 2; a++) { s[a] = lo + u(rng) * size; d[a] = std::min(std::max(s[a] + (u(rng) - 0.5f) * (float)(MESH_X_DIST), (float)lo), top); }
+          break;
+      }
+      moves.insert(moves.end(), { s[0], s[1], 0.2f + u(rng), u(rng) * 100, d[0], d[1], 0.2f + u(rng), u(rng) * 100 });
+    }
+
+    // Check
+    double worst = 0, worst_old = 0;
+    long wrong = 0, wrong_old = 0, count_old = 0;
+    for (int version = 0; version < 2; version++)
+      for (size_t m = 0; m < moves.size(); m += 8) {
+        for (int i = 0; i < XYZE; i++) { current_position[i] = moves[m + i]; destination[i] = moves[m + 4 + i]; }
+        const std::vector<double> want = expected(&moves[m], &moves[m + 4]);
+        recording = true;
+        pieces.clear();
+        if (version) ubl_t::old_line_to_destination_cartesian(100, 0); else ubl_t::line_to_destination_cartesian(100, 0);
+        if (pieces.size() != want.size()) {
+          (version ? count_old : wrong)++;
+          continue;
+        }
+        double diff = 0;
+        for (size_t i = 0; i < want.size(); i++) diff = std::max(diff, std::fabs(pieces[i] - want[i]));
+        if (version) { worst_old = std::max(worst_old, diff); wrong_old += diff > %(tolerance)g; }
+        else { worst = std::max(worst, diff); wrong += diff > %(tolerance)g; }
+      }
+
+    // Time
+    recording = false;
+    double ns[2];
+    for (int version = 0; version < 2; version++) {
+      const auto start = std::chrono::steady_clock::now();
+      for (int rep = 0; rep < 5; rep++)
+        for (size_t m = 0; m < moves.size(); m += 8) {
+          for (int i = 0; i < XYZE; i++) { current_position[i] = moves[m + i]; destination[i] = moves[m + 4 + i]; }
+          if (version) ubl_t::old_line_to_destination_cartesian(100, 0); else ubl_t::line_to_destination_cartesian(100, 0);
+        }
+      ns[version] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (5 * moves.size() / 8);
+    }
+    printf("%%d %%g %%ld %%g %%ld %%ld %%.1f %%.1f\n", kind, worst, wrong, worst_old, wrong_old, count_old, ns[1], ns[0]);
+  }
+  return 0;
+}
+'''
+
+
+def extract():
+  line = host.extract(args, 'ubl_motion.cpp', r'\n  void unified_bed_leveling::line_to_destination_cartesian\(.*?\n  }\n', 'line_to_destination_cartesian()')
+  h1 = host.extract(args, 'ubl.h', r'\n      static int8_t get_cell_index_x\(.*?(?=\n      static int8_t find_closest_x_index)', 'get_cell_index_x()')
+  h2 = host.extract(args, 'ubl.h', r'\n      inline static float z_correction_for_x_on_horizontal_mesh_line\(.*?(?=\n      /\*\*\n       \* This is the generic Z-Correction)', 'z_correction_for_x_on_horizontal_mesh_line()')
+  return line, h1 + h2
+
+
+code, helpers = extract()
+src = PRELUDE % dict(vars(args), helpers=helpers) + code + REFERENCE + MAIN % vars(args)
+with host.HostBuild(args) as build:
+  out = host.output(build.build(src))
+
+failed = False
+print('%-8s %12s %8s %12s %8s %10s %10s %10s %8s' % ('moves', 'max diff mm', 'wrong', 'old diff', 'wrong', 'old split', 'old ns', 'new ns', 'speedup'))
+for line in out.splitlines():
+  kind, worst, wrong, worst_old, wrong_old, count_old, old_ns, new_ns = line.split()
+  print('%-8s %12.2g %8s %12.2g %8s %10s %10s %10s %7.2fx' % (('random', 'long', 'lines', 'short')[int(kind)],
+    float(worst), wrong, float(worst_old), wrong_old, count_old, old_ns, new_ns, float(old_ns) / float(new_ns)))
+  failed |= int(wrong) > 0
+
+sys.exit(1 if failed else 0)